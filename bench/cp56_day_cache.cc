@@ -0,0 +1,176 @@
+// Разбор меток времени CP56Time2a в ASDU мониторинга, как в RawMessageHandler IEC104Client /
+// IEC101MasterBalanced / IEC101MasterUnbalanced / IEC104ClientPool / IEC101LineManager: элемент
+// декодируется через CS101_ASDU_getElementEx, метка переводится в мс через
+// CP56Time2a_toMsTimestampCached с кэшем суток потока приёма. Для сравнения — прежний
+// CP56Time2a_toMsTimestamp, который считает календарную дату для каждой метки.
+//
+//   bench_cp56_day_cache [--asdus 200000] [--check]
+//
+// ASDU — M_SP_TB_1 и M_ME_TF_1 (SQ=1 и SQ=0) с наибольшим числом элементов, которое помещается
+// в 249 байт. Метки элементов идут через 7 минут и переходят через полночь. С --check код выхода 1,
+// если метки с кэшем суток расходятся с CP56Time2a_toMsTimestamp.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "iec60870_decode.h"
+
+extern "C" {
+#include "cs101_asdu_internal.h"
+#include "cs101_information_objects.h"
+#include "iec60870_common.h"
+}
+
+static struct sCS101_AppLayerParameters appLayerParameters = {
+    /* .sizeOfTypeId = */ 1,
+    /* .sizeOfVSQ = */ 1,
+    /* .sizeOfCOT = */ 2,
+    /* .originatorAddress = */ 0,
+    /* .sizeOfCA = */ 2,
+    /* .sizeOfIOA = */ 3,
+    /* .maxSizeOfASDU = */ 249
+};
+
+static const int HEADER_SIZE = 6;
+static const uint64_t FIRST_TIMESTAMP = 1760652000000ULL; // 16.10.2025 22:00 UTC, за 2 часа до полуночи
+
+// Элементы (без IOA) для M_SP_TB_1 и M_ME_TF_1: значение, качество, CP56Time2a
+static int ElementSize(int typeId) { return typeId == M_SP_TB_1 ? 8 : 12; }
+
+static std::vector<uint8_t> EncodeASDU(int typeId, bool sequence)
+{
+    int elementSize = ElementSize(typeId);
+    int count = sequence ? (appLayerParameters.maxSizeOfASDU - HEADER_SIZE - 3) / elementSize
+                         : (appLayerParameters.maxSizeOfASDU - HEADER_SIZE) / (3 + elementSize);
+    std::vector<uint8_t> msg = {static_cast<uint8_t>(typeId), static_cast<uint8_t>((sequence ? 0x80 : 0) | count), 3, 0, 1, 0};
+    for (int i = 0; i < count; i++) {
+        int ioa = 1000 + i;
+        if (i == 0 || !sequence) {
+            msg.push_back(static_cast<uint8_t>(ioa));
+            msg.push_back(static_cast<uint8_t>(ioa >> 8));
+            msg.push_back(static_cast<uint8_t>(ioa >> 16));
+        }
+        if (typeId == M_SP_TB_1) {
+            msg.push_back(static_cast<uint8_t>(i & 1));
+        } else {
+            float value = 0.5f * i;
+            uint8_t bytes[4];
+            memcpy(bytes, &value, 4);
+            msg.insert(msg.end(), bytes, bytes + 4);
+            msg.push_back(IEC60870_QUALITY_GOOD);
+        }
+        struct sCP56Time2a time;
+        memset(&time, 0, sizeof(time));
+        CP56Time2a_setFromMsTimestamp(&time, FIRST_TIMESTAMP + static_cast<uint64_t>(i) * 7 * 60 * 1000 + i);
+        msg.insert(msg.end(), time.encodedValue, time.encodedValue + 7);
+    }
+    return msg;
+}
+
+struct Connection {
+    IODecodeBuffer decodeBuffer;
+    DecodedPoints decodedPoints;
+    CP56Time2aDayCache dayCache = {0, 0};
+};
+
+// Значение и качество элемента; метку времени разбирает вызывающий
+static InformationObject DecodeValue(Connection &con, CS101_ASDU asdu, int i, double &val, uint8_t &quality)
+{
+    InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&con.decodeBuffer, i);
+    if (!io)
+        return nullptr;
+    if (CS101_ASDU_getTypeID(asdu) == M_SP_TB_1) {
+        val = SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0;
+        quality = SinglePointInformation_getQuality((SinglePointInformation)io);
+    } else {
+        val = MeasuredValueShort_getValue((MeasuredValueShort)io);
+        quality = MeasuredValueShort_getQuality((MeasuredValueShort)io);
+    }
+    return io;
+}
+
+static CP56Time2a ElementTimestamp(CS101_ASDU asdu, InformationObject io)
+{
+    if (CS101_ASDU_getTypeID(asdu) == M_SP_TB_1)
+        return SinglePointWithCP56Time2a_getTimestamp((SinglePointWithCP56Time2a)io);
+    return MeasuredValueShortWithCP56Time2a_getTimestamp((MeasuredValueShortWithCP56Time2a)io);
+}
+
+// Метка из информационного объекта каждого элемента, с кэшем суток или без
+template <bool cached>
+static void DecodeASDU(Connection &con, CS101_ASDU asdu)
+{
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+    DecodedPoints &elements = con.decodedPoints;
+    elements.clear();
+    for (int i = 0; i < numberOfElements; i++) {
+        double val = 0;
+        uint8_t quality = 0;
+        InformationObject io = DecodeValue(con, asdu, i, val, quality);
+        if (!io)
+            continue;
+        CP56Time2a time = ElementTimestamp(asdu, io);
+        uint64_t timestamp = cached ? CP56Time2a_toMsTimestampCached(time, &con.dayCache) : CP56Time2a_toMsTimestamp(time);
+        elements.emplace_back(InformationObject_getObjectAddress(io), val, quality, timestamp);
+    }
+}
+
+static uint64_t checksum = 0;
+
+template <typename Decode>
+static double Run(const std::string &name, int asdus, int numberOfElements, Decode decode)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < asdus; i++)
+        checksum += decode();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double ns = seconds * 1e9 / asdus;
+    fprintf(stderr, "%-34s %8.1f ns/ASDU %6.1f ns/element\n", name.c_str(), ns, ns / numberOfElements);
+    return ns;
+}
+
+int main(int argc, char **argv)
+{
+    int asdus = 200000;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--asdus") && i + 1 < argc)
+            asdus = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+    }
+
+    bool failed = false;
+    for (int typeId : {M_SP_TB_1, M_ME_TF_1}) {
+        for (bool sequence : {true, false}) {
+            std::vector<uint8_t> msg = EncodeASDU(typeId, sequence);
+            CS101_ASDU asdu = CS101_ASDU_createFromBuffer(&appLayerParameters, msg.data(), static_cast<int>(msg.size()));
+            int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+            std::string suffix = std::string(" ") + TypeID_toString(static_cast<TypeID>(typeId)) + (sequence ? " SQ=1" : " SQ=0") +
+                                 " x" + std::to_string(numberOfElements);
+
+            // Метки с кэшем суток должны совпасть с CP56Time2a_toMsTimestamp
+            Connection *con = new Connection();
+            DecodeASDU<false>(*con, asdu);
+            DecodedPoints expected = con->decodedPoints;
+            DecodeASDU<true>(*con, asdu);
+            if (con->decodedPoints != expected || static_cast<int>(expected.size()) != numberOfElements) {
+                fprintf(stderr, "timestamps differ:%s\n", suffix.c_str());
+                failed = true;
+            }
+
+            auto last = [con] { return std::get<3>(con->decodedPoints.back()); };
+            double cached = Run("toMsTimestampCached" + suffix, asdus, numberOfElements, [&] { DecodeASDU<true>(*con, asdu); return last(); });
+            double uncached = Run("toMsTimestamp" + suffix, asdus, numberOfElements, [&] { DecodeASDU<false>(*con, asdu); return last(); });
+            fprintf(stderr, "%-34s %8.2fx\n", "speedup", uncached / cached);
+
+            delete con;
+            CS101_ASDU_destroy(asdu);
+        }
+    }
+    fprintf(stderr, "checksum %llu\n", static_cast<unsigned long long>(checksum));
+    return check && failed ? 1 : 0;
+}
@@ -0,0 +1,396 @@
+// Потоки, память и переключения контекста на соединение для двух схем клиента IEC 104:
+//   thread — как IEC104Client: поток соединения аддона (ожидание с шагом 100 мс) и поток приёма
+//            lib60870 на каждое RTU;
+//   pool   — как IEC104ClientPool: соединения без своего потока (CS104_Connection_connectThreadless)
+//            на нескольких рабочих потоках с epoll и кучей таймеров.
+//
+//   bench_cs104_pool_threads [--connections 200] [--workers 2] [--seconds 3] [--port 24992] [--check]
+//
+// RTU — CS104_Slave в дочернем процессе (по 100 соединений на порт, epoll-потоки слейва). После
+// STARTDT_CON каждое соединение шлёт общий опрос, RTU отвечает одним M_ME_NC_1, дальше только TESTFR
+// по t3 = 1 с. Каждая схема замеряется в своём дочернем процессе: рост VmRSS и VmSize на соединение
+// после опроса и переключения контекста в секунду (getrusage, все потоки).
+// Стек потока резервирует 8 МиБ адресного пространства, но занимает лишь несколько страниц, а буфер
+// чтения CS104_Connection (4 КиБ) остаётся и в пуле, поэтому RSS сокращается в разы, а не на порядок.
+// Отношения памяти и переключений контекста только выводятся: они зависят от нагрузки машины.
+// С --check код выхода 1, если не все соединения получили ответ на опрос или у пула больше потоков,
+// чем рабочих потоков и основной.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+extern "C" {
+#include "cs104_connection.h"
+#include "cs104_slave.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+}
+
+static const int CONNECTIONS_PER_SLAVE = 100; // CONFIG_CS104_MAX_CLIENT_CONNECTIONS
+
+struct Result {
+    int activated;
+    int delivered;
+    int threads;
+    double rssKiB;
+    double vmKiB;
+    double switchesPerSecond;
+};
+
+static long ProcStatus(const char *field)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+        return 0;
+    char line[256];
+    long value = 0;
+    size_t length = strlen(field);
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, field, length) && line[length] == ':') {
+            value = atol(line + length + 1);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+static long ContextSwitches()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// Ответ на общий опрос: ACT_CON, одно измерение, ACT_TERM
+static bool InterrogationHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu, uint8_t qoi)
+{
+    IMasterConnection_sendACT_CON(connection, asdu, false);
+    CS101_ASDU response = CS101_ASDU_create(IMasterConnection_getApplicationLayerParameters(connection), false,
+                                            CS101_COT_INTERROGATED_BY_STATION, 0, CS101_ASDU_getCA(asdu), false, false);
+    InformationObject io = (InformationObject)MeasuredValueShort_create(NULL, 1000, 1.5f, IEC60870_QUALITY_GOOD);
+    CS101_ASDU_addInformationObject(response, io);
+    InformationObject_destroy(io);
+    IMasterConnection_sendASDU(connection, response);
+    CS101_ASDU_destroy(response);
+    IMasterConnection_sendACT_TERM(connection, asdu);
+    return true;
+}
+
+static void RunSlaves(int port, int connections)
+{
+    std::vector<CS104_Slave> slaves;
+    for (int i = 0; i * CONNECTIONS_PER_SLAVE < connections; i++) {
+        CS104_Slave slave = CS104_Slave_create(10, 10);
+        CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+        CS104_Slave_setLocalPort(slave, port + i);
+        CS104_Slave_setServerMode(slave, CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP);
+        CS104_Slave_setMaxOpenConnections(slave, CONNECTIONS_PER_SLAVE);
+        CS104_Slave_setEpollWorkers(slave, 1);
+        CS104_Slave_setInterrogationHandler(slave, InterrogationHandler, NULL);
+        CS104_Slave_start(slave);
+        if (!CS104_Slave_isRunning(slave)) {
+            fprintf(stderr, "failed to start the slave on port %d\n", port + i);
+            _exit(1);
+        }
+        slaves.push_back(slave);
+    }
+    // Останавливается сигналом от родителя
+    while (true)
+        Thread_sleep(1000);
+}
+
+static struct sCS104_APCIParameters BenchAPCIParameters()
+{
+    struct sCS104_APCIParameters apci = {12, 8, 10, 15, 10, 1};
+    return apci;
+}
+
+static std::atomic<int> activated{0};
+static std::atomic<int> delivered{0};
+
+static void ConnectionHandler(void *parameter, CS104_Connection con, CS104_ConnectionEvent event)
+{
+    if (event == CS104_CONNECTION_OPENED) {
+        CS104_Connection_sendStartDT(con);
+    } else if (event == CS104_CONNECTION_STARTDT_CON_RECEIVED) {
+        activated++;
+    }
+}
+
+static bool AsduHandler(void *parameter, int address, CS101_ASDU asdu)
+{
+    if (CS101_ASDU_getTypeID(asdu) == M_ME_NC_1)
+        delivered++;
+    return true;
+}
+
+// Очередь accept слейва lib60870 — 2 соединения, поэтому подключения разнесены во времени
+static const int CONNECT_INTERVAL_MS = 5;
+
+// Все соединения процесса замера: общий опрос шлёт основной поток после STARTDT_CON (обработчик
+// соединения вызывается под блокировкой соединения, отправка из него не возвращается)
+static std::vector<CS104_Connection> allConnections;
+
+static CS104_Connection CreateConnection(int port, int index)
+{
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port + index / CONNECTIONS_PER_SLAVE);
+    allConnections.push_back(con);
+    struct sCS104_APCIParameters apci = BenchAPCIParameters();
+    CS104_Connection_setAPCIParameters(con, &apci);
+    CS104_Connection_setConnectionHandler(con, ConnectionHandler, NULL);
+    CS104_Connection_setASDUReceivedHandler(con, AsduHandler, NULL);
+    return con;
+}
+
+// Схема IEC104Client: поток соединения на каждое RTU ждёт события с шагом 100 мс, соединение ведёт
+// поток приёма lib60870
+class ThreadClients {
+public:
+    void Start(int port, int connections)
+    {
+        for (int i = 0; i < connections; i++) {
+            CS104_Connection con = CreateConnection(port, i);
+            cons.push_back(con);
+            threads.emplace_back([this, con] {
+                CS104_Connection_connectAsync(con);
+                // Процесс замера завершается через _exit, потоки не останавливаются
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true)
+                    cv.wait_for(lock, std::chrono::milliseconds(100));
+            });
+            Thread_sleep(CONNECT_INTERVAL_MS);
+        }
+    }
+
+private:
+    std::vector<CS104_Connection> cons;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+// Схема IEC104ClientPool: рабочий поток ждёт сокеты своих соединений одним epoll и ведёт их через
+// CS104_Connection_run по готовности сокета или по ближайшему таймеру (как WorkerLoop пула)
+class PoolClients {
+public:
+    void Start(int port, int connections, int workerCount)
+    {
+        for (int w = 0; w < workerCount; w++)
+            workers.push_back(std::make_unique<Worker>());
+        // TCP-подключение завершает ядро, рабочие потоки подхватывают сокеты после запуска
+        for (int i = 0; i < connections; i++) {
+            Worker &worker = *workers[i % workerCount];
+            CS104_Connection con = CreateConnection(port, i);
+            CS104_Connection_connectThreadless(con);
+            worker.cons.push_back(con);
+            Thread_sleep(CONNECT_INTERVAL_MS);
+        }
+        for (auto &worker : workers) {
+            Worker *w = worker.get();
+            w->thread = std::thread([this, w] { Run(*w); });
+        }
+    }
+
+private:
+    struct Timer {
+        uint64_t due;
+        size_t index;
+        bool operator>(const Timer &other) const { return due > other.due; }
+    };
+
+    struct Worker {
+        std::vector<CS104_Connection> cons;
+        std::vector<int> registeredFd;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+        int epollFd = -1;
+        std::thread thread;
+    };
+
+    void Register(Worker &worker, size_t index)
+    {
+        int fd = CS104_Connection_getSocketFd(worker.cons[index]);
+        struct epoll_event ev;
+        ev.events = CS104_Connection_isConnecting(worker.cons[index]) ? EPOLLOUT : EPOLLIN;
+        ev.data.u64 = index;
+        if (fd >= 0 && fd != worker.registeredFd[index]) {
+            if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &ev) == 0)
+                worker.registeredFd[index] = fd;
+        } else if (fd >= 0) {
+            epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    void Step(Worker &worker, size_t index, uint64_t now)
+    {
+        CS104_Connection con = worker.cons[index];
+        if (!CS104_Connection_run(con)) {
+            worker.registeredFd[index] = -1;
+            return;
+        }
+        Register(worker, index);
+        worker.timers.push({std::max(CS104_Connection_getNextTimeout(con), now + 1), index});
+    }
+
+    void Run(Worker &worker)
+    {
+        worker.epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker.registeredFd.assign(worker.cons.size(), -1);
+        uint64_t now = Hal_getTimeInMs();
+        for (size_t i = 0; i < worker.cons.size(); i++) {
+            Register(worker, i);
+            worker.timers.push({CS104_Connection_getNextTimeout(worker.cons[i]), i});
+        }
+
+        struct epoll_event events[64];
+        while (true) {
+            int timeout = -1;
+            now = Hal_getTimeInMs();
+            if (!worker.timers.empty())
+                timeout = worker.timers.top().due <= now ? 0 : static_cast<int>(std::min<uint64_t>(worker.timers.top().due - now, INT32_MAX));
+            int count = epoll_wait(worker.epollFd, events, 64, timeout);
+            now = Hal_getTimeInMs();
+            for (int i = 0; i < count; i++)
+                Step(worker, static_cast<size_t>(events[i].data.u64), now);
+            // Просроченные записи кучи безвредны: лишний вызов CS104_Connection_run ничего не делает
+            while (!worker.timers.empty() && worker.timers.top().due <= now) {
+                size_t index = worker.timers.top().index;
+                worker.timers.pop();
+                if (worker.registeredFd[index] >= 0)
+                    Step(worker, index, now);
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+};
+
+// Замер одной схемы в отдельном процессе, чтобы память и потоки другой схемы не смешивались
+static bool Measure(bool pool, int port, int connections, int workers, int seconds, Result &result)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        long rssBefore = ProcStatus("VmRSS");
+        long vmBefore = ProcStatus("VmSize");
+        ThreadClients threadClients;
+        PoolClients poolClients;
+        if (pool)
+            poolClients.Start(port, connections, workers);
+        else
+            threadClients.Start(port, connections);
+
+        uint64_t deadline = Hal_getTimeInMs() + 20000;
+        while (activated < connections && Hal_getTimeInMs() < deadline)
+            Thread_sleep(10);
+        for (CS104_Connection con : allConnections)
+            CS104_Connection_sendInterrogationCommand(con, CS101_COT_ACTIVATION, 1, IEC60870_QOI_STATION);
+        while (delivered < connections && Hal_getTimeInMs() < deadline)
+            Thread_sleep(10);
+        Thread_sleep(1000);
+
+        Result r;
+        r.activated = activated;
+        r.delivered = delivered;
+        r.threads = static_cast<int>(ProcStatus("Threads"));
+        r.rssKiB = static_cast<double>(ProcStatus("VmRSS") - rssBefore);
+        r.vmKiB = static_cast<double>(ProcStatus("VmSize") - vmBefore);
+        long switchesBefore = ContextSwitches();
+        auto start = std::chrono::steady_clock::now();
+        Thread_sleep(seconds * 1000);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        r.switchesPerSecond = (ContextSwitches() - switchesBefore) / elapsed;
+
+        // Соединения не закрываются: CS104_Connection_destroy ждёт поток приёма до 100 мс на соединение,
+        // а сокеты закроет выход процесса
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    int connections = 200;
+    int workers = 2;
+    int seconds = 3;
+    int port = 24992;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--connections") && i + 1 < argc)
+            connections = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--workers") && i + 1 < argc)
+            workers = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--port") && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+    }
+
+    pid_t slaves = fork();
+    if (slaves == 0) {
+        RunSlaves(port, connections);
+        _exit(0);
+    }
+    Thread_sleep(500);
+
+    Result results[2];
+    bool ok = true;
+    for (int mode = 0; mode < 2 && ok; mode++) {
+        ok = Measure(mode == 1, port, connections, workers, seconds, results[mode]);
+        if (ok && results[mode].activated < connections) {
+            fprintf(stderr, "%s: only %d of %d connections activated\n", mode ? "pool" : "thread", results[mode].activated, connections);
+            ok = false;
+        }
+        if (ok && results[mode].delivered < connections) {
+            fprintf(stderr, "%s: only %d of %d interrogation responses delivered\n", mode ? "pool" : "thread", results[mode].delivered, connections);
+            ok = false;
+        }
+    }
+    kill(slaves, SIGKILL);
+    waitpid(slaves, NULL, 0);
+    if (!ok) {
+        fprintf(stderr, "measurement failed\n");
+        return 1;
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        const Result &r = results[mode];
+        fprintf(stderr, "%-6s %5d connections %5d threads %8.1f KiB RSS/connection %10.1f KiB virtual/connection %10.1f context switches/s\n",
+                mode ? "pool" : "thread", connections, r.threads, r.rssKiB / connections, r.vmKiB / connections, r.switchesPerSecond);
+    }
+    double rssRatio = results[0].rssKiB / std::max(results[1].rssKiB, 1.0);
+    double vmRatio = results[0].vmKiB / std::max(results[1].vmKiB, 1.0);
+    double switchRatio = results[0].switchesPerSecond / std::max(results[1].switchesPerSecond, 1.0);
+    fprintf(stderr, "pool: %.1fx less RSS, %.1fx less virtual memory, %.1fx fewer context switches\n", rssRatio, vmRatio, switchRatio);
+    if (results[1].threads > workers + 1) {
+        fprintf(stderr, "pool: %d threads for %d workers\n", results[1].threads, workers);
+        return check ? 1 : 0;
+    }
+    return 0;
+}
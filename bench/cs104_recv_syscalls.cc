@@ -0,0 +1,173 @@
+// Системные вызовы на приём кадров CS104: IEC104Client (CS104_Connection) раз за разом посылает
+// общий опрос CS104_Slave в том же процессе и получает ответ пачкой коротких I-кадров. Считаются
+// recv и poll на сокете клиента. Прежний receiveMessage читал каждый APDU тремя recv (старт, длина,
+// остаток) после poll — 4 вызова на кадр; буфер чтения соединения забирает пришедшие кадры одним recv.
+//
+//   bench_cs104_recv_syscalls [--asdus 50000] [--port 24990] [--check]
+//
+// Параметры APCI по умолчанию (k = 12, w = 8). Ответ на опрос — ACT_CON, GI_ASDUS ASDU M_ME_NC_1
+// с одним элементом (21 байт на кадр) и ACT_TERM. С --check код выхода 1, если на кадр приходится
+// больше 4/3 системных вызовов (сокращение меньше чем в 3 раза).
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+extern "C" {
+#include "cs104_connection.h"
+#include "cs104_slave.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+}
+
+static const int MAX_FD = 1024;
+
+struct FdCounters {
+    std::atomic<uint64_t> recvCalls{0};
+    std::atomic<uint64_t> recvBytes{0};
+    std::atomic<uint64_t> pollCalls{0};
+};
+
+static FdCounters counters[MAX_FD];
+
+extern "C" {
+ssize_t recv(int fd, void *buf, size_t len, int flags)
+{
+    static ssize_t (*realRecv)(int, void *, size_t, int) = (ssize_t (*)(int, void *, size_t, int))dlsym(RTLD_NEXT, "recv");
+    ssize_t result = realRecv(fd, buf, len, flags);
+    if (fd >= 0 && fd < MAX_FD) {
+        counters[fd].recvCalls++;
+        if (result > 0)
+            counters[fd].recvBytes += result;
+    }
+    return result;
+}
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    static int (*realPoll)(struct pollfd *, nfds_t, int) = (int (*)(struct pollfd *, nfds_t, int))dlsym(RTLD_NEXT, "poll");
+    for (nfds_t i = 0; i < nfds; i++) {
+        if (fds[i].fd >= 0 && fds[i].fd < MAX_FD)
+            counters[fds[i].fd].pollCalls++;
+    }
+    return realPoll(fds, nfds, timeout);
+}
+}
+
+// Вместе с ACT_CON и ACT_TERM ответ помещается в очередь высокого приоритета соединения (50)
+static const int GI_ASDUS = 45;
+
+static bool InterrogationHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu, uint8_t qoi)
+{
+    IMasterConnection_sendACT_CON(connection, asdu, false);
+    CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
+    for (int i = 0; i < GI_ASDUS; i++) {
+        CS101_ASDU response = CS101_ASDU_create(alParams, false, CS101_COT_INTERROGATED_BY_STATION, 0, 1, false, false);
+        InformationObject io = (InformationObject)MeasuredValueShort_create(NULL, 1000 + i, static_cast<float>(i), IEC60870_QUALITY_GOOD);
+        CS101_ASDU_addInformationObject(response, io);
+        IMasterConnection_sendASDU(connection, response);
+        InformationObject_destroy(io);
+        CS101_ASDU_destroy(response);
+    }
+    IMasterConnection_sendACT_TERM(connection, asdu);
+    return true;
+}
+
+static std::atomic<int> received{0};
+static std::atomic<int> terminated{0};
+
+static bool AsduHandler(void *parameter, int address, CS101_ASDU asdu)
+{
+    if (CS101_ASDU_getTypeID(asdu) == M_ME_NC_1)
+        received++;
+    else if (CS101_ASDU_getTypeID(asdu) == C_IC_NA_1 && CS101_ASDU_getCOT(asdu) == CS101_COT_ACTIVATION_TERMINATION)
+        terminated++;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int asdus = 50000;
+    int port = 24990;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--asdus") && i + 1 < argc)
+            asdus = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--port") && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+    }
+
+    int rounds = (asdus + GI_ASDUS - 1) / GI_ASDUS;
+
+    CS104_Slave slave = CS104_Slave_create(100, 100);
+    CS104_Slave_setLocalAddress(slave, "127.0.0.1");
+    CS104_Slave_setLocalPort(slave, port);
+    CS104_Slave_setInterrogationHandler(slave, InterrogationHandler, NULL);
+    CS104_Slave_start(slave);
+    if (!CS104_Slave_isRunning(slave)) {
+        fprintf(stderr, "failed to start the slave on port %d\n", port);
+        CS104_Slave_destroy(slave);
+        return 1;
+    }
+
+    CS104_Connection con = CS104_Connection_create("127.0.0.1", port);
+    CS104_Connection_setASDUReceivedHandler(con, AsduHandler, NULL);
+    if (!CS104_Connection_connect(con)) {
+        fprintf(stderr, "failed to connect to port %d\n", port);
+        CS104_Connection_destroy(con);
+        CS104_Slave_destroy(slave);
+        return 1;
+    }
+
+    CS104_Connection_sendStartDT(con);
+    Thread_sleep(100);
+
+    // Снимок счётчиков после подключения: считаются только кадры ответов на опрос
+    uint64_t recvBefore[MAX_FD], pollBefore[MAX_FD];
+    for (int fd = 0; fd < MAX_FD; fd++) {
+        recvBefore[fd] = counters[fd].recvCalls;
+        pollBefore[fd] = counters[fd].pollCalls;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(60);
+    for (int round = 1; round <= rounds && std::chrono::steady_clock::now() < deadline; round++) {
+        CS104_Connection_sendInterrogationCommand(con, CS101_COT_ACTIVATION, 1, IEC60870_QOI_STATION);
+        while (terminated < round && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int expected = rounds * GI_ASDUS;
+    int frames = received + 2 * terminated; // ASDU ответа, ACT_CON и ACT_TERM
+
+    // Сокет клиента — тот, через который принято больше всего байт
+    int clientFd = 0;
+    for (int fd = 1; fd < MAX_FD; fd++) {
+        if (counters[fd].recvBytes > counters[clientFd].recvBytes)
+            clientFd = fd;
+    }
+    uint64_t recvCalls = counters[clientFd].recvCalls - recvBefore[clientFd];
+    uint64_t pollCalls = counters[clientFd].pollCalls - pollBefore[clientFd];
+
+    CS104_Connection_destroy(con);
+    CS104_Slave_stop(slave);
+    CS104_Slave_destroy(slave);
+
+    if (received < expected) {
+        fprintf(stderr, "received %d of %d ASDUs\n", static_cast<int>(received), expected);
+        return 1;
+    }
+    double recvPerFrame = static_cast<double>(recvCalls) / frames;
+    double pollPerFrame = static_cast<double>(pollCalls) / frames;
+    fprintf(stderr, "frames %d: %.3f recv/frame, %.3f poll/frame, %.3f syscalls/frame (3 recv + 1 poll before), %.0f frames/s\n",
+            frames, recvPerFrame, pollPerFrame, recvPerFrame + pollPerFrame, frames / seconds);
+    return check && recvPerFrame + pollPerFrame > 4.0 / 3.0 ? 1 : 0;
+}
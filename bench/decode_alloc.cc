@@ -0,0 +1,177 @@
+// Число выделений памяти на ASDU при декодировании точек мониторинга, как в RawMessageHandler
+// IEC104Client / IEC101MasterBalanced / IEC101MasterUnbalanced: элементы декодируются через
+// CS101_ASDU_getElementEx в IODecodeBuffer соединения, точки собираются в его DecodedPoints и
+// уходят в лямбду TSFN вектором из DecodedPointsPool. Для сравнения — прежняя схема:
+// CS101_ASDU_getElement (malloc на элемент) и новый вектор на ASDU, копируемый в лямбду.
+//
+//   bench_decode_alloc [--asdus 200000] [--check]
+//
+// ASDU — M_ME_NC_1 из 127 элементов (SQ=1 и SQ=0). С --check код выхода 1, если новая схема
+// выделяет память в установившемся режиме. Счётчик перехватывает malloc/calloc/realloc (glibc).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "iec60870_decode.h"
+
+extern "C" {
+#include "cs101_asdu_internal.h"
+#include "cs101_information_objects.h"
+#include "iec60870_common.h"
+}
+
+static size_t allocations = 0;
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    allocations++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+}
+
+static const int ELEMENTS = 127;
+
+static struct sCS101_AppLayerParameters appLayerParameters = {
+    /* .sizeOfTypeId = */ 1,
+    /* .sizeOfVSQ = */ 1,
+    /* .sizeOfCOT = */ 2,
+    /* .originatorAddress = */ 0,
+    /* .sizeOfCA = */ 2,
+    /* .sizeOfIOA = */ 3,
+    /* .maxSizeOfASDU = */ 249
+};
+
+// M_ME_NC_1, COT 3, CA 1: 127 значений float с QDS. При sequence — один IOA на всё ASDU.
+static std::vector<uint8_t> EncodeASDU(bool sequence)
+{
+    std::vector<uint8_t> msg = {M_ME_NC_1, static_cast<uint8_t>((sequence ? 0x80 : 0) | ELEMENTS), 3, 0, 1, 0};
+    for (int i = 0; i < ELEMENTS; i++) {
+        int ioa = 1000 + i;
+        if (i == 0 || !sequence) {
+            msg.push_back(static_cast<uint8_t>(ioa));
+            msg.push_back(static_cast<uint8_t>(ioa >> 8));
+            msg.push_back(static_cast<uint8_t>(ioa >> 16));
+        }
+        float value = 0.5f * i;
+        uint8_t bytes[4];
+        memcpy(bytes, &value, 4);
+        msg.insert(msg.end(), bytes, bytes + 4);
+        msg.push_back(IEC60870_QUALITY_GOOD);
+    }
+    return msg;
+}
+
+struct Connection {
+    IODecodeBuffer decodeBuffer;
+    DecodedPoints decodedPoints;
+    DecodedPointsPool pointsPool;
+};
+
+static double checksum = 0;
+
+// Текущая схема: буфер соединения и вектор из пула, который лямбда TSFN возвращает после разбора
+static void DecodeReused(Connection &con, CS101_ASDU asdu)
+{
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+    DecodedPoints &elements = con.decodedPoints;
+    elements.clear();
+    elements.reserve(numberOfElements);
+    for (int i = 0; i < numberOfElements; i++) {
+        MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElementEx(asdu, (InformationObject)&con.decodeBuffer, i);
+        if (io) {
+            int ioa = InformationObject_getObjectAddress((InformationObject)io);
+            double val = MeasuredValueShort_getValue(io);
+            uint8_t quality = MeasuredValueShort_getQuality(io);
+            elements.emplace_back(ioa, val, quality, 0);
+        }
+    }
+    DecodedPoints *points = con.pointsPool.Acquire(elements);
+    checksum += std::get<1>(points->back());
+    con.pointsPool.Release(points);
+}
+
+// Прежняя схема: информационный объект в куче на каждый элемент и вектор на ASDU, копия в лямбду
+static void DecodeAllocating(CS101_ASDU asdu)
+{
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+    std::vector<DecodedPoint> elements;
+    elements.reserve(numberOfElements);
+    for (int i = 0; i < numberOfElements; i++) {
+        MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElement(asdu, i);
+        if (io) {
+            int ioa = InformationObject_getObjectAddress((InformationObject)io);
+            double val = MeasuredValueShort_getValue(io);
+            uint8_t quality = MeasuredValueShort_getQuality(io);
+            elements.emplace_back(ioa, val, quality, 0);
+            InformationObject_destroy((InformationObject)io);
+        }
+    }
+    std::vector<DecodedPoint> captured(elements);
+    checksum += std::get<1>(captured.back());
+}
+
+template <typename Decode>
+static void Run(const char *name, int asdus, Decode decode, double &allocsPerAsdu)
+{
+    decode(); // Прогрев: векторы соединения и пула получают ёмкость
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < asdus; i++)
+        decode();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    allocsPerAsdu = static_cast<double>(allocations - before) / asdus;
+    fprintf(stderr, "%-28s %8.1f ns/ASDU %8.2f allocations/ASDU\n", name, seconds * 1e9 / asdus, allocsPerAsdu);
+}
+
+int main(int argc, char **argv)
+{
+    int asdus = 200000;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--asdus") && i + 1 < argc)
+            asdus = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+    }
+
+    bool failed = false;
+    for (bool sequence : {true, false}) {
+        std::vector<uint8_t> msg = EncodeASDU(sequence);
+        CS101_ASDU asdu = CS101_ASDU_createFromBuffer(&appLayerParameters, msg.data(), static_cast<int>(msg.size()));
+        if (CS101_ASDU_getNumberOfElements(asdu) != ELEMENTS) {
+            fprintf(stderr, "failed to build the test ASDU\n");
+            return 1;
+        }
+        Connection *con = new Connection();
+        double reused = 0, allocating = 0;
+        std::string suffix = sequence ? " SQ=1" : " SQ=0";
+        Run(("getElementEx + pool" + suffix).c_str(), asdus, [&] { DecodeReused(*con, asdu); }, reused);
+        Run(("getElement + vector" + suffix).c_str(), asdus, [&] { DecodeAllocating(asdu); }, allocating);
+        if (reused != 0)
+            failed = true;
+        delete con;
+        CS101_ASDU_destroy(asdu);
+    }
+    fprintf(stderr, "checksum %.0f\n", checksum);
+    return check && failed ? 1 : 0;
+}
@@ -5,14 +5,102 @@
   },
   
   "targets": [
+    {
+      "target_name": "lib60870",
+      "type": "static_library",
+      "sources": [
+        "lib/src/common/linked_list.c",
+        "lib/src/iec60870/apl/cpXXtime2a.c",
+        "lib/src/iec60870/cs101/cs101_asdu.c",
+        "lib/src/iec60870/cs101/cs101_bcr.c",
+        "lib/src/iec60870/cs101/cs101_information_objects.c",
+        "lib/src/iec60870/cs101/cs101_master.c",
+        "lib/src/iec60870/cs101/cs101_master_connection.c",
+        "lib/src/iec60870/cs101/cs101_queue.c",
+        "lib/src/iec60870/cs101/cs101_slave.c",
+        "lib/src/iec60870/cs104/cs104_connection.c",
+        "lib/src/iec60870/cs104/cs104_frame.c",
+        "lib/src/iec60870/cs104/cs104_slave.c",
+        "lib/src/iec60870/frame.c",
+        "lib/src/iec60870/lib60870_common.c",
+        "lib/src/iec60870/link_layer/buffer_frame.c",
+        "lib/src/iec60870/link_layer/link_layer.c",
+        "lib/src/iec60870/link_layer/serial_transceiver_ft_1_2.c",
+        "lib/src/hal/memory/lib_memory.c"
+      ],
+      "include_dirs": [
+        "lib/config",
+        "lib/src/inc/api",
+        "lib/src/inc/internal",
+        "lib/src/hal/inc",
+        "lib/src/common/inc"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": ["lib/config"]
+      },
+      "cflags": ["-Wno-unused-parameter"],
+      "conditions": [
+        ["OS=='linux'", {
+          "sources": [
+            "lib/src/hal/serial/linux/serial_port_linux.c",
+            "lib/src/hal/socket/linux/socket_linux.c",
+            "lib/src/hal/thread/linux/thread_linux.c",
+            "lib/src/hal/time/unix/time.c"
+          ]
+        }],
+        ["OS=='linux' and target_arch=='x64'", {
+          "cflags": ["-fPIC"]
+        }],
+        ["OS=='linux' and target_arch=='arm64'", {
+          "cflags": ["-fPIC", "-march=armv8-a"]
+        }],
+        ["OS=='linux' and target_arch=='arm'", {
+          "cflags": ["-fPIC", "-march=armv7-a", "-mfpu=vfp", "-mfloat-abi=hard"]
+        }],
+        ["OS=='mac'", {
+          "sources": [
+            "lib/src/hal/serial/linux/serial_port_linux.c",
+            "lib/src/hal/socket/bsd/socket_bsd.c",
+            "lib/src/hal/thread/macos/thread_macos.c",
+            "lib/src/hal/time/unix/time.c"
+          ],
+          "xcode_settings": {
+            "MACOSX_DEPLOYMENT_TARGET": "11.0",
+            "OTHER_CFLAGS": ["-Wno-unused-parameter"]
+          }
+        }],
+        ["OS=='mac' and target_arch=='arm64'", {
+          "xcode_settings": { "ARCHS": ["arm64"] }
+        }],
+        ["OS=='mac' and target_arch=='x64'", {
+          "xcode_settings": { "ARCHS": ["x64"] }
+        }],
+        ["OS=='win'", {
+          "sources": [
+            "lib/src/hal/serial/win32/serial_port_win32.c",
+            "lib/src/hal/socket/win32/socket_win32.c",
+            "lib/src/hal/thread/win32/thread_win32.c",
+            "lib/src/hal/time/win32/time.c"
+          ],
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "CompileAs": 2
+            }
+          }
+        }]
+      ]
+    },
     {
       "target_name": "addon_iec60870",
+      "dependencies": ["lib60870"],
       "sources": [
         "src/cs104_client.cc",
         "src/cs101_master_balanced.cc",
         "src/cs101_master_unbalanced.cc",
         "src/cs104_server.cc",
         "src/cs101_slave1.cc",
+        "src/cs101_line_manager.cc",
+        "src/cs104_client_pool.cc",
         "src/iec60870.cc"
       ],
       "actions": [
@@ -42,10 +130,7 @@
             "ARCHS": ["arm64"],
             "OTHER_CFLAGS": ["-Wall", "-Wno-unused-parameter"],
             "OTHER_CPLUSPLUSFLAGS": ["-Wall", "-Wno-unused-parameter", "-std=c++17", "-fexceptions"]
-          },
-          "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_darwin_arm64.a"
-          ]
+          }
         }],
         ["OS=='mac' and target_arch=='x64'", {
           "xcode_settings": {
@@ -54,16 +139,12 @@
             "ARCHS": ["x64"],
             "OTHER_CFLAGS": ["-Wall", "-Wno-unused-parameter"],
             "OTHER_CPLUSPLUSFLAGS": ["-Wall", "-Wno-unused-parameter", "-std=c++17", "-fexceptions"]
-          },
-          "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_darwin_x64.a"
-          ]
+          }
         }],
         ["OS=='linux' and target_arch=='x64'", {
           "cflags": ["-fPIC"],
           "cflags_cc": ["-fPIC"],
           "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_linux_x64.a",
             "-lpthread"
           ]
         }],
@@ -71,7 +152,6 @@
           "cflags": ["-fPIC", "-march=armv8-a"],
           "cflags_cc": ["-fPIC", "-march=armv8-a"],
           "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_linux_arm64.a",
             "-lpthread"
           ]
         }],
@@ -79,7 +159,6 @@
           "cflags": ["-fPIC", "-march=armv7-a", "-mfpu=vfp", "-mfloat-abi=hard"],
           "cflags_cc": ["-fPIC", "-march=armv7-a", "-mfpu=vfp", "-mfloat-abi=hard"],
           "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_linux_arm.a",
             "-lpthread"
           ]
         }],
@@ -91,7 +170,6 @@
             }
           },
           "libraries": [
-            "<(module_root_dir)/lib/build/lib60870_win_x64.lib",
             "-lws2_32.lib",
             "-liphlpapi.lib",
             "-lbcrypt.lib",
@@ -0,0 +1,92 @@
+// Замер доставки данных мониторинга в JS: dataFormat 'objects' (объект на точку) против 'columnar'
+// (typed arrays на ASDU). IEC104Server с autoInterrogation отвечает на общий опрос из процесса-образа
+// на своём потоке, IEC104Client принимает ответ и в callback суммирует значения всех точек.
+//
+//   node examples/bench_columnar.js [--points 50000] [--rounds 10] [--port 24050] > /dev/null
+//
+// Для каждого формата — время общего опроса, точек в секунду и время цикла событий JS на точку
+// (performance.eventLoopUtilization за время опросов). Отчёт пишется в stderr; код выхода 1,
+// если какой-то опрос пришёл не полностью.
+
+const { performance } = require('perf_hooks');
+const { IEC104Server, IEC104Client } = require('../build/Release/addon_iec60870');
+
+const args = process.argv.slice(2);
+const option = (name, def) => {
+    const i = args.indexOf(`--${name}`);
+    return i >= 0 && i + 1 < args.length ? Number(args[i + 1]) : def;
+};
+const points = option('points', 50000);
+const rounds = option('rounds', 10);
+const port = option('port', 24050);
+const report = (...line) => console.error(...line);
+
+async function measure(format) {
+    let received = 0;
+    let sum = 0;
+    let activated;
+    let roundDone;
+    const activatedPromise = new Promise(resolve => { activated = resolve; });
+
+    const client = new IEC104Client((event, data) => {
+        if (event === 'conn' && data.event === 'activated') activated();
+        if (event !== 'data') return;
+        if (format === 'columnar' && data.val) {
+            const val = data.val;
+            for (let i = 0; i < val.length; i++) sum += val[i];
+            received += val.length;
+        } else if (Array.isArray(data)) {
+            for (const p of data) sum += p.val;
+            received += data.length;
+        }
+        if (received >= points && roundDone) roundDone();
+    });
+    client.connect({ ip: '127.0.0.1', port, clientID: `bench_${format}`, dataFormat: format });
+    await activatedPromise;
+
+    let wall = 0;
+    let active = 0;
+    let complete = true;
+    for (let r = 0; r < rounds; r++) {
+        received = 0;
+        const done = new Promise(resolve => { roundDone = resolve; });
+        const timeout = new Promise(resolve => setTimeout(resolve, 30000, 'timeout'));
+        const elu = performance.eventLoopUtilization();
+        const start = performance.now();
+        client.sendCommands([{ typeId: 100, ioa: 0, asdu: 1, value: 20 }]);
+        if (await Promise.race([done, timeout]) === 'timeout') {
+            report(`${format}: round ${r} received ${received} of ${points} points`);
+            complete = false;
+            break;
+        }
+        roundDone = null;
+        wall += performance.now() - start;
+        active += performance.eventLoopUtilization(elu).active;
+    }
+    client.disconnect();
+
+    const total = points * rounds;
+    const result = { format, complete, ms: wall / rounds, pointsPerSec: total / (wall / 1000), nsPerPoint: active * 1e6 / total, sum };
+    report(`${format.padEnd(8)} ${result.ms.toFixed(1).padStart(8)} ms/GI ${Math.round(result.pointsPerSec).toString().padStart(10)} points/s` +
+           ` ${result.nsPerPoint.toFixed(0).padStart(6)} ns/point on the event loop`);
+    return result;
+}
+
+async function main() {
+    const server = new IEC104Server(() => {});
+    server.start({ port, serverID: 'bench', mode: 'multi', params: { autoInterrogation: true } });
+    const ioa = Int32Array.from({ length: points }, (_, i) => 1000 + i);
+    const value = Float64Array.from({ length: points }, (_, i) => i * 0.5);
+    server.updatePoints({ typeId: 13, asduAddress: 1, ioa, value });
+
+    report(`general interrogation of ${points} M_ME_NC_1 points, ${rounds} rounds`);
+    const objects = await measure('objects');
+    const columnar = await measure('columnar');
+    server.stop();
+
+    report(`columnar vs objects: ${(columnar.pointsPerSec / objects.pointsPerSec).toFixed(1)}x points/s,` +
+           ` ${(objects.nsPerPoint / columnar.nsPerPoint).toFixed(1)}x less event loop time per point`);
+    process.exit(objects.complete && columnar.complete ? 0 : 1);
+}
+
+main();
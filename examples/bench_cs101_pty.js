@@ -0,0 +1,292 @@
+// Стенд для замера CS101 без оборудования: мастер и слейвы соединяются через псевдотерминалы.
+//
+//   node examples/bench_cs101_pty.js [--mode unbalanced|balanced] [--baud 9600] [--slaves 2]
+//                                    [--rate 50] [--duration 30] [--batchLatency 0] > /dev/null
+//
+// Нужен socat (Linux/macOS). Каждая сторона получает свой PTY (socat pty <-> STDIO),
+// байты между ними передаёт этот скрипт: он ограничивает скорость до --baud (8E1, 11 бит на байт,
+// 0 — без ограничения), считает кадры FT 1.2 и в режиме unbalanced раздаёт кадры мастера всем
+// слейвам, как на общей линии RS-485. Слейвы (IEC101Slave) кладут в очередь класса 1
+// M_ME_TF_1 с текущим временем, мастер считает задержку от события до вызова callback.
+// Отчёт пишется в stderr, поэтому отладочный вывод аддона можно отправить в /dev/null.
+
+const { spawn } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { IEC101MasterUnbalanced, IEC101MasterBalanced, IEC101Slave } = require('../build/Release/addon_iec60870');
+
+const args = process.argv.slice(2);
+const option = (name, def) => {
+    const i = args.indexOf(`--${name}`);
+    return i >= 0 && i + 1 < args.length ? args[i + 1] : def;
+};
+
+const mode = option('mode', 'unbalanced');
+const baud = Number(option('baud', 9600));
+const slaveCount = mode === 'balanced' ? 1 : Number(option('slaves', 2));
+const rate = Number(option('rate', 50));            // Событий в секунду на слейв
+const duration = Number(option('duration', 30));    // Секунд
+const batchLatency = Number(option('batchLatency', 0));
+
+const BITS_PER_BYTE = 11; // старт + 8 данных + чётность + стоп
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+const report = (...line) => console.error(...line);
+
+// PTY, второй конец которого — stdin/stdout процесса socat
+async function openPty(name) {
+    const link = path.join(os.tmpdir(), `iec101_bench_${process.pid}_${name}`);
+    const proc = spawn('socat', [`pty,raw,echo=0,link=${link}`, 'STDIO'], { stdio: ['pipe', 'pipe', 'inherit'] });
+    proc.on('error', err => {
+        report(`socat failed: ${err.message}`);
+        process.exit(1);
+    });
+    for (let i = 0; i < 100 && !fs.existsSync(link); i++) {
+        await sleep(20);
+    }
+    if (!fs.existsSync(link)) {
+        throw new Error(`PTY ${link} was not created`);
+    }
+    return { link, proc };
+}
+
+// Счётчик кадров FT 1.2 (адрес канального уровня — 1 байт)
+class FrameCounter {
+    constructor() {
+        this.buffer = Buffer.alloc(0);
+        this.frames = 0;
+        this.userDataFrames = 0;
+        this.bytes = 0;
+    }
+
+    push(chunk) {
+        this.bytes += chunk.length;
+        this.buffer = Buffer.concat([this.buffer, chunk]);
+        let pos = 0;
+        while (pos < this.buffer.length) {
+            const start = this.buffer[pos];
+            let size;
+            if (start === 0xe5) {
+                size = 1;
+            } else if (start === 0x10) {
+                size = 5;
+            } else if (start === 0x68) {
+                if (this.buffer.length - pos < 2) break;
+                size = this.buffer[pos + 1] + 6;
+            } else {
+                pos++; // Мусор между кадрами
+                continue;
+            }
+            if (this.buffer.length - pos < size) break;
+            this.frames++;
+            if (start === 0x68) this.userDataFrames++;
+            pos += size;
+        }
+        this.buffer = this.buffer.subarray(pos);
+    }
+}
+
+// Одно направление линии: очередь байтов, которая отдаётся не быстрее baud
+class ThrottledLink {
+    constructor(targets) {
+        this.targets = targets;
+        this.queue = [];
+        this.queued = 0;
+        this.credit = 0;
+        this.last = process.hrtime.bigint();
+        this.counter = new FrameCounter();
+        this.timer = setInterval(() => this.pump(), 1);
+    }
+
+    write(chunk) {
+        this.counter.push(chunk);
+        if (!baud) {
+            this.targets.forEach(t => t.write(chunk));
+            return;
+        }
+        this.queue.push(chunk);
+        this.queued += chunk.length;
+    }
+
+    pump() {
+        const now = process.hrtime.bigint();
+        this.credit += Number(now - this.last) / 1e9 * baud / BITS_PER_BYTE;
+        this.last = now;
+        if (this.queued === 0) {
+            this.credit = Math.min(this.credit, 1); // Простой линии не копится
+            return;
+        }
+        let allowed = Math.floor(this.credit);
+        while (allowed > 0 && this.queue.length) {
+            const chunk = this.queue[0];
+            const part = chunk.subarray(0, allowed);
+            this.targets.forEach(t => t.write(part));
+            allowed -= part.length;
+            this.credit -= part.length;
+            this.queued -= part.length;
+            if (part.length === chunk.length) this.queue.shift();
+            else this.queue[0] = chunk.subarray(part.length);
+        }
+    }
+
+    close() {
+        clearInterval(this.timer);
+    }
+}
+
+function percentile(sorted, p) {
+    if (!sorted.length) return 0;
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+async function main() {
+    report(`CS101 PTY benchmark: mode=${mode}, baud=${baud || 'unlimited'}, slaves=${slaveCount}, rate=${rate}/s per slave, duration=${duration}s`);
+
+    const masterPty = await openPty('master');
+    const slavePtys = [];
+    for (let i = 0; i < slaveCount; i++) {
+        slavePtys.push(await openPty(`slave${i + 1}`));
+    }
+
+    // Кадры мастера получают все слейвы, ответы слейвов идут мастеру
+    const down = new ThrottledLink(slavePtys.map(p => p.proc.stdin));
+    const up = new ThrottledLink([masterPty.proc.stdin]);
+    masterPty.proc.stdout.on('data', chunk => down.write(chunk));
+    slavePtys.forEach(p => p.proc.stdout.on('data', chunk => up.write(chunk)));
+
+    const latencies = [];
+    let received = 0;
+    let sent = 0;
+    let dropped = 0;
+
+    const onMasterEvent = (event, data) => {
+        if (event !== 'data') return;
+        if (Array.isArray(data)) {
+            const now = Date.now();
+            data.forEach(item => {
+                if (item.typeId === 36 && item.timestamp) {
+                    latencies.push(now - item.timestamp);
+                    received++;
+                }
+            });
+        } else if (data.type === 'control' && data.event !== 'opened' && data.event !== 'busy') {
+            report(`Master: ${data.event} ${data.reason || ''}`);
+        }
+    };
+
+    // Размеры полей ASDU слейва совпадают с мастером выбранного режима
+    const slaves = [];
+    slavePtys.forEach((pty, i) => {
+        const slave = new IEC101Slave(() => {});
+        const address = i + 1;
+        slave.connect(pty.link, baud || 115200, address, `bench_slave_${address}`, mode === 'balanced'
+            ? { mode: 'balanced', linkAddress: address, otherLinkAddress: address, asduAddress: address, queueSize: 10000 }
+            : { linkAddress: address, asduAddress: address, sizeOfCOT: 1, sizeOfCA: 1, sizeOfIOA: 2, queueSize: 10000 });
+        slaves.push(slave);
+    });
+
+    let master;
+    const masterParams = { t0: 30, t1: 5, t2: 2, queueSize: 1000, batchLatency };
+    if (mode === 'balanced') {
+        master = new IEC101MasterBalanced(onMasterEvent);
+        master.connect({ portName: masterPty.link, baudRate: baud || 115200, clientID: 'bench_master',
+            params: { ...masterParams, linkAddress: 1, asduAddress: 1 } });
+    } else {
+        master = new IEC101MasterUnbalanced(onMasterEvent);
+        master.connect({ portName: masterPty.link, baudRate: baud || 115200, clientID: 'bench_master',
+            params: { ...masterParams, linkAddress: 0, slaveAddresses: slaves.map((s, i) => i + 1), autoPoll: true } });
+    }
+
+    await sleep(1000);
+
+    // Генерация событий: каждые 10 мс очередная порция M_ME_TF_1 с текущим временем
+    let ioa = 0;
+    let carry = 0;
+    const generator = setInterval(() => {
+        carry += rate / 100;
+        const count = Math.floor(carry);
+        carry -= count;
+        if (!count) return;
+        slaves.forEach(slave => {
+            const events = [];
+            for (let k = 0; k < count; k++) {
+                ioa = (ioa + 1) % 60000;
+                events.push({ typeId: 36, ioa: ioa + 1, value: Math.random() * 100, timestamp: Date.now() });
+            }
+            try {
+                const accepted = slave.enqueueClass1(events);
+                sent += accepted;
+                dropped += events.length - accepted;
+            } catch (err) {
+                dropped += events.length;
+            }
+        });
+    }, 10);
+
+    const startedAt = Date.now();
+    let last = { time: startedAt, down: 0, up: 0, downBytes: 0, upBytes: 0, received: 0 };
+    const ticker = setInterval(() => {
+        const now = Date.now();
+        const dt = (now - last.time) / 1000;
+        const sorted = latencies.slice(-5000).sort((a, b) => a - b);
+        const downBytes = (down.counter.bytes - last.downBytes) / dt;
+        const upBytes = (up.counter.bytes - last.upBytes) / dt;
+        let line = `[${Math.round((now - startedAt) / 1000)}s] frames/s down ${((down.counter.frames - last.down) / dt).toFixed(0)}` +
+            ` up ${((up.counter.frames - last.up) / dt).toFixed(0)}, events/s ${((received - last.received) / dt).toFixed(0)}` +
+            `, latency p50 ${percentile(sorted, 0.5)} ms p99 ${percentile(sorted, 0.99)} ms`;
+        if (baud) {
+            line += `, line load down ${(downBytes * BITS_PER_BYTE / baud * 100).toFixed(0)}% up ${(upBytes * BITS_PER_BYTE / baud * 100).toFixed(0)}%`;
+        }
+        report(line);
+        last = { time: now, down: down.counter.frames, up: up.counter.frames, downBytes: down.counter.bytes, upBytes: up.counter.bytes, received };
+    }, 1000);
+
+    await sleep(duration * 1000);
+    clearInterval(generator);
+    clearInterval(ticker);
+
+    const elapsed = (Date.now() - startedAt) / 1000;
+    const sorted = latencies.slice().sort((a, b) => a - b);
+    const summary = {
+        mode,
+        baud,
+        slaves: slaveCount,
+        seconds: elapsed,
+        framesPerSecond: { down: down.counter.frames / elapsed, up: up.counter.frames / elapsed },
+        userDataFramesPerSecond: { down: down.counter.userDataFrames / elapsed, up: up.counter.userDataFrames / elapsed },
+        events: { enqueued: sent, droppedAtSlave: dropped, received, perSecond: received / elapsed },
+        latencyMs: {
+            p50: percentile(sorted, 0.5),
+            p95: percentile(sorted, 0.95),
+            p99: percentile(sorted, 0.99),
+            max: sorted.length ? sorted[sorted.length - 1] : 0
+        }
+    };
+
+    // Время цикла опроса считает планировщик unbalanced-мастера
+    const status = master.getStatus();
+    if (Array.isArray(status.slaves)) {
+        summary.scanCycleMs = status.slaves.map(s => ({
+            slaveAddress: s.slaveAddress,
+            avg: s.avgScanCycleMs,
+            max: s.maxScanCycleMs,
+            class1Requests: s.class1Requests,
+            class2Requests: s.class2Requests,
+            timeouts: s.timeouts
+        }));
+    }
+
+    report(JSON.stringify(summary, null, 2));
+
+    master.disconnect();
+    slaves.forEach(slave => slave.disconnect());
+    down.close();
+    up.close();
+    [masterPty, ...slavePtys].forEach(p => p.proc.kill());
+    setTimeout(() => process.exit(0), 500);
+}
+
+main().catch(err => {
+    report(`Benchmark error: ${err.message}`);
+    process.exit(1);
+});
@@ -18,14 +18,17 @@ const master = new IEC101MasterUnbalanced((event, data) => {
                 master.addSlave(1);
                 console.log('Master: Adding slave with address 2...');
                 master.addSlave(2);
+                // Команды и опросы ставятся в очередь слейва, Promise завершается по подтверждению канального уровня
+                const report = (what, p) => p.then(() => console.log(`Master: ${what} confirmed`))
+                    .catch(err => console.error(`Master: ${what} failed - ${err.message}`));
                 console.log('Master: Sending interrogation command to slave 1...');
-                master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 1);
+                report('Interrogation of slave 1', master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 1));
                 console.log('Master: Sending interrogation command to slave 2...');
-                master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 2);
+                report('Interrogation of slave 2', master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 2));
                 console.log('Master: Polling slave 1...');
-                master.pollSlave(1);
+                report('Poll of slave 1', master.pollSlave(1));
                 console.log('Master: Polling slave 2...');
-                master.pollSlave(2);
+                report('Poll of slave 2', master.pollSlave(2));
                 isInitialized = true;
             } else if (data.event === 'failed') {
                 console.error(`Master: Connection failed for slave ${data.slaveAddress} - ${data.reason}`);
@@ -78,16 +81,16 @@ async function main() {
             if (currentStatus.connected) {
                 try {
                     console.log('Master: Polling slave 1...');
-                    master.pollSlave(1);
-                    master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 1);
+                    await master.pollSlave(1);
+                    await master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 1, { timeout: 5000 });
                 } catch (error) {
                     console.error(`Master: Failed to poll slave 1 - ${error.message}`);
                 }
                 await sleep(2000); // Задержка 2 секунды между опросами
                 try {
                     console.log('Master: Polling slave 2...');
-                    master.pollSlave(2);
-                    master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 2);
+                    await master.pollSlave(2);
+                    await master.sendCommands([{ typeId: 100, ioa: 0, value: 20 }], 2, { timeout: 5000 });
                 } catch (error) {
                     console.error(`Master: Failed to poll slave 2 - ${error.message}`);
                 }
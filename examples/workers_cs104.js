@@ -0,0 +1,86 @@
+// Проверка работы аддона одновременно в нескольких worker_threads: каждый воркер загружает
+// аддон сам, поднимает свой IEC104Server и несколько IEC104Client к нему и считает принятые точки.
+//
+//   node examples/workers_cs104.js [--workers 4] [--clients 8] [--points 100] [--duration 10] [--port 24040]
+//
+// Воркер i слушает порт port + i. Итог по каждому воркеру пишется в stderr; код выхода 1, если
+// какой-то воркер упал или его клиенты не получили данных.
+
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+
+const addonPath = '../build/Release/addon_iec60870';
+
+if (isMainThread) {
+    const args = process.argv.slice(2);
+    const option = (name, def) => {
+        const i = args.indexOf(`--${name}`);
+        return i >= 0 && i + 1 < args.length ? Number(args[i + 1]) : def;
+    };
+    const workers = option('workers', 4);
+    const config = {
+        clients: option('clients', 8),
+        points: option('points', 100),
+        duration: option('duration', 10),
+        port: option('port', 24040)
+    };
+
+    // Аддон загружен и в главном потоке: его классы не должны мешать воркерам
+    require(addonPath);
+
+    const results = [];
+    let failed = false;
+    let exited = 0;
+    const summarize = () => {
+        let total = 0;
+        for (const r of results.sort((a, b) => a.id - b.id)) {
+            console.error(`worker ${r.id}: clients activated ${r.activated}/${config.clients}, points ${r.points}`);
+            total += r.points;
+            if (r.activated < config.clients || r.points === 0) failed = true;
+        }
+        if (results.length < workers) failed = true;
+        console.error(`total points ${total} in ${config.duration} s, ${Math.round(total / config.duration)} points/s`);
+        process.exitCode = failed ? 1 : 0;
+    };
+    for (let id = 0; id < workers; id++) {
+        const worker = new Worker(__filename, { workerData: { ...config, id } });
+        worker.on('message', result => results.push(result));
+        worker.on('error', err => console.error(`worker ${id}: ${err.stack || err}`));
+        worker.on('exit', () => {
+            if (++exited === workers) summarize();
+        });
+    }
+} else {
+    const { IEC104Server, IEC104Client } = require(addonPath);
+    const { id, clients, points, duration } = workerData;
+    const port = workerData.port + id;
+
+    const server = new IEC104Server(() => {});
+    server.start({ port, serverID: `w${id}`, mode: 'multi', params: { maxClients: clients } });
+
+    let received = 0;
+    const activated = new Set();
+    const list = [];
+    for (let c = 0; c < clients; c++) {
+        const client = new IEC104Client((event, data) => {
+            if (event === 'conn' && data.event === 'activated') activated.add(data.clientID);
+            else if (event === 'data' && Array.isArray(data)) received += data.length;
+        });
+        client.connect({ ip: '127.0.0.1', port, clientID: `w${id}c${c}`, reconnectDelay: 1 });
+        list.push(client);
+    }
+
+    const batch = Array.from({ length: points }, (_, i) => ({ typeId: 13, asduAddress: 1, ioa: 1000 + i, value: 0 }));
+    let tick = 0;
+    const timer = setInterval(() => {
+        tick++;
+        for (const p of batch) p.value = tick;
+        server.publish(batch);
+    }, 100);
+
+    setTimeout(() => {
+        clearInterval(timer);
+        for (const client of list) client.disconnect();
+        server.stop();
+        parentPort.postMessage({ id, activated: activated.size, points: received });
+    }, duration * 1000);
+}
@@ -0,0 +1,63 @@
+/*
+ *  lib60870_config.h
+ *
+ *  Build configuration of lib60870-C used by the addon (binding.gyp) and by lib/CMakeLists.txt
+ */
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+/* print debugging information with printf if set to 1 */
+#define CONFIG_DEBUG_OUTPUT 0
+
+/**
+ * Define the maximum slave message queue size (for CS 101)
+ *
+ * When set to -1 the message queue size is not limited can be set by the application
+ */
+#define CONFIG_SLAVE_MESSAGE_QUEUE_SIZE -1
+
+/**
+ * Define the default size for the slave (outstation) message queue. This is used also
+ * to buffer ASDUs in the case when the connection is lost.
+ *
+ * For each queued message about 256 bytes of memory are required.
+ */
+#define CONFIG_CS104_MESSAGE_QUEUE_SIZE 100
+
+/**
+ * This is a connection specific ASDU queue for the slave (outstation). It is used for connection
+ * specific ASDUs like those that are automatically generated by the stack or created in
+ * the slave side callback. The messages in the queue are sent before the ASDUs from the
+ * standard queue.
+ */
+#define CONFIG_CS104_MESSAGE_QUEUE_HIGH_PRIO_SIZE 50
+
+/* Support a single redundancy group */
+#define CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP 1
+
+/* Support multiple redundancy groups */
+#define CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS 1
+
+/* Support connection is redundancy group mode */
+#define CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP 1
+
+/* the addon is built without mbedtls */
+#define CONFIG_CS104_SUPPORT_TLS 0
+
+/* maximum number of client connections */
+#define CONFIG_CS104_MAX_CLIENT_CONNECTIONS 100
+
+/* use threads (required by CS104_Slave_start and CS104_Connection_connect) */
+#define CONFIG_USE_THREADS 1
+
+/* use semaphores to protect shared data structures */
+#define CONFIG_USE_SEMAPHORES 1
+
+/* allocate frames dynamically */
+#define CONFIG_LIB60870_STATIC_FRAMES 0
+
+/* maximum number of frames when CONFIG_LIB60870_STATIC_FRAMES == 1 */
+#define CONFIG_LIB60870_MAX_FRAMES 1
+
+#endif /* CONFIG_H_ */
@@ -88,6 +88,17 @@ SerialPort_close(SerialPort self);
 PAL_API int
 SerialPort_getBaudRate(SerialPort self);
 
+/**
+ * \brief Get the operating system file descriptor of the serial interface
+ *
+ * Can be used to wait for received data of many interfaces with one poll call.
+ * Implementation of this function is OPTIONAL.
+ *
+ * \return the file descriptor, or -1 if the interface is not open or not available
+ */
+PAL_API int
+SerialPort_getFd(SerialPort self);
+
 /**
  * \brief Set the timeout used for message reception
  *
@@ -110,6 +121,21 @@ SerialPort_discardInBuffer(SerialPort self);
 PAL_API int
 SerialPort_readByte(SerialPort self);
 
+/**
+ * \brief Read the bytes available at the interface
+ *
+ * Waits up to the configured timeout for the first byte and then returns all bytes that are
+ * already received (up to maxSize) without waiting for more. Used to read many bytes with a
+ * single system call.
+ *
+ * \param buffer buffer to store the read bytes
+ * \param maxSize maximum number of bytes to read
+ *
+ * \return number of read bytes, 0 in case of a timeout, or -1 in case of an error
+ */
+PAL_API int
+SerialPort_readBytes(SerialPort self, uint8_t* buffer, int maxSize);
+
 /**
  * \brief Write the number of bytes from the buffer to the serial interface
  *
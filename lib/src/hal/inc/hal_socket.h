@@ -334,6 +334,33 @@ Socket_getPeerAddress(Socket self);
 PAL_API char*
 Socket_getPeerAddressStatic(Socket self, char* peerAddressString);
 
+/**
+ * \brief Get the operating system file descriptor of the socket
+ *
+ * Can be used to wait for many sockets at once with an OS specific event
+ * notification mechanism (e.g. epoll).
+ *
+ * Implementation of this function is OPTIONAL.
+ *
+ * \param self the client, connection or server socket instance
+ *
+ * \return the file descriptor or -1 if not available
+ */
+PAL_API int
+Socket_getFd(Socket self);
+
+/**
+ * \brief Get the operating system file descriptor of the server socket
+ *
+ * Implementation of this function is OPTIONAL.
+ *
+ * \param self the server socket instance
+ *
+ * \return the file descriptor or -1 if not available
+ */
+PAL_API int
+ServerSocket_getFd(ServerSocket self);
+
 /**
  * \brief destroy a socket (close the socket if a connection is established)
  *
@@ -347,6 +374,19 @@ Socket_getPeerAddressStatic(Socket self, char* peerAddressString);
 PAL_API void
 Socket_destroy(Socket self);
 
+/**
+ * \brief destroy a socket without waiting for other threads
+ *
+ * Same as \ref Socket_destroy but returns immediately. Only for sockets that are not
+ * used by any other thread at the same time (e.g. sockets handled by a single event loop).
+ *
+ * Implementation of this function is OPTIONAL.
+ *
+ * \param self the client or connection socket instance
+ */
+PAL_API void
+Socket_destroyNoWait(Socket self);
+
 /*! @} */
 
 /*! @} */
@@ -17,6 +17,8 @@
 #include <unistd.h>
 #include <sys/time.h>
 #include <sys/select.h>
+#include <poll.h>
+#include <errno.h>
 
 #include "hal_serial.h"
 #include "hal_time.h"
@@ -203,6 +205,12 @@ SerialPort_getBaudRate(SerialPort self)
     return self->baudRate;
 }
 
+int
+SerialPort_getFd(SerialPort self)
+{
+    return self->fd;
+}
+
 void
 SerialPort_discardInBuffer(SerialPort self)
 {
@@ -248,6 +256,45 @@ SerialPort_readByte(SerialPort self)
     }
 }
 
+int
+SerialPort_readBytes(SerialPort self, uint8_t* buffer, int maxSize)
+{
+    struct pollfd fds;
+
+    self->lastError = SERIAL_PORT_ERROR_NONE;
+
+    fds.fd = self->fd;
+    fds.events = POLLIN;
+    fds.revents = 0;
+
+    int timeoutInMs = (int) (self->timeout.tv_sec * 1000 + self->timeout.tv_usec / 1000);
+
+    int ret = poll(&fds, 1, timeoutInMs);
+
+    if (ret == -1) {
+        if (errno == EINTR)
+            return 0;
+
+        self->lastError = SERIAL_PORT_ERROR_UNKNOWN;
+        return -1;
+    }
+    else if (ret == 0)
+        return 0;
+
+    /* port is opened with O_NDELAY and VMIN = VTIME = 0: returns what is already received */
+    ssize_t readBytes = read(self->fd, buffer, maxSize);
+
+    if (readBytes < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+            return 0;
+
+        self->lastError = SERIAL_PORT_ERROR_UNKNOWN;
+        return -1;
+    }
+
+    return (int) readBytes;
+}
+
 int
 SerialPort_write(SerialPort self, uint8_t* buffer, int startPos, int bufSize)
 {
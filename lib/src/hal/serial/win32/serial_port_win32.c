@@ -205,6 +205,14 @@ SerialPort_getBaudRate(SerialPort self)
 	return self->baudRate;
 }
 
+int
+SerialPort_getFd(SerialPort self)
+{
+	(void) self;
+
+	return -1;
+}
+
 void
 SerialPort_discardInBuffer(SerialPort self)
 {
@@ -245,6 +253,55 @@ SerialPort_readByte(SerialPort self)
 		return (int) buf[0];
 }
 
+int
+SerialPort_readBytes(SerialPort self, uint8_t* buffer, int maxSize)
+{
+	DWORD errors;
+	COMSTAT comStat;
+
+	if (maxSize < 1)
+		return 0;
+
+	if (ClearCommError(self->comPort, &errors, &comStat) == false) {
+		self->lastError = SERIAL_PORT_ERROR_UNKNOWN;
+		return -1;
+	}
+
+	DWORD bytesToRead = comStat.cbInQue;
+
+	/* timeout 0: only return what is already received */
+	if ((bytesToRead == 0) && (self->timeout == 0)) {
+		self->lastError = SERIAL_PORT_ERROR_NONE;
+		return 0;
+	}
+
+	/* nothing received yet -> wait for the first byte with the port timeouts */
+	if (bytesToRead == 0) {
+		int readByte = SerialPort_readByte(self);
+
+		if (readByte == -1)
+			return (self->lastError == SERIAL_PORT_ERROR_NONE) ? 0 : -1;
+
+		buffer[0] = (uint8_t) readByte;
+
+		return 1;
+	}
+
+	if (bytesToRead > (DWORD) maxSize)
+		bytesToRead = (DWORD) maxSize;
+
+	DWORD bytesRead = 0;
+
+	if (ReadFile(self->comPort, buffer, bytesToRead, &bytesRead, NULL) == false) {
+		self->lastError = SERIAL_PORT_ERROR_UNKNOWN;
+		return -1;
+	}
+
+	self->lastError = SERIAL_PORT_ERROR_NONE;
+
+	return (int) bytesRead;
+}
+
 int
 SerialPort_write(SerialPort self, uint8_t* buffer, int startPos, int bufSize)
 {
@@ -505,17 +505,15 @@ Socket_connectAsync(Socket self, const char* address, int port)
 SocketState
 Socket_checkAsyncConnectState(Socket self)
 {
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 0;
-
-    fd_set fdSet;
-    FD_ZERO(&fdSet);
-    FD_SET(self->fd, &fdSet);
+    /* poll instead of select: the descriptor may be above FD_SETSIZE when many connections are open */
+    struct pollfd fds[1];
+    fds[0].fd = self->fd;
+    fds[0].events = POLLOUT;
+    fds[0].revents = 0;
 
-    int selectVal = select(self->fd + 1, NULL, &fdSet , NULL, &timeout);
+    int pollVal = poll(fds, 1, 0);
 
-    if (selectVal == 1) {
+    if (pollVal == 1) {
 
         /* Check if connection is established */
 
@@ -530,7 +528,7 @@ Socket_checkAsyncConnectState(Socket self)
 
         return SOCKET_STATE_FAILED;
     }
-    else if (selectVal == 0) {
+    else if (pollVal == 0) {
         return SOCKET_STATE_CONNECTING;
     }
     else {
@@ -722,6 +720,18 @@ Socket_write(Socket self, uint8_t* buf, int size)
     return retVal;
 }
 
+int
+Socket_getFd(Socket self)
+{
+    return self->fd;
+}
+
+int
+ServerSocket_getFd(ServerSocket self)
+{
+    return self->fd;
+}
+
 void
 Socket_destroy(Socket self)
 {
@@ -736,6 +746,18 @@ Socket_destroy(Socket self)
     GLOBAL_FREEMEM(self);
 }
 
+void
+Socket_destroyNoWait(Socket self)
+{
+    int fd = self->fd;
+
+    self->fd = -1;
+
+    closeAndShutdownSocket(fd);
+
+    GLOBAL_FREEMEM(self);
+}
+
 UdpSocket
 UdpSocket_create()
 {
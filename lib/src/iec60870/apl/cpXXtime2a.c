@@ -533,6 +533,42 @@ CP56Time2a_toMsTimestamp(const CP56Time2a self)
     return msTimestamp;
 }
 
+uint64_t
+CP56Time2a_toMsTimestampCached(const CP56Time2a self, CP56Time2aDayCache* cache)
+{
+    const uint8_t* encodedValue = self->encodedValue;
+
+    /* bit 31 marks the key as valid, so a zero-initialized cache never matches */
+    uint32_t dayKey = 0x80000000u | ((uint32_t) (encodedValue[6] & 0x7f) << 9) |
+            ((uint32_t) (encodedValue[5] & 0x0f) << 5) | (uint32_t) (encodedValue[4] & 0x1f);
+
+    uint64_t dayStartMs;
+
+    if ((cache != NULL) && (cache->dayKey == dayKey)) {
+        dayStartMs = cache->dayStartMs;
+    }
+    else {
+        struct tm tmTime;
+
+        memset(&tmTime, 0, sizeof(struct tm));
+
+        tmTime.tm_mday = CP56Time2a_getDayOfMonth(self);
+        tmTime.tm_mon = CP56Time2a_getMonth(self) - 1;
+        tmTime.tm_year = CP56Time2a_getYear(self) + 100;
+
+        dayStartMs = (uint64_t) my_mktime(&tmTime) * (uint64_t) 1000;
+
+        if (cache != NULL) {
+            cache->dayKey = dayKey;
+            cache->dayStartMs = dayStartMs;
+        }
+    }
+
+    /* the two millisecond bytes hold second * 1000 + millisecond */
+    return dayStartMs + (uint64_t) (encodedValue[3] & 0x1f) * 3600000u + (uint64_t) (encodedValue[2] & 0x3f) * 60000u +
+            (uint64_t) (encodedValue[0] + (encodedValue[1] * 0x100));
+}
+
 /* private */ bool
 CP56Time2a_getFromBuffer(CP56Time2a self, const uint8_t* msg, int msgSize, int startIndex)
 {
@@ -1201,7 +1201,7 @@ SinglePointWithCP56Time2a_create(SinglePointWithCP56Time2a self, int ioa, bool v
     return self;
 }
 
-SinglePointWithCP56Time2a
+bool
 SinglePointWithCP56Time2a_getValue(SinglePointWithCP56Time2a self)
 {
     return self->value;
@@ -3061,12 +3061,6 @@ IntegratedTotals_setBCR(IntegratedTotals self, BinaryCounterReading value)
         self->totals.encodedValue[i] = value->encodedValue[i];
 }
 
-QualityDescriptor
-IntegratedTotals_getQuality(IntegratedTotals self)
-{
-    return self->quality;
-}
-
 IntegratedTotals
 IntegratedTotals_getFromBuffer(IntegratedTotals self, CS101_AppLayerParameters parameters,
         uint8_t* msg, int msgSize, int startIndex, bool isSequence)
@@ -240,6 +240,30 @@ CS101_Master_run(CS101_Master self)
     }
 }
 
+void
+CS101_Master_runNonBlocking(CS101_Master self)
+{
+    if (self->unbalancedLinkLayer) {
+        LinkLayerPrimaryUnbalanced_runNonBlocking(self->unbalancedLinkLayer);
+    }
+    else {
+        LinkLayerBalanced_runNonBlocking(self->balancedLinkLayer);
+    }
+}
+
+uint64_t
+CS101_Master_getNextTimeout(CS101_Master self)
+{
+    if (self->unbalancedLinkLayer)
+        return LinkLayerPrimaryUnbalanced_getNextTimeout(self->unbalancedLinkLayer);
+
+    CS101_Queue_lock(&(self->userDataQueue));
+    bool userDataPending = (CS101_Queue_isEmpty(&(self->userDataQueue)) == false);
+    CS101_Queue_unlock(&(self->userDataQueue));
+
+    return LinkLayerBalanced_getNextTimeout(self->balancedLinkLayer, userDataPending);
+}
+
 #if (CONFIG_USE_THREADS == 1)
 static void*
 masterMainThread(void* parameter)
@@ -496,6 +520,31 @@ CS101_Master_pollSingleSlave(CS101_Master self, int address)
     }
 }
 
+void
+CS101_Master_setAutoPolling(CS101_Master self, bool enable, int minBackoff, int maxBackoff)
+{
+    if (self->unbalancedLinkLayer)
+        LinkLayerPrimaryUnbalanced_setAutoPolling(self->unbalancedLinkLayer, enable, minBackoff, maxBackoff);
+}
+
+bool
+CS101_Master_setSlavePriority(CS101_Master self, int address, int priority)
+{
+    if (self->unbalancedLinkLayer)
+        return LinkLayerPrimaryUnbalanced_setSlavePriority(self->unbalancedLinkLayer, address, priority);
+
+    return false;
+}
+
+bool
+CS101_Master_getSlavePollingStatistics(CS101_Master self, int address, LinkLayerPollingStatistics stats)
+{
+    if (self->unbalancedLinkLayer)
+        return LinkLayerPrimaryUnbalanced_getPollingStatistics(self->unbalancedLinkLayer, address, stats);
+
+    return false;
+}
+
 void
 CS101_Master_setASDUReceivedHandler(CS101_Master self, CS101_ASDUReceivedHandler handler, void* parameter)
 {
@@ -514,6 +563,13 @@ CS101_Master_setLinkLayerStateChanged(CS101_Master self, IEC60870_LinkLayerState
     }
 }
 
+void
+CS101_Master_setChannelReadyHandler(CS101_Master self, IEC60870_ChannelReadyHandler handler, void* parameter)
+{
+    if (self->unbalancedLinkLayer)
+        LinkLayerPrimaryUnbalanced_setChannelReadyHandler(self->unbalancedLinkLayer, handler, parameter);
+}
+
 void
 CS101_Master_setRawMessageHandler(CS101_Master self, IEC60870_RawMessageHandler handler, void* parameter)
 {
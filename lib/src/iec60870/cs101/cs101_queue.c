@@ -36,29 +36,31 @@
  * CS101_Queue
  ********************************************/
 
+/* initial allocation, the buffer grows on demand up to maxBufferSize */
+#define CS101_QUEUE_INITIAL_BUFFER_SIZE 1024
+
 void
 CS101_Queue_initialize(CS101_Queue self, int maxQueueSize)
 {
     self->entryCounter = 0;
     self->firstMsgIndex = 0;
     self->lastMsgIndex = 0;
-    self->size = maxQueueSize;
-
-    BufferFrame_initialize(&(self->encodeFrame), NULL, 0);
-
-#if (CS101_MAX_QUEUE_SIZE == -1)
-    int queueSize = maxQueueSize;
 
     if (maxQueueSize == -1)
-        queueSize = 100;
+        maxQueueSize = 100;
+    else if (maxQueueSize < 1)
+        maxQueueSize = CS101_MAX_QUEUE_SIZE;
 
-    self->elements = (CS101_QueueElement) GLOBAL_CALLOC(queueSize, sizeof(struct sCS101_QueueElement));
+    self->size = maxQueueSize;
 
-    self->size = queueSize;
-#else
-    self->size = CS101_MAX_QUEUE_SIZE;
-#endif
+    /* one length byte and at most 255 bytes of ASDU per entry */
+    self->maxBufferSize = maxQueueSize * 256;
 
+    self->bufferSize = 0;
+    self->usedBytes = 0;
+    self->buffer = NULL;
+
+    BufferFrame_initialize(&(self->encodeFrame), NULL, 0);
 
 #if (CONFIG_USE_SEMAPHORES == 1)
     self->queueLock = Semaphore_create(1);
@@ -72,9 +74,10 @@ CS101_Queue_dispose(CS101_Queue self)
     Semaphore_destroy(self->queueLock);
 #endif
 
-#if (CS101_MAX_QUEUE_SIZE == -1)
-    GLOBAL_FREEMEM(self->elements);
-#endif
+    if (self->buffer) {
+        GLOBAL_FREEMEM(self->buffer);
+        self->buffer = NULL;
+    }
 }
 
 void
@@ -93,61 +96,161 @@ CS101_Queue_unlock(CS101_Queue self)
 #endif
 }
 
-void
-CS101_Queue_enqueue(CS101_Queue self, CS101_ASDU asdu)
+static void
+copyToBuffer(CS101_Queue self, int offset, const uint8_t* src, int length)
 {
-    CS101_Queue_lock(self);
+    int firstPart = self->bufferSize - offset;
 
-    int nextIndex;
-    bool removeEntry = false;
+    if (firstPart >= length)
+        memcpy(self->buffer + offset, src, length);
+    else {
+        memcpy(self->buffer + offset, src, firstPart);
+        memcpy(self->buffer, src + firstPart, length - firstPart);
+    }
+}
+
+static void
+copyFromBuffer(CS101_Queue self, int offset, uint8_t* dst, int length)
+{
+    int firstPart = self->bufferSize - offset;
 
-    if (self->entryCounter == 0) {
-        self->firstMsgIndex = 0;
-        nextIndex = 0;
+    if (firstPart >= length)
+        memcpy(dst, self->buffer + offset, length);
+    else {
+        memcpy(dst, self->buffer + offset, firstPart);
+        memcpy(dst + firstPart, self->buffer, length - firstPart);
     }
-    else
-        nextIndex = self->lastMsgIndex + 1;
+}
 
-    if (nextIndex == self->size)
-        nextIndex = 0;
+static void
+removeOldestEntry(CS101_Queue self)
+{
+    int entrySize = 1 + self->buffer[self->firstMsgIndex];
 
-    if (self->entryCounter == self->size)
-        removeEntry = true;
+    self->firstMsgIndex = (self->firstMsgIndex + entrySize) % self->bufferSize;
+    self->usedBytes -= entrySize;
+    self->entryCounter--;
+}
 
-    if (removeEntry == false) {
-        DEBUG_PRINT("add entry (nextIndex:%i)\n", nextIndex);
-        self->lastMsgIndex = nextIndex;
-        self->entryCounter++;
-    }
-    else {
-        DEBUG_PRINT("add entry (nextIndex:%i) -> remove oldest\n", nextIndex);
+/*
+ * Make room for requiredBytes more bytes. The entries are moved to the start of
+ * the new buffer. Returns false when the buffer cannot be enlarged.
+ */
+static bool
+growBuffer(CS101_Queue self, int requiredBytes)
+{
+    int newSize = (self->bufferSize == 0) ? CS101_QUEUE_INITIAL_BUFFER_SIZE : self->bufferSize;
 
-        /* remove oldest entry */
-        self->lastMsgIndex = nextIndex;
+    while (newSize < self->usedBytes + requiredBytes)
+        newSize = newSize * 2;
 
-        int firstIndex = nextIndex + 1;
+    if (newSize > self->maxBufferSize)
+        newSize = self->maxBufferSize;
 
-        if (firstIndex == self->size)
-            firstIndex = 0;
+    if (newSize < self->usedBytes + requiredBytes)
+        return false;
 
-        self->firstMsgIndex = firstIndex;
-    }
+    uint8_t* newBuffer = (uint8_t*) GLOBAL_MALLOC(newSize);
 
-    self->encodeFrame.buffer = self->elements[nextIndex].buffer;
-    self->encodeFrame.startSize = 0;
-    self->encodeFrame.msgSize = 0;
+    if (newBuffer == NULL)
+        return false;
+
+    if (self->usedBytes > 0)
+        copyFromBuffer(self, self->firstMsgIndex, newBuffer, self->usedBytes);
+
+    if (self->buffer)
+        GLOBAL_FREEMEM(self->buffer);
+
+    DEBUG_PRINT("queue buffer resized: %i -> %i bytes\n", self->bufferSize, newSize);
+
+    self->buffer = newBuffer;
+    self->bufferSize = newSize;
+    self->firstMsgIndex = 0;
+    self->lastMsgIndex = self->usedBytes;
+
+    return true;
+}
+
+/*
+ * NOTE: Locking has to be done by caller!
+ */
+static bool
+enqueueEntry(CS101_Queue self, CS101_ASDU asdu, bool removeOldest)
+{
+    BufferFrame_initialize(&(self->encodeFrame), self->encodeBuffer, 0);
 
     CS101_ASDU_encode(asdu, (Frame)&(self->encodeFrame));
 
-    int srcSize = self->encodeFrame.msgSize;
-    self->elements[nextIndex].size = srcSize;
+    int asduSize = self->encodeFrame.msgSize;
+
+    if (asduSize > 255)
+        return false;
+
+    int entrySize = 1 + asduSize;
+
+    if (self->entryCounter == self->size) {
+        if (removeOldest == false)
+            return false;
+
+        DEBUG_PRINT("queue full -> remove oldest\n");
+        removeOldestEntry(self);
+    }
+
+    if (self->bufferSize - self->usedBytes < entrySize) {
+        if (growBuffer(self, entrySize) == false) {
+            if (removeOldest == false)
+                return false;
+
+            while ((self->entryCounter > 0) && (self->bufferSize - self->usedBytes < entrySize))
+                removeOldestEntry(self);
+
+            if (self->bufferSize - self->usedBytes < entrySize)
+                return false;
+        }
+    }
+
+    uint8_t length = (uint8_t) asduSize;
+
+    copyToBuffer(self, self->lastMsgIndex, &length, 1);
+    copyToBuffer(self, (self->lastMsgIndex + 1) % self->bufferSize, self->encodeBuffer, asduSize);
+
+    self->lastMsgIndex = (self->lastMsgIndex + entrySize) % self->bufferSize;
+    self->usedBytes += entrySize;
+    self->entryCounter++;
+
+    DEBUG_PRINT("Events in FIFO: %i (%i/%i bytes)\n", self->entryCounter, self->usedBytes, self->bufferSize);
+
+    return true;
+}
+
+void
+CS101_Queue_enqueue(CS101_Queue self, CS101_ASDU asdu)
+{
+    CS101_Queue_lock(self);
 
-    DEBUG_PRINT("Events in FIFO: %i (first: %i, last: %i)\n", self->entryCounter,
-            self->firstMsgIndex, self->lastMsgIndex);
+    enqueueEntry(self, asdu, true);
 
     CS101_Queue_unlock(self);
 }
 
+int
+CS101_Queue_enqueueMany(CS101_Queue self, CS101_ASDU* asdus, int count)
+{
+    int enqueued = 0;
+
+    CS101_Queue_lock(self);
+
+    while (enqueued < count) {
+        if (enqueueEntry(self, asdus[enqueued], false) == false)
+            break;
+
+        enqueued++;
+    }
+
+    CS101_Queue_unlock(self);
+
+    return enqueued;
+}
 
 /*
  * NOTE: Locking has to be done by caller!
@@ -163,11 +266,18 @@ CS101_Queue_dequeue(CS101_Queue self, Frame resultStorage)
             frame = resultStorage;
 
             int currentIndex = self->firstMsgIndex;
-
-            Frame_appendBytes(frame, self->elements[currentIndex].buffer, self->elements[currentIndex].size);
-
-            self->firstMsgIndex = (currentIndex + 1) % self->size;
-            self->entryCounter--;
+            int asduSize = self->buffer[currentIndex];
+            int dataIndex = (currentIndex + 1) % self->bufferSize;
+            int firstPart = self->bufferSize - dataIndex;
+
+            if (firstPart >= asduSize)
+                Frame_appendBytes(frame, self->buffer + dataIndex, asduSize);
+            else {
+                Frame_appendBytes(frame, self->buffer + dataIndex, firstPart);
+                Frame_appendBytes(frame, self->buffer, asduSize - firstPart);
+            }
+
+            removeOldestEntry(self);
         }
     }
 
@@ -186,6 +296,11 @@ CS101_Queue_isEmpty(CS101_Queue self)
    return (self->entryCounter == 0);
 }
 
+int
+CS101_Queue_getEntryCount(CS101_Queue self)
+{
+   return self->entryCounter;
+}
 
 void
 CS101_Queue_flush(CS101_Queue self)
@@ -194,6 +309,7 @@ CS101_Queue_flush(CS101_Queue self)
     self->entryCounter = 0;
     self->firstMsgIndex = 0;
     self->lastMsgIndex = 0;
+    self->usedBytes = 0;
     CS101_Queue_unlock(self);
 }
 
@@ -463,6 +463,18 @@ CS101_Slave_enqueueUserDataClass1(CS101_Slave self, CS101_ASDU asdu)
     CS101_Queue_enqueue(&(self->userDataClass1Queue), asdu);
 }
 
+int
+CS101_Slave_enqueueUserDataClass1Many(CS101_Slave self, CS101_ASDU* asdus, int count)
+{
+    return CS101_Queue_enqueueMany(&(self->userDataClass1Queue), asdus, count);
+}
+
+int
+CS101_Slave_getClass1QueueCount(CS101_Slave self)
+{
+    return CS101_Queue_getEntryCount(&(self->userDataClass1Queue));
+}
+
 
 bool
 CS101_Slave_isClass2QueueFull(CS101_Slave self)
@@ -476,6 +488,18 @@ CS101_Slave_enqueueUserDataClass2(CS101_Slave self, CS101_ASDU asdu)
     CS101_Queue_enqueue(&(self->userDataClass2Queue), asdu);
 }
 
+int
+CS101_Slave_enqueueUserDataClass2Many(CS101_Slave self, CS101_ASDU* asdus, int count)
+{
+    return CS101_Queue_enqueueMany(&(self->userDataClass2Queue), asdus, count);
+}
+
+int
+CS101_Slave_getClass2QueueCount(CS101_Slave self)
+{
+    return CS101_Queue_getEntryCount(&(self->userDataClass2Queue));
+}
+
 void
 CS101_Slave_flushQueues(CS101_Slave self)
 {
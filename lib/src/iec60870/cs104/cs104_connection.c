@@ -43,6 +43,10 @@
 #include "lib60870_internal.h"
 #include "cs101_asdu_internal.h"
 
+#ifndef CONFIG_CS104_READ_BUFFER_SIZE
+#define CONFIG_CS104_READ_BUFFER_SIZE 4096 /* has to hold at least one maximum size APDU (255 + 2 bytes) */
+#endif
+
 struct sCS104_APCIParameters defaultAPCIParameters = {
 		/* .k = */ 12,
 		/* .w = */ 8,
@@ -89,8 +93,12 @@ struct sCS104_Connection {
     struct sCS104_APCIParameters parameters;
     struct sCS101_AppLayerParameters alParameters;
 
-    uint8_t recvBuffer[260];
-    int recvBufPos;
+    uint8_t* recvBuffer; /* current message (points into readBuffer) */
+
+    /* received but not yet handled bytes (complete messages and one partial message) */
+    uint8_t readBuffer[CONFIG_CS104_READ_BUFFER_SIZE];
+    int readBufStart;
+    int readBufEnd;
 
     int connectTimeoutInMs;
     uint8_t sMessage[6];
@@ -128,6 +136,11 @@ struct sCS104_Connection {
     bool failure;
     bool close;
 
+    /* threadless mode (CS104_Connection_connectThreadless/CS104_Connection_run) */
+    bool threadless;
+    bool connecting;
+    uint64_t connectDeadline;
+
     CS104_ConState conState;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -251,6 +264,7 @@ createConnection(const char* hostname, int tcpPort)
         self->tcpPort = tcpPort;
         self->parameters = defaultAPCIParameters;
         self->alParameters = defaultAppLayerParameters;
+        self->connectTimeoutInMs = self->parameters.t0 * 1000;
 
         self->localIpAddress = NULL;
         self->localTcpPort = -1;
@@ -328,8 +342,9 @@ resetConnection(CS104_Connection self)
     Semaphore_wait(self->conStateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
 
-    self->connectTimeoutInMs = self->parameters.t0 * 1000;
-    self->recvBufPos = 0;
+    self->readBufStart = 0;
+    self->readBufEnd = 0;
+    self->recvBuffer = self->readBuffer;
 
     self->running = false;
     self->failure = false;
@@ -466,6 +481,9 @@ isSentBufferFull(CS104_Connection self)
         return false;
 }
 
+static void
+closeThreadless(CS104_Connection self, CS104_ConnectionEvent event);
+
 void
 CS104_Connection_close(CS104_Connection self)
 {
@@ -479,6 +497,11 @@ CS104_Connection_close(CS104_Connection self)
     Semaphore_post(self->conStateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
 
+    if (self->threadless) {
+        if (self->socket)
+            closeThreadless(self, CS104_CONNECTION_CLOSED);
+    }
+
 #if (CONFIG_USE_THREADS == 1)
     if (self->connectionHandlingThread)
     {
@@ -575,70 +598,86 @@ readFromSocket(CS104_Connection self, uint8_t* buffer, int size)
 }
 
 /**
- * \brief Read message part into receive buffer
+ * \brief Get the size of the complete message at the start of the buffer
  *
- * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in buffer
+ * \return -1 in case of a framing error, 0 when the message is not complete, > 0 message size
  */
 static int
-receiveMessage(CS104_Connection self)
+getBufferedMessageSize(const uint8_t* buffer, int available)
 {
-    uint8_t* buffer = self->recvBuffer;
-    int bufPos = self->recvBufPos;
+    if (available < 1)
+        return 0;
 
-    /* read start byte */
-    if (bufPos == 0) {
-        int readFirst = readFromSocket(self, buffer, 1);
+    if (buffer[0] != 0x68)
+        return -1; /* message error */
 
-        if (readFirst < 1)
-            return readFirst;
+    if (available < 2)
+        return 0;
 
-        if (buffer[0] != 0x68)
-            return -1; /* message error */
+    int messageSize = buffer[1] + 2;
 
-        bufPos++;
-    }
+    if (available < messageSize)
+        return 0;
+
+    return messageSize;
+}
+
+static bool
+isMessageBuffered(CS104_Connection self)
+{
+    return (getBufferedMessageSize(self->readBuffer + self->readBufStart, self->readBufEnd - self->readBufStart) != 0);
+}
+
+/**
+ * \brief Get the next message from the read buffer
+ *
+ * All bytes available on the socket are read with a single call into the read buffer
+ * when it doesn't contain a complete message. Following calls return the buffered
+ * messages without accessing the socket. A partial message at the end of the buffer
+ * is moved to the buffer start and completed by later reads.
+ *
+ * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in recvBuffer
+ */
+static int
+receiveMessage(CS104_Connection self)
+{
+    int messageSize = getBufferedMessageSize(self->readBuffer + self->readBufStart, self->readBufEnd - self->readBufStart);
 
-    /* read length byte */
-    if (bufPos == 1)  {
+    if (messageSize == 0) {
+        int available = self->readBufEnd - self->readBufStart;
 
-        int readCnt = readFromSocket(self, buffer + 1, 1);
+        if (self->readBufStart > 0) {
+            memmove(self->readBuffer, self->readBuffer + self->readBufStart, available);
+            self->readBufStart = 0;
+            self->readBufEnd = available;
+        }
+
+        int readCnt = readFromSocket(self, self->readBuffer + self->readBufEnd, CONFIG_CS104_READ_BUFFER_SIZE - self->readBufEnd);
 
         if (readCnt < 0) {
-            self->recvBufPos = 0;
+            self->readBufStart = 0;
+            self->readBufEnd = 0;
             return -1;
         }
-        else if (readCnt == 0) {
-            self->recvBufPos = 1;
-            return 0;
-        }
 
-        bufPos++;
+        self->readBufEnd += readCnt;
+
+        messageSize = getBufferedMessageSize(self->readBuffer, self->readBufEnd);
     }
 
-    /* read remaining frame */
-    if (bufPos > 1) {
-        int length = buffer[1];
+    if (messageSize < 0) {
+        self->readBufStart = 0;
+        self->readBufEnd = 0;
+        return -1;
+    }
 
-        int remainingLength = length - bufPos + 2;
+    if (messageSize == 0)
+        return 0;
 
-        int readCnt = readFromSocket(self, buffer + bufPos, remainingLength);
+    self->recvBuffer = self->readBuffer + self->readBufStart;
+    self->readBufStart += messageSize;
 
-        if (readCnt == remainingLength) {
-            self->recvBufPos = 0;
-            return length + 2;
-        }
-        else if (readCnt == -1) {
-            self->recvBufPos = 0;
-            return -1;
-        }
-        else {
-            self->recvBufPos = bufPos + readCnt;
-            return 0;
-        }
-    }
-
-    self->recvBufPos = bufPos;
-    return 0;
+    return messageSize;
 }
 
 static bool
@@ -987,7 +1026,8 @@ handleConnection(void* parameter)
                     Handleset_reset(handleSet);
                     Handleset_addSocket(handleSet, self->socket);
 
-                    if (Handleset_waitReady(handleSet, 100)) {
+                    /* buffered messages are handled without waiting for the socket */
+                    if (isMessageBuffered(self) || Handleset_waitReady(handleSet, 100)) {
                         int bytesRec = receiveMessage(self);
 
                         if (bytesRec == -1) {
@@ -1103,6 +1143,257 @@ handleConnection(void* parameter)
 }
 #endif /* (CONFIG_USE_THREADS == 1) */
 
+static void
+closeThreadless(CS104_Connection self, CS104_ConnectionEvent event)
+{
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    /* Confirm all unconfirmed received I-messages before closing the connection */
+    if (self->running && (self->unconfirmedReceivedIMessages > 0)) {
+        confirmOutstandingMessages(self);
+    }
+
+#if defined(__linux__)
+    Socket_destroyNoWait(self->socket);
+#else
+    Socket_destroy(self->socket);
+#endif
+    self->socket = NULL;
+
+    self->conState = STATE_IDLE;
+    self->running = false;
+    self->connecting = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    if (self->connectionHandler)
+        self->connectionHandler(self->connectionHandlerParameter, self, event);
+}
+
+bool
+CS104_Connection_connectThreadless(CS104_Connection self)
+{
+#if (CONFIG_CS104_SUPPORT_TLS == 1)
+    if (self->tlsConfig != NULL)
+        return false;
+#endif
+
+    if (self->socket != NULL)
+        return false;
+
+    resetConnection(self);
+
+    self->threadless = true;
+
+    self->socket = TcpSocket_create();
+
+    if (self->socket == NULL) {
+        DEBUG_PRINT("Failed to create socket\n");
+        return false;
+    }
+
+    if (self->localIpAddress) {
+        Socket_bind(self->socket, self->localIpAddress, self->localTcpPort);
+    }
+
+    if (Socket_connectAsync(self->socket, self->hostname, self->tcpPort) == false) {
+        Socket_destroy(self->socket);
+        self->socket = NULL;
+        return false;
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    self->connecting = true;
+    self->connectDeadline = Hal_getTimeInMs() + self->connectTimeoutInMs;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    return true;
+}
+
+int
+CS104_Connection_getSocketFd(CS104_Connection self)
+{
+#if defined(__linux__)
+    if (self->socket)
+        return Socket_getFd(self->socket);
+#endif
+
+    return -1;
+}
+
+bool
+CS104_Connection_isConnecting(CS104_Connection self)
+{
+    return self->connecting;
+}
+
+bool
+CS104_Connection_run(CS104_Connection self)
+{
+    if (self->socket == NULL)
+        return false;
+
+    if (self->connecting) {
+        SocketState state = Socket_checkAsyncConnectState(self->socket);
+
+        if (state == SOCKET_STATE_CONNECTING) {
+            if (Hal_getTimeInMs() < self->connectDeadline)
+                return true;
+
+            state = SOCKET_STATE_FAILED;
+        }
+
+        if (state == SOCKET_STATE_FAILED) {
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+            self->failure = true;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+            closeThreadless(self, CS104_CONNECTION_FAILED);
+            return false;
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+        self->connecting = false;
+        self->running = true;
+        self->conState = STATE_INACTIVE;
+        resetT3Timeout(self);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+        if (self->connectionHandler)
+            self->connectionHandler(self->connectionHandlerParameter, self, CS104_CONNECTION_OPENED);
+    }
+
+    bool loopRunning = true;
+
+    /* all frames available on the socket and in the read buffer are handled */
+    while (loopRunning) {
+        int bytesRec = receiveMessage(self);
+
+        if (bytesRec == 0)
+            break;
+
+        if (bytesRec == -1) {
+            loopRunning = false;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+            self->failure = true;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+            Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+            break;
+        }
+
+        if (self->rawMessageHandler)
+            self->rawMessageHandler(self->rawMessageHandlerParameter, self->recvBuffer, bytesRec, false);
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+        if (checkMessage(self, self->recvBuffer, bytesRec) == false) {
+            /* close connection on error */
+            loopRunning = false;
+
+            self->failure = true;
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+        if ((self->unconfirmedReceivedIMessages >= self->parameters.w) || (self->conState == STATE_WAITING_FOR_STOPDT_CON)) {
+            confirmOutstandingMessages(self);
+        }
+    }
+
+    if (loopRunning && (handleTimeouts(self) == false))
+        loopRunning = false;
+
+    if (loopRunning && isClose(self))
+        loopRunning = false;
+
+    if (loopRunning == false) {
+        closeThreadless(self, CS104_CONNECTION_CLOSED);
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t
+CS104_Connection_getNextTimeout(CS104_Connection self)
+{
+    uint64_t nextTimeout;
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_wait(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    /* handleTimeouts checks with ">", so every deadline is one ms after the stored time */
+    if (self->connecting) {
+        nextTimeout = self->connectDeadline;
+    }
+    else {
+        nextTimeout = self->nextT3Timeout + 1;
+
+        if ((self->uMessageTimeout != 0) && (self->uMessageTimeout + 1 < nextTimeout))
+            nextTimeout = self->uMessageTimeout + 1;
+
+        if ((self->unconfirmedReceivedIMessages > 0) && (self->lastConfirmationTime != 0xffffffffffffffff)) {
+            uint64_t t2Timeout = self->lastConfirmationTime + (self->parameters.t2 * 1000) + 1;
+
+            if (t2Timeout < nextTimeout)
+                nextTimeout = t2Timeout;
+        }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_wait(self->sentASDUsLock);
+#endif
+        if (self->oldestSentASDU != -1) {
+            uint64_t t1Timeout = self->sentASDUs[self->oldestSentASDU].sentTime + (self->parameters.t1 * 1000);
+
+            if (t1Timeout < nextTimeout)
+                nextTimeout = t1Timeout;
+        }
+#if (CONFIG_USE_SEMAPHORES == 1)
+        Semaphore_post(self->sentASDUsLock);
+#endif
+    }
+
+#if (CONFIG_USE_SEMAPHORES == 1)
+    Semaphore_post(self->conStateLock);
+#endif /* (CONFIG_USE_SEMAPHORES == 1) */
+
+    return nextTimeout;
+}
+
 void
 CS104_Connection_connectAsync(CS104_Connection self)
 {
@@ -1113,6 +1404,7 @@ CS104_Connection_connectAsync(CS104_Connection self)
     self->running = false;
     self->failure = false;
     self->close = false;
+    self->threadless = false;
 
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore_post(self->conStateLock);
@@ -49,6 +49,28 @@
 #include "tls_socket.h"
 #endif
 
+#ifndef CONFIG_CS104_READ_BUFFER_SIZE
+#define CONFIG_CS104_READ_BUFFER_SIZE 4096 /* has to hold at least one maximum size APDU (255 + 2 bytes) */
+#endif
+
+/* epoll engine (see CS104_Slave_setEpollWorkers) */
+#if defined(__linux__) && (CONFIG_USE_THREADS == 1) && (CONFIG_USE_SEMAPHORES == 1)
+#ifndef CONFIG_CS104_SLAVE_EPOLL
+#define CONFIG_CS104_SLAVE_EPOLL 1
+#endif
+#else
+#undef CONFIG_CS104_SLAVE_EPOLL
+#define CONFIG_CS104_SLAVE_EPOLL 0
+#endif
+
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
 #if ((CONFIG_CS104_SUPPORT_SERVER_MODE_CONNECTION_IS_REDUNDANCY_GROUP != 1) && (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP != 1) && (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS != 1))
 #error Illegal configuration: Define either CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP or CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP or CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS
 #endif
@@ -1039,6 +1061,11 @@ struct sCS104_Slave {
     bool isThreadlessMode;
 #endif
 
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+    int epollWorkerCount; /**< configured number of epoll workers (0 = thread per connection) */
+    struct sEpollWorker* epollWorkers; /**< running epoll workers (NULL in thread per connection mode) */
+#endif
+
     int maxOpenConnections; /**< maximum accepted open client connections */
 
     struct sCS104_APCIParameters conParameters;
@@ -1122,8 +1149,12 @@ struct sMasterConnection {
 
     HandleSet handleSet;
 
-    uint8_t recvBuffer[260];
-    int recvBufPos;
+    uint8_t* recvBuffer; /* current message (points into readBuffer) */
+
+    /* received but not yet handled bytes (complete messages and one partial message) */
+    uint8_t readBuffer[CONFIG_CS104_READ_BUFFER_SIZE];
+    int readBufStart;
+    int readBufEnd;
 
     uint8_t sendBuffer[260];
 
@@ -1133,6 +1164,15 @@ struct sMasterConnection {
 #if (CONFIG_CS104_SUPPORT_SERVER_MODE_MULTIPLE_REDUNDANCY_GROUPS == 1)
     CS104_RedundancyGroup redundancyGroup;
 #endif
+
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+    struct sEpollWorker* epollWorker; /* owning worker in epoll mode (protected by stateLock) */
+
+    /* timer wheel of the owning worker (only accessed by the worker thread) */
+    MasterConnection wheelNext;
+    MasterConnection wheelPrev;
+    int wheelSlot; /* -1 when not scheduled */
+#endif
 };
 
 static uint8_t STARTDT_CON_MSG[] = { 0x68, 0x04, 0x0b, 0x00, 0x00, 0x00 };
@@ -1470,6 +1510,46 @@ CS104_Slave_setMaxOpenConnections(CS104_Slave self, int maxOpenConnections)
     self->maxOpenConnections = maxOpenConnections;
 }
 
+bool
+CS104_Slave_setEpollWorkers(CS104_Slave self, int numberOfWorkers)
+{
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+    if (numberOfWorkers < 0)
+        numberOfWorkers = 0;
+
+#if (CONFIG_CS104_SUPPORT_TLS == 1)
+    if ((numberOfWorkers > 0) && (self->tlsConfig != NULL)) {
+        DEBUG_PRINT("CS104 SLAVE: epoll workers not supported with TLS\n");
+        return false;
+    }
+#endif
+
+    self->epollWorkerCount = numberOfWorkers;
+
+    return true;
+#else
+    (void)self;
+    (void)numberOfWorkers;
+
+    DEBUG_PRINT("CS104 SLAVE: epoll workers not supported on this platform\n");
+
+    return false;
+#endif
+}
+
+int
+CS104_Slave_getEpollWorkers(CS104_Slave self)
+{
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+    if (self->epollWorkers != NULL)
+        return self->epollWorkerCount;
+#else
+    (void)self;
+#endif
+
+    return 0;
+}
+
 void
 CS104_Slave_setConnectionRequestHandler(CS104_Slave self, CS104_ConnectionRequestHandler handler, void* parameter)
 {
@@ -1654,63 +1734,86 @@ readFromSocket(MasterConnection self, uint8_t* buffer, int size)
 }
 
 /**
- * \brief Read message part into receive buffer
+ * \brief Get the size of the complete message at the start of the buffer
  *
- * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in buffer
+ * \return -1 in case of a framing error, 0 when the message is not complete, > 0 message size
  */
 static int
-receiveMessage(MasterConnection self)
+getBufferedMessageSize(const uint8_t* buffer, int available)
 {
-    uint8_t* buffer = self->recvBuffer;
-    int bufPos = self->recvBufPos;
-
-    /* read start byte */
-    if (bufPos == 0) {
-        int readFirst = readFromSocket(self, buffer, 1);
+    if (available < 1)
+        return 0;
 
-        if (readFirst < 1)
-            return readFirst;
+    if (buffer[0] != 0x68)
+        return -1; /* message error */
 
-        if (buffer[0] != 0x68)
-            return -1; /* message error */
+    if (available < 2)
+        return 0;
 
-        bufPos++;
-    }
+    int messageSize = buffer[1] + 2;
 
-    /* read length byte */
-    if (bufPos == 1)  {
-        if (readFromSocket(self, buffer + 1, 1) != 1) {
-            self->recvBufPos = 0;
-            return -1;
-        }
+    if (available < messageSize)
+        return 0;
 
-        bufPos++;
-    }
+    return messageSize;
+}
 
-    /* read remaining frame */
-    if (bufPos > 1) {
-        int length = buffer[1];
+static bool
+isMessageBuffered(MasterConnection self)
+{
+    return (getBufferedMessageSize(self->readBuffer + self->readBufStart, self->readBufEnd - self->readBufStart) != 0);
+}
 
-        int remainingLength = length - bufPos + 2;
+/**
+ * \brief Get the next message from the read buffer
+ *
+ * All bytes available on the socket are read with a single call into the read buffer
+ * when it doesn't contain a complete message. Following calls return the buffered
+ * messages without accessing the socket. A partial message at the end of the buffer
+ * is moved to the buffer start and completed by later reads.
+ *
+ * \return -1 in case of an error, 0 when no complete message can be read, > 0 when a complete message is in recvBuffer
+ */
+static int
+receiveMessage(MasterConnection self)
+{
+    int messageSize = getBufferedMessageSize(self->readBuffer + self->readBufStart, self->readBufEnd - self->readBufStart);
 
-        int readCnt = readFromSocket(self, buffer + bufPos, remainingLength);
+    if (messageSize == 0) {
+        int available = self->readBufEnd - self->readBufStart;
 
-        if (readCnt == remainingLength) {
-            self->recvBufPos = 0;
-            return length + 2;
+        if (self->readBufStart > 0) {
+            memmove(self->readBuffer, self->readBuffer + self->readBufStart, available);
+            self->readBufStart = 0;
+            self->readBufEnd = available;
         }
-        else if (readCnt == -1) {
-            self->recvBufPos = 0;
+
+        int readCnt = readFromSocket(self, self->readBuffer + self->readBufEnd, CONFIG_CS104_READ_BUFFER_SIZE - self->readBufEnd);
+
+        if (readCnt < 0) {
+            self->readBufStart = 0;
+            self->readBufEnd = 0;
             return -1;
         }
-        else {
-            self->recvBufPos = bufPos + readCnt;
-            return 0;
-        }
+
+        self->readBufEnd += readCnt;
+
+        messageSize = getBufferedMessageSize(self->readBuffer, self->readBufEnd);
     }
 
-    self->recvBufPos = bufPos;
-    return 0;
+    if (messageSize < 0) {
+        self->readBufStart = 0;
+        self->readBufEnd = 0;
+        return -1;
+    }
+
+    if (messageSize == 0)
+        return 0;
+
+    self->recvBuffer = self->readBuffer + self->readBufStart;
+    self->readBufStart += messageSize;
+
+    return messageSize;
 }
 
 static int
@@ -2861,7 +2964,8 @@ connectionHandlingThread(void* parameter)
         else
             socketTimeout = 100;
 
-        if (Handleset_waitReady(self->handleSet, socketTimeout)) {
+        /* buffered messages are handled without waiting for the socket */
+        if (isMessageBuffered(self) || Handleset_waitReady(self->handleSet, socketTimeout)) {
 
             int bytesRec = receiveMessage(self);
 
@@ -3069,6 +3173,13 @@ MasterConnection_create(CS104_Slave slave)
 #endif
         self->lowPrioQueue = NULL;
         self->highPrioQueue = NULL;
+
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+        self->epollWorker = NULL;
+        self->wheelNext = NULL;
+        self->wheelPrev = NULL;
+        self->wheelSlot = -1;
+#endif
     }
 
     return self;
@@ -3083,7 +3194,9 @@ MasterConnection_init(MasterConnection self, Socket skt, MessageQueue lowPrioQue
         self->isRunning = false;
         self->receiveCount = 0;
         self->sendCount = 0;
-        self->recvBufPos = 0;
+        self->readBufStart = 0;
+        self->readBufEnd = 0;
+        self->recvBuffer = self->readBuffer;
 
         self->unconfirmedReceivedIMessages = 0;
         self->lastConfirmationTime = UINT64_MAX;
@@ -3221,17 +3334,30 @@ MasterConnection_activate(MasterConnection self)
 
 }
 
-static void
+/**
+ * \brief Read from the socket once and handle all complete messages
+ *
+ * \return -1 in case of an error, otherwise the number of handled messages
+ */
+static int
 MasterConnection_handleTcpConnection(MasterConnection self)
 {
-    int bytesRec = receiveMessage(self);
+    int messages = 0;
 
-    if (bytesRec < 0) {
-        DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
-        self->isRunning = false;
-    }
+    do {
+        int bytesRec = receiveMessage(self);
 
-    if ((bytesRec > 0) && (self->isRunning)) {
+        if (bytesRec < 0) {
+            DEBUG_PRINT("CS104 SLAVE: Error reading from socket\n");
+            self->isRunning = false;
+
+            return -1;
+        }
+
+        if (bytesRec == 0)
+            break;
+
+        messages++;
 
         if (self->slave->rawMessageHandler)
             self->slave->rawMessageHandler(self->slave->rawMessageHandlerParameter,
@@ -3250,7 +3376,10 @@ MasterConnection_handleTcpConnection(MasterConnection self)
 
             sendSMessage(self);
         }
-    }
+
+    } while (self->isRunning && isMessageBuffered(self));
+
+    return messages;
 }
 
 static void
@@ -3359,6 +3488,573 @@ handleClientConnections(CS104_Slave self)
 
 }
 
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+
+/***************************************************
+ * epoll engine
+ *
+ * A fixed pool of worker threads. The listening thread hands every accepted
+ * connection to the worker with the fewest connections. A worker waits for
+ * all of its sockets and its wakeup eventfd with one epoll instance and keeps
+ * the t1/t2/t3 timeouts of its connections in a timer wheel.
+ ***************************************************/
+
+#define EPOLL_WHEEL_SLOTS 64
+#define EPOLL_WHEEL_RESOLUTION_MS 16
+#define EPOLL_MAX_EVENTS 64
+
+typedef struct sEpollWorker* EpollWorker;
+
+struct sEpollWorker {
+    CS104_Slave slave;
+
+    int epollFd;
+    int wakeupFd;
+
+    Thread thread;
+
+    Semaphore lock; /* protects stop, pending, pendingCount, load */
+    bool stop;
+    MasterConnection pending[CONFIG_CS104_MAX_CLIENT_CONNECTIONS]; /* handed over, not yet adopted */
+    int pendingCount;
+    int load; /* pending + owned connections */
+
+    /* only accessed by the worker thread */
+    MasterConnection connections[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
+    int connectionCount;
+
+    MasterConnection wheel[EPOLL_WHEEL_SLOTS];
+    uint64_t wheelTick; /* next tick to be processed */
+};
+
+static void
+EpollWorker_wakeup(EpollWorker self)
+{
+    uint64_t value = 1;
+
+    if (write(self->wakeupFd, &value, sizeof(value)) < 0) {
+        DEBUG_PRINT("CS104 SLAVE: epoll worker wakeup failed (errno=%i)\n", errno);
+    }
+}
+
+static bool
+EpollWorker_isStopped(EpollWorker self)
+{
+    bool stop;
+
+    Semaphore_wait(self->lock);
+    stop = self->stop;
+    Semaphore_post(self->lock);
+
+    return stop;
+}
+
+static void
+wakeupEpollWorkers(CS104_Slave self)
+{
+    if (self->epollWorkers) {
+        int i;
+
+        for (i = 0; i < self->epollWorkerCount; i++)
+            EpollWorker_wakeup(&(self->epollWorkers[i]));
+    }
+}
+
+/* earliest time at which handleTimeouts has something to do for the connection */
+static uint64_t
+MasterConnection_nextTimeout(MasterConnection self)
+{
+    uint64_t nextTimeout;
+
+    Semaphore_wait(self->stateLock);
+
+    nextTimeout = self->nextT3Timeout + 1;
+
+    if (self->waitingForTestFRcon && (self->nextTestFRConTimeout + 1 < nextTimeout))
+        nextTimeout = self->nextTestFRConTimeout + 1;
+
+    if ((self->unconfirmedReceivedIMessages > 0) && (self->lastConfirmationTime != UINT64_MAX)) {
+        uint64_t t2Timeout = self->lastConfirmationTime + (uint64_t) (self->slave->conParameters.t2 * 1000);
+
+        if (t2Timeout < nextTimeout)
+            nextTimeout = t2Timeout;
+    }
+
+    Semaphore_post(self->stateLock);
+
+    Semaphore_wait(self->sentASDUsLock);
+
+    if (self->oldestSentASDU != -1) {
+        uint64_t t1Timeout = self->sentASDUs[self->oldestSentASDU].sentTime + (uint64_t) (self->slave->conParameters.t1 * 1000);
+
+        if (t1Timeout < nextTimeout)
+            nextTimeout = t1Timeout;
+    }
+
+    Semaphore_post(self->sentASDUsLock);
+
+    return nextTimeout;
+}
+
+static void
+EpollWorker_unschedule(EpollWorker self, MasterConnection con)
+{
+    if (con->wheelSlot == -1)
+        return;
+
+    if (con->wheelPrev)
+        con->wheelPrev->wheelNext = con->wheelNext;
+    else
+        self->wheel[con->wheelSlot] = con->wheelNext;
+
+    if (con->wheelNext)
+        con->wheelNext->wheelPrev = con->wheelPrev;
+
+    con->wheelNext = NULL;
+    con->wheelPrev = NULL;
+    con->wheelSlot = -1;
+}
+
+/*
+ * Put the connection into the slot of its next timeout. The wheel covers
+ * EPOLL_WHEEL_SLOTS ticks, later timeouts are rescheduled when the last slot
+ * expires. ASDUs sent from other threads start t1 asynchronously, so every
+ * connection is revisited at least once per wheel revolution.
+ */
+static void
+EpollWorker_schedule(EpollWorker self, MasterConnection con)
+{
+    EpollWorker_unschedule(self, con);
+
+    uint64_t tick = MasterConnection_nextTimeout(con) / EPOLL_WHEEL_RESOLUTION_MS;
+
+    if (tick < self->wheelTick)
+        tick = self->wheelTick;
+    else if (tick > self->wheelTick + EPOLL_WHEEL_SLOTS - 1)
+        tick = self->wheelTick + EPOLL_WHEEL_SLOTS - 1;
+
+    int slot = (int) (tick % EPOLL_WHEEL_SLOTS);
+
+    con->wheelSlot = slot;
+    con->wheelPrev = NULL;
+    con->wheelNext = self->wheel[slot];
+
+    if (con->wheelNext)
+        con->wheelNext->wheelPrev = con;
+
+    self->wheel[slot] = con;
+}
+
+/* epoll_wait timeout in ms until the next occupied wheel slot (-1 = no timeout) */
+static int
+EpollWorker_getTimeout(EpollWorker self, uint64_t currentTime)
+{
+    int i;
+
+    for (i = 0; i < EPOLL_WHEEL_SLOTS; i++) {
+        uint64_t tick = self->wheelTick + i;
+
+        if (self->wheel[tick % EPOLL_WHEEL_SLOTS]) {
+            uint64_t slotTime = tick * EPOLL_WHEEL_RESOLUTION_MS;
+
+            if (slotTime <= currentTime)
+                return 0;
+
+            return (int) (slotTime - currentTime);
+        }
+    }
+
+    return -1;
+}
+
+static void
+EpollWorker_runPeriodicTasks(EpollWorker self, MasterConnection con)
+{
+    CS104_Slave slave = self->slave;
+
+    MasterConnection_executePeriodicTasks(con);
+
+    /* call plugins */
+    if (slave->plugins) {
+
+        LinkedList pluginElem = LinkedList_getNext(slave->plugins);
+
+        while (pluginElem) {
+
+            CS101_SlavePlugin plugin = (CS101_SlavePlugin) LinkedList_getData(pluginElem);
+
+            plugin->runTask(plugin->parameter, &(con->iMasterConnection));
+
+            pluginElem = LinkedList_getNext(pluginElem);
+        }
+    }
+}
+
+static void
+EpollWorker_advanceWheel(EpollWorker self, uint64_t currentTime)
+{
+    uint64_t currentTick = currentTime / EPOLL_WHEEL_RESOLUTION_MS;
+
+    /* after a long stall (or system time jump) one revolution covers all slots */
+    if (currentTick > self->wheelTick + EPOLL_WHEEL_SLOTS)
+        self->wheelTick = currentTick - EPOLL_WHEEL_SLOTS;
+
+    while (self->wheelTick <= currentTick) {
+
+        int slot = (int) (self->wheelTick % EPOLL_WHEEL_SLOTS);
+
+        MasterConnection con = self->wheel[slot];
+
+        self->wheel[slot] = NULL;
+        self->wheelTick++;
+
+        while (con) {
+            MasterConnection next = con->wheelNext;
+
+            con->wheelNext = NULL;
+            con->wheelPrev = NULL;
+            con->wheelSlot = -1;
+
+            if (MasterConnection_isRunning(con)) {
+                EpollWorker_runPeriodicTasks(self, con);
+
+                if (MasterConnection_isRunning(con))
+                    EpollWorker_schedule(self, con);
+            }
+
+            con = next;
+        }
+    }
+}
+
+static void
+EpollWorker_adoptPendingConnections(EpollWorker self)
+{
+    MasterConnection adopted[CONFIG_CS104_MAX_CLIENT_CONNECTIONS];
+    int adoptedCount;
+
+    Semaphore_wait(self->lock);
+
+    adoptedCount = self->pendingCount;
+    memcpy(adopted, self->pending, adoptedCount * sizeof(MasterConnection));
+    self->pendingCount = 0;
+
+    Semaphore_post(self->lock);
+
+    int i;
+
+    for (i = 0; i < adoptedCount; i++) {
+        MasterConnection con = adopted[i];
+
+        self->connections[self->connectionCount++] = con;
+
+        resetT3Timeout(con, Hal_getTimeInMs());
+
+        if (self->slave->connectionEventHandler) {
+            self->slave->connectionEventHandler(self->slave->connectionEventHandlerParameter, &(con->iMasterConnection), CS104_CON_EVENT_CONNECTION_OPENED);
+        }
+
+        struct epoll_event event;
+
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = con;
+
+        if (epoll_ctl(self->epollFd, EPOLL_CTL_ADD, Socket_getFd(con->socket), &event) == -1) {
+            DEBUG_PRINT("CS104 SLAVE: epoll_ctl failed (errno=%i) -> close connection\n", errno);
+
+            MasterConnection_close(con);
+        }
+        else {
+            EpollWorker_schedule(self, con);
+        }
+    }
+}
+
+static void
+EpollWorker_handleReadable(EpollWorker self, MasterConnection con)
+{
+    /* level triggered: data left in the socket is reported again by the next epoll_wait */
+    if (MasterConnection_isRunning(con))
+        MasterConnection_handleTcpConnection(con);
+
+    if (MasterConnection_isRunning(con)) {
+        /* received confirmations can open the send window */
+        if (MasterConnection_isActive(con))
+            sendWaitingASDUs(con);
+
+        EpollWorker_schedule(self, con);
+    }
+}
+
+/* hand closed connections back to the listening thread for cleanup */
+static void
+EpollWorker_releaseClosedConnections(EpollWorker self, bool releaseAll)
+{
+    int i = 0;
+
+    while (i < self->connectionCount) {
+
+        MasterConnection con = self->connections[i];
+
+        if (releaseAll || (MasterConnection_isRunning(con) == false)) {
+
+            epoll_ctl(self->epollFd, EPOLL_CTL_DEL, Socket_getFd(con->socket), NULL);
+
+            EpollWorker_unschedule(self, con);
+
+            self->connections[i] = self->connections[--self->connectionCount];
+
+            if (self->slave->connectionEventHandler) {
+                self->slave->connectionEventHandler(self->slave->connectionEventHandlerParameter, &(con->iMasterConnection), CS104_CON_EVENT_CONNECTION_CLOSED);
+            }
+
+            DEBUG_PRINT("CS104 SLAVE: Connection closed\n");
+
+            MessageQueue_setWaitingForTransmissionWhenNotConfirmed(con->lowPrioQueue);
+
+            Semaphore_wait(self->lock);
+            self->load--;
+            Semaphore_post(self->lock);
+
+            Semaphore_wait(con->stateLock);
+            con->isRunning = false;
+            con->epollWorker = NULL;
+            Semaphore_post(con->stateLock);
+        }
+        else
+            i++;
+    }
+}
+
+static void*
+epollWorkerThread(void* parameter)
+{
+    EpollWorker self = (EpollWorker) parameter;
+
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+
+    self->wheelTick = Hal_getTimeInMs() / EPOLL_WHEEL_RESOLUTION_MS;
+
+    while (EpollWorker_isStopped(self) == false) {
+
+        int timeout = EpollWorker_getTimeout(self, Hal_getTimeInMs());
+
+        int eventCount = epoll_wait(self->epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+        if (eventCount == -1) {
+            if (errno != EINTR) {
+                DEBUG_PRINT("CS104 SLAVE: epoll_wait failed (errno=%i)\n", errno);
+                Thread_sleep(10);
+            }
+
+            eventCount = 0;
+        }
+
+        bool wakeup = false;
+
+        int i;
+
+        for (i = 0; i < eventCount; i++) {
+
+            MasterConnection con = (MasterConnection) events[i].data.ptr;
+
+            if (con == NULL) {
+                uint64_t value;
+
+                if (read(self->wakeupFd, &value, sizeof(value)) < 0) {
+                    DEBUG_PRINT("CS104 SLAVE: failed to read epoll worker wakeup (errno=%i)\n", errno);
+                }
+
+                wakeup = true;
+            }
+            else {
+                EpollWorker_handleReadable(self, con);
+            }
+        }
+
+        if (wakeup) {
+            EpollWorker_adoptPendingConnections(self);
+
+            /* new events in the low priority queues */
+            for (i = 0; i < self->connectionCount; i++) {
+                MasterConnection con = self->connections[i];
+
+                if (MasterConnection_isRunning(con) && MasterConnection_isActive(con))
+                    sendWaitingASDUs(con);
+            }
+        }
+
+        EpollWorker_advanceWheel(self, Hal_getTimeInMs());
+
+        EpollWorker_releaseClosedConnections(self, false);
+    }
+
+    /* connections handed over but not yet adopted */
+    EpollWorker_adoptPendingConnections(self);
+
+    EpollWorker_releaseClosedConnections(self, true);
+
+    return NULL;
+}
+
+static void
+stopEpollWorkers(CS104_Slave self)
+{
+    if (self->epollWorkers == NULL)
+        return;
+
+    int i;
+
+    for (i = 0; i < self->epollWorkerCount; i++) {
+        EpollWorker worker = &(self->epollWorkers[i]);
+
+        if (worker->thread) {
+            Semaphore_wait(worker->lock);
+            worker->stop = true;
+            Semaphore_post(worker->lock);
+
+            EpollWorker_wakeup(worker);
+
+            Thread_destroy(worker->thread);
+        }
+
+        if (worker->epollFd != -1)
+            close(worker->epollFd);
+
+        if (worker->wakeupFd != -1)
+            close(worker->wakeupFd);
+
+        if (worker->lock)
+            Semaphore_destroy(worker->lock);
+    }
+
+    GLOBAL_FREEMEM(self->epollWorkers);
+    self->epollWorkers = NULL;
+}
+
+static bool
+startEpollWorkers(CS104_Slave self)
+{
+#if (CONFIG_CS104_SUPPORT_TLS == 1)
+    if (self->tlsConfig != NULL) {
+        DEBUG_PRINT("CS104 SLAVE: epoll workers not supported with TLS -> use thread per connection\n");
+        return false;
+    }
+#endif
+
+    self->epollWorkers = (EpollWorker) GLOBAL_CALLOC(self->epollWorkerCount, sizeof(struct sEpollWorker));
+
+    if (self->epollWorkers == NULL)
+        return false;
+
+    int i;
+
+    for (i = 0; i < self->epollWorkerCount; i++) {
+        EpollWorker worker = &(self->epollWorkers[i]);
+
+        worker->slave = self;
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        worker->lock = Semaphore_create(1);
+
+        if ((worker->epollFd == -1) || (worker->wakeupFd == -1))
+            goto exit_error;
+
+        struct epoll_event event;
+
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+
+        if (epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeupFd, &event) == -1)
+            goto exit_error;
+    }
+
+    for (i = 0; i < self->epollWorkerCount; i++) {
+        EpollWorker worker = &(self->epollWorkers[i]);
+
+        worker->thread = Thread_create(epollWorkerThread, (void*) worker, false);
+
+        if (worker->thread == NULL)
+            goto exit_error;
+
+        Thread_start(worker->thread);
+    }
+
+    return true;
+
+exit_error:
+    DEBUG_PRINT("CS104 SLAVE: Failed to start epoll workers (errno=%i) -> use thread per connection\n", errno);
+
+    stopEpollWorkers(self);
+
+    return false;
+}
+
+/* called by the listening thread for a new connection */
+static void
+handOverToEpollWorker(CS104_Slave self, MasterConnection connection)
+{
+    EpollWorker worker = NULL;
+    int minLoad = 0;
+
+    int i;
+
+    for (i = 0; i < self->epollWorkerCount; i++) {
+        EpollWorker candidate = &(self->epollWorkers[i]);
+
+        Semaphore_wait(candidate->lock);
+        int load = candidate->load;
+        Semaphore_post(candidate->lock);
+
+        if ((worker == NULL) || (load < minLoad)) {
+            worker = candidate;
+            minLoad = load;
+        }
+    }
+
+    Semaphore_wait(connection->stateLock);
+    connection->isRunning = true;
+    connection->epollWorker = worker;
+    Semaphore_post(connection->stateLock);
+
+    Semaphore_wait(worker->lock);
+    worker->pending[worker->pendingCount++] = connection;
+    worker->load++;
+    Semaphore_post(worker->lock);
+
+    EpollWorker_wakeup(worker);
+}
+
+/* wait until the listening socket has a pending connection or the timeout expired */
+static void
+waitForIncomingConnection(CS104_Slave self, int timeoutInMs)
+{
+    struct pollfd fds;
+
+    fds.fd = ServerSocket_getFd(self->serverSocket);
+    fds.events = POLLIN;
+    fds.revents = 0;
+
+    if (poll(&fds, 1, timeoutInMs) < 0)
+        Thread_sleep(10);
+}
+
+static bool
+isOwnedByEpollWorker(MasterConnection self)
+{
+    bool isOwned;
+
+    Semaphore_wait(self->stateLock);
+    isOwned = (self->epollWorker != NULL);
+    Semaphore_post(self->stateLock);
+
+    return isOwned;
+}
+
+#endif /* (CONFIG_CS104_SLAVE_EPOLL == 1) */
+
 static char*
 getPeerAddress(Socket socket, char* ipAddress)
 {
@@ -3686,6 +4382,11 @@ serverThread (void* parameter)
 #endif
 
                 if (connection) {
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+                    if (self->epollWorkers)
+                        handOverToEpollWorker(self, connection);
+                    else
+#endif
                     /* now start the connection handling (thread) */
                     MasterConnection_start(connection);
                 }
@@ -3700,8 +4401,14 @@ serverThread (void* parameter)
                 Socket_destroy(newSocket);
             }
         }
-        else
+        else {
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+            if (self->epollWorkers)
+                waitForIncomingConnection(self, 100);
+            else
+#endif
             Thread_sleep(10);
+        }
 
         /* check if there are connections to close */
 #if (CONFIG_USE_SEMAPHORES == 1)
@@ -3726,6 +4433,12 @@ serverThread (void* parameter)
                 Semaphore_post(connection->stateLock);
 #endif /* (CONFIG_USE_SEMAPHORES == 1) */
 
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+                /* the worker hands the connection back after it has been closed */
+                if (isConnectionUsed && isOwnedByEpollWorker(connection))
+                    continue;
+#endif
+
                 if (isConnectionUsed) {
 
                     if (MasterConnection_isRunning(connection) == false) {
@@ -3845,6 +4558,11 @@ CS104_Slave_enqueueASDU(CS104_Slave self, CS101_ASDU asdu)
 #endif
     }
 #endif /* (CONFIG_CS104_SUPPORT_SERVER_MODE_SINGLE_REDUNDANCY_GROUP == 1) */
+
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+    /* workers only wake up for socket events and timeouts */
+    wakeupEpollWorkers(self);
+#endif
 }
 
 void
@@ -3917,6 +4635,11 @@ CS104_Slave_start(CS104_Slave self)
             initializeConnectionSpecificQueues(self);
 #endif
 
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+        if (self->epollWorkerCount > 0)
+            startEpollWorkers(self);
+#endif
+
         self->listeningThread = Thread_create(serverThread, (void*) self, false);
 
         Thread_start(self->listeningThread);
@@ -4076,6 +4799,11 @@ CS104_Slave_stop(CS104_Slave self)
             Thread_destroy(self->listeningThread);
         }
 
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+        /* workers close their connections and hand them back */
+        stopEpollWorkers(self);
+#endif
+
         /*
          * Stop all connections
          * */
@@ -4112,6 +4840,11 @@ CS104_Slave_stop(CS104_Slave self)
 
                             connection->connectionThread = NULL;
                         }
+#if (CONFIG_CS104_SLAVE_EPOLL == 1)
+                        else if (self->epollWorkerCount > 0) {
+                            MasterConnection_deinit(connection);
+                        }
+#endif
 #endif
 
                         self->openConnections--;
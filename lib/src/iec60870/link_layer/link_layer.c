@@ -1359,6 +1359,57 @@ LinkLayerBalanced_run(LinkLayerBalanced self)
     LinkLayerPrimaryBalanced_runStateMachine(&(self->primaryLinkLayer));
 }
 
+void
+LinkLayerBalanced_runNonBlocking(LinkLayerBalanced self)
+{
+    LinkLayer ll = self->linkLayer;
+
+    SerialTransceiverFT12_readAvailableMessages(ll->transceiver, ll->buffer, HandleMessageBalancedAndPrimaryUnbalanced, (void*) ll);
+
+    LinkLayerPrimaryBalanced_runStateMachine(&(self->primaryLinkLayer));
+}
+
+/* the state machines check timeouts with ">", so every deadline is one ms after the stored time */
+uint64_t
+LinkLayerBalanced_getNextTimeout(LinkLayerBalanced self, bool userDataPending)
+{
+    LinkLayerPrimaryBalanced pll = &(self->primaryLinkLayer);
+    uint64_t currentTime = Hal_getTimeInMs();
+    uint64_t ackTimeout = pll->lastSendTime + pll->linkLayer->linkLayerParameters->timeoutForAck + 1;
+    uint64_t nextTimeout = SerialTransceiverFT12_getNextTimeout(self->linkLayer->transceiver);
+    uint64_t stateTimeout;
+
+    switch (pll->primaryState) {
+
+    case PLL_IDLE:
+        stateTimeout = currentTime;
+        break;
+
+    case PLL_EXECUTE_REQUEST_STATUS_OF_LINK:
+    case PLL_EXECUTE_RESET_REMOTE_LINK:
+        stateTimeout = pll->waitingForResponse ? ackTimeout : currentTime;
+        break;
+
+    case PLL_LINK_LAYERS_AVAILABLE:
+        if (pll->sendLinkLayerTestFunction || userDataPending)
+            stateTimeout = currentTime;
+        else
+            stateTimeout = pll->lastReceivedMsg + (uint64_t) pll->idleTimeout + 1;
+        break;
+
+    case PLL_EXECUTE_SERVICE_SEND_CONFIRM:
+        stateTimeout = ackTimeout;
+        break;
+
+    default:
+        /* PLL_SECONDARY_LINK_LAYER_BUSY: waits for a message from the other station */
+        stateTimeout = UINT64_MAX;
+        break;
+    }
+
+    return (stateTimeout < nextTimeout) ? stateTimeout : nextTimeout;
+}
+
 /******************************************************
  * Unbalanced primary link layer
  *
@@ -1390,6 +1441,13 @@ struct sLinkLayerPrimaryUnbalanced {
 
     IEC60870_LinkLayerStateChangedHandler stateChangedHandler;
     void* stateChangedHandlerParameter;
+
+    IEC60870_ChannelReadyHandler channelReadyHandler;
+    void* channelReadyHandlerParameter;
+
+    bool autoPolling; /* slaves are polled by the scheduler (weighted round-robin) */
+    int minBackoff; /* first back-off interval for a slave that does not respond (ms) */
+    int maxBackoff; /* upper limit of the back-off interval (ms) */
 };
 
 LinkLayerPrimaryUnbalanced
@@ -1419,6 +1477,12 @@ LinkLayerPrimaryUnbalanced_create(SerialTransceiverFT12 transceiver, LinkLayerPa
         self->slaveConnections = LinkedList_create();
 
         self->stateChangedHandler = NULL;
+
+        self->channelReadyHandler = NULL;
+
+        self->autoPolling = false;
+        self->minBackoff = 1000;
+        self->maxBackoff = 60000;
     }
 
     return self;
@@ -1432,6 +1496,14 @@ LinkLayerPrimaryUnbalanced_setStateChangeHandler(LinkLayerPrimaryUnbalanced self
     self->stateChangedHandlerParameter = parameter;
 }
 
+void
+LinkLayerPrimaryUnbalanced_setChannelReadyHandler(LinkLayerPrimaryUnbalanced self,
+        IEC60870_ChannelReadyHandler handler, void* parameter)
+{
+    self->channelReadyHandler = handler;
+    self->channelReadyHandlerParameter = parameter;
+}
+
 void
 LinkLayerPrimaryUnbalanced_destroy(LinkLayerPrimaryUnbalanced self)
 {
@@ -1469,6 +1541,22 @@ struct sLinkLayerSlaveConnection {
     bool sendLinkLayerTestFunction;
 
     bool nextFcb;
+
+    /* polling scheduler */
+    int priority; /* weight in the weighted round-robin */
+    int currentWeight; /* smooth weighted round-robin state */
+    int consecutiveFailures;
+    uint64_t nextPollTime; /* back-off: the slave is not scheduled before this time */
+
+    /* polling statistics */
+    uint32_t class1Requests;
+    uint32_t class2Requests;
+    uint32_t timeouts;
+    uint64_t lastClass2RequestTime;
+    uint32_t lastScanCycle;
+    uint32_t maxScanCycle;
+    uint64_t scanCycleSum;
+    uint32_t scanCycleCount;
 };
 
 static LinkLayerSlaveConnection
@@ -1497,6 +1585,20 @@ LinkLayerSlaveConnection_create(LinkLayerSlaveConnection self, LinkLayerPrimaryU
         self->requestClass1Data = false;
         self->requestClass2Data = false;
 
+        self->priority = 1;
+        self->currentWeight = 0;
+        self->consecutiveFailures = 0;
+        self->nextPollTime = 0;
+
+        self->class1Requests = 0;
+        self->class2Requests = 0;
+        self->timeouts = 0;
+        self->lastClass2RequestTime = 0;
+        self->lastScanCycle = 0;
+        self->maxScanCycle = 0;
+        self->scanCycleSum = 0;
+        self->scanCycleCount = 0;
+
         BufferFrame_initialize(&(self->nextMessage), self->buffer, 0);
     }
 
@@ -1515,6 +1617,56 @@ llsc_setState(LinkLayerSlaveConnection self, LinkLayerState newState)
     }
 }
 
+/* the slave did not respond: count the timeout and back off exponentially when the scheduler is active */
+static void
+llsc_handleTimeout(LinkLayerSlaveConnection self, uint64_t currentTime)
+{
+    LinkLayerPrimaryUnbalanced primaryLink = self->primaryLink;
+
+    self->timeouts++;
+    self->consecutiveFailures++;
+
+    if (primaryLink->autoPolling) {
+        uint64_t backoff = (uint64_t) primaryLink->minBackoff;
+        int i;
+
+        for (i = 1; (i < self->consecutiveFailures) && (backoff < (uint64_t) primaryLink->maxBackoff); i++)
+            backoff = backoff * 2;
+
+        if (backoff > (uint64_t) primaryLink->maxBackoff)
+            backoff = (uint64_t) primaryLink->maxBackoff;
+
+        self->nextPollTime = currentTime + backoff;
+
+        DEBUG_PRINT ("[SLAVE %i] PLL - back-off %i ms after %i failures\n", self->address, (int) backoff, self->consecutiveFailures);
+    }
+}
+
+static void
+llsc_countRequest(LinkLayerSlaveConnection self, bool class1, uint64_t currentTime)
+{
+    if (class1) {
+        self->class1Requests++;
+        return;
+    }
+
+    self->class2Requests++;
+
+    if (self->lastClass2RequestTime != 0 && currentTime >= self->lastClass2RequestTime) {
+        uint32_t scanCycle = (uint32_t) (currentTime - self->lastClass2RequestTime);
+
+        self->lastScanCycle = scanCycle;
+
+        if (scanCycle > self->maxScanCycle)
+            self->maxScanCycle = scanCycle;
+
+        self->scanCycleSum += scanCycle;
+        self->scanCycleCount++;
+    }
+
+    self->lastClass2RequestTime = currentTime;
+}
+
 static void
 LinkLayerSlaveConnection_HandleMessage(LinkLayerSlaveConnection self, uint8_t fc, bool acd, bool dfc, int address, uint8_t* msg, int userDataStart, int userDataLength)
 {
@@ -1523,6 +1675,10 @@ LinkLayerSlaveConnection_HandleMessage(LinkLayerSlaveConnection self, uint8_t fc
     PrimaryLinkLayerState primaryState = self->primaryState;
     PrimaryLinkLayerState newState = primaryState;
 
+    /* any response ends the back-off of the slave */
+    self->consecutiveFailures = 0;
+    self->nextPollTime = 0;
+
     if (dfc) {
 
         DEBUG_PRINT ("[SLAVE %i] PLL - DFC = true!\n", self->address);
@@ -1718,6 +1874,18 @@ llsc_isMessageWaitingToSend(LinkLayerSlaveConnection self)
         return false;
 }
 
+/* report that the channel became free again (message confirmed, data request answered or given up) */
+static void
+llsc_notifyChannelReady(LinkLayerSlaveConnection self, bool wasWaiting)
+{
+    LinkLayerPrimaryUnbalanced primaryLink = self->primaryLink;
+
+    if (wasWaiting && (llsc_isMessageWaitingToSend(self) == false)) {
+        if (primaryLink->channelReadyHandler)
+            primaryLink->channelReadyHandler(primaryLink->channelReadyHandlerParameter, self->address);
+    }
+}
+
 static void
 LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
 {
@@ -1769,6 +1937,8 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 self->waitingForResponse = false;
                 self->lastSendTime = currentTime;
                 newState = PLL_TIMEOUT;
+
+                llsc_handleTimeout(self, currentTime);
             }
 
         }
@@ -1799,6 +1969,7 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 self->lastSendTime = currentTime;
                 newState = PLL_TIMEOUT;
 
+                llsc_handleTimeout(self, currentTime);
                 llsc_setState(self, LL_STATE_ERROR);
             }
         }
@@ -1845,6 +2016,7 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 SendFixedFrame(self->primaryLink->linkLayer, LL_FC_10_REQUEST_USER_DATA_CLASS_1, self->address, true, false, self->nextFcb, true);
 
                 self->requestClass1Data = false;
+                llsc_countRequest(self, true, currentTime);
             }
             else {
                 DEBUG_PRINT ("[SLAVE %i] PLL - SEND FC 11 - REQ UD 2\n", self->address);
@@ -1852,6 +2024,7 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 SendFixedFrame(self->primaryLink->linkLayer, LL_FC_11_REQUEST_USER_DATA_CLASS_2, self->address, true, false, self->nextFcb, true);
 
                 self->requestClass2Data = false;
+                llsc_countRequest(self, false, currentTime);
             }
 
             self->nextFcb = !(self->nextFcb);
@@ -1879,6 +2052,7 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 self->lastSendTime = currentTime;
                 newState = PLL_TIMEOUT;
 
+                llsc_handleTimeout(self, currentTime);
                 llsc_setState(self, LL_STATE_ERROR);
             }
             else {
@@ -1921,7 +2095,9 @@ LinkLayerSlaveConnection_runStateMachine(LinkLayerSlaveConnection self)
                 newState = PLL_IDLE;
                 self->requestClass1Data = false;
                 self->requestClass2Data = false;
+                self->waitingForResponse = false;
 
+                llsc_handleTimeout(self, currentTime);
                 llsc_setState(self, LL_STATE_ERROR);
             }
             else {
@@ -2114,13 +2290,133 @@ LinkLayerPrimaryUnbalanced_handleMessage(LinkLayerPrimaryUnbalanced self, uint8_
         slave = LinkLayerPrimaryUnbalanced_getSlaveConnection(self, address);
 
     if (slave) {
+        bool wasWaiting = llsc_isMessageWaitingToSend(slave);
+
         LinkLayerSlaveConnection_HandleMessage(slave, fc, acd, dfc, address, msg, userDataStart, userDataLength);
+
+        llsc_notifyChannelReady(slave, wasWaiting);
     }
     else {
         DEBUG_PRINT ("PLL RECV - response from unknown slave %i\n", address);
     }
 }
 
+/*
+ * Select the next slave when the scheduler is active:
+ * 1. slaves with pending class 1 data (ACD set in the last response) are polled immediately
+ * 2. then slaves with an application layer message or test function to send
+ * 3. otherwise smooth weighted round-robin over all slaves by priority, the winner is polled for class 2 data
+ * Slaves that did not respond are skipped until their back-off interval has elapsed.
+ */
+static LinkLayerSlaveConnection
+LinkLayerPrimaryUnbalanced_scheduleNextSlave(LinkLayerPrimaryUnbalanced self)
+{
+    uint64_t currentTime = Hal_getTimeInMs();
+
+    LinkLayerSlaveConnection pendingMessage = NULL;
+    LinkLayerSlaveConnection best = NULL;
+    int totalWeight = 0;
+
+    LinkedList element = LinkedList_getNext(self->slaveConnections);
+
+    while (element) {
+        LinkLayerSlaveConnection slave = (LinkLayerSlaveConnection) LinkedList_getData(element);
+
+        element = LinkedList_getNext(element);
+
+        if (slave->nextPollTime > currentTime)
+            continue;
+
+        if (slave->requestClass1Data)
+            return slave;
+
+        if ((pendingMessage == NULL) && (slave->hasMessageToSend || slave->sendLinkLayerTestFunction))
+            pendingMessage = slave;
+    }
+
+    if (pendingMessage)
+        return pendingMessage;
+
+    element = LinkedList_getNext(self->slaveConnections);
+
+    while (element) {
+        LinkLayerSlaveConnection slave = (LinkLayerSlaveConnection) LinkedList_getData(element);
+
+        element = LinkedList_getNext(element);
+
+        if (slave->nextPollTime > currentTime)
+            continue;
+
+        slave->currentWeight += slave->priority;
+        totalWeight += slave->priority;
+
+        if ((best == NULL) || (slave->currentWeight > best->currentWeight))
+            best = slave;
+    }
+
+    if (best) {
+        best->currentWeight -= totalWeight;
+
+        if ((best->primaryState == PLL_LINK_LAYERS_AVAILABLE) && (llsc_isMessageWaitingToSend(best) == false))
+            best->requestClass2Data = true;
+    }
+
+    return best;
+}
+
+void
+LinkLayerPrimaryUnbalanced_setAutoPolling(LinkLayerPrimaryUnbalanced self, bool enable, int minBackoff, int maxBackoff)
+{
+    self->autoPolling = enable;
+
+    if (minBackoff > 0)
+        self->minBackoff = minBackoff;
+
+    if (maxBackoff > 0)
+        self->maxBackoff = maxBackoff;
+
+    if (self->maxBackoff < self->minBackoff)
+        self->maxBackoff = self->minBackoff;
+}
+
+bool
+LinkLayerPrimaryUnbalanced_setSlavePriority(LinkLayerPrimaryUnbalanced self, int slaveAddress, int priority)
+{
+    LinkLayerSlaveConnection slave = LinkLayerPrimaryUnbalanced_getSlaveConnection(self, slaveAddress);
+
+    if (slave && (priority > 0)) {
+        slave->priority = priority;
+        slave->currentWeight = 0;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+LinkLayerPrimaryUnbalanced_getPollingStatistics(LinkLayerPrimaryUnbalanced self, int slaveAddress, LinkLayerPollingStatistics stats)
+{
+    LinkLayerSlaveConnection slave = LinkLayerPrimaryUnbalanced_getSlaveConnection(self, slaveAddress);
+
+    if (slave) {
+        uint64_t currentTime = Hal_getTimeInMs();
+
+        stats->priority = slave->priority;
+        stats->class1Requests = slave->class1Requests;
+        stats->class2Requests = slave->class2Requests;
+        stats->timeouts = slave->timeouts;
+        stats->consecutiveFailures = slave->consecutiveFailures;
+        stats->backoff = (slave->nextPollTime > currentTime) ? (uint32_t) (slave->nextPollTime - currentTime) : 0;
+        stats->lastScanCycle = slave->lastScanCycle;
+        stats->avgScanCycle = (slave->scanCycleCount > 0) ? (uint32_t) (slave->scanCycleSum / slave->scanCycleCount) : 0;
+        stats->maxScanCycle = slave->maxScanCycle;
+
+        return true;
+    }
+
+    return false;
+}
+
 void
 LinkLayerPrimaryUnbalanced_runStateMachine(LinkLayerPrimaryUnbalanced self)
 {
@@ -2142,13 +2438,91 @@ LinkLayerPrimaryUnbalanced_runStateMachine(LinkLayerPrimaryUnbalanced self)
 
         if (self->currentSlave == NULL) {
             /* schedule next slave connection */
-            self->currentSlave = (LinkLayerSlaveConnection) LinkedList_getData(LinkedList_get(self->slaveConnections, self->currentSlaveIndex));
-            self->currentSlaveIndex = (self->currentSlaveIndex + 1) % LinkedList_size(self->slaveConnections);
+            if (self->autoPolling) {
+                self->currentSlave = LinkLayerPrimaryUnbalanced_scheduleNextSlave(self);
+            }
+            else {
+                self->currentSlave = (LinkLayerSlaveConnection) LinkedList_getData(LinkedList_get(self->slaveConnections, self->currentSlaveIndex));
+                self->currentSlaveIndex = (self->currentSlaveIndex + 1) % LinkedList_size(self->slaveConnections);
+            }
         }
 
-        if (self->currentSlave)
+        if (self->currentSlave) {
+            bool wasWaiting = llsc_isMessageWaitingToSend(self->currentSlave);
+
             LinkLayerSlaveConnection_runStateMachine(self->currentSlave);
+
+            llsc_notifyChannelReady(self->currentSlave, wasWaiting);
+        }
+    }
+}
+
+static uint64_t
+llsc_getNextTimeout(LinkLayerSlaveConnection self, uint64_t currentTime)
+{
+    LinkLayerParameters parameters = self->primaryLink->linkLayer->linkLayerParameters;
+
+    /* the scheduler skips a slave in back-off */
+    if (self->primaryLink->autoPolling && (self->nextPollTime > currentTime))
+        return self->nextPollTime;
+
+    switch (self->primaryState) {
+
+    case PLL_TIMEOUT:
+        return self->lastSendTime + parameters->timeoutLinkState + 1;
+
+    case PLL_IDLE:
+        return currentTime;
+
+    case PLL_EXECUTE_REQUEST_STATUS_OF_LINK:
+    case PLL_EXECUTE_RESET_REMOTE_LINK:
+        return self->waitingForResponse ? self->lastSendTime + parameters->timeoutForAck + 1 : currentTime;
+
+    case PLL_EXECUTE_SERVICE_SEND_CONFIRM:
+    case PLL_EXECUTE_SERVICE_REQUEST_RESPOND:
+        return self->lastSendTime + parameters->timeoutForAck + 1;
+
+    case PLL_LINK_LAYERS_AVAILABLE:
+        /* with auto polling an available slave is asked for class 2 data right away */
+        if (self->primaryLink->autoPolling || self->sendLinkLayerTestFunction || llsc_isMessageWaitingToSend(self))
+            return currentTime;
+        return UINT64_MAX;
+
+    default:
+        return UINT64_MAX;
+    }
+}
+
+uint64_t
+LinkLayerPrimaryUnbalanced_getNextTimeout(LinkLayerPrimaryUnbalanced self)
+{
+    uint64_t currentTime = Hal_getTimeInMs();
+    uint64_t nextTimeout = SerialTransceiverFT12_getNextTimeout(self->linkLayer->transceiver);
+
+    if (self->hasNextBroadcastToSend)
+        return currentTime;
+
+    /* only the current slave runs while it waits for the response */
+    if (self->currentSlave && self->currentSlave->waitingForResponse) {
+        uint64_t ackTimeout = llsc_getNextTimeout(self->currentSlave, currentTime);
+
+        return (ackTimeout < nextTimeout) ? ackTimeout : nextTimeout;
+    }
+
+    LinkedList element = LinkedList_getNext(self->slaveConnections);
+
+    while (element) {
+        LinkLayerSlaveConnection slave = (LinkLayerSlaveConnection) LinkedList_getData(element);
+
+        element = LinkedList_getNext(element);
+
+        uint64_t slaveTimeout = llsc_getNextTimeout(slave, currentTime);
+
+        if (slaveTimeout < nextTimeout)
+            nextTimeout = slaveTimeout;
     }
+
+    return nextTimeout;
 }
 
 void
@@ -2160,3 +2534,13 @@ LinkLayerPrimaryUnbalanced_run(LinkLayerPrimaryUnbalanced self)
 
     LinkLayerPrimaryUnbalanced_runStateMachine(self);
 }
+
+void
+LinkLayerPrimaryUnbalanced_runNonBlocking(LinkLayerPrimaryUnbalanced self)
+{
+    LinkLayer ll = self->linkLayer;
+
+    SerialTransceiverFT12_readAvailableMessages(ll->transceiver, ll->buffer, HandleMessageBalancedAndPrimaryUnbalanced, (void*) ll);
+
+    LinkLayerPrimaryUnbalanced_runStateMachine(self);
+}
@@ -22,12 +22,18 @@
  */
 
 #include "hal_serial.h"
+#include "hal_time.h"
 #include "serial_transceiver_ft_1_2.h"
 #include "lib_memory.h"
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include "lib60870_internal.h"
 
+#ifndef CONFIG_FT12_RX_BUFFER_SIZE
+#define CONFIG_FT12_RX_BUFFER_SIZE 512
+#endif
+
 struct sSerialTransceiverFT12 {
     int messageTimeout;
     int characterTimeout;
@@ -35,6 +41,13 @@ struct sSerialTransceiverFT12 {
     SerialPort serialPort;
     IEC60870_RawMessageHandler rawMessageHandler;
     void* rawMessageHandlerParameter;
+
+    /* received bytes not yet parsed (filled with bulk reads) */
+    uint8_t rxBuffer[CONFIG_FT12_RX_BUFFER_SIZE];
+    int rxStart;
+    int rxEnd;
+
+    uint64_t partialFrameTime; /* first reception of an incomplete frame (non-blocking mode), 0 if none */
 };
 
 SerialTransceiverFT12
@@ -48,6 +61,9 @@ SerialTransceiverFT12_create(SerialPort serialPort, LinkLayerParameters linkLaye
         self->linkLayerParameters = linkLayerParameters;
         self->serialPort = serialPort;
         self->rawMessageHandler = NULL;
+        self->rxStart = 0;
+        self->rxEnd = 0;
+        self->partialFrameTime = 0;
     }
 
     return self;
@@ -89,19 +105,59 @@ SerialTransceiverFT12_sendMessage(SerialTransceiverFT12 self, uint8_t* msg, int
     SerialPort_write(self->serialPort, msg, 0, msgSize);
 }
 
+/* read all bytes available at the serial port with one call (waits up to the current timeout) */
+static bool
+fillBuffer(SerialTransceiverFT12 self)
+{
+    if (self->rxStart == self->rxEnd) {
+        self->rxStart = 0;
+        self->rxEnd = 0;
+    }
+
+    int readBytes = SerialPort_readBytes(self->serialPort, self->rxBuffer + self->rxEnd, CONFIG_FT12_RX_BUFFER_SIZE - self->rxEnd);
+
+    if (readBytes < 1)
+        return false;
+
+    self->rxEnd += readBytes;
+
+    return true;
+}
+
+static int
+readByte(SerialTransceiverFT12 self)
+{
+    if (self->rxStart == self->rxEnd) {
+        if (fillBuffer(self) == false)
+            return -1;
+    }
+
+    return (int) self->rxBuffer[self->rxStart++];
+}
+
 static int
 readBytesWithTimeout(SerialTransceiverFT12 self, uint8_t* buffer, int startIndex, int count)
 {
-    int readByte;
     int readBytes = 0;
 
-    while ((readByte = SerialPort_readByte(self->serialPort)) != -1) {
-        buffer[startIndex++] = (uint8_t) readByte;
+    while (readBytes < count) {
 
-        readBytes++;
+        int available = self->rxEnd - self->rxStart;
 
-        if (readBytes >= count)
-            break;
+        if (available == 0) {
+            if (fillBuffer(self) == false)
+                break;
+
+            available = self->rxEnd - self->rxStart;
+        }
+
+        if (available > (count - readBytes))
+            available = count - readBytes;
+
+        memcpy(buffer + startIndex + readBytes, self->rxBuffer + self->rxStart, available);
+
+        self->rxStart += available;
+        readBytes += available;
     }
 
     return readBytes;
@@ -113,7 +169,7 @@ SerialTransceiverFT12_readNextMessage(SerialTransceiverFT12 self, uint8_t* buffe
 {
     SerialPort_setTimeout(self->serialPort, self->messageTimeout);
 
-    int read = SerialPort_readByte(self->serialPort);
+    int read = readByte(self);
 
     if (read != -1) {
 
@@ -121,7 +177,7 @@ SerialTransceiverFT12_readNextMessage(SerialTransceiverFT12 self, uint8_t* buffe
 
             SerialPort_setTimeout(self->serialPort, self->characterTimeout);
 
-            int msgSize = SerialPort_readByte(self->serialPort);
+            int msgSize = readByte(self);
 
             if (msgSize == -1)
                 goto sync_error;
@@ -192,5 +248,99 @@ sync_error:
 
     SerialPort_discardInBuffer(self->serialPort);
 
+    self->rxStart = 0;
+    self->rxEnd = 0;
+
+    return;
+}
+
+uint64_t
+SerialTransceiverFT12_getNextTimeout(SerialTransceiverFT12 self)
+{
+    if (self->partialFrameTime == 0)
+        return UINT64_MAX;
+
+    return self->partialFrameTime + (uint64_t) self->characterTimeout + 1;
+}
+
+void
+SerialTransceiverFT12_readAvailableMessages(SerialTransceiverFT12 self, uint8_t* buffer,
+        SerialTXMessageHandler messageHandler, void* parameter)
+{
+    /* keep an incomplete frame at the start of the buffer to make room for the rest */
+    if ((self->rxStart > 0) && (self->rxStart < self->rxEnd)) {
+        memmove(self->rxBuffer, self->rxBuffer + self->rxStart, self->rxEnd - self->rxStart);
+        self->rxEnd -= self->rxStart;
+        self->rxStart = 0;
+    }
+
+    SerialPort_setTimeout(self->serialPort, 0);
+
+    bool received = fillBuffer(self);
+
+    while (self->rxStart < self->rxEnd) {
+
+        uint8_t* frame = self->rxBuffer + self->rxStart;
+        int available = self->rxEnd - self->rxStart;
+        int msgSize;
+
+        if (frame[0] == 0xe5) {
+            msgSize = 1;
+        }
+        else if (frame[0] == 0x10) {
+            msgSize = 4 + self->linkLayerParameters->addressLength;
+        }
+        else if (frame[0] == 0x68) {
+            /* header 68 L L 68: a corrupted length must not make us wait for a wrong frame size */
+            if (available < 4)
+                msgSize = 0;
+            else if ((frame[1] != frame[2]) || (frame[3] != 0x68))
+                goto sync_error;
+            else
+                msgSize = frame[1] + 6;
+        }
+        else {
+            goto sync_error;
+        }
+
+        if ((msgSize == 0) || (available < msgSize)) {
+            uint64_t currentTime = Hal_getTimeInMs();
+
+            /* the character timeout is the gap between bytes: restart it whenever new bytes arrived */
+            if ((self->partialFrameTime == 0) || received) {
+                self->partialFrameTime = currentTime;
+            }
+            else if (currentTime > self->partialFrameTime + (uint64_t) self->characterTimeout) {
+                DEBUG_PRINT("RECV: Timeout reading frame (received %i bytes)\n", available);
+
+                self->rxStart = 0;
+                self->rxEnd = 0;
+                self->partialFrameTime = 0;
+            }
+
+            return;
+        }
+
+        memcpy(buffer, frame, msgSize);
+
+        self->rxStart += msgSize;
+        self->partialFrameTime = 0;
+
+        if (self->rawMessageHandler)
+            self->rawMessageHandler(self->rawMessageHandlerParameter, buffer, msgSize, false);
+
+        messageHandler(parameter, buffer, msgSize);
+    }
+
     return;
+
+sync_error:
+
+    DEBUG_PRINT("RECV: SYNC ERROR\n");
+
+    SerialPort_discardInBuffer(self->serialPort);
+
+    self->rxStart = 0;
+    self->rxEnd = 0;
+    self->partialFrameTime = 0;
 }
@@ -362,7 +362,7 @@ SinglePointWithCP56Time2a_destroy(SinglePointWithCP56Time2a self);
 CP56Time2a
 SinglePointWithCP56Time2a_getTimestamp(SinglePointWithCP56Time2a self);
 
-SinglePointWithCP56Time2a
+bool
 SinglePointWithCP56Time2a_getValue(SinglePointWithCP56Time2a self);
 /************************************************
  * DoublePointInformation (:InformationObject)
@@ -784,9 +784,6 @@ IntegratedTotals_getBCR(IntegratedTotals self);
 void
 IntegratedTotals_setBCR(IntegratedTotals self, BinaryCounterReading value);
 
-QualityDescriptor
-IntegratedTotals_getQuality(IntegratedTotals self);
-
 /***********************************************************************
  * IntegratedTotalsWithCP24Time2a : IntegratedTotals
  ***********************************************************************/
@@ -92,6 +92,29 @@ CS101_Master_createEx(SerialPort serialPort, const LinkLayerParameters llParamet
 void
 CS101_Master_run(CS101_Master self);
 
+/**
+ * \brief Process the bytes already received and run the protocol state machine(s) without waiting.
+ *
+ * Unlike \ref CS101_Master_run this function never blocks: an incomplete frame is kept
+ * until the next call. Intended for applications that drive many masters from one thread
+ * and wait for received data themselves (e.g. poll over \ref SerialPort_getFd).
+ * It has to be called when data is received and for the link layer timeouts, either every few
+ * milliseconds or at the time returned by \ref CS101_Master_getNextTimeout.
+ */
+void
+CS101_Master_runNonBlocking(CS101_Master self);
+
+/**
+ * \brief Get the time (in ms) when \ref CS101_Master_runNonBlocking has to be called next without received data
+ *
+ * Covers the link layer timers (response timeout and repetition, link state timeout, idle test
+ * function, polling back-off) and the character timeout of an incomplete frame. Returns the current
+ * time when the next call sends a frame right away, and UINT64_MAX when nothing happens until data
+ * is received. ASDUs sent by \ref CS101_Master_sendASDU or a slave poll afterwards require an earlier call.
+ */
+uint64_t
+CS101_Master_getNextTimeout(CS101_Master self);
+
 /**
  * \brief Start a background thread that handles the link layer connections
  *
@@ -138,6 +161,46 @@ CS101_Master_addSlave(CS101_Master self, int address);
 void
 CS101_Master_pollSingleSlave(CS101_Master self, int address);
 
+/**
+ * \brief Let the link layer poll the slaves automatically (only unbalanced mode)
+ *
+ * When enabled, the link layer selects the next slave itself: slaves that signal
+ * class 1 data (ACD) are polled for class 1 data immediately, pending ASDUs are
+ * sent next, and otherwise the slaves are polled for class 2 data in weighted
+ * round-robin order (see \ref CS101_Master_setSlavePriority). A slave that does
+ * not respond is skipped for an exponentially growing back-off interval.
+ *
+ * \param enable true to enable the scheduler, false to poll only on request (default)
+ * \param minBackoff back-off after the first failure in ms (0 keeps the current value, default 1000)
+ * \param maxBackoff upper limit of the back-off interval in ms (0 keeps the current value, default 60000)
+ */
+void
+CS101_Master_setAutoPolling(CS101_Master self, bool enable, int minBackoff, int maxBackoff);
+
+/**
+ * \brief Set the polling weight of a slave (only unbalanced mode)
+ *
+ * A slave with priority 4 is polled four times as often as a slave with priority 1.
+ *
+ * \param address the link layer address of the slave
+ * \param priority weight of the slave (>= 1, default 1)
+ *
+ * \return true on success, false if the slave is unknown or the priority is invalid
+ */
+bool
+CS101_Master_setSlavePriority(CS101_Master self, int address, int priority);
+
+/**
+ * \brief Get the polling statistics of a slave (only unbalanced mode)
+ *
+ * \param address the link layer address of the slave
+ * \param stats structure that receives the statistics
+ *
+ * \return true on success, false if the slave is unknown
+ */
+bool
+CS101_Master_getSlavePollingStatistics(CS101_Master self, int address, LinkLayerPollingStatistics stats);
+
 /**
  * \brief Destroy the master instance and release all resources
  */
@@ -308,6 +371,18 @@ CS101_Master_setASDUReceivedHandler(CS101_Master self, CS101_ASDUReceivedHandler
 void
 CS101_Master_setLinkLayerStateChanged(CS101_Master self, IEC60870_LinkLayerStateChangedHandler handler, void* parameter);
 
+/**
+ * \brief Set a callback handler that is called when a slave channel becomes ready (only unbalanced mode)
+ *
+ * Allows to send the next ASDU to a slave without polling \ref CS101_Master_isChannelReady.
+ * The handler is called by the thread that runs the link layer.
+ *
+ * \param handler user provided callback handler function
+ * \param parameter user provided parameter that is passed to the callback handler
+ */
+void
+CS101_Master_setChannelReadyHandler(CS101_Master self, IEC60870_ChannelReadyHandler handler, void* parameter);
+
 /**
  * \brief Set the raw message callback (called when a message is sent or received)
  *
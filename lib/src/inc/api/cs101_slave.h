@@ -174,6 +174,29 @@ CS101_Slave_isClass1QueueFull(CS101_Slave self);
 void
 CS101_Slave_enqueueUserDataClass1(CS101_Slave self, CS101_ASDU asdu);
 
+/**
+ * \brief Enqueue a list of ASDUs into the class 1 data queue
+ *
+ * In contrast to \ref CS101_Slave_enqueueUserDataClass1 queued ASDUs are never
+ * overwritten. Enqueuing stops when the queue is full.
+ *
+ * \param self CS101_Slave instance
+ * \param asdus the ASDU instances to enqueue
+ * \param count number of ASDUs
+ *
+ * \return number of ASDUs added to the queue
+ */
+int
+CS101_Slave_enqueueUserDataClass1Many(CS101_Slave self, CS101_ASDU* asdus, int count);
+
+/**
+ * \brief Get the number of ASDUs in the class 1 data queue
+ *
+ * \param self CS101_Slave instance
+ */
+int
+CS101_Slave_getClass1QueueCount(CS101_Slave self);
+
 /**
  * \brief Check if the class 2 ASDU is full
  *
@@ -193,6 +216,29 @@ CS101_Slave_isClass2QueueFull(CS101_Slave self);
 void
 CS101_Slave_enqueueUserDataClass2(CS101_Slave self, CS101_ASDU asdu);
 
+/**
+ * \brief Enqueue a list of ASDUs into the class 2 data queue
+ *
+ * In contrast to \ref CS101_Slave_enqueueUserDataClass2 queued ASDUs are never
+ * overwritten. Enqueuing stops when the queue is full.
+ *
+ * \param self CS101_Slave instance
+ * \param asdus the ASDU instances to enqueue
+ * \param count number of ASDUs
+ *
+ * \return number of ASDUs added to the queue
+ */
+int
+CS101_Slave_enqueueUserDataClass2Many(CS101_Slave self, CS101_ASDU* asdus, int count);
+
+/**
+ * \brief Get the number of ASDUs in the class 2 data queue
+ *
+ * \param self CS101_Slave instance
+ */
+int
+CS101_Slave_getClass2QueueCount(CS101_Slave self);
+
 /**
  * \brief Remove all ASDUs from the class 1/2 data queues
  *
@@ -164,6 +164,65 @@ CS104_Connection_connectAsync(CS104_Connection self);
 bool
 CS104_Connection_connect(CS104_Connection self);
 
+/**
+ * \brief Start connecting without a connection handling thread (threadless mode)
+ *
+ * Starts a non-blocking TCP connect and returns immediately. The connection is then driven
+ * by the application with \ref CS104_Connection_run, e.g. from an event loop that waits for
+ * the socket of many connections (\ref CS104_Connection_getSocketFd). The connection handler
+ * is called from CS104_Connection_run with CS104_CONNECTION_OPENED, CS104_CONNECTION_FAILED or
+ * CS104_CONNECTION_CLOSED. After a failure or close the function can be called again to reconnect.
+ *
+ * NOTE: Not available for TLS connections. CS104_Connection_run, CS104_Connection_close and
+ * CS104_Connection_destroy must not be called concurrently for the same connection.
+ *
+ * \param self CS104_Connection instance
+ *
+ * \return true when the connect was started, false otherwise
+ */
+bool
+CS104_Connection_connectThreadless(CS104_Connection self);
+
+/**
+ * \brief Handle the connection in threadless mode
+ *
+ * Completes a pending connect, handles all received messages and the t1/t2/t3 timeouts.
+ * Never blocks.
+ *
+ * \param self CS104_Connection instance
+ *
+ * \return true while the connection is connecting or connected, false when it has been
+ * closed (the connection handler was called)
+ */
+bool
+CS104_Connection_run(CS104_Connection self);
+
+/**
+ * \brief Get the operating system socket descriptor of a threadless connection
+ *
+ * NOTE: Only available on Linux.
+ *
+ * \return the file descriptor, or -1 when there is no socket
+ */
+int
+CS104_Connection_getSocketFd(CS104_Connection self);
+
+/**
+ * \brief Check if a threadless connection is still waiting for the TCP connect to complete
+ *
+ * While connecting the socket has to be watched for writability instead of readability.
+ */
+bool
+CS104_Connection_isConnecting(CS104_Connection self);
+
+/**
+ * \brief Get the time (in ms) when \ref CS104_Connection_run has to be called next to handle a timeout
+ *
+ * Messages sent from other threads can start a t1 timeout earlier than the returned time.
+ */
+uint64_t
+CS104_Connection_getNextTimeout(CS104_Connection self);
+
 /**
  * \brief start data transmission on this connection
  *
@@ -170,6 +170,37 @@ CS104_Slave_getOpenConnections(CS104_Slave self);
 void
 CS104_Slave_setMaxOpenConnections(CS104_Slave self, int maxOpenConnections);
 
+/**
+ * \brief Handle the client connections with a fixed pool of epoll worker threads
+ *
+ * By default every client connection is handled by its own thread. With worker threads
+ * the connections are distributed over the workers. Each worker waits for all of its
+ * connections with epoll and keeps the t1/t2/t3 timeouts in a timer wheel.
+ *
+ * NOTE: Only available on Linux and not used together with TLS. Has to be called
+ * before \ref CS104_Slave_start.
+ *
+ * \param self the slave instance
+ * \param numberOfWorkers number of worker threads (0 = one thread per connection)
+ *
+ * \return true when the epoll engine is available, false otherwise (other platforms, TLS)
+ */
+bool
+CS104_Slave_setEpollWorkers(CS104_Slave self, int numberOfWorkers);
+
+/**
+ * \brief Get the number of running epoll worker threads
+ *
+ * When the workers could not be started by \ref CS104_Slave_start the slave falls back
+ * to one thread per connection and this function returns 0.
+ *
+ * \param self the slave instance
+ *
+ * \return number of running worker threads, 0 when every connection has its own thread
+ */
+int
+CS104_Slave_getEpollWorkers(CS104_Slave self);
+
 /**
  * \brief Set one of the server modes
  *
@@ -90,6 +90,17 @@ typedef enum {
  */
 typedef void (*IEC60870_LinkLayerStateChangedHandler) (void* parameter, int address, LinkLayerState newState);
 
+/**
+ * \brief Callback handler for a free slave channel (only unbalanced master)
+ *
+ * Called by the link layer thread when the pending message or data request of a slave is finished
+ * (confirmed, answered or given up), i.e. when CS101_Master_isChannelReady becomes true again.
+ *
+ * \param parameter user provided parameter that is passed to the handler
+ * \param address slave address of the channel
+ */
+typedef void (*IEC60870_ChannelReadyHandler) (void* parameter, int address);
+
 /**
  * \brief Callback handler for sent and received messages
  *
@@ -256,6 +267,18 @@ struct sCP56Time2a {
     uint8_t encodedValue[7];
 };
 
+/**
+ * \brief Cache of the last converted calendar day for \ref CP56Time2a_toMsTimestampCached
+ *
+ * Zero-initialize before first use. One cache must not be shared between threads.
+ */
+typedef struct sCP56Time2aDayCache CP56Time2aDayCache;
+
+struct sCP56Time2aDayCache {
+    uint32_t dayKey;     /* encoded (year, month, day) of the cached day, 0 = empty */
+    uint64_t dayStartMs; /* ms timestamp of 00:00:00.000 of the cached day */
+};
+
 /**
  * \brief Base type for counter readings
  */
@@ -725,6 +748,17 @@ CP56Time2a_setFromMsTimestamp(CP56Time2a self, uint64_t timestamp);
 uint64_t
 CP56Time2a_toMsTimestamp(const CP56Time2a self);
 
+/**
+ * \brief Convert a 7 byte time to a ms timestamp, reusing the start of day from the cache
+ *
+ * Gives the same result as \ref CP56Time2a_toMsTimestamp. When the date matches the cached
+ * day only the time of day is computed; otherwise the cache is updated.
+ *
+ * \param cache day cache (may be NULL)
+ */
+uint64_t
+CP56Time2a_toMsTimestampCached(const CP56Time2a self, CP56Time2aDayCache* cache);
+
 /**
  * \brief Get the ms part of a time value
  */
@@ -25,6 +25,7 @@
 #define SRC_IEC60870_LINK_LAYER_LINK_LAYER_PARAMETERS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,6 +48,23 @@ struct sLinkLayerParameters {
     int timeoutLinkState; /** interval to repeat request status of link (FC=9) after response timeout */
 };
 
+/**
+ * \brief Polling statistics of a slave connection (unbalanced mode, primary station)
+ */
+typedef struct sLinkLayerPollingStatistics* LinkLayerPollingStatistics;
+
+struct sLinkLayerPollingStatistics {
+    int priority; /** weight of the slave in the weighted round-robin of the polling scheduler */
+    uint32_t class1Requests; /** number of requests for class 1 data (FC=10) */
+    uint32_t class2Requests; /** number of requests for class 2 data (FC=11) */
+    uint32_t timeouts; /** number of link layer timeouts */
+    int consecutiveFailures; /** timeouts since the last response of the slave */
+    uint32_t backoff; /** current back-off interval in ms (0 when the slave is polled normally) */
+    uint32_t lastScanCycle; /** time between the last two requests for class 2 data in ms */
+    uint32_t avgScanCycle; /** average time between requests for class 2 data in ms */
+    uint32_t maxScanCycle; /** maximum time between requests for class 2 data in ms */
+};
+
 #ifdef __cplusplus
 }
 #endif
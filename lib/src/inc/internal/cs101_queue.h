@@ -38,29 +38,27 @@ extern "C" {
 #define CS101_MAX_QUEUE_SIZE 10
 #endif
 
-typedef struct sCS101_QueueElement* CS101_QueueElement;
-
-struct sCS101_QueueElement {
-    uint8_t size;
-    uint8_t buffer[256];
-};
-
 typedef struct sCS101_Queue* CS101_Queue;
 
+/*
+ * Ring buffer of encoded ASDUs. Each entry is stored as one length byte followed by
+ * the encoded ASDU, so the memory used is proportional to the actual ASDU sizes.
+ * The buffer is allocated on demand and grows up to maxQueueSize entries of maximum size.
+ */
 struct sCS101_Queue {
 
-    int size;
+    int size; /* maximum number of entries */
     int entryCounter;
-    int lastMsgIndex;
-    int firstMsgIndex;
+    int firstMsgIndex; /* offset of the oldest entry */
+    int lastMsgIndex; /* offset behind the newest entry */
 
-    struct sBufferFrame encodeFrame;
+    uint8_t* buffer;
+    int bufferSize; /* allocated bytes */
+    int usedBytes;
+    int maxBufferSize;
 
-#if (CS101_MAX_QUEUE_SIZE == -1)
-    struct sCS101_QueueElement* elements;
-#else
-    struct sCS101_QueueElement elements[CS101_MAX_QUEUE_SIZE];
-#endif
+    struct sBufferFrame encodeFrame;
+    uint8_t encodeBuffer[256];
 
 #if (CONFIG_USE_SEMAPHORES == 1)
     Semaphore queueLock;
@@ -82,6 +80,15 @@ CS101_Queue_unlock(CS101_Queue self);
 void
 CS101_Queue_enqueue(CS101_Queue self, CS101_ASDU asdu);
 
+/*
+ * Enqueue a list of ASDUs with a single lock. Unlike CS101_Queue_enqueue no
+ * older entries are removed: enqueuing stops when the queue is full.
+ *
+ * \return number of ASDUs added to the queue
+ */
+int
+CS101_Queue_enqueueMany(CS101_Queue self, CS101_ASDU* asdus, int count);
+
     /*
      * NOTE: Locking has to be done by caller!
      */
@@ -94,6 +101,9 @@ CS101_Queue_isFull(CS101_Queue self);
 bool
 CS101_Queue_isEmpty(CS101_Queue self);
 
+int
+CS101_Queue_getEntryCount(CS101_Queue self);
+
 void
 CS101_Queue_flush(CS101_Queue self);
 
@@ -80,6 +80,10 @@ void
 LinkLayerPrimaryUnbalanced_setStateChangeHandler(LinkLayerPrimaryUnbalanced self,
         IEC60870_LinkLayerStateChangedHandler handler, void* parameter);
 
+void
+LinkLayerPrimaryUnbalanced_setChannelReadyHandler(LinkLayerPrimaryUnbalanced self,
+        IEC60870_ChannelReadyHandler handler, void* parameter);
+
 void
 LinkLayerPrimaryUnbalanced_addSlaveConnection(LinkLayerPrimaryUnbalanced self, int slaveAddress);
 
@@ -98,6 +102,15 @@ LinkLayerPrimaryUnbalanced_requestClass1Data(LinkLayerPrimaryUnbalanced self, in
 bool
 LinkLayerPrimaryUnbalanced_requestClass2Data(LinkLayerPrimaryUnbalanced self, int slaveAddress);
 
+void
+LinkLayerPrimaryUnbalanced_setAutoPolling(LinkLayerPrimaryUnbalanced self, bool enable, int minBackoff, int maxBackoff);
+
+bool
+LinkLayerPrimaryUnbalanced_setSlavePriority(LinkLayerPrimaryUnbalanced self, int slaveAddress, int priority);
+
+bool
+LinkLayerPrimaryUnbalanced_getPollingStatistics(LinkLayerPrimaryUnbalanced self, int slaveAddress, LinkLayerPollingStatistics stats);
+
 bool
 LinkLayerPrimaryUnbalanced_sendConfirmed(LinkLayerPrimaryUnbalanced self, int slaveAddress, BufferFrame message);
 
@@ -107,6 +120,13 @@ LinkLayerPrimaryUnbalanced_sendNoReply(LinkLayerPrimaryUnbalanced self, int slav
 void
 LinkLayerPrimaryUnbalanced_run(LinkLayerPrimaryUnbalanced self);
 
+void
+LinkLayerPrimaryUnbalanced_runNonBlocking(LinkLayerPrimaryUnbalanced self);
+
+/* time (in ms) when LinkLayerPrimaryUnbalanced_runNonBlocking has to be called without received data, UINT64_MAX if never */
+uint64_t
+LinkLayerPrimaryUnbalanced_getNextTimeout(LinkLayerPrimaryUnbalanced self);
+
 
 
 
@@ -169,6 +189,13 @@ LinkLayerBalanced_destroy(LinkLayerBalanced self);
 void
 LinkLayerBalanced_run(LinkLayerBalanced self);
 
+void
+LinkLayerBalanced_runNonBlocking(LinkLayerBalanced self);
+
+/* as LinkLayerPrimaryUnbalanced_getNextTimeout, userDataPending: the application layer has user data to send */
+uint64_t
+LinkLayerBalanced_getNextTimeout(LinkLayerBalanced self, bool userDataPending);
+
 LinkLayer
 LinkLayer_init(LinkLayer self, int address, SerialTransceiverFT12 transceiver, LinkLayerParameters linkLayerParameters);
 
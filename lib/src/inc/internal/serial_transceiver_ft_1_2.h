@@ -54,6 +54,22 @@ void
 SerialTransceiverFT12_readNextMessage(SerialTransceiverFT12 self, uint8_t* buffer,
         SerialTXMessageHandler, void* parameter);
 
+/*
+ * Non-blocking variant of SerialTransceiverFT12_readNextMessage: reads the bytes already
+ * received and passes every complete frame to the message handler. An incomplete frame
+ * stays buffered until the next call (or is dropped after the character timeout).
+ */
+void
+SerialTransceiverFT12_readAvailableMessages(SerialTransceiverFT12 self, uint8_t* buffer,
+        SerialTXMessageHandler, void* parameter);
+
+/*
+ * Time (in ms) when SerialTransceiverFT12_readAvailableMessages has to drop an incomplete frame
+ * if no more bytes arrive, UINT64_MAX when no frame is incomplete.
+ */
+uint64_t
+SerialTransceiverFT12_getNextTimeout(SerialTransceiverFT12 self);
+
 #endif /* SRC_IEC60870_LINK_LAYER_SERIAL_TRANSCEIVER_FT_1_2_H_ */
 
 
@@ -0,0 +1,54 @@
+#ifndef ADDON_DATA_H
+#define ADDON_DATA_H
+
+#include <napi.h>
+
+// Данные модуля для одного окружения Node.js. Аддон может быть загружен одновременно в главном
+// потоке и в нескольких worker_threads, и у каждого окружения свои конструкторы классов.
+// Поэтому они хранятся не в статических полях классов, а в данных экземпляра (Env::SetInstanceData),
+// которые освобождаются вместе с окружением.
+struct AddonData {
+    Napi::FunctionReference iec104Server;
+    Napi::FunctionReference iec104Client;
+    Napi::FunctionReference iec104ClientPool;
+    Napi::FunctionReference iec101MasterBalanced;
+    Napi::FunctionReference iec101MasterUnbalanced;
+    Napi::FunctionReference iec101LineManager;
+    Napi::FunctionReference iec101Slave;
+};
+
+// Данные текущего окружения; создаются при первом обращении из InitAll
+inline AddonData *GetAddonData(Napi::Env env)
+{
+    AddonData *data = env.GetInstanceData<AddonData>();
+    if (!data) {
+        data = new AddonData();
+        env.SetInstanceData(data);
+    }
+    return data;
+}
+
+// Остановка нативных потоков объекта при завершении окружения (worker.terminate(), выход воркера).
+// Node вызывает cleanup hooks в порядке, обратном регистрации, а деструкторы ObjectWrap — позже,
+// когда ThreadSafeFunction объекта уже удалена своим hook'ом. Поэтому объект регистрирует hook
+// после создания TSFN: он срабатывает раньше, останавливает потоки и освобождает TSFN, пока она жива.
+// T::Teardown() должен быть идемпотентным — деструктор вызывает его повторно.
+template <typename T>
+void TeardownHook(void *instance)
+{
+    static_cast<T *>(instance)->Teardown();
+}
+
+template <typename T>
+void AddTeardownHook(Napi::Env env, T *instance)
+{
+    napi_add_env_cleanup_hook(env, TeardownHook<T>, instance);
+}
+
+template <typename T>
+void RemoveTeardownHook(Napi::Env env, T *instance)
+{
+    napi_remove_env_cleanup_hook(env, TeardownHook<T>, instance);
+}
+
+#endif // ADDON_DATA_H
@@ -0,0 +1,173 @@
+#ifndef ASDU_PACKER_H
+#define ASDU_PACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "iec60870_decode.h"
+
+extern "C" {
+#include "cs101_information_objects.h"
+#include "iec60870_common.h"
+}
+
+// Точка мониторинга для кодирования в ASDU
+struct PackPoint {
+    int ioa;
+    double value;
+    uint8_t quality;
+    uint64_t timestamp;
+};
+
+// Начиная с такой длины подряд идущих IOA выгоднее кодировать их последовательностью (SQ=1)
+static const size_t kMinSequenceRun = 4;
+
+// Память для одного кодируемого объекта: сам объект и вложенные метка времени/показание счётчика
+struct PackScratch {
+    IODecodeBuffer io;
+    struct sCP56Time2a time;
+    struct sBinaryCounterReading bcr;
+};
+
+// Создаёт информационный объект типа typeId в scratch без выделения памяти.
+// Возвращает NULL для типов, которые упаковщик не поддерживает.
+inline InformationObject CreateMonitorIO(PackScratch &scratch, int typeId, const PackPoint &p)
+{
+    void *self = &scratch.io;
+    CP56Time2a time = &scratch.time;
+    switch (typeId) {
+        case M_SP_NA_1:
+            return (InformationObject)SinglePointInformation_create((SinglePointInformation)self, p.ioa, p.value != 0, p.quality);
+        case M_DP_NA_1:
+            return (InformationObject)DoublePointInformation_create((DoublePointInformation)self, p.ioa, (DoublePointValue)(int)p.value, p.quality);
+        case M_ST_NA_1:
+            return (InformationObject)StepPositionInformation_create((StepPositionInformation)self, p.ioa, (int)p.value, false, p.quality);
+        case M_BO_NA_1:
+            return (InformationObject)BitString32_createEx((BitString32)self, p.ioa, (uint32_t)p.value, p.quality);
+        case M_ME_NA_1:
+            return (InformationObject)MeasuredValueNormalized_create((MeasuredValueNormalized)self, p.ioa, (float)p.value, p.quality);
+        case M_ME_NB_1:
+            return (InformationObject)MeasuredValueScaled_create((MeasuredValueScaled)self, p.ioa, (int)p.value, p.quality);
+        case M_ME_NC_1:
+            return (InformationObject)MeasuredValueShort_create((MeasuredValueShort)self, p.ioa, (float)p.value, p.quality);
+        case M_IT_NA_1:
+            BinaryCounterReading_create(&scratch.bcr, (int32_t)p.value, 0, false, false, (p.quality & IEC60870_QUALITY_INVALID) != 0);
+            return (InformationObject)IntegratedTotals_create((IntegratedTotals)self, p.ioa, &scratch.bcr);
+        case M_SP_TB_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)SinglePointWithCP56Time2a_create((SinglePointWithCP56Time2a)self, p.ioa, p.value != 0, p.quality, time);
+        case M_DP_TB_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)DoublePointWithCP56Time2a_create((DoublePointWithCP56Time2a)self, p.ioa, (DoublePointValue)(int)p.value, p.quality, time);
+        case M_ST_TB_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)StepPositionWithCP56Time2a_create((StepPositionWithCP56Time2a)self, p.ioa, (int)p.value, false, p.quality, time);
+        case M_BO_TB_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)Bitstring32WithCP56Time2a_createEx((Bitstring32WithCP56Time2a)self, p.ioa, (uint32_t)p.value, p.quality, time);
+        case M_ME_TD_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)MeasuredValueNormalizedWithCP56Time2a_create((MeasuredValueNormalizedWithCP56Time2a)self, p.ioa, (float)p.value, p.quality, time);
+        case M_ME_TE_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)MeasuredValueScaledWithCP56Time2a_create((MeasuredValueScaledWithCP56Time2a)self, p.ioa, (int)p.value, p.quality, time);
+        case M_ME_TF_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            return (InformationObject)MeasuredValueShortWithCP56Time2a_create((MeasuredValueShortWithCP56Time2a)self, p.ioa, (float)p.value, p.quality, time);
+        case M_IT_TB_1:
+            CP56Time2a_createFromMsTimestamp(time, p.timestamp);
+            BinaryCounterReading_create(&scratch.bcr, (int32_t)p.value, 0, false, false, (p.quality & IEC60870_QUALITY_INVALID) != 0);
+            return (InformationObject)IntegratedTotalsWithCP56Time2a_create((IntegratedTotalsWithCP56Time2a)self, p.ioa, &scratch.bcr, time);
+        default:
+            return NULL;
+    }
+}
+
+inline bool IsPackableMonitorType(int typeId)
+{
+    PackScratch scratch;
+    PackPoint probe = {1, 0, 0, 0};
+    return CreateMonitorIO(scratch, typeId, probe) != NULL;
+}
+
+// Типы с меткой времени CP56Time2a. По IEC 60870-5-101 (7.2.2.1) они передаются только с SQ=0:
+// у каждого элемента своя метка времени и свой IOA
+inline bool HasCP56Time2a(int typeId)
+{
+    switch (typeId) {
+        case M_SP_TB_1:
+        case M_DP_TB_1:
+        case M_ST_TB_1:
+        case M_BO_TB_1:
+        case M_ME_TD_1:
+        case M_ME_TE_1:
+        case M_ME_TF_1:
+        case M_IT_TB_1:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Длина цепочки подряд идущих IOA начиная с points[0], но не больше limit
+inline size_t SequenceRun(const PackPoint *points, size_t count, size_t limit)
+{
+    size_t run = 1;
+    while (run < count && run < limit && points[run].ioa == points[run - 1].ioa + 1)
+        run++;
+    return run;
+}
+
+// Заполняет один ASDU точками points[0..count) одного typeId (отсортированными по ioa).
+// Цепочки из kMinSequenceRun и более подряд идущих IOA кодируются с SQ=1, остальные точки
+// собираются в ASDU с SQ=0. Типы с меткой времени всегда кодируются с SQ=0.
+// Возвращает число уложенных точек; 0 — тип не поддерживается.
+inline size_t PackASDU(sCS101_StaticASDU *storage, CS101_ASDU *out, CS101_AppLayerParameters alParams,
+                       CS101_CauseOfTransmission cot, int ca, int typeId, const PackPoint *points, size_t count)
+{
+    PackScratch scratch;
+    if (count == 0)
+        return 0;
+
+    bool allowSequence = !HasCP56Time2a(typeId);
+    bool sequence = allowSequence && SequenceRun(points, count, kMinSequenceRun) >= kMinSequenceRun;
+    CS101_ASDU asdu = CS101_ASDU_initializeStatic(storage, alParams, sequence, cot, 0, ca, false, false);
+    *out = asdu;
+
+    size_t added = 0;
+    while (added < count)
+    {
+        if (sequence)
+        {
+            if (added > 0 && points[added].ioa != points[added - 1].ioa + 1)
+                break;
+        }
+        else if (allowSequence && added > 0 && SequenceRun(points + added, count - added, kMinSequenceRun) >= kMinSequenceRun)
+        {
+            break; // Дальше начинается цепочка — ей нужен свой ASDU с SQ=1
+        }
+
+        InformationObject io = CreateMonitorIO(scratch, typeId, points[added]);
+        if (!io || !CS101_ASDU_addInformationObject(asdu, io))
+            break; // ASDU заполнен
+        added++;
+    }
+    return added;
+}
+
+// Для ответа на опрос типы с меткой времени заменяются на соответствующие без метки
+inline int InterrogationTypeId(int typeId)
+{
+    switch (typeId) {
+        case M_SP_TB_1: return M_SP_NA_1;
+        case M_DP_TB_1: return M_DP_NA_1;
+        case M_ST_TB_1: return M_ST_NA_1;
+        case M_BO_TB_1: return M_BO_NA_1;
+        case M_ME_TD_1: return M_ME_NA_1;
+        case M_ME_TE_1: return M_ME_NB_1;
+        case M_ME_TF_1: return M_ME_NC_1;
+        case M_IT_TB_1: return M_IT_NA_1;
+        default: return typeId;
+    }
+}
+
+#endif // ASDU_PACKER_H
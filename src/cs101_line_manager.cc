@@ -0,0 +1,926 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+#include <inttypes.h>
+#include <cs101_line_manager.h>
+#include "addon_data.h"
+#include <napi.h>
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+}
+
+using namespace Napi;
+using namespace std;
+
+Object IEC101LineManager::Init(Napi::Env env, Object exports) {
+    Function func = DefineClass(env, "IEC101LineManager", {
+        InstanceMethod("start", &IEC101LineManager::Start),
+        InstanceMethod("stop", &IEC101LineManager::Stop),
+        InstanceMethod("addLine", &IEC101LineManager::AddLine),
+        InstanceMethod("removeLine", &IEC101LineManager::RemoveLine),
+        InstanceMethod("sendCommands", &IEC101LineManager::SendCommands),
+        InstanceMethod("pollSlave", &IEC101LineManager::PollSlave),
+        InstanceMethod("getStatus", &IEC101LineManager::GetStatus)
+    });
+
+    GetAddonData(env)->iec101LineManager = Persistent(func);
+    exports.Set("IEC101LineManager", func);
+    return exports;
+}
+
+IEC101LineManager::IEC101LineManager(const CallbackInfo &info) : ObjectWrap<IEC101LineManager>(info) {
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(info.Env(), "Expected a callback function").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Function emit = info[0].As<Napi::Function>();
+    running = false;
+
+    try {
+        tsfn = ThreadSafeFunction::New(
+            info.Env(),
+            emit,
+            "IEC101LineManagerTSFN",
+            0,
+            1,
+            [](Napi::Env) {}
+        );
+    } catch (const std::exception& e) {
+        printf("Failed to create ThreadSafeFunction: %s\n", e.what());
+        Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
+    }
+    AddTeardownHook(info.Env(), this);
+}
+
+IEC101LineManager::~IEC101LineManager() {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает
+void IEC101LineManager::Teardown() {
+    if (running) {
+        Shutdown();
+        tsfn.Release();
+    }
+}
+
+Napi::Value IEC101LineManager::Start(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected an object with { managerID (string), [threads (number)], [tickMs (number)], [params (object)] }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (running) {
+        Napi::Error::New(env, "Manager already running").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    if (!config.Has("managerID") || !config.Get("managerID").IsString()) {
+        Napi::TypeError::New(env, "Object must contain 'managerID' (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    managerID = config.Get("managerID").As<String>().Utf8Value();
+    int threads = 1;
+    if (config.Has("threads")) threads = config.Get("threads").As<Number>().Int32Value();
+    if (config.Has("tickMs")) tickMs = config.Get("tickMs").As<Number>().Int32Value();
+
+    if (threads < 1 || threads > 64) {
+        Napi::RangeError::New(env, "threads must be 1-64").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (tickMs < 1 || tickMs > 1000) {
+        Napi::RangeError::New(env, "tickMs must be 1-1000").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Пакетная передача данных в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = config.Has("params") && config.Get("params").IsObject() ? config.Get("params").As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    workers.clear();
+    for (int i = 0; i < threads; i++) {
+        auto worker = std::make_unique<LineWorker>();
+#ifndef _WIN32
+        if (pipe(worker->wakeupPipe) != 0) {
+            for (auto &w : workers) {
+                close(w->wakeupPipe[0]);
+                close(w->wakeupPipe[1]);
+            }
+            workers.clear();
+            Napi::Error::New(env, "Failed to create wakeup pipe").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        fcntl(worker->wakeupPipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(worker->wakeupPipe[1], F_SETFL, O_NONBLOCK);
+#endif
+        workers.push_back(std::move(worker));
+    }
+
+    printf("Starting line manager %s with %d threads, tickMs=%d\n", managerID.c_str(), threads, tickMs);
+
+    running = true;
+    batcher.Start(tsfn, [this](Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+        EmitBatch(env, jsCallback, points);
+    });
+    for (auto &worker : workers) {
+        LineWorker *w = worker.get();
+        w->thread = std::thread([this, w]() { WorkerLoop(*w); });
+    }
+
+    return env.Undefined();
+}
+
+void IEC101LineManager::Shutdown() {
+    running = false;
+
+    for (auto &worker : workers) {
+        Wakeup(*worker);
+    }
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        for (auto &line : worker->lines) {
+            CloseLine(*line, "manager stopped");
+        }
+        worker->lines.clear();
+#ifndef _WIN32
+        close(worker->wakeupPipe[0]);
+        close(worker->wakeupPipe[1]);
+#endif
+    }
+    workers.clear();
+    lines.clear();
+
+    batcher.Stop();
+}
+
+Napi::Value IEC101LineManager::Stop(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (running) {
+        printf("Stopping line manager %s\n", managerID.c_str());
+        Shutdown();
+        tsfn.Release();
+    }
+    return env.Undefined();
+}
+
+Napi::Value IEC101LineManager::AddLine(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected an object with { lineID (string), portName (string), baudRate (number), [mode (string)], [params (object)] }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!running) {
+        Napi::Error::New(env, "Manager not started").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    if (!config.Has("lineID") || !config.Get("lineID").IsString() ||
+        !config.Has("portName") || !config.Get("portName").IsString() ||
+        !config.Has("baudRate") || !config.Get("baudRate").IsNumber()) {
+        Napi::TypeError::New(env, "Object must contain 'lineID' (string), 'portName' (string), and 'baudRate' (number)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto line = std::make_shared<ManagedLine>();
+    line->manager = this;
+    line->lineID = config.Get("lineID").As<String>().Utf8Value();
+    line->portName = config.Get("portName").As<String>().Utf8Value();
+    line->baudRate = config.Get("baudRate").As<Number>().Int32Value();
+
+    if (line->lineID.empty() || line->portName.empty() || line->baudRate <= 0) {
+        Napi::Error::New(env, "Invalid 'lineID', 'portName', or 'baudRate'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (lines.count(line->lineID)) {
+        Napi::Error::New(env, "Line '" + line->lineID + "' already exists").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (config.Has("parity")) {
+        std::string parity = config.Get("parity").ToString().Utf8Value();
+        if (parity != "E" && parity != "O" && parity != "N") {
+            Napi::Error::New(env, "parity must be 'E', 'O' or 'N'").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        line->parity = parity[0];
+    }
+    if (config.Has("mode")) {
+        std::string mode = config.Get("mode").ToString().Utf8Value();
+        if (mode != "unbalanced" && mode != "balanced") {
+            Napi::Error::New(env, "mode must be 'unbalanced' or 'balanced'").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        line->unbalanced = mode == "unbalanced";
+    }
+
+    if (config.Has("params") && config.Get("params").IsObject()) {
+        Napi::Object params = config.Get("params").As<Napi::Object>();
+        if (params.Has("linkAddress")) line->linkAddress = params.Get("linkAddress").As<Number>().Int32Value();
+        line->otherAddress = line->linkAddress;
+        if (params.Has("slaveAddress")) line->otherAddress = params.Get("slaveAddress").As<Number>().Int32Value();
+        if (params.Has("originatorAddress")) line->originatorAddress = params.Get("originatorAddress").As<Number>().Int32Value();
+        if (params.Has("t0")) line->t0 = params.Get("t0").As<Number>().Int32Value();
+        if (params.Has("t1")) line->t1 = params.Get("t1").As<Number>().Int32Value();
+        if (params.Has("t2")) line->t2 = params.Get("t2").As<Number>().Int32Value();
+        if (params.Has("reconnectDelay")) line->reconnectDelay = params.Get("reconnectDelay").As<Number>().Int32Value();
+        if (params.Has("queueSize")) line->queueSize = params.Get("queueSize").As<Number>().Int32Value();
+        if (params.Has("autoPoll")) line->autoPoll = params.Get("autoPoll").ToBoolean().Value();
+        if (params.Has("pollBackoffMin")) line->pollBackoffMin = params.Get("pollBackoffMin").As<Number>().Int32Value();
+        if (params.Has("pollBackoffMax")) line->pollBackoffMax = params.Get("pollBackoffMax").As<Number>().Int32Value();
+        if (params.Has("slaveAddresses") && params.Get("slaveAddresses").IsArray()) {
+            Napi::Array slaveAddrArray = params.Get("slaveAddresses").As<Napi::Array>();
+            for (uint32_t i = 0; i < slaveAddrArray.Length(); i++) {
+                int addr = slaveAddrArray.Get(i).ToNumber().Int32Value();
+                if (addr < 0 || addr > 255) {
+                    Napi::RangeError::New(env, "Each slaveAddress must be 0-255").ThrowAsJavaScriptException();
+                    return env.Undefined();
+                }
+                line->slaveAddresses.push_back(addr);
+            }
+        }
+        if (params.Has("slavePriorities") && params.Get("slavePriorities").IsObject()) {
+            Napi::Object priorities = params.Get("slavePriorities").As<Napi::Object>();
+            Napi::Array keys = priorities.GetPropertyNames();
+            for (uint32_t i = 0; i < keys.Length(); i++) {
+                std::string key = keys.Get(i).ToString().Utf8Value();
+                int priority = priorities.Get(key).ToNumber().Int32Value();
+                if (priority < 1) {
+                    Napi::RangeError::New(env, "slavePriorities must map slave addresses to priorities >= 1").ThrowAsJavaScriptException();
+                    return env.Undefined();
+                }
+                line->slavePriorities[atoi(key.c_str())] = priority;
+            }
+        }
+    }
+
+    if (line->unbalanced && line->slaveAddresses.empty()) {
+        Napi::Error::New(env, "At least one slaveAddress must be provided in params.slaveAddresses for an unbalanced line").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->linkAddress < 0 || line->linkAddress > 255 || line->otherAddress < 0 || line->otherAddress > 255) {
+        Napi::Error::New(env, "linkAddress and slaveAddress must be 0-255").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->originatorAddress < 0 || line->originatorAddress > 255) {
+        Napi::Error::New(env, "originatorAddress must be 0-255").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->t0 <= 0 || line->t1 <= 0 || line->t2 <= 0) {
+        Napi::Error::New(env, "t0, t1, t2 must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->reconnectDelay < 1) {
+        Napi::Error::New(env, "reconnectDelay must be at least 1 second").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->queueSize <= 0) {
+        Napi::Error::New(env, "queueSize must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->pollBackoffMin <= 0 || line->pollBackoffMax < line->pollBackoffMin) {
+        Napi::Error::New(env, "pollBackoffMin must be positive and pollBackoffMax not less than pollBackoffMin").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Линия достаётся потоку с наименьшим числом линий
+    size_t best = 0;
+    size_t bestCount = SIZE_MAX;
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::lock_guard<std::mutex> lock(workers[i]->mutex);
+        if (workers[i]->lines.size() < bestCount) {
+            best = i;
+            bestCount = workers[i]->lines.size();
+        }
+    }
+
+    line->worker = best;
+    line->index = static_cast<int>(lineNames.size());
+    lineNames.push_back(line->lineID);
+    lines[line->lineID] = line;
+
+    {
+        std::lock_guard<std::mutex> lock(workers[best]->mutex);
+        workers[best]->lines.push_back(line);
+    }
+    Wakeup(*workers[best]);
+
+    printf("Added line %s (%s, %d baud, %s) to worker %zu, managerID: %s\n", line->lineID.c_str(), line->portName.c_str(),
+           line->baudRate, line->unbalanced ? "unbalanced" : "balanced", best, managerID.c_str());
+
+    return env.Undefined();
+}
+
+Napi::Value IEC101LineManager::RemoveLine(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected lineID (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string lineID = info[0].As<String>().Utf8Value();
+    auto it = lines.find(lineID);
+    if (it == lines.end()) {
+        return Boolean::New(env, false);
+    }
+
+    std::shared_ptr<ManagedLine> line = it->second;
+    LineWorker &worker = *workers[line->worker];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        CloseLine(*line, "line removed");
+        line->removed = true;
+        worker.lines.erase(std::remove(worker.lines.begin(), worker.lines.end(), line), worker.lines.end());
+    }
+    lines.erase(it);
+
+    printf("Removed line %s, managerID: %s\n", lineID.c_str(), managerID.c_str());
+    return Boolean::New(env, true);
+}
+
+Napi::Value IEC101LineManager::SendCommands(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+        Napi::TypeError::New(env, "Expected lineID (string), commands (array of objects) and [slaveAddress (number)]").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto it = lines.find(info[0].As<String>().Utf8Value());
+    if (it == lines.end()) {
+        Napi::Error::New(env, "Unknown line").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::shared_ptr<ManagedLine> line = it->second;
+
+    Napi::Array commands = info[1].As<Napi::Array>();
+    int slaveAddress = line->unbalanced ? line->slaveAddresses[0] : line->otherAddress;
+    if (info.Length() > 2 && info[2].IsNumber()) {
+        slaveAddress = info[2].As<Number>().Int32Value();
+    }
+
+    LineWorker &worker = *workers[line->worker];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!line->open) {
+        Napi::Error::New(env, "Line not open").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (line->unbalanced && !line->slaveStates.count(slaveAddress)) {
+        Napi::Error::New(env, "Unknown slaveAddress for this line").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    CS101_AppLayerParameters alParams = CS101_Master_getAppLayerParameters(line->master);
+    std::vector<CS101_ASDU> asdus;
+
+    for (uint32_t i = 0; i < commands.Length(); i++) {
+        Napi::Value cmdVal = commands[i];
+        if (!cmdVal.IsObject()) {
+            Napi::TypeError::New(env, "Command must be an object").ThrowAsJavaScriptException();
+            break;
+        }
+
+        Napi::Object cmdObj = cmdVal.As<Napi::Object>();
+        if (!cmdObj.Has("typeId") || !cmdObj.Has("ioa")) {
+            Napi::TypeError::New(env, "Each command must have 'typeId' and 'ioa'").ThrowAsJavaScriptException();
+            break;
+        }
+
+        int typeId = cmdObj.Get("typeId").As<Number>().Int32Value();
+        int ioa = cmdObj.Get("ioa").As<Number>().Int32Value();
+        int ca = cmdObj.Has("asdu") ? cmdObj.Get("asdu").As<Number>().Int32Value() : slaveAddress;
+        Napi::Value value = cmdObj.Has("value") ? cmdObj.Get("value") : Napi::Value(Number::New(env, 0));
+        bool select = cmdObj.Has("bselCmd") && cmdObj.Get("bselCmd").ToBoolean().Value();
+        int ql = cmdObj.Has("ql") ? cmdObj.Get("ql").As<Number>().Int32Value() : 0;
+
+        CS101_CauseOfTransmission cot = (typeId == C_RD_NA_1) ? CS101_COT_REQUEST : CS101_COT_ACTIVATION;
+        InformationObject io = nullptr;
+        struct sCP56Time2a time;
+
+        switch (typeId) {
+            case C_SC_NA_1:
+                io = (InformationObject)SingleCommand_create(NULL, ioa, value.ToBoolean().Value(), select, ql);
+                break;
+            case C_DC_NA_1:
+                io = (InformationObject)DoubleCommand_create(NULL, ioa, value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_RC_NA_1:
+                io = (InformationObject)StepCommand_create(NULL, ioa, (StepCommandValue)value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_SE_NA_1:
+                io = (InformationObject)SetpointCommandNormalized_create(NULL, ioa, value.ToNumber().FloatValue(), select, ql);
+                break;
+            case C_SE_NB_1:
+                io = (InformationObject)SetpointCommandScaled_create(NULL, ioa, value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_SE_NC_1:
+                io = (InformationObject)SetpointCommandShort_create(NULL, ioa, value.ToNumber().FloatValue(), select, ql);
+                break;
+            case C_BO_NA_1:
+                io = (InformationObject)Bitstring32Command_create(NULL, ioa, value.ToNumber().Uint32Value());
+                break;
+            case C_IC_NA_1:
+                io = (InformationObject)InterrogationCommand_create(NULL, ioa, cmdObj.Has("value") ? value.ToNumber().Uint32Value() : IEC60870_QOI_STATION);
+                break;
+            case C_CI_NA_1:
+                io = (InformationObject)CounterInterrogationCommand_create(NULL, ioa, value.ToNumber().Uint32Value());
+                break;
+            case C_RD_NA_1:
+                io = (InformationObject)ReadCommand_create(NULL, ioa);
+                break;
+            case C_CS_NA_1:
+                CP56Time2a_createFromMsTimestamp(&time, cmdObj.Has("value") ? value.ToNumber().Int64Value() : Hal_getTimeInMs());
+                io = (InformationObject)ClockSynchronizationCommand_create(NULL, ioa, &time);
+                break;
+            default:
+                break;
+        }
+
+        if (!io) {
+            Napi::TypeError::New(env, "Unsupported command typeId " + to_string(typeId)).ThrowAsJavaScriptException();
+            break;
+        }
+
+        CS101_ASDU asdu = CS101_ASDU_create(alParams, false, cot, line->originatorAddress, ca, false, false);
+        CS101_ASDU_addInformationObject(asdu, io);
+        InformationObject_destroy(io);
+        asdus.push_back(asdu);
+    }
+
+    if (asdus.size() != commands.Length()) {
+        for (CS101_ASDU asdu : asdus) {
+            CS101_ASDU_destroy(asdu);
+        }
+        return env.Undefined();
+    }
+
+    // Отправляет рабочий поток линии: в unbalanced канал слейва принимает один кадр за раз
+    for (CS101_ASDU asdu : asdus) {
+        if (line->unbalanced) {
+            line->pendingAsdus.emplace_back(slaveAddress, asdu);
+        } else {
+            CS101_Master_sendASDU(line->master, asdu);
+            CS101_ASDU_destroy(asdu);
+        }
+    }
+    line->nextStep = 0;
+    Wakeup(worker);
+
+    return Number::New(env, static_cast<double>(asdus.size()));
+}
+
+Napi::Value IEC101LineManager::PollSlave(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected lineID (string) and slaveAddress (number)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto it = lines.find(info[0].As<String>().Utf8Value());
+    if (it == lines.end()) {
+        Napi::Error::New(env, "Unknown line").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::shared_ptr<ManagedLine> line = it->second;
+    int slaveAddress = info[1].As<Number>().Int32Value();
+
+    LineWorker &worker = *workers[line->worker];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!line->open || !line->unbalanced) {
+        Napi::Error::New(env, "Line not open or not unbalanced").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    CS101_Master_pollSingleSlave(line->master, slaveAddress);
+    line->nextStep = 0;
+    Wakeup(worker);
+
+    return Boolean::New(env, true);
+}
+
+Napi::Value IEC101LineManager::GetStatus(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Object status = Object::New(env);
+    status.Set("managerID", String::New(env, managerID.c_str()));
+    status.Set("running", Boolean::New(env, running.load()));
+    status.Set("threads", Number::New(env, static_cast<double>(workers.size())));
+    status.Set("tickMs", Number::New(env, tickMs));
+
+    Napi::Array workerArray = Napi::Array::New(env, workers.size());
+    Napi::Array lineArray = Napi::Array::New(env);
+    uint32_t lineIndex = 0;
+    for (size_t i = 0; i < workers.size(); i++) {
+        LineWorker &worker = *workers[i];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        Object w = Object::New(env);
+        w.Set("lines", Number::New(env, static_cast<double>(worker.lines.size())));
+        w.Set("wakeups", Number::New(env, static_cast<double>(worker.wakeups.load())));
+        w.Set("steps", Number::New(env, static_cast<double>(worker.steps.load())));
+        workerArray[i] = w;
+
+        for (auto &line : worker.lines) {
+            Object l = Object::New(env);
+            l.Set("lineID", String::New(env, line->lineID.c_str()));
+            l.Set("portName", String::New(env, line->portName.c_str()));
+            l.Set("mode", String::New(env, line->unbalanced ? "unbalanced" : "balanced"));
+            l.Set("worker", Number::New(env, static_cast<double>(i)));
+            l.Set("open", Boolean::New(env, line->open));
+            l.Set("openAttempts", Number::New(env, static_cast<double>(line->openAttempts)));
+            l.Set("steps", Number::New(env, static_cast<double>(line->steps)));
+            l.Set("asdusReceived", Number::New(env, static_cast<double>(line->asdusReceived)));
+            l.Set("pendingCommands", Number::New(env, static_cast<double>(line->pendingAsdus.size())));
+
+            Napi::Array slaves = Napi::Array::New(env);
+            uint32_t slaveIndex = 0;
+            for (const auto &[addr, state] : line->slaveStates) {
+                Object slave = Object::New(env);
+                slave.Set("slaveAddress", Number::New(env, addr));
+                slave.Set("state", Number::New(env, state));
+                struct sLinkLayerPollingStatistics stats;
+                if (line->unbalanced && line->open && CS101_Master_getSlavePollingStatistics(line->master, addr, &stats)) {
+                    slave.Set("class1Requests", Number::New(env, stats.class1Requests));
+                    slave.Set("class2Requests", Number::New(env, stats.class2Requests));
+                    slave.Set("timeouts", Number::New(env, stats.timeouts));
+                    slave.Set("backoffMs", Number::New(env, stats.backoff));
+                    slave.Set("avgScanCycleMs", Number::New(env, stats.avgScanCycle));
+                }
+                slaves[slaveIndex++] = slave;
+            }
+            l.Set("slaves", slaves);
+            lineArray[lineIndex++] = l;
+        }
+    }
+    status.Set("workers", workerArray);
+    status.Set("lines", lineArray);
+    status.Set("batching", batcher.GetStats(env));
+    return status;
+}
+
+void IEC101LineManager::Wakeup(LineWorker &worker) {
+#ifndef _WIN32
+    uint8_t b = 1;
+    if (write(worker.wakeupPipe[1], &b, 1) < 0) {
+        // Канал уже полон — поток и так проснётся
+    }
+#endif
+}
+
+void IEC101LineManager::WorkerLoop(LineWorker &worker) {
+#ifndef _WIN32
+    std::vector<struct pollfd> fds;
+#endif
+    std::vector<std::shared_ptr<ManagedLine>> polled;
+
+    while (running) {
+        polled.clear();
+
+        // Ждём до ближайшего таймера канального уровня или повторного открытия порта среди линий потока
+        uint64_t wakeAt = UINT64_MAX;
+#ifndef _WIN32
+        fds.clear();
+        fds.push_back({worker.wakeupPipe[0], POLLIN, 0});
+#endif
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (auto &line : worker.lines) {
+                wakeAt = std::min(wakeAt, line->open ? line->nextStep : line->nextOpenAttempt);
+#ifndef _WIN32
+                int fd = line->open ? SerialPort_getFd(line->serialPort) : -1;
+                if (fd >= 0) {
+                    fds.push_back({fd, POLLIN, 0});
+                    polled.push_back(line);
+                }
+#endif
+            }
+        }
+        uint64_t before = Hal_getTimeInMs();
+        int timeoutMs = wakeAt == UINT64_MAX ? -1 : static_cast<int>(std::min<uint64_t>(wakeAt > before ? wakeAt - before : 0, INT32_MAX));
+
+#ifndef _WIN32
+        int ret = poll(fds.data(), fds.size(), timeoutMs);
+        if (ret > 0 && (fds[0].revents & POLLIN)) {
+            uint8_t drain[64];
+            while (read(worker.wakeupPipe[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+#else
+        // Нет poll() для COM-портов: StepLine назначает шаг линии раз в tickMs
+        Sleep(static_cast<DWORD>(timeoutMs < 0 ? tickMs : std::min(timeoutMs, tickMs)));
+#endif
+        worker.wakeups++;
+
+        if (!running)
+            break;
+
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        uint64_t now = Hal_getTimeInMs();
+
+#ifndef _WIN32
+        // Линии с принятыми байтами обрабатываются сразу, пропавший порт (например, USB-адаптер) переоткрывается
+        for (size_t i = 0; i < polled.size(); i++) {
+            ManagedLine &line = *polled[i];
+            short revents = fds[i + 1].revents;
+            if (line.removed || !line.open)
+                continue;
+            if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                CloseLine(line, "serial port error");
+                line.nextOpenAttempt = now + static_cast<uint64_t>(line.reconnectDelay) * 1000;
+            } else if (revents & POLLIN) {
+                line.nextStep = 0;
+            }
+        }
+#endif
+
+        for (auto &line : worker.lines) {
+            if (!line->open) {
+                if (now >= line->nextOpenAttempt)
+                    OpenLine(*line, now);
+                continue;
+            }
+            if (line->nextStep > now)
+                continue;
+            StepLine(*line, now);
+            worker.steps++;
+        }
+    }
+}
+
+bool IEC101LineManager::OpenLine(ManagedLine &line, uint64_t now) {
+    line.openAttempts++;
+    line.serialPort = SerialPort_create(line.portName.c_str(), line.baudRate, 8, line.parity, 1);
+    if (!line.serialPort || !SerialPort_open(line.serialPort)) {
+        if (line.serialPort) {
+            SerialPort_destroy(line.serialPort);
+            line.serialPort = nullptr;
+        }
+        line.nextOpenAttempt = now + static_cast<uint64_t>(line.reconnectDelay) * 1000;
+        printf("Serial port %s failed to open, line %s, managerID: %s\n", line.portName.c_str(), line.lineID.c_str(), managerID.c_str());
+        EmitControl(line, "reconnecting", string("attempt ") + to_string(line.openAttempts), -1);
+        return false;
+    }
+
+    struct sLinkLayerParameters llParams;
+    llParams.addressLength = 1;
+    llParams.timeoutForAck = line.t1 * 1000;
+    llParams.timeoutRepeat = line.t2 * 1000;
+    llParams.timeoutLinkState = line.t0 * 1000;
+    llParams.useSingleCharACK = true;
+
+    // Размеры полей ASDU как у IEC101MasterUnbalanced / IEC101MasterBalanced
+    struct sCS101_AppLayerParameters alParams;
+    alParams.sizeOfTypeId = 1;
+    alParams.sizeOfVSQ = 1;
+    alParams.sizeOfCOT = line.unbalanced ? 1 : 2;
+    alParams.originatorAddress = line.originatorAddress;
+    alParams.sizeOfCA = line.unbalanced ? 1 : 2;
+    alParams.sizeOfIOA = line.unbalanced ? 2 : 3;
+    alParams.maxSizeOfASDU = 249;
+
+    line.master = CS101_Master_createEx(line.serialPort, &llParams, &alParams,
+                                        line.unbalanced ? IEC60870_LINK_LAYER_UNBALANCED : IEC60870_LINK_LAYER_BALANCED, line.queueSize);
+    if (!line.master) {
+        SerialPort_close(line.serialPort);
+        SerialPort_destroy(line.serialPort);
+        line.serialPort = nullptr;
+        line.nextOpenAttempt = now + static_cast<uint64_t>(line.reconnectDelay) * 1000;
+        EmitControl(line, "error", "Failed to create master object", -1);
+        return false;
+    }
+
+    // Рабочий поток lib60870 не запускается: линию шагает поток менеджера (CS101_Master_runNonBlocking)
+    CS101_Master_setASDUReceivedHandler(line.master, RawMessageHandler, &line);
+    CS101_Master_setLinkLayerStateChanged(line.master, LinkLayerStateChanged, &line);
+    CS101_Master_setOwnAddress(line.master, line.linkAddress);
+
+    if (line.unbalanced) {
+        CS101_Master_setAutoPolling(line.master, line.autoPoll, line.pollBackoffMin, line.pollBackoffMax);
+        for (int slaveAddr : line.slaveAddresses) {
+            CS101_Master_addSlave(line.master, slaveAddr);
+            if (line.slavePriorities.count(slaveAddr))
+                CS101_Master_setSlavePriority(line.master, slaveAddr, line.slavePriorities[slaveAddr]);
+            line.slaveStates[slaveAddr] = LL_STATE_IDLE;
+        }
+    } else {
+        CS101_Master_setDIR(line.master, true);
+        CS101_Master_useSlaveAddress(line.master, line.otherAddress);
+        line.slaveStates[line.otherAddress] = LL_STATE_IDLE;
+    }
+
+    line.open = true;
+    line.nextStep = 0;
+    printf("Line %s opened on %s, managerID: %s\n", line.lineID.c_str(), line.portName.c_str(), managerID.c_str());
+    EmitControl(line, "portOpened", "serial port opened", -1);
+    return true;
+}
+
+void IEC101LineManager::CloseLine(ManagedLine &line, const std::string &reason) {
+    if (!line.open)
+        return;
+
+    CS101_Master_destroy(line.master);
+    SerialPort_close(line.serialPort);
+    SerialPort_destroy(line.serialPort);
+    line.master = nullptr;
+    line.serialPort = nullptr;
+    line.open = false;
+
+    for (auto &pending : line.pendingAsdus) {
+        CS101_ASDU_destroy(pending.second);
+    }
+    line.pendingAsdus.clear();
+    line.slaveStates.clear();
+
+    printf("Line %s closed: %s, managerID: %s\n", line.lineID.c_str(), reason.c_str(), managerID.c_str());
+    EmitControl(line, "portClosed", reason, -1);
+}
+
+void IEC101LineManager::StepLine(ManagedLine &line, uint64_t now) {
+    // Команды слейвам unbalanced-линии: следующий кадр — только в свободный канал слейва
+    for (auto it = line.pendingAsdus.begin(); it != line.pendingAsdus.end();) {
+        int slaveAddress = it->first;
+        bool earlier = false;
+        for (auto prev = line.pendingAsdus.begin(); prev != it; ++prev) {
+            if (prev->first == slaveAddress) {
+                earlier = true;
+                break;
+            }
+        }
+        if (!earlier && CS101_Master_isChannelReady(line.master, slaveAddress)) {
+            CS101_Master_useSlaveAddress(line.master, slaveAddress);
+            CS101_Master_sendASDU(line.master, it->second);
+            CS101_ASDU_destroy(it->second);
+            it = line.pendingAsdus.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    CS101_Master_runNonBlocking(line.master);
+
+    line.steps++;
+#ifndef _WIN32
+    // Следующий шаг — по приёму байтов (poll) или по ближайшему таймеру канального уровня
+    // (ожидание ответа и повтор, опрос слейва после back-off, тест канала)
+    line.nextStep = CS101_Master_getNextTimeout(line.master);
+    // Канал слейва с ожидающей командой освободился в этом шаге: команда уходит следующим шагом
+    for (const auto &pending : line.pendingAsdus) {
+        if (CS101_Master_isChannelReady(line.master, pending.first)) {
+            line.nextStep = now;
+            break;
+        }
+    }
+#else
+    line.nextStep = now + static_cast<uint64_t>(tickMs);
+#endif
+}
+
+void IEC101LineManager::EmitControl(const ManagedLine &line, const std::string &event, const std::string &reason, int slaveAddress) {
+    std::string lineID = line.lineID;
+    tsfn.NonBlockingCall([lineID, event, reason, slaveAddress](Napi::Env env, Function jsCallback) {
+        Object eventObj = Object::New(env);
+        eventObj.Set("lineID", String::New(env, lineID.c_str()));
+        eventObj.Set("type", String::New(env, "control"));
+        eventObj.Set("event", String::New(env, event));
+        eventObj.Set("reason", String::New(env, reason));
+        if (slaveAddress >= 0) {
+            eventObj.Set("slaveAddress", Number::New(env, slaveAddress));
+        }
+        std::vector<napi_value> args = {String::New(env, "data"), eventObj};
+        jsCallback.Call(args);
+    });
+}
+
+Napi::Object IEC101LineManager::PointObject(Napi::Env env, const PointRecord &p) {
+    Napi::Object msg = Napi::Object::New(env);
+    if (p.line >= 0 && static_cast<size_t>(p.line) < lineNames.size()) {
+        msg.Set("lineID", String::New(env, lineNames[p.line].c_str()));
+    }
+    msg.Set("typeId", Number::New(env, p.typeId));
+    msg.Set("asdu", Number::New(env, p.ca));
+    msg.Set("ioa", Number::New(env, p.ioa));
+    msg.Set("val", Number::New(env, p.val));
+    msg.Set("quality", Number::New(env, p.quality));
+    msg.Set("slaveAddress", Number::New(env, p.source));
+    if (p.timestamp > 0) {
+        msg.Set("timestamp", Number::New(env, static_cast<double>(p.timestamp)));
+    }
+    return msg;
+}
+
+void IEC101LineManager::EmitBatch(Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+    Napi::Array jsArray = Napi::Array::New(env, points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        jsArray[i] = PointObject(env, points[i]);
+    }
+    std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+    jsCallback.Call(args);
+    cnt++;
+}
+
+void IEC101LineManager::LinkLayerStateChanged(void *parameter, int address, LinkLayerState state) {
+    ManagedLine *line = static_cast<ManagedLine *>(parameter);
+    std::string eventStr;
+    std::string reason;
+
+    switch (state) {
+        case LL_STATE_ERROR:
+            eventStr = "failed";
+            reason = "link layer error";
+            break;
+        case LL_STATE_AVAILABLE:
+            eventStr = "opened";
+            reason = "link layer available";
+            break;
+        case LL_STATE_BUSY:
+            eventStr = "busy";
+            reason = "link layer busy";
+            break;
+        case LL_STATE_IDLE:
+            eventStr = "closed";
+            reason = "link layer idle";
+            break;
+    }
+
+    // Вызывается потоком линии под mutex рабочего потока
+    if (!line->unbalanced && address < 0) {
+        address = line->otherAddress;
+    }
+    line->slaveStates[address] = state;
+
+    printf("Link layer event: %s, line %s, slaveAddress: %d\n", eventStr.c_str(), line->lineID.c_str(), address);
+    line->manager->EmitControl(*line, eventStr, reason, address);
+}
+
+bool IEC101LineManager::RawMessageHandler(void *parameter, int address, CS101_ASDU asdu) {
+    ManagedLine *line = static_cast<ManagedLine *>(parameter);
+    IEC101LineManager *manager = line->manager;
+    LineWorker &worker = *manager->workers[line->worker];
+
+    IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
+    int ca = CS101_ASDU_getCA(asdu);
+    int cot = CS101_ASDU_getCOT(asdu);
+    int slaveAddress = line->unbalanced ? address : line->otherAddress;
+    int index = line->index;
+
+    line->asdusReceived++;
+
+    // Точки декодируются в буфер рабочего потока без выделения памяти
+    DecodedPoints &elements = worker.decodedPoints;
+    DecodeMonitoringASDU(asdu, worker.decodeBuffer, worker.dayCache, elements);
+    if (elements.empty())
+        return true;
+
+    if (manager->batcher.IsEnabled()) {
+        manager->batcher.Append(elements.size(), [&](size_t i) {
+            const auto& [ioa, val, quality, timestamp] = elements[i];
+            PointRecord record{typeID, ca, cot, ioa, val, quality, timestamp, slaveAddress};
+            record.line = index;
+            return record;
+        });
+        return true;
+    }
+
+    DecodedPoints *points = manager->pointsPool.Acquire(elements);
+    if (manager->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
+        Napi::Array jsArray = Napi::Array::New(env, points->size());
+        for (size_t i = 0; i < points->size(); i++) {
+            const auto& [ioa, val, quality, timestamp] = (*points)[i];
+            PointRecord record{typeID, ca, cot, ioa, val, quality, timestamp, slaveAddress};
+            record.line = index;
+            jsArray[i] = manager->PointObject(env, record);
+        }
+        manager->pointsPool.Release(points);
+        std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+        jsCallback.Call(args);
+        manager->cnt++;
+    }) != napi_ok)
+        manager->pointsPool.Release(points);
+    return true;
+}
@@ -0,0 +1,118 @@
+#ifndef CS101_LINE_MANAGER_H
+#define CS101_LINE_MANAGER_H
+
+#include <napi.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+
+extern "C" {
+#include "hal_serial.h"
+#include "cs101_master.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+}
+
+// Много последовательных линий CS101 (master, balanced или unbalanced) на нескольких потоках.
+// Каждый рабочий поток ждёт данные всех своих портов одним poll() и продвигает автомат
+// канального уровня линии (CS101_Master_runNonBlocking) только по готовности порта или по таймеру,
+// поэтому число потоков не зависит от числа линий.
+class IEC101LineManager : public Napi::ObjectWrap<IEC101LineManager> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    IEC101LineManager(const Napi::CallbackInfo& info);
+    virtual ~IEC101LineManager();
+    void Teardown();
+
+private:
+
+    // Линия под управлением менеджера. Состояние меняется только под mutex своего рабочего потока.
+    struct ManagedLine {
+        IEC101LineManager *manager = nullptr;
+        size_t worker = 0;          // Индекс рабочего потока, который ведёт линию
+        int index = 0;              // Номер линии (PointRecord.line)
+        std::string lineID;
+        std::string portName;
+        int baudRate = 9600;
+        char parity = 'E';
+        bool unbalanced = true;
+        int linkAddress = 3;
+        int otherAddress = 3;       // Адрес станции на другой стороне (balanced)
+        int originatorAddress = 1;
+        int t0 = 120;
+        int t1 = 60;
+        int t2 = 40;
+        int queueSize = 1000;
+        int reconnectDelay = 10;
+        bool autoPoll = true;
+        int pollBackoffMin = 1000;
+        int pollBackoffMax = 60000;
+        std::vector<int> slaveAddresses;
+        std::map<int, int> slavePriorities;
+
+        SerialPort serialPort = nullptr;
+        CS101_Master master = nullptr;
+        bool open = false;
+        bool removed = false;
+        uint64_t nextOpenAttempt = 0;
+        uint64_t nextStep = 0;
+        std::map<int, LinkLayerState> slaveStates;
+        std::deque<std::pair<int, CS101_ASDU>> pendingAsdus; // Ждут свободного канала слейва (unbalanced)
+        uint64_t steps = 0;
+        uint64_t asdusReceived = 0;
+        uint64_t openAttempts = 0;
+    };
+
+    struct LineWorker {
+        std::thread thread;
+        std::mutex mutex;           // Линии потока и их состояние
+        std::vector<std::shared_ptr<ManagedLine>> lines;
+        int wakeupPipe[2] = {-1, -1};
+        IODecodeBuffer decodeBuffer; // Буфер для CS101_ASDU_getElementEx (только этот поток)
+        CP56Time2aDayCache dayCache = {0, 0}; // Последние сутки для CP56Time2a_toMsTimestampCached (только этот поток)
+        DecodedPoints decodedPoints; // Точки текущего ASDU (только этот поток)
+        std::atomic<uint64_t> wakeups{0};
+        std::atomic<uint64_t> steps{0};
+    };
+
+    std::vector<std::unique_ptr<LineWorker>> workers;
+    std::map<std::string, std::shared_ptr<ManagedLine>> lines; // Только из JS-потока
+    std::vector<std::string> lineNames;                        // Номер линии -> lineID (только из JS-потока)
+    std::atomic<bool> running;
+    int tickMs = 10;
+    std::string managerID;
+    int cnt = 0;
+    Napi::ThreadSafeFunction tsfn;
+    EventBatcher<PointRecord> batcher; // Пакетная передача точек в JS (batchSize/batchLatency)
+    DecodedPointsPool pointsPool;      // Векторы точек для передачи ASDU в JS без batcher
+
+    void WorkerLoop(LineWorker &worker);
+    void Wakeup(LineWorker &worker);
+    bool OpenLine(ManagedLine &line, uint64_t now);
+    void CloseLine(ManagedLine &line, const std::string &reason);
+    void StepLine(ManagedLine &line, uint64_t now);
+    void EmitControl(const ManagedLine &line, const std::string &event, const std::string &reason, int slaveAddress);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord>& points);
+    Napi::Object PointObject(Napi::Env env, const PointRecord &p);
+    void Shutdown();
+
+    static bool RawMessageHandler(void *parameter, int address, CS101_ASDU asdu);
+    static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state);
+
+    Napi::Value Start(const Napi::CallbackInfo& info);
+    Napi::Value Stop(const Napi::CallbackInfo& info);
+    Napi::Value AddLine(const Napi::CallbackInfo& info);
+    Napi::Value RemoveLine(const Napi::CallbackInfo& info);
+    Napi::Value SendCommands(const Napi::CallbackInfo& info);
+    Napi::Value PollSlave(const Napi::CallbackInfo& info);
+    Napi::Value GetStatus(const Napi::CallbackInfo& info);
+};
+
+#endif // CS101_LINE_MANAGER_H
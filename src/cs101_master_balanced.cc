@@ -9,8 +9,13 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <stdexcept>
 #include <vector>
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+#include "addon_data.h"
+#include "deadband_filter.h"
 
 extern "C"
 {
@@ -32,8 +37,7 @@ public:
     static Object Init(Napi::Env env, Object exports);
     IEC101MasterBalanced(const CallbackInfo &info);
     ~IEC101MasterBalanced();
-
-    static FunctionReference constructor;
+    void Teardown();
 
 private:
     CS101_Master master;
@@ -41,16 +45,24 @@ private:
     std::thread _thread;
     std::atomic<bool> running;
     std::mutex connMutex;
+    std::condition_variable linkCv; // Будит поток соединения при потере связи или остановке
     bool connected = false;
     bool activated = false;
     int clientId = 0;
     std::string clientID;
     int cnt = 0;
     ThreadSafeFunction tsfn;
+    IODecodeBuffer decodeBuffer; // Буфер для CS101_ASDU_getElementEx (используется только потоком канального уровня)
+    DecodedPoints decodedPoints; // Точки текущего ASDU и векторы для передачи в JS (поток канального уровня)
+    DecodedPointsPool pointsPool;
+    CP56Time2aDayCache dayCache = {0, 0}; // Последние сутки для CP56Time2a_toMsTimestampCached (поток канального уровня)
+    EventBatcher<PointRecord> batcher; // Пакетная передача точек в JS (batchSize/batchLatency)
+    DeadbandFilter deadband; // Зона нечувствительности аналоговых точек (params.deadband)
     int asduAddress = 1; // Поле класса для хранения адреса ASDU
 
     static bool RawMessageHandler(void *parameter, int address, CS101_ASDU asdu);
     static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state);
+    void EmitBatch(Napi::Env env, Function jsCallback, const vector<PointRecord> &points);
 
     Napi::Value Connect(const CallbackInfo &info);
     Napi::Value Disconnect(const CallbackInfo &info);
@@ -60,8 +72,6 @@ private:
     Napi::Value GetStatus(const CallbackInfo &info);
 };
 
-FunctionReference IEC101MasterBalanced::constructor;
-
 Object IEC101MasterBalanced::Init(Napi::Env env, Object exports)
 {
     Function func = DefineClass(env, "IEC101MasterBalanced", {
@@ -73,8 +83,7 @@ Object IEC101MasterBalanced::Init(Napi::Env env, Object exports)
         InstanceMethod("getStatus", &IEC101MasterBalanced::GetStatus)
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    GetAddonData(env)->iec101MasterBalanced = Persistent(func);
     exports.Set("IEC101MasterBalanced", func);
     return exports;
 }
@@ -102,13 +111,25 @@ IEC101MasterBalanced::IEC101MasterBalanced(const CallbackInfo &info) : ObjectWra
     } catch (const std::exception& e) {
         printf("Failed to create ThreadSafeFunction: %s\n", e.what());
         Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
     }
+    AddTeardownHook(info.Env(), this);
 }
 
 IEC101MasterBalanced::~IEC101MasterBalanced()
 {
-    std::lock_guard<std::mutex> lock(connMutex);
-    if (running) {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает.
+// Поток соединения берёт connMutex, поэтому join — после выхода из блокировки, как в Disconnect.
+void IEC101MasterBalanced::Teardown()
+{
+    {
+        std::lock_guard<std::mutex> lock(connMutex);
+        if (!running)
+            return;
         running = false;
         if (connected) {
             printf("Destructor closing connection, clientID: %s, clientId: %i\n", clientID.c_str(), clientId);
@@ -118,11 +139,13 @@ IEC101MasterBalanced::~IEC101MasterBalanced()
             connected = false;
             activated = false;
         }
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-        tsfn.Release();
     }
+    linkCv.notify_all();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    batcher.Stop();
+    tsfn.Release();
 }
 
 Napi::Value IEC101MasterBalanced::Connect(const CallbackInfo &info)
@@ -224,6 +247,19 @@ Napi::Value IEC101MasterBalanced::Connect(const CallbackInfo &info)
         }
     }
 
+    // Пакетная передача данных в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = config.Has("params") && config.Get("params").IsObject() ? config.Get("params").As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string deadbandError = deadband.Configure(batchParams);
+    if (!deadbandError.empty()) {
+        Napi::Error::New(env, deadbandError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
     try {
         printf("Creating serial connection to %s, baudRate: %d, clientID: %s, clientId: %i\n", portName.c_str(), baudRate, clientID.c_str(), clientId);
         fflush(stdout);
@@ -270,6 +306,9 @@ Napi::Value IEC101MasterBalanced::Connect(const CallbackInfo &info)
         fflush(stdout);
 
         running = true;
+        batcher.Start(tsfn, [this](Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+            EmitBatch(env, jsCallback, points);
+        });
         _thread = std::thread([this, portName, baudRate, linkAddress, originatorAddress, t0, t1, t2, reconnectDelay, maxRetries, queueSize]() {
             try {
                 int retryCount = 0;
@@ -287,13 +326,12 @@ Napi::Value IEC101MasterBalanced::Connect(const CallbackInfo &info)
                             activated = true; // В Balanced Mode активация автоматическая
                         }
 
-                        while (running) {
-                            CS101_Master_run(master);
-                            Thread_sleep(100);
-                            {
-                                std::lock_guard<std::mutex> lock(this->connMutex);
-                                if (!connected) break;
-                            }
+                        // Канальный уровень ведёт рабочий поток lib60870 (CS101_Master_start): он ждёт
+                        // готовности порта и продвигает автоматы link_layer.c сразу по приходу байтов.
+                        // Здесь только ждём потери связи или остановки.
+                        {
+                            std::unique_lock<std::mutex> lock(this->connMutex);
+                            linkCv.wait(lock, [this] { return !running || !connected; });
                         }
 
                         std::lock_guard<std::mutex> lock(this->connMutex);
@@ -440,10 +478,14 @@ Napi::Value IEC101MasterBalanced::Disconnect(const CallbackInfo &info)
         }
     }
 
+    linkCv.notify_all();
+
     if (_thread.joinable()) {
         _thread.join();
     }
 
+    batcher.Stop();
+
     std::lock_guard<std::mutex> lock(connMutex);
     tsfn.Release();
 
@@ -811,9 +853,34 @@ Napi::Value IEC101MasterBalanced::GetStatus(const CallbackInfo &info)
     status.Set("activated", Boolean::New(env, activated));
     status.Set("clientId", Number::New(env, clientId));
     status.Set("clientID", String::New(env, clientID.c_str()));
+    status.Set("batching", batcher.GetStats(env));
+    if (deadband.IsEnabled())
+        status.Set("deadband", deadband.GetStats(env));
     return status;
 }
 
+void IEC101MasterBalanced::EmitBatch(Napi::Env env, Function jsCallback, const vector<PointRecord> &points)
+{
+    Napi::Array jsArray = Napi::Array::New(env, points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        const PointRecord &p = points[i];
+        Napi::Object msg = Napi::Object::New(env);
+        msg.Set("clientID", String::New(env, clientID.c_str()));
+        msg.Set("typeId", Number::New(env, p.typeId));
+        msg.Set("asdu", Number::New(env, p.ca));
+        msg.Set("ioa", Number::New(env, p.ioa));
+        msg.Set("val", Number::New(env, p.val));
+        msg.Set("quality", Number::New(env, p.quality));
+        if (p.timestamp > 0) {
+            msg.Set("timestamp", Number::New(env, static_cast<double>(p.timestamp)));
+        }
+        jsArray[i] = msg;
+    }
+    std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+    jsCallback.Call(args);
+    cnt++;
+}
+
 void IEC101MasterBalanced::LinkLayerStateChanged(void *parameter, int address, LinkLayerState state)
 {
     IEC101MasterBalanced *client = static_cast<IEC101MasterBalanced *>(parameter);
@@ -849,6 +916,8 @@ void IEC101MasterBalanced::LinkLayerStateChanged(void *parameter, int address, L
         }
     }
 
+    client->linkCv.notify_all();
+
     printf("Link layer event: %s, reason: %s, clientID: %s, clientId: %i\n", eventStr.c_str(), reason.c_str(), client->clientID.c_str(), client->clientId);
 
     client->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
@@ -870,229 +939,216 @@ bool IEC101MasterBalanced::RawMessageHandler(void *parameter, int address, CS101
     int receivedAsduAddress = CS101_ASDU_getCA(asdu); // Получаем адрес ASDU из полученного сообщения
 
     try {
-        vector<tuple<int, double, uint8_t, uint64_t>> elements;
+        // Точки декодируются в буфер соединения без выделения памяти
+        DecodedPoints &elements = client->decodedPoints;
+        elements.clear();
+        elements.reserve(numberOfElements);
 
         switch (typeID) {
             case M_SP_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElement(asdu, i);
+                    SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = SinglePointInformation_getValue(io) ? 1.0 : 0.0;
                         uint8_t quality = SinglePointInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        SinglePointInformation_destroy(io);
                     }
                 }
                 break;
 
             case M_DP_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElement(asdu, i);
+                    DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(DoublePointInformation_getValue(io));
                         uint8_t quality = DoublePointInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        DoublePointInformation_destroy(io);
                     }
                 }
                 break;
 
             case M_ST_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElement(asdu, i);
+                    StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(StepPositionInformation_getValue(io));
                         uint8_t quality = StepPositionInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        StepPositionInformation_destroy(io);
                     }
                 }
                 break;
 
             case M_BO_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    BitString32 io = (BitString32)CS101_ASDU_getElement(asdu, i);
+                    BitString32 io = (BitString32)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(BitString32_getValue(io));
                         uint8_t quality = BitString32_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        BitString32_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueNormalized_getValue(io);
                         uint8_t quality = MeasuredValueNormalized_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueNormalized_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_NB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueScaled_getValue(io);
                         uint8_t quality = MeasuredValueScaled_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueScaled_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_NC_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueShort_getValue(io);
                         uint8_t quality = MeasuredValueShort_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueShort_destroy(io);
                     }
                 }
                 break;
 
             case M_IT_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElement(asdu, i);
+                    IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = BinaryCounterReading_getValue(IntegratedTotals_getBCR(io));
                         uint8_t quality = IEC60870_QUALITY_GOOD;
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        IntegratedTotals_destroy(io);
                     }
                 }
                 break;
 
             case M_SP_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0;
                         uint8_t quality = SinglePointInformation_getQuality((SinglePointInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(SinglePointWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(SinglePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        SinglePointWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_DP_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(DoublePointInformation_getValue((DoublePointInformation)io));
                         uint8_t quality = DoublePointInformation_getQuality((DoublePointInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(DoublePointWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(DoublePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        DoublePointWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_ST_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(StepPositionInformation_getValue((StepPositionInformation)io));
                         uint8_t quality = StepPositionInformation_getQuality((StepPositionInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(StepPositionWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(StepPositionWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        StepPositionWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_BO_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(BitString32_getValue((BitString32)io));
                         uint8_t quality = BitString32_getQuality((BitString32)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(Bitstring32WithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(Bitstring32WithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        Bitstring32WithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_TD_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueNormalized_getValue((MeasuredValueNormalized)io);
                         uint8_t quality = MeasuredValueNormalized_getQuality((MeasuredValueNormalized)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueNormalizedWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_TE_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueScaled_getValue((MeasuredValueScaled)io);
                         uint8_t quality = MeasuredValueScaled_getQuality((MeasuredValueScaled)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueScaledWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueScaledWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_ME_TF_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueShort_getValue((MeasuredValueShort)io);
                         uint8_t quality = MeasuredValueShort_getQuality((MeasuredValueShort)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueShortWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueShortWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
 
             case M_IT_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = BinaryCounterReading_getValue(IntegratedTotals_getBCR((IntegratedTotals)io));
                         uint8_t quality = IEC60870_QUALITY_GOOD;
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(IntegratedTotalsWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        IntegratedTotalsWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
@@ -1102,15 +1158,30 @@ bool IEC101MasterBalanced::RawMessageHandler(void *parameter, int address, CS101
                 return true;
         }
 
+        CS101_CauseOfTransmission cot = CS101_ASDU_getCOT(asdu);
+        // Значения внутри зоны нечувствительности в JS не передаются
+        client->deadband.Apply(typeID, cot, receivedAsduAddress, elements);
+        if (elements.empty())
+            return true;
+
         for (const auto& [ioa, val, quality, timestamp] : elements) {
             printf("ASDU type: %s, clientID: %s, clientId: %i, asduAddress: %d, ioa: %i, value: %f, quality: %u, timestamp: %" PRIu64 ", cnt: %i\n",
                    TypeID_toString(typeID), client->clientID.c_str(), client->clientId, receivedAsduAddress, ioa, val, quality, timestamp, client->cnt);
         }
 
-        client->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
-            Napi::Array jsArray = Napi::Array::New(env, elements.size());
-            for (size_t i = 0; i < elements.size(); i++) {
+        if (client->batcher.IsEnabled()) {
+            client->batcher.Append(elements.size(), [&](size_t i) {
                 const auto& [ioa, val, quality, timestamp] = elements[i];
+                return PointRecord{typeID, receivedAsduAddress, cot, ioa, val, quality, timestamp, 0};
+            });
+            return true;
+        }
+
+        DecodedPoints *points = client->pointsPool.Acquire(elements);
+        if (client->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
+            Napi::Array jsArray = Napi::Array::New(env, points->size());
+            for (size_t i = 0; i < points->size(); i++) {
+                const auto& [ioa, val, quality, timestamp] = (*points)[i];
                 Napi::Object msg = Napi::Object::New(env);
                 msg.Set("clientID", String::New(env, client->clientID.c_str()));
                 msg.Set("typeId", Number::New(env, typeID));
@@ -1123,10 +1194,12 @@ bool IEC101MasterBalanced::RawMessageHandler(void *parameter, int address, CS101
                 }
                 jsArray[i] = msg;
             }
+            client->pointsPool.Release(points);
             std::vector<napi_value> args = {String::New(env, "data"), jsArray};
             jsCallback.Call(args);
             client->cnt++;
-        });
+        }) != napi_ok)
+            client->pointsPool.Release(points);
 
         return true;
     } catch (const std::exception& e) {
@@ -5,7 +5,11 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <vector>
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+#include "deadband_filter.h"
 
 extern "C" {
 #include "hal_serial.h"
@@ -19,25 +23,32 @@ public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     IEC101MasterBalanced(const Napi::CallbackInfo& info);
     virtual ~IEC101MasterBalanced();
+    void Teardown();
 
 private:
-    static Napi::FunctionReference constructor;
-
     CS101_Master master;
     SerialPort serialPort;
     std::thread _thread;
     std::atomic<bool> running;
     std::mutex connMutex;
+    std::condition_variable linkCv; // Будит поток соединения при потере связи или остановке
     bool connected = false;
     bool activated = false;
     int clientId = 0;
     std::string clientID;
     int cnt = 0;
     Napi::ThreadSafeFunction tsfn;
+    IODecodeBuffer decodeBuffer; // Buffer for CS101_ASDU_getElementEx (used by the link layer thread only)
+    DecodedPoints decodedPoints; // Decoded points of the current ASDU and buffers handed to JS
+    DecodedPointsPool pointsPool;
+    CP56Time2aDayCache dayCache = {0, 0}; // Last day for CP56Time2a_toMsTimestampCached (link layer thread)
+    EventBatcher<PointRecord> batcher; // Batched delivery of points to JS (batchSize/batchLatency)
+    DeadbandFilter deadband; // Deadband for analog points (params.deadband)
     int asduAddress = 1; // Class field for storing ASDU address
 
     static bool RawMessageHandler(void *parameter, int address, CS101_ASDU asdu);
     static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord>& points);
 
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value Disconnect(const Napi::CallbackInfo& info);
@@ -6,12 +6,16 @@
 
 #include <inttypes.h>
 #include <cs101_master_unbalanced.h>
+#include "addon_data.h"
 #include <napi.h>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <stdexcept>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <chrono>
 #include <map> 
 
 extern "C" {
@@ -29,7 +33,6 @@ using namespace std;
 
 
 
-FunctionReference IEC101MasterUnbalanced::constructor;
 
 Object IEC101MasterUnbalanced::Init(Napi::Env env, Object exports) {
     Function func = DefineClass(env, "IEC101MasterUnbalanced", {
@@ -43,8 +46,7 @@ Object IEC101MasterUnbalanced::Init(Napi::Env env, Object exports) {
         InstanceMethod("pollSlave", &IEC101MasterUnbalanced::PollSlave)
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    GetAddonData(env)->iec101MasterUnbalanced = Persistent(func);
     exports.Set("IEC101MasterUnbalanced", func);
     return exports;
 }
@@ -76,12 +78,23 @@ IEC101MasterUnbalanced::IEC101MasterUnbalanced(const CallbackInfo &info) : Objec
     } catch (const std::exception& e) {
         printf("Failed to create ThreadSafeFunction: %s\n", e.what());
         Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
     }
+    AddTeardownHook(info.Env(), this);
 }
 
 IEC101MasterUnbalanced::~IEC101MasterUnbalanced() {
-    std::lock_guard<std::mutex> lock(connMutex);
-    if (running) {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает.
+// Поток опроса берёт connMutex, поэтому join — после выхода из блокировки, как в Disconnect.
+void IEC101MasterUnbalanced::Teardown() {
+    {
+        std::lock_guard<std::mutex> lock(connMutex);
+        if (!running)
+            return;
         running = false;
         if (connected) {
             printf("Destructor closing connection, clientID: %s\n", clientID.c_str());
@@ -93,11 +106,13 @@ IEC101MasterUnbalanced::~IEC101MasterUnbalanced() {
             slaveStates.clear();
             slaveActivated.clear();
         }
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-        tsfn.Release();
     }
+    WakeConnectionThread();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    batcher.Stop();
+    tsfn.Release();
 }
 
 Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
@@ -152,6 +167,23 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
         if (params.Has("t2")) t2 = params.Get("t2").As<Number>().Int32Value();
         if (params.Has("reconnectDelay")) reconnectDelay = params.Get("reconnectDelay").As<Number>().Int32Value();
         if (params.Has("queueSize")) queueSize = params.Get("queueSize").As<Number>().Int32Value();
+        if (params.Has("autoPoll")) autoPoll = params.Get("autoPoll").ToBoolean().Value();
+        if (params.Has("pollBackoffMin")) pollBackoffMin = params.Get("pollBackoffMin").As<Number>().Int32Value();
+        if (params.Has("pollBackoffMax")) pollBackoffMax = params.Get("pollBackoffMax").As<Number>().Int32Value();
+        if (params.Has("slavePriorities") && params.Get("slavePriorities").IsObject()) {
+            Napi::Object priorities = params.Get("slavePriorities").As<Napi::Object>();
+            Napi::Array keys = priorities.GetPropertyNames();
+            for (uint32_t i = 0; i < keys.Length(); i++) {
+                std::string key = keys.Get(i).ToString().Utf8Value();
+                int addr = atoi(key.c_str());
+                int priority = priorities.Get(key).ToNumber().Int32Value();
+                if (addr < 0 || addr > 255 || priority < 1) {
+                    Napi::RangeError::New(env, "slavePriorities must map slave addresses 0-255 to priorities >= 1").ThrowAsJavaScriptException();
+                    return env.Undefined();
+                }
+                slavePriorities[addr] = priority;
+            }
+        }
         if (params.Has("slaveAddresses") && params.Get("slaveAddresses").IsArray()) {
             Napi::Array slaveAddrArray = params.Get("slaveAddresses").As<Napi::Array>();
             for (uint32_t i = 0; i < slaveAddrArray.Length(); i++) {
@@ -198,6 +230,23 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
         Napi::Error::New(env, "queueSize must be positive").ThrowAsJavaScriptException();
         return env.Undefined();
     }
+    if (pollBackoffMin <= 0 || pollBackoffMax < pollBackoffMin) {
+        Napi::Error::New(env, "pollBackoffMin must be positive and pollBackoffMax not less than pollBackoffMin").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Пакетная передача данных в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = config.Has("params") && config.Get("params").IsObject() ? config.Get("params").As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string deadbandError = deadband.Configure(batchParams);
+    if (!deadbandError.empty()) {
+        Napi::Error::New(env, deadbandError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
     try {
         printf("Creating serial connection to %s, baudRate: %d, clientID: %s\n", portName.c_str(), baudRate, clientID.c_str());
@@ -231,7 +280,9 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
 
         CS101_Master_setASDUReceivedHandler(master, RawMessageHandler, this);
         CS101_Master_setLinkLayerStateChanged(master, LinkLayerStateChanged, this);
+        CS101_Master_setChannelReadyHandler(master, ChannelReady, this);
         CS101_Master_setOwnAddress(master, linkAddress);
+        CS101_Master_setAutoPolling(master, autoPoll, pollBackoffMin, pollBackoffMax);
         printf("Registered RawMessageHandler for master, clientID: %s\n", clientID.c_str());
 
         printf("Connecting with params: linkAddress=%d, originatorAddress=%d, asduAddress=%d, t0=%d, t1=%d, t2=%d, reconnectDelay=%d, queueSize=%d, slaveAddresses=[", 
@@ -243,6 +294,9 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
         printf("], clientID: %s\n", clientID.c_str());
 
         running = true;
+        batcher.Start(tsfn, [this](Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+            EmitBatch(env, jsCallback, points);
+        });
         _thread = std::thread([this, portName, baudRate, linkAddress, t0, t1, t2, reconnectDelay, queueSize, slaveAddresses]() {
             try {
                 int retryCount = 0;
@@ -261,6 +315,8 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
                             activated = true;
                             for (int slaveAddr : slaveAddresses) {
                                 CS101_Master_addSlave(master, slaveAddr);
+                                if (slavePriorities.count(slaveAddr))
+                                    CS101_Master_setSlavePriority(master, slaveAddr, slavePriorities[slaveAddr]);
                                 slaveStates[slaveAddr] = false; // Изначально не AVAILABLE
                                 slaveActivated[slaveAddr] = true; // Активируем слейв
                                 printf("Added slave with address %d, clientID: %s\n", slaveAddr, clientID.c_str());
@@ -268,16 +324,24 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
                         }
 
                         for (int slaveAddr : slaveAddresses) {
-                            CS101_Master_useSlaveAddress(master, slaveAddr);
-                            printf("Sending link layer test function to slave %d, clientID: %s\n", slaveAddr, clientID.c_str());
-                            CS101_Master_sendLinkLayerTestFunction(master);
+                            {
+                                // Disconnect закрывает мастер под connMutex, пока этот поток спит
+                                std::lock_guard<std::mutex> lock(this->connMutex);
+                                if (!running || !connected)
+                                    break;
+                                CS101_Master_useSlaveAddress(master, slaveAddr);
+                                printf("Sending link layer test function to slave %d, clientID: %s\n", slaveAddr, clientID.c_str());
+                                CS101_Master_sendLinkLayerTestFunction(master);
+                            }
                             Thread_sleep(500);
                         }
 
                         {
                             std::lock_guard<std::mutex> lock(this->connMutex);
-                            CS101_AppLayerParameters alParams = CS101_Master_getAppLayerParameters(master);
                             for (int slaveAddr : slaveAddresses) {
+                                if (!running || !connected)
+                                    break;
+                                CS101_AppLayerParameters alParams = CS101_Master_getAppLayerParameters(master);
                                 CS101_Master_useSlaveAddress(master, slaveAddr);
                                 printf("Switched to slave address %d for initial interrogation, clientID: %s\n", slaveAddr, clientID.c_str());
                                 CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_INTERROGATED_BY_STATION, originatorAddress, slaveAddr, false, false);
@@ -304,13 +368,29 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
                             jsCallback.Call(args);
                         });
 
-                        while (running) {
-                            CS101_Master_run(master);
-                            Thread_sleep(100);
+                        // Канальный уровень ведёт рабочий поток lib60870 (CS101_Master_start): он ждёт
+                        // готовности порта и продвигает автоматы link_layer.c сразу по приходу байтов.
+                        // Здесь обслуживаем очереди команд слейвов до потери связи или остановки. Поток
+                        // просыпается по WakeConnectionThread (в том числе когда канал слейва освободился)
+                        // или по ближайшему таймауту команды.
+                        while (true) {
+                            uint64_t wakeAt;
                             {
                                 std::lock_guard<std::mutex> lock(this->connMutex);
-                                if (!connected) break;
+                                if (!running || !connected) {
+                                    FailCommandQueues(running ? "Connection lost" : "Connection closed");
+                                    break;
+                                }
+                                wakeAt = ServeCommandQueues();
                             }
+                            std::unique_lock<std::mutex> wakeLock(this->wakeMutex);
+                            if (wakeAt) {
+                                uint64_t now = Hal_getTimeInMs();
+                                linkCv.wait_for(wakeLock, std::chrono::milliseconds(wakeAt > now ? wakeAt - now : 0), [this] { return linkWakeup; });
+                            } else {
+                                linkCv.wait(wakeLock, [this] { return linkWakeup; });
+                            }
+                            linkWakeup = false;
                         }
 
                         std::lock_guard<std::mutex> lock(this->connMutex);
@@ -353,7 +433,9 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
 
                             CS101_Master_setASDUReceivedHandler(master, RawMessageHandler, this);
                             CS101_Master_setLinkLayerStateChanged(master, LinkLayerStateChanged, this);
+                            CS101_Master_setChannelReadyHandler(master, ChannelReady, this);
                             CS101_Master_setOwnAddress(master, linkAddress);
+                            CS101_Master_setAutoPolling(master, autoPoll, pollBackoffMin, pollBackoffMax);
                             printf("Registered RawMessageHandler for recreated master, clientID: %s\n", clientID.c_str());
                             slaveStates.clear();
                             slaveActivated.clear();
@@ -405,6 +487,7 @@ Napi::Value IEC101MasterUnbalanced::Connect(const CallbackInfo &info) {
                 printf("Exception in connection thread: %s, clientID: %s\n", e.what(), clientID.c_str());
                 std::lock_guard<std::mutex> lock(this->connMutex);
                 running = false;
+                FailCommandQueues(string("Thread exception: ") + e.what());
                 if (connected) {
                     CS101_Master_stop(master);
                     CS101_Master_destroy(master);
@@ -453,11 +536,16 @@ Napi::Value IEC101MasterUnbalanced::Disconnect(const CallbackInfo &info) {
         }
     }
 
+    WakeConnectionThread();
+
     if (_thread.joinable()) {
         _thread.join();
     }
 
+    batcher.Stop();
+
     std::lock_guard<std::mutex> lock(connMutex);
+    RejectPendingCommands(env, "Connection closed");
     tsfn.Release();
 
     return env.Undefined();
@@ -499,6 +587,12 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
     Napi::Array commands = info[0].As<Napi::Array>();
     int slaveAddress = info[1].As<Napi::Number>().Int32Value();
 
+    uint64_t timeoutMs = 10000;
+    bool waitActCon = false;
+    if (!ParseCommandOptions(env, info, 2, timeoutMs, &waitActCon)) {
+        return env.Undefined();
+    }
+
     std::lock_guard<std::mutex> lock(connMutex);
     if (!connected || !slaveActivated[slaveAddress]) {
         printf("SendCommands failed for slave %d: master not connected or slave not activated, clientID: %s\n", 
@@ -507,13 +601,12 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
         return env.Undefined();
     }
 
-    CS101_Master_useSlaveAddress(master, slaveAddress);
-    printf("Switched to slave address %d, clientID: %s\n", slaveAddress, clientID.c_str());
-
     CS101_AppLayerParameters alParams = CS101_Master_getAppLayerParameters(master);
 
     try {
         bool allSuccess = true;
+        std::vector<CommandJob> jobs;
+        jobs.reserve(commands.Length());
         for (uint32_t i = 0; i < commands.Length(); i++) {
             Napi::Value cmdVal = commands[i];
             if (!cmdVal.IsObject()) {
@@ -534,7 +627,13 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
             printf("Sending command: typeId=%d, ioa=%d, value=%f, slaveAddress=%d, clientID: %s\n", 
                    typeId, ioa, value.ToNumber().DoubleValue(), slaveAddress, clientID.c_str());
 
-            CS101_ASDU asdu = CS101_ASDU_create(alParams, false, CS101_COT_ACTIVATION, 0, slaveAddress, false, false);
+            // ASDU кодируется сразу, а отправляет его поток соединения, когда канал слейва свободен
+            CommandJob job;
+            job.asdu.reset(CS101_ASDU_create(alParams, false, CS101_COT_ACTIVATION, 0, slaveAddress, false, false));
+            job.typeId = typeId;
+            job.ioa = ioa;
+            job.waitActCon = waitActCon;
+            CS101_ASDU asdu = job.asdu.get();
 
             switch (typeId) {
                 case C_SC_NA_1: {
@@ -545,7 +644,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     bool val = value.As<Napi::Boolean>();
                     SingleCommand sc = SingleCommand_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                    CS101_Master_sendASDU(master, asdu);
                     SingleCommand_destroy(sc);
                     break;
                 }
@@ -561,7 +659,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     DoubleCommand dc = DoubleCommand_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                    CS101_Master_sendASDU(master, asdu);
                     DoubleCommand_destroy(dc);
                     break;
                 }
@@ -577,7 +674,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     StepCommand rc = StepCommand_create(NULL, ioa, (StepCommandValue)val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
-                    CS101_Master_sendASDU(master, asdu);
                     StepCommand_destroy(rc);
                     break;
                 }
@@ -593,7 +689,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     SetpointCommandNormalized scn = SetpointCommandNormalized_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandNormalized_destroy(scn);
                     break;
                 }
@@ -609,7 +704,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     SetpointCommandScaled scs = SetpointCommandScaled_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandScaled_destroy(scs);
                     break;
                 }
@@ -621,7 +715,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     float val = value.As<Napi::Number>().FloatValue();
                     SetpointCommandShort scsf = SetpointCommandShort_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandShort_destroy(scsf);
                     break;
                 }
@@ -633,7 +726,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     uint32_t val = value.As<Napi::Number>().Uint32Value();
                     Bitstring32Command bc = Bitstring32Command_create(NULL, ioa, val);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
-                    CS101_Master_sendASDU(master, asdu);
                     Bitstring32Command_destroy(bc);
                     break;
                 }
@@ -646,7 +738,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SingleCommandWithCP56Time2a sc = SingleCommandWithCP56Time2a_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                    CS101_Master_sendASDU(master, asdu);
                     SingleCommandWithCP56Time2a_destroy(sc);
                     break;
                 }
@@ -663,7 +754,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     DoubleCommandWithCP56Time2a dc = DoubleCommandWithCP56Time2a_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                    CS101_Master_sendASDU(master, asdu);
                     DoubleCommandWithCP56Time2a_destroy(dc);
                     break;
                 }
@@ -680,7 +770,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     StepCommandWithCP56Time2a rc = StepCommandWithCP56Time2a_create(NULL, ioa, (StepCommandValue)val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
-                    CS101_Master_sendASDU(master, asdu);
                     StepCommandWithCP56Time2a_destroy(rc);
                     break;
                 }
@@ -697,7 +786,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     SetpointCommandNormalizedWithCP56Time2a scn = SetpointCommandNormalizedWithCP56Time2a_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandNormalizedWithCP56Time2a_destroy(scn);
                     break;
                 }
@@ -714,7 +802,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     }
                     SetpointCommandScaledWithCP56Time2a scs = SetpointCommandScaledWithCP56Time2a_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandScaledWithCP56Time2a_destroy(scs);
                     break;
                 }
@@ -727,7 +814,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SetpointCommandShortWithCP56Time2a scsf = SetpointCommandShortWithCP56Time2a_create(NULL, ioa, val, false, IEC60870_QUALITY_GOOD, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
-                    CS101_Master_sendASDU(master, asdu);
                     SetpointCommandShortWithCP56Time2a_destroy(scsf);
                     break;
                 }
@@ -740,7 +826,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     Bitstring32CommandWithCP56Time2a bc = Bitstring32CommandWithCP56Time2a_create(NULL, ioa, val, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
-                    CS101_Master_sendASDU(master, asdu);
                     Bitstring32CommandWithCP56Time2a_destroy(bc);
                     break;
                 }
@@ -749,7 +834,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     CS101_ASDU_setCOT(asdu, CS101_COT_INTERROGATED_BY_STATION);
                     InformationObject io = (InformationObject)InterrogationCommand_create(NULL, ioa, value.As<Napi::Number>().Uint32Value());
                     CS101_ASDU_addInformationObject(asdu, io);
-                    CS101_Master_sendASDU(master, asdu);
                     InformationObject_destroy(io);
                     break;
                 }
@@ -758,7 +842,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
                     InformationObject io = (InformationObject)CounterInterrogationCommand_create(NULL, ioa, value.As<Napi::Number>().Uint32Value());
                     CS101_ASDU_addInformationObject(asdu, io);
-                    CS101_Master_sendASDU(master, asdu);
                     InformationObject_destroy(io);
                     break;
                 }
@@ -767,7 +850,6 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
                     InformationObject io = (InformationObject)ReadCommand_create(NULL, ioa);
                     CS101_ASDU_addInformationObject(asdu, io);
-                    CS101_Master_sendASDU(master, asdu);
                     InformationObject_destroy(io);
                     break;
                 }
@@ -781,23 +863,35 @@ Napi::Value IEC101MasterUnbalanced::SendCommands(const CallbackInfo &info) {
                     CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION);
                     InformationObject io = (InformationObject)ClockSynchronizationCommand_create(NULL, ioa, CP56Time2a_createFromMsTimestamp(NULL, val));
                     CS101_ASDU_addInformationObject(asdu, io);
-                    CS101_Master_sendASDU(master, asdu);
                     InformationObject_destroy(io);
                     break;
                 }
                 default:
                     printf("Unsupported command type: %d, clientID: %s\n", typeId, clientID.c_str());
-                    CS101_ASDU_destroy(asdu);
                     allSuccess = false;
                     continue;
             }
 
-            CS101_ASDU_destroy(asdu);
-            printf("Sent command: typeId=%d, ioa=%d, slaveAddress=%d, clientID: %s\n", 
-                   typeId, ioa, slaveAddress, clientID.c_str());
-            Thread_sleep(100);
+            jobs.push_back(std::move(job));
+        }
+
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        if (jobs.empty()) {
+            deferred.Resolve(Boolean::New(env, allSuccess));
+            return deferred.Promise();
+        }
+
+        auto batch = std::make_shared<CommandBatch>(CommandBatch{deferred, Hal_getTimeInMs() + timeoutMs, jobs.size(), allSuccess, ""});
+        std::deque<CommandJob> &queue = commandQueues[slaveAddress];
+        for (CommandJob &job : jobs) {
+            job.batch = batch;
+            queue.push_back(std::move(job));
         }
-        return Boolean::New(env, allSuccess);
+        printf("Queued %zu commands for slave %d, queue length: %zu, clientID: %s\n",
+               jobs.size(), slaveAddress, queue.size(), clientID.c_str());
+        WakeConnectionThread();
+
+        return deferred.Promise();
     } catch (const std::exception& e) {
         printf("Exception in SendCommands: %s, clientID: %s\n", e.what(), clientID.c_str());
         Napi::Error::New(env, string("SendCommands failed: ") + e.what()).ThrowAsJavaScriptException();
@@ -812,9 +906,246 @@ Napi::Value IEC101MasterUnbalanced::GetStatus(const CallbackInfo &info) {
     status.Set("connected", Boolean::New(env, connected));
     status.Set("activated", Boolean::New(env, activated));
     status.Set("clientID", String::New(env, clientID.c_str()));
+    status.Set("batching", batcher.GetStats(env));
+    if (deadband.IsEnabled())
+        status.Set("deadband", deadband.GetStats(env));
+    size_t queuedCommands = 0;
+    for (const auto &[addr, queue] : commandQueues) {
+        queuedCommands += queue.size();
+    }
+    status.Set("queuedCommands", Number::New(env, static_cast<double>(queuedCommands)));
+    status.Set("autoPoll", Boolean::New(env, autoPoll));
+
+    // Статистика опроса по слейвам (канальный уровень)
+    Napi::Array slaves = Napi::Array::New(env);
+    if (connected) {
+        uint32_t index = 0;
+        for (const auto &[addr, state] : slaveStates) {
+            struct sLinkLayerPollingStatistics stats;
+            if (!CS101_Master_getSlavePollingStatistics(master, addr, &stats))
+                continue;
+            Object slave = Object::New(env);
+            slave.Set("slaveAddress", Number::New(env, addr));
+            slave.Set("available", Boolean::New(env, state));
+            slave.Set("priority", Number::New(env, stats.priority));
+            slave.Set("class1Requests", Number::New(env, stats.class1Requests));
+            slave.Set("class2Requests", Number::New(env, stats.class2Requests));
+            slave.Set("timeouts", Number::New(env, stats.timeouts));
+            slave.Set("consecutiveFailures", Number::New(env, stats.consecutiveFailures));
+            slave.Set("backoffMs", Number::New(env, stats.backoff));
+            slave.Set("lastScanCycleMs", Number::New(env, stats.lastScanCycle));
+            slave.Set("avgScanCycleMs", Number::New(env, stats.avgScanCycle));
+            slave.Set("maxScanCycleMs", Number::New(env, stats.maxScanCycle));
+            slaves[index++] = slave;
+        }
+    }
+    status.Set("slaves", slaves);
     return status;
 }
 
+bool IEC101MasterUnbalanced::ParseCommandOptions(Napi::Env env, const CallbackInfo &info, size_t index, uint64_t &timeoutMs, bool *waitActCon) {
+    if (info.Length() <= index || info[index].IsUndefined()) {
+        return true;
+    }
+    if (!info[index].IsObject()) {
+        Napi::TypeError::New(env, "Options must be an object { timeout (ms), confirm ('link' | 'actcon') }").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object options = info[index].As<Napi::Object>();
+    if (options.Has("timeout")) {
+        int timeout = options.Get("timeout").As<Number>().Int32Value();
+        if (timeout <= 0) {
+            Napi::RangeError::New(env, "timeout must be positive").ThrowAsJavaScriptException();
+            return false;
+        }
+        timeoutMs = timeout;
+    }
+    if (waitActCon && options.Has("confirm")) {
+        std::string confirm = options.Get("confirm").ToString().Utf8Value();
+        if (confirm != "link" && confirm != "actcon") {
+            Napi::Error::New(env, "confirm must be 'link' or 'actcon'").ThrowAsJavaScriptException();
+            return false;
+        }
+        *waitActCon = confirm == "actcon";
+    }
+    return true;
+}
+
+// Вызывается потоком соединения под connMutex. Возвращает ближайший таймаут команд в работе
+// (Hal_getTimeInMs()) или 0, если очереди пусты.
+uint64_t IEC101MasterUnbalanced::ServeCommandQueues() {
+    std::vector<CommandConfirmation> received;
+    {
+        std::lock_guard<std::mutex> lock(confirmMutex);
+        received.swap(confirmations);
+    }
+    for (const CommandConfirmation &confirmation : received) {
+        auto it = commandQueues.find(confirmation.address);
+        if (it == commandQueues.end() || it->second.empty())
+            continue;
+        CommandJob &job = it->second.front();
+        if (job.sent && job.waitActCon && job.typeId == confirmation.typeId && (confirmation.ioa < 0 || job.ioa == confirmation.ioa)) {
+            job.actConReceived = true;
+            job.negative = confirmation.negative;
+        }
+    }
+
+    uint64_t now = Hal_getTimeInMs();
+    uint64_t wakeAt = 0;
+
+    for (auto &[slaveAddress, queue] : commandQueues) {
+        if (!slaveActivated[slaveAddress]) {
+            while (!queue.empty()) {
+                CompleteCommand(queue.front(), "Slave link layer not available");
+                queue.pop_front();
+            }
+            continue;
+        }
+
+        while (!queue.empty()) {
+            CommandJob &job = queue.front();
+
+            if (job.sent) {
+                // Кадр подтверждён, когда канальный уровень освободил канал слейва (ACK, в том числе
+                // вместе с дочитанными по ACD данными класса 1)
+                bool linkConfirmed = CS101_Master_isChannelReady(master, slaveAddress);
+                if (job.actConReceived || (linkConfirmed && !job.waitActCon)) {
+                    CompleteCommand(job, job.negative ? "Negative confirmation" : "");
+                    queue.pop_front();
+                    continue;
+                }
+            }
+
+            if (now >= job.batch->deadline) {
+                CompleteCommand(job, "Command timeout");
+                queue.pop_front();
+                continue;
+            }
+            if (!job.sent && !job.batch->error.empty()) {
+                // Вызов уже завершился ошибкой, остальные его команды не отправляем
+                CompleteCommand(job, "");
+                queue.pop_front();
+                continue;
+            }
+
+            if (!job.sent) {
+                // CS101_Master_sendASDU молча отбрасывает кадр, если у слейва уже есть неотправленный
+                if (!CS101_Master_isChannelReady(master, slaveAddress))
+                    break;
+                CS101_Master_useSlaveAddress(master, slaveAddress);
+                if (job.asdu) {
+                    CS101_Master_sendASDU(master, job.asdu.get());
+                    printf("Sent command: typeId=%d, ioa=%d, slaveAddress=%d, clientID: %s\n",
+                           job.typeId, job.ioa, slaveAddress, clientID.c_str());
+                } else {
+                    CS101_Master_pollSingleSlave(master, slaveAddress);
+                    printf("Polling slave with address %d, clientID: %s\n", slaveAddress, clientID.c_str());
+                }
+                job.sent = true;
+            }
+            break;
+        }
+
+        if (!queue.empty() && (wakeAt == 0 || queue.front().batch->deadline < wakeAt))
+            wakeAt = queue.front().batch->deadline;
+    }
+
+    return wakeAt;
+}
+
+// Будит поток соединения. connMutex не берётся: вызывается и из потока канального уровня lib60870
+void IEC101MasterUnbalanced::WakeConnectionThread() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        linkWakeup = true;
+    }
+    linkCv.notify_all();
+}
+
+// Канал слейва освободился (кадр подтверждён, запрос данных отработан): можно передавать следующую команду
+void IEC101MasterUnbalanced::ChannelReady(void *parameter, int address) {
+    static_cast<IEC101MasterUnbalanced *>(parameter)->WakeConnectionThread();
+}
+
+void IEC101MasterUnbalanced::CompleteCommand(CommandJob &job, const std::string &error) {
+    std::shared_ptr<CommandBatch> batch = job.batch;
+    if (!error.empty() && batch->error.empty()) {
+        batch->error = error;
+    }
+    if (--batch->remaining > 0) {
+        return;
+    }
+
+    napi_status status = tsfn.NonBlockingCall([batch](Napi::Env env, Function) {
+        SettleBatch(env, *batch);
+    });
+    if (status != napi_ok) {
+        // TSFN закрывается: промис вызова разрешит Disconnect на потоке JS
+        undeliveredBatches.push_back(batch);
+    }
+}
+
+void IEC101MasterUnbalanced::SettleBatch(Napi::Env env, CommandBatch &batch) {
+    if (batch.error.empty()) {
+        batch.deferred.Resolve(Boolean::New(env, batch.allSuccess));
+    } else {
+        batch.deferred.Reject(Napi::Error::New(env, batch.error).Value());
+    }
+}
+
+// Поток JS под connMutex, поток соединения уже остановлен: отклоняет команды, оставшиеся в очередях,
+// и разрешает вызовы, завершение которых не прошло через tsfn. Вызывать до tsfn.Release().
+void IEC101MasterUnbalanced::RejectPendingCommands(Napi::Env env, const std::string &error) {
+    for (auto &[slaveAddress, queue] : commandQueues) {
+        for (CommandJob &job : queue) {
+            if (job.batch->error.empty()) {
+                job.batch->error = error;
+            }
+            if (--job.batch->remaining == 0) {
+                undeliveredBatches.push_back(job.batch);
+            }
+        }
+    }
+    commandQueues.clear();
+    for (auto &batch : undeliveredBatches) {
+        SettleBatch(env, *batch);
+    }
+    undeliveredBatches.clear();
+}
+
+void IEC101MasterUnbalanced::FailCommandQueues(const std::string &error) {
+    for (auto &[slaveAddress, queue] : commandQueues) {
+        while (!queue.empty()) {
+            CompleteCommand(queue.front(), error);
+            queue.pop_front();
+        }
+    }
+    commandQueues.clear();
+}
+
+void IEC101MasterUnbalanced::EmitBatch(Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+    Napi::Array jsArray = Napi::Array::New(env, points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        const PointRecord &p = points[i];
+        Napi::Object msg = Napi::Object::New(env);
+        msg.Set("clientID", String::New(env, clientID.c_str()));
+        msg.Set("typeId", Number::New(env, p.typeId));
+        msg.Set("asdu", Number::New(env, p.ca));
+        msg.Set("ioa", Number::New(env, p.ioa));
+        msg.Set("val", Number::New(env, p.val));
+        msg.Set("quality", Number::New(env, p.quality));
+        msg.Set("slaveAddress", Number::New(env, p.source));
+        if (p.timestamp > 0) {
+            msg.Set("timestamp", Number::New(env, static_cast<double>(p.timestamp)));
+        }
+        jsArray[i] = msg;
+    }
+    std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+    jsCallback.Call(args);
+    cnt++;
+}
+
 Napi::Value IEC101MasterUnbalanced::AddSlave(const CallbackInfo &info) {
     Napi::Env env = info.Env();
 
@@ -830,6 +1161,15 @@ Napi::Value IEC101MasterUnbalanced::AddSlave(const CallbackInfo &info) {
         return env.Undefined();
     }
 
+    int priority = 0;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        priority = info[1].As<Number>().Int32Value();
+        if (priority < 1) {
+            Napi::RangeError::New(env, "priority must be at least 1").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+
     std::lock_guard<std::mutex> lock(connMutex);
     if (!connected) {
         Napi::Error::New(env, "Not connected").ThrowAsJavaScriptException();
@@ -837,6 +1177,10 @@ Napi::Value IEC101MasterUnbalanced::AddSlave(const CallbackInfo &info) {
     }
 
     CS101_Master_addSlave(master, slaveAddress);
+    if (priority > 0)
+        slavePriorities[slaveAddress] = priority;
+    if (slavePriorities.count(slaveAddress))
+        CS101_Master_setSlavePriority(master, slaveAddress, slavePriorities[slaveAddress]);
     slaveStates[slaveAddress] = false; // Изначально не AVAILABLE
     slaveActivated[slaveAddress] = true; // Активируем слейв
     printf("Added slave with address %d, clientID: %s\n", slaveAddress, clientID.c_str());
@@ -892,6 +1236,8 @@ void IEC101MasterUnbalanced::LinkLayerStateChanged(void *parameter, int address,
         client->activated = client->connected;
     }
 
+    client->WakeConnectionThread();
+
     printf("Link layer event: %s, reason: %s, clientID: %s, slaveAddress: %d\n", 
            eventStr.c_str(), reason.c_str(), client->clientID.c_str(), address);
 
@@ -925,207 +1271,210 @@ bool IEC101MasterUnbalanced::RawMessageHandler(void *parameter, int address, CS1
     }
     printf("\n");
 
+    // Подтверждения команд (ACT_CON, DEACT_CON и отрицательные ответы 44..47) завершают ожидающую команду слейва
+    CS101_CauseOfTransmission cot = CS101_ASDU_getCOT(asdu);
+    if (((typeID >= C_SC_NA_1 && typeID <= C_BO_TA_1) || (typeID >= C_IC_NA_1 && typeID <= C_TS_TA_1)) &&
+        (cot == CS101_COT_ACTIVATION_CON || cot == CS101_COT_DEACTIVATION_CON ||
+         (cot >= CS101_COT_UNKNOWN_TYPE_ID && cot <= CS101_COT_UNKNOWN_IOA))) {
+        InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, 0);
+        CommandConfirmation confirmation{address, typeID, io ? InformationObject_getObjectAddress(io) : -1,
+                                         CS101_ASDU_isNegative(asdu) || cot >= CS101_COT_UNKNOWN_TYPE_ID};
+        {
+            std::lock_guard<std::mutex> lock(client->confirmMutex);
+            client->confirmations.push_back(confirmation);
+        }
+        client->WakeConnectionThread();
+    }
+
     try {
-        vector<tuple<int, double, uint8_t, uint64_t>> elements;
+        // Точки декодируются в буфер соединения без выделения памяти
+        DecodedPoints &elements = client->decodedPoints;
+        elements.clear();
+        elements.reserve(numberOfElements);
         printf("RawMessageHandler invoked for address: %d, typeID: %d, payloadSize: %d, clientID: %s\n", 
                address, typeID, payloadSize, client->clientID.c_str());
 
         switch (typeID) {
             case M_SP_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElement(asdu, i);
+                    SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = SinglePointInformation_getValue(io) ? 1.0 : 0.0;
                         uint8_t quality = SinglePointInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        SinglePointInformation_destroy(io);
                     }
                 }
                 break;
             case M_DP_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElement(asdu, i);
+                    DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(DoublePointInformation_getValue(io));
                         uint8_t quality = DoublePointInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        DoublePointInformation_destroy(io);
                     }
                 }
                 break;
             case M_ST_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElement(asdu, i);
+                    StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(StepPositionInformation_getValue(io));
                         uint8_t quality = StepPositionInformation_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        StepPositionInformation_destroy(io);
                     }
                 }
                 break;
             case M_BO_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    BitString32 io = (BitString32)CS101_ASDU_getElement(asdu, i);
+                    BitString32 io = (BitString32)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(BitString32_getValue(io));
                         uint8_t quality = BitString32_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        BitString32_destroy(io);
                     }
                 }
                 break;
             case M_ME_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueNormalized_getValue(io);
                         uint8_t quality = MeasuredValueNormalized_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueNormalized_destroy(io);
                     }
                 }
                 break;
             case M_ME_NB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueScaled_getValue(io);
                         uint8_t quality = MeasuredValueScaled_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueScaled_destroy(io);
                     }
                 }
                 break;
             case M_ME_NC_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueShort_getValue(io);
                         uint8_t quality = MeasuredValueShort_getQuality(io);
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueShort_destroy(io);
                     }
                 }
                 break;
             case M_IT_NA_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElement(asdu, i);
+                    IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = BinaryCounterReading_getValue(IntegratedTotals_getBCR(io));
                         uint8_t quality = IEC60870_QUALITY_GOOD;
                         uint64_t timestamp = 0;
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        IntegratedTotals_destroy(io);
                     }
                 }
                 break;
             case M_SP_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0;
                         uint8_t quality = SinglePointInformation_getQuality((SinglePointInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(SinglePointWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(SinglePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        SinglePointWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_DP_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(DoublePointInformation_getValue((DoublePointInformation)io));
                         uint8_t quality = DoublePointInformation_getQuality((DoublePointInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(DoublePointWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(DoublePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        DoublePointWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_ST_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(StepPositionInformation_getValue((StepPositionInformation)io));
                         uint8_t quality = StepPositionInformation_getQuality((StepPositionInformation)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(StepPositionWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(StepPositionWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        StepPositionWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_BO_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = static_cast<double>(BitString32_getValue((BitString32)io));
                         uint8_t quality = BitString32_getQuality((BitString32)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(Bitstring32WithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(Bitstring32WithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        Bitstring32WithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_ME_TD_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueNormalized_getValue((MeasuredValueNormalized)io);
                         uint8_t quality = MeasuredValueNormalized_getQuality((MeasuredValueNormalized)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueNormalizedWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_ME_TE_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueScaled_getValue((MeasuredValueScaled)io);
                         uint8_t quality = MeasuredValueScaled_getQuality((MeasuredValueScaled)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueScaledWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueScaledWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
             case M_ME_TF_1:
                 printf("Processing M_ME_TF_1, numberOfElements: %d, clientID: %s\n", numberOfElements, client->clientID.c_str());
                 for (int i = 0; i < numberOfElements; i++) {
-                    MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = MeasuredValueShort_getValue((MeasuredValueShort)io);
                         uint8_t quality = MeasuredValueShort_getQuality((MeasuredValueShort)io);
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueShortWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         printf("M_ME_TF_1 element %d: ioa=%d, val=%f, quality=%u, timestamp=%" PRIu64 ", clientID: %s\n",
                                i, ioa, val, quality, timestamp, client->clientID.c_str());
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        MeasuredValueShortWithCP56Time2a_destroy(io);
                     } else {
                         printf("Failed to get M_ME_TF_1 element %d, clientID: %s\n", i, client->clientID.c_str());
                     }
@@ -1133,14 +1482,13 @@ bool IEC101MasterUnbalanced::RawMessageHandler(void *parameter, int address, CS1
                 break;
             case M_IT_TB_1:
                 for (int i = 0; i < numberOfElements; i++) {
-                    IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                     if (io) {
                         int ioa = InformationObject_getObjectAddress((InformationObject)io);
                         double val = BinaryCounterReading_getValue(IntegratedTotals_getBCR((IntegratedTotals)io));
                         uint8_t quality = IEC60870_QUALITY_GOOD;
-                        uint64_t timestamp = CP56Time2a_toMsTimestamp(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
+                        uint64_t timestamp = CP56Time2a_toMsTimestampCached(IntegratedTotalsWithCP56Time2a_getTimestamp(io), &client->dayCache);
                         elements.emplace_back(ioa, val, quality, timestamp);
-                        IntegratedTotalsWithCP56Time2a_destroy(io);
                     }
                 }
                 break;
@@ -1155,15 +1503,29 @@ bool IEC101MasterUnbalanced::RawMessageHandler(void *parameter, int address, CS1
                 return true;
         }
 
+        // Значения внутри зоны нечувствительности в JS не передаются
+        client->deadband.Apply(typeID, cot, receivedAsduAddress, elements);
+        if (elements.empty())
+            return true;
+
         for (const auto& [ioa, val, quality, timestamp] : elements) {
             printf("ASDU type: %s, clientID: %s, asduAddress: %d, ioa: %i, value: %f, quality: %u, timestamp: %" PRIu64 ", cnt: %i, slaveAddress: %d\n",
                    TypeID_toString(typeID), client->clientID.c_str(), receivedAsduAddress, ioa, val, quality, timestamp, client->cnt, address);
         }
 
-        client->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
-            Napi::Array jsArray = Napi::Array::New(env, elements.size());
-            for (size_t i = 0; i < elements.size(); i++) {
+        if (client->batcher.IsEnabled()) {
+            client->batcher.Append(elements.size(), [&](size_t i) {
                 const auto& [ioa, val, quality, timestamp] = elements[i];
+                return PointRecord{typeID, receivedAsduAddress, cot, ioa, val, quality, timestamp, address};
+            });
+            return true;
+        }
+
+        DecodedPoints *points = client->pointsPool.Acquire(elements);
+        if (client->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
+            Napi::Array jsArray = Napi::Array::New(env, points->size());
+            for (size_t i = 0; i < points->size(); i++) {
+                const auto& [ioa, val, quality, timestamp] = (*points)[i];
                 Napi::Object msg = Napi::Object::New(env);
                 msg.Set("clientID", String::New(env, client->clientID.c_str()));
                 msg.Set("typeId", Number::New(env, typeID));
@@ -1177,10 +1539,12 @@ bool IEC101MasterUnbalanced::RawMessageHandler(void *parameter, int address, CS1
                 }
                 jsArray[i] = msg;
             }
+            client->pointsPool.Release(points);
             std::vector<napi_value> args = {String::New(env, "data"), jsArray};
             jsCallback.Call(args);
             client->cnt++;
-        });
+        }) != napi_ok)
+            client->pointsPool.Release(points);
 
         printf("RawMessageHandler completed in %" PRIu64 " ms, clientID: %s\n", 
                Hal_getTimeInMs() - startTime, client->clientID.c_str());
@@ -1214,6 +1578,11 @@ Napi::Value IEC101MasterUnbalanced::PollSlave(const CallbackInfo &info) {
         return env.Undefined();
     }
 
+    uint64_t timeoutMs = 10000;
+    if (!ParseCommandOptions(env, info, 1, timeoutMs, nullptr)) {
+        return env.Undefined();
+    }
+
     std::lock_guard<std::mutex> lock(connMutex);
     if (!connected || !slaveActivated[slaveAddress]) {
         printf("PollSlave failed for slave %d: master not connected or slave not activated, clientID: %s\n", 
@@ -1222,15 +1591,13 @@ Napi::Value IEC101MasterUnbalanced::PollSlave(const CallbackInfo &info) {
         return env.Undefined();
     }
 
-    CS101_Master_useSlaveAddress(master, slaveAddress);
-    printf("Switched to slave address %d for polling, clientID: %s\n", slaveAddress, clientID.c_str());
+    // Запрос данных класса 2 встаёт в ту же очередь, что и команды слейва
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    CommandJob job;
+    job.batch = std::make_shared<CommandBatch>(CommandBatch{deferred, Hal_getTimeInMs() + timeoutMs, 1, true, ""});
+    commandQueues[slaveAddress].push_back(std::move(job));
+    printf("Queued poll for slave %d, clientID: %s\n", slaveAddress, clientID.c_str());
+    WakeConnectionThread();
 
-    LinkLayerState state = LL_STATE_IDLE; // Замените на актуальный getter, если доступен
-    printf("Polling slave with address %d, clientID: %s, link state: %d (0=IDLE, 1=ERROR, 2=BUSY, 3=AVAILABLE)\n", 
-           slaveAddress, clientID.c_str(), state);
-    CS101_Master_pollSingleSlave(master, slaveAddress);
-    printf("Poll completed for slave %d, clientID: %s\n", slaveAddress, clientID.c_str());
-    Thread_sleep(1000);
-
-    return Boolean::New(env, true);
+    return deferred.Promise();
 }
\ No newline at end of file
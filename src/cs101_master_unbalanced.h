@@ -5,8 +5,14 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <map> // Добавлено для slaveStates и slaveActivated
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+#include "deadband_filter.h"
 
 extern "C" {
 #include "hal_serial.h"
@@ -20,28 +26,90 @@ public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     IEC101MasterUnbalanced(const Napi::CallbackInfo& info);
     virtual ~IEC101MasterUnbalanced();
+    void Teardown();
 
 private:
-    static Napi::FunctionReference constructor;
-
     CS101_Master master;
     SerialPort serialPort;
     std::thread _thread;
     std::atomic<bool> running;
     std::mutex connMutex;
+    std::mutex wakeMutex;           // Только для linkWakeup: его берут обработчики потока lib60870
+    std::condition_variable linkCv; // Ждёт linkWakeup под wakeMutex
+    bool linkWakeup = false;        // Новые команды, подтверждения, свободный канал, потеря связи или остановка
     bool connected = false;
     bool activated = false;
    
     std::string clientID;
     int cnt = 0;
     Napi::ThreadSafeFunction tsfn;
+    IODecodeBuffer decodeBuffer; // Буфер для CS101_ASDU_getElementEx (используется только потоком опроса)
+    DecodedPoints decodedPoints; // Точки текущего ASDU и векторы для передачи в JS (поток опроса)
+    DecodedPointsPool pointsPool;
+    CP56Time2aDayCache dayCache = {0, 0}; // Последние сутки для CP56Time2a_toMsTimestampCached (поток опроса)
+    EventBatcher<PointRecord> batcher; // Пакетная передача точек в JS (batchSize/batchLatency)
+    DeadbandFilter deadband; // Зона нечувствительности аналоговых точек (params.deadband)
     int asduAddress = 1;
      int originatorAddress;   
    std::map<int, bool> slaveStates; // Состояние каждого слейва (true = AVAILABLE, false = ERROR/IDLE)
     std::map<int, bool> slaveActivated; // Активировано ли соединение для слейва
 
+    // Планировщик опроса канального уровня (params.autoPoll)
+    bool autoPoll = false;
+    int pollBackoffMin = 1000;
+    int pollBackoffMax = 60000;
+    std::map<int, int> slavePriorities; // Вес слейва во взвешенном циклическом опросе
+
+    // Вызов sendCommands/pollSlave, ожидающий завершения своих команд
+    struct CommandBatch {
+        Napi::Promise::Deferred deferred; // Разрешается только в JS-потоке через tsfn
+        uint64_t deadline;                // Hal_getTimeInMs(), после которого вызов завершается по таймауту
+        size_t remaining;
+        bool allSuccess;                  // false, если часть команд пропущена (неподдерживаемый typeId)
+        std::string error;
+    };
+
+    // Элемент очереди слейва: закодированный ASDU или запрос данных класса 2 (asdu == nullptr)
+    struct CommandJob {
+        std::shared_ptr<CommandBatch> batch;
+        std::unique_ptr<sCS101_ASDU, void (*)(CS101_ASDU)> asdu{nullptr, CS101_ASDU_destroy};
+        int typeId = 0;
+        int ioa = 0;
+        bool waitActCon = false;    // Завершать по ACT_CON слейва, а не по подтверждению канального уровня
+        bool sent = false;
+        bool actConReceived = false;
+        bool negative = false;
+    };
+
+    // ACT_CON/DEACT_CON или отрицательный ответ слейва, принятый потоком lib60870. Обработчик ASDU
+    // не берёт connMutex, чтобы не задерживать канальный уровень: подтверждения разбирает ServeCommandQueues
+    struct CommandConfirmation {
+        int address;
+        int typeId;
+        int ioa;
+        bool negative;
+    };
+    std::mutex confirmMutex;
+    std::vector<CommandConfirmation> confirmations; // Под confirmMutex
+
+    // Очереди команд по адресам слейвов (под connMutex). Обслуживаются потоком соединения:
+    // следующая команда передаётся канальному уровню, только когда канал слейва свободен.
+    std::map<int, std::deque<CommandJob>> commandQueues;
+    // Завершённые вызовы, которые не удалось передать через tsfn (под connMutex). Их отклоняет
+    // Disconnect на потоке JS до tsfn.Release()
+    std::vector<std::shared_ptr<CommandBatch>> undeliveredBatches;
+
     static bool RawMessageHandler(void *parameter, int address, CS101_ASDU asdu);
     static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state);
+    static void ChannelReady(void *parameter, int address);
+    void WakeConnectionThread();
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord>& points);
+    uint64_t ServeCommandQueues();
+    void CompleteCommand(CommandJob& job, const std::string& error);
+    void FailCommandQueues(const std::string& error);
+    void RejectPendingCommands(Napi::Env env, const std::string& error);
+    static void SettleBatch(Napi::Env env, CommandBatch& batch);
+    bool ParseCommandOptions(Napi::Env env, const Napi::CallbackInfo& info, size_t index, uint64_t& timeoutMs, bool* waitActCon);
 
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value Disconnect(const Napi::CallbackInfo& info);
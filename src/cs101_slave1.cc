@@ -5,6 +5,7 @@
 #endif
 
 #include "cs101_slave1.h"
+#include "addon_data.h"
 #include <inttypes.h>
 #include <stdexcept>
 #include <vector>
@@ -15,17 +16,16 @@
 using namespace Napi;
 using namespace std;
 
-Napi::FunctionReference IEC101Slave::constructor;
-
 Napi::Object IEC101Slave::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "IEC101Slave", {
         InstanceMethod("connect", &IEC101Slave::Connect),
         InstanceMethod("disconnect", &IEC101Slave::Disconnect),
         InstanceMethod("sendCommands", &IEC101Slave::SendCommands),
+        InstanceMethod("enqueueClass1", &IEC101Slave::EnqueueClass1),
+        InstanceMethod("enqueueClass2", &IEC101Slave::EnqueueClass2),
         InstanceMethod("getStatus", &IEC101Slave::GetStatus)
     });
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    GetAddonData(env)->iec101Slave = Napi::Persistent(func);
     exports.Set("IEC101Slave", func);
     return exports;
 }
@@ -51,12 +51,23 @@ IEC101Slave::IEC101Slave(const Napi::CallbackInfo& info) : Napi::ObjectWrap<IEC1
     } catch (const std::exception& e) {
         printf("Failed to create ThreadSafeFunction: %s\n", e.what());
         Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
     }
+    AddTeardownHook(info.Env(), this);
 }
 
 IEC101Slave::~IEC101Slave() {
-    std::lock_guard<std::mutex> lock(connMutex);
-    if (running) {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает.
+// Поток линии берёт connMutex, поэтому join — после выхода из блокировки, как в Disconnect.
+void IEC101Slave::Teardown() {
+    {
+        std::lock_guard<std::mutex> lock(connMutex);
+        if (!running)
+            return;
         running = false;
         if (connected) {
             printf("Destructor closing connection, clientID: %s, clientId: %i\n", clientID.c_str(), clientId);
@@ -65,11 +76,13 @@ IEC101Slave::~IEC101Slave() {
             SerialPort_destroy(serialPort);
             connected = false;
         }
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-        tsfn.Release();
     }
+    linkCv.notify_all();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    batcher.Stop();
+    tsfn.Release();
 }
 
 Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
@@ -106,17 +119,45 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
     int reconnectDelay = 5;
     int maxRetries = 10;
     int queueSize = 100;
+    bool balanced = false;
+    int otherLinkAddress = 1;
+    int sizeOfCOT = 2;
+    int sizeOfCA = 2;
+    int sizeOfIOA = 3;
 
     if (info.Length() > 4 && info[4].IsObject()) {
         Napi::Object params = info[4].As<Napi::Object>();
         if (params.Has("linkAddress")) linkAddress = params.Get("linkAddress").As<Napi::Number>().Int32Value();
         if (params.Has("originatorAddress")) originatorAddress = params.Get("originatorAddress").As<Napi::Number>().Int32Value();
+        if (params.Has("asduAddress")) asduAddress = params.Get("asduAddress").As<Napi::Number>().Int32Value();
         if (params.Has("t0")) t0 = params.Get("t0").As<Napi::Number>().Int32Value();
         if (params.Has("t1")) t1 = params.Get("t1").As<Napi::Number>().Int32Value();
         if (params.Has("t2")) t2 = params.Get("t2").As<Napi::Number>().Int32Value();
         if (params.Has("reconnectDelay")) reconnectDelay = params.Get("reconnectDelay").As<Napi::Number>().Int32Value();
         if (params.Has("maxRetries")) maxRetries = params.Get("maxRetries").As<Napi::Number>().Int32Value();
         if (params.Has("queueSize")) queueSize = params.Get("queueSize").As<Napi::Number>().Int32Value();
+        if (params.Has("mode")) {
+            std::string mode = params.Get("mode").ToString().Utf8Value();
+            if (mode != "unbalanced" && mode != "balanced") {
+                Napi::Error::New(env, "mode must be 'unbalanced' or 'balanced'").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            balanced = mode == "balanced";
+        }
+        otherLinkAddress = linkAddress;
+        if (params.Has("otherLinkAddress")) otherLinkAddress = params.Get("otherLinkAddress").As<Napi::Number>().Int32Value();
+        if (params.Has("sizeOfCOT")) sizeOfCOT = params.Get("sizeOfCOT").As<Napi::Number>().Int32Value();
+        if (params.Has("sizeOfCA")) sizeOfCA = params.Get("sizeOfCA").As<Napi::Number>().Int32Value();
+        if (params.Has("sizeOfIOA")) sizeOfIOA = params.Get("sizeOfIOA").As<Napi::Number>().Int32Value();
+
+        if (otherLinkAddress < 0 || otherLinkAddress > 255) {
+            Napi::Error::New(env, "otherLinkAddress must be 0-255").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (sizeOfCOT < 1 || sizeOfCOT > 2 || sizeOfCA < 1 || sizeOfCA > 2 || sizeOfIOA < 1 || sizeOfIOA > 3) {
+            Napi::RangeError::New(env, "sizeOfCOT and sizeOfCA must be 1-2, sizeOfIOA 1-3").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
 
         if (linkAddress < 0 || linkAddress > 255) {
             Napi::Error::New(env, "linkAddress must be 0-255").ThrowAsJavaScriptException();
@@ -126,6 +167,10 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
             Napi::Error::New(env, "originatorAddress must be 0-255").ThrowAsJavaScriptException();
             return env.Undefined();
         }
+        if (asduAddress < 0 || asduAddress > 65535) {
+            Napi::Error::New(env, "asduAddress must be 0-65535").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
         if (t0 <= 0 || t1 <= 0 || t2 <= 0) {
             Napi::Error::New(env, "t0, t1, t2 must be positive").ThrowAsJavaScriptException();
             return env.Undefined();
@@ -144,6 +189,14 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
         }
     }
 
+    // Пакетная передача принятых команд в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = info.Length() > 4 && info[4].IsObject() ? info[4].As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
     try {
         printf("Creating serial connection to %s, baudRate: %d, clientID: %s, clientId: %i\n", portName.c_str(), baudRate, clientID.c_str(), clientId);
         serialPort = SerialPort_create(portName.c_str(), baudRate, 8, 'E', 1);
@@ -151,23 +204,24 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
             throw runtime_error("Failed to create serial port object");
         }
 
-        LinkLayerParameters llParams = LinkLayerParameters();
-        llParams->addressLength = 1;
-        llParams->timeoutForAck = t1 * 1000;
-        llParams->timeoutRepeat = t2 * 1000;
-        llParams->timeoutLinkState = t0 * 1000;
-        llParams->useSingleCharACK = true;
-
-        CS101_AppLayerParameters alParams = CS101_AppLayerParameters();
-        alParams->sizeOfTypeId = 1;
-        alParams->sizeOfVSQ = 1;
-        alParams->sizeOfCOT = 2;
-        alParams->originatorAddress = originatorAddress;
-        alParams->sizeOfCA = 2;
-        alParams->sizeOfIOA = 3;
-        alParams->maxSizeOfASDU = 249;
-
-        slave = CS101_Slave_createEx(serialPort, llParams, alParams, IEC60870_LINK_LAYER_UNBALANCED, queueSize, queueSize);
+        struct sLinkLayerParameters llParams;
+        llParams.addressLength = 1;
+        llParams.timeoutForAck = t1 * 1000;
+        llParams.timeoutRepeat = t2 * 1000;
+        llParams.timeoutLinkState = t0 * 1000;
+        llParams.useSingleCharACK = true;
+
+        struct sCS101_AppLayerParameters alParams;
+        alParams.sizeOfTypeId = 1;
+        alParams.sizeOfVSQ = 1;
+        alParams.sizeOfCOT = sizeOfCOT;
+        alParams.originatorAddress = originatorAddress;
+        alParams.sizeOfCA = sizeOfCA;
+        alParams.sizeOfIOA = sizeOfIOA;
+        alParams.maxSizeOfASDU = 249;
+
+        IEC60870_LinkLayerMode linkLayerMode = balanced ? IEC60870_LINK_LAYER_BALANCED : IEC60870_LINK_LAYER_UNBALANCED;
+        slave = CS101_Slave_createEx(serialPort, &llParams, &alParams, linkLayerMode, queueSize, queueSize);
         if (!slave) {
             SerialPort_destroy(serialPort);
             throw runtime_error("Failed to create slave object");
@@ -176,12 +230,18 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
         CS101_Slave_setASDUHandler(slave, RawMessageHandler, this);
         CS101_Slave_setLinkLayerStateChanged(slave, LinkLayerStateChanged, this);
         CS101_Slave_setLinkLayerAddress(slave, linkAddress);
+        if (balanced) {
+            CS101_Slave_setLinkLayerAddressOtherStation(slave, otherLinkAddress);
+        }
 
         printf("Connecting with params: linkAddress=%d, originatorAddress=%d, t0=%d, t1=%d, t2=%d, reconnectDelay=%d, maxRetries=%d, queueSize=%d, clientID: %s, clientId: %i\n",
                linkAddress, originatorAddress, t0, t1, t2, reconnectDelay, maxRetries, queueSize, clientID.c_str(), clientId);
 
         running = true;
-        _thread = std::thread([this, portName, baudRate, linkAddress, originatorAddress, t0, t1, t2, reconnectDelay, maxRetries, queueSize] {
+        batcher.Start(tsfn, [this](Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands) {
+            EmitBatch(env, jsCallback, commands);
+        });
+        _thread = std::thread([this, portName, baudRate, linkAddress, otherLinkAddress, balanced, llParams, alParams, linkLayerMode, reconnectDelay, maxRetries, queueSize]() mutable {
             try {
                 int retryCount = 0;
                 while (running && retryCount <= maxRetries) {
@@ -193,11 +253,12 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
                     }
                     printf("Attempting to connect (attempt %d/%d), clientID: %s, clientId: %i\n", retryCount + 1, maxRetries + 1, clientID.c_str(), clientId);
 
-                    while (running) {
-                        CS101_Slave_run(slave);
-                        Thread_sleep(100);
-                        std::lock_guard<std::mutex> lock(connMutex);
-                        if (!connected) break;
+                    // Канальный уровень ведёт рабочий поток lib60870 (CS101_Slave_start): он ждёт
+                    // готовности порта и продвигает автоматы link_layer.c сразу по приходу байтов.
+                    // Здесь только ждём потери связи или остановки.
+                    {
+                        std::unique_lock<std::mutex> lock(connMutex);
+                        linkCv.wait(lock, [this] { return !running || !connected; });
                     }
 
                     std::lock_guard<std::mutex> lock(connMutex);
@@ -212,23 +273,7 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
                             throw runtime_error("Failed to recreate serial port object for reconnect");
                         }
 
-                        LinkLayerParameters llParams = LinkLayerParameters();
-                        llParams->addressLength = 1;
-                        llParams->timeoutForAck = t1 * 1000;
-                        llParams->timeoutRepeat = t2 * 1000;
-                        llParams->timeoutLinkState = t0 * 1000;
-                        llParams->useSingleCharACK = true;
-
-                        CS101_AppLayerParameters alParams = CS101_AppLayerParameters();
-                        alParams->sizeOfTypeId = 1;
-                        alParams->sizeOfVSQ = 1;
-                        alParams->sizeOfCOT = 2;
-                        alParams->originatorAddress = originatorAddress;
-                        alParams->sizeOfCA = 2;
-                        alParams->sizeOfIOA = 3;
-                        alParams->maxSizeOfASDU = 249;
-
-                        slave = CS101_Slave_createEx(serialPort, llParams, alParams, IEC60870_LINK_LAYER_UNBALANCED, queueSize, queueSize);
+                        slave = CS101_Slave_createEx(serialPort, &llParams, &alParams, linkLayerMode, queueSize, queueSize);
                         if (!slave) {
                             SerialPort_destroy(serialPort);
                             throw runtime_error("Failed to recreate slave object for reconnect");
@@ -237,6 +282,9 @@ Napi::Value IEC101Slave::Connect(const Napi::CallbackInfo& info) {
                         CS101_Slave_setASDUHandler(slave, RawMessageHandler, this);
                         CS101_Slave_setLinkLayerStateChanged(slave, LinkLayerStateChanged, this);
                         CS101_Slave_setLinkLayerAddress(slave, linkAddress);
+                        if (balanced) {
+                            CS101_Slave_setLinkLayerAddressOtherStation(slave, otherLinkAddress);
+                        }
                     } else if (!running && connected) {
                         printf("Thread stopped by client, closing connection, clientID: %s, clientId: %i\n", clientID.c_str(), clientId);
                         CS101_Slave_stop(slave);
@@ -322,10 +370,14 @@ Napi::Value IEC101Slave::Disconnect(const Napi::CallbackInfo& info) {
         }
     }
 
+    linkCv.notify_all();
+
     if (_thread.joinable()) {
         _thread.join();
     }
 
+    batcher.Stop();
+
     std::lock_guard<std::mutex> lock(connMutex);
     tsfn.Release();
 
@@ -333,6 +385,20 @@ Napi::Value IEC101Slave::Disconnect(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
+    return SubmitCommands(info, 0);
+}
+
+Napi::Value IEC101Slave::EnqueueClass1(const Napi::CallbackInfo& info) {
+    return SubmitCommands(info, 1);
+}
+
+Napi::Value IEC101Slave::EnqueueClass2(const Napi::CallbackInfo& info) {
+    return SubmitCommands(info, 2);
+}
+
+// dataClass 0: отправка через IMasterConnection (sendCommands),
+// 1/2: все ASDU кладутся в очередь класса 1/2 одним вызовом без вытеснения старых (enqueueClass1/enqueueClass2)
+Napi::Value IEC101Slave::SubmitCommands(const Napi::CallbackInfo& info, int dataClass) {
     Napi::Env env = info.Env();
 
     if (info.Length() < 1 || !info[0].IsArray()) {
@@ -343,12 +409,18 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
     Napi::Array commands = info[0].As<Napi::Array>();
 
     std::lock_guard<std::mutex> lock(connMutex);
-    if (!connected || !masterConnection) {
+    if (dataClass == 0 && (!connected || !masterConnection)) {
         Napi::Error::New(env, "Not connected or no master connection available").ThrowAsJavaScriptException();
         return env.Undefined();
     }
+    if (dataClass != 0 && (!running || !slave)) {
+        Napi::Error::New(env, "Slave not running").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
     CS101_AppLayerParameters alParams = CS101_Slave_getAppLayerParameters(slave);
+    std::vector<std::unique_ptr<sCS101_ASDU, void(*)(CS101_ASDU)>> queued;
+    queued.reserve(dataClass != 0 ? commands.Length() : 0);
 
     try {
         bool allSuccess = true;
@@ -398,7 +470,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
 
             CS101_ASDU asdu = CS101_ASDU_create(alParams, false, (CS101_CauseOfTransmission)cot, 0, asduAddress, false, false);
 
-            bool success = false;
              switch (typeId) {
                case M_SP_NA_1: {
                     if (!cmdObj.Get("value").IsBoolean()) {
@@ -409,7 +480,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
                     SinglePointInformation sp = SinglePointInformation_create(NULL, ioa, value, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sp);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SinglePointInformation_destroy(sp);
                     break;
                 }
@@ -427,7 +497,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     DoublePointInformation dp = DoublePointInformation_create(NULL, ioa, (DoublePointValue)value, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dp);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     DoublePointInformation_destroy(dp);
                     break;
                 }
@@ -445,7 +514,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     StepPositionInformation st = StepPositionInformation_create(NULL, ioa, value, false, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)st);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     StepPositionInformation_destroy(st);
                     break;
                 }
@@ -458,7 +526,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
                     BitString32 bo = BitString32_create(NULL, ioa, value);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     BitString32_destroy(bo);
                     break;
                 }
@@ -476,7 +543,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     MeasuredValueNormalized mn = MeasuredValueNormalized_create(NULL, ioa, value, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)mn);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueNormalized_destroy(mn);
                     break;
                 }
@@ -495,7 +561,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     MeasuredValueScaled ms = MeasuredValueScaled_create(NULL, ioa, value, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)ms);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueScaled_destroy(ms);
                     break;
                 }
@@ -509,7 +574,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     float value = static_cast<float>(doubleValue);
                     MeasuredValueShort mc = MeasuredValueShort_create(NULL, ioa, value, quality);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)mc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueShort_destroy(mc);
                     break;
                 }
@@ -523,7 +587,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     BinaryCounterReading bcr = BinaryCounterReading_create(NULL, value, 0, false, false, false);
                     IntegratedTotals it = IntegratedTotals_create(NULL, ioa, bcr);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)it);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     IntegratedTotals_destroy(it);
                     BinaryCounterReading_destroy(bcr);
                     break;
@@ -538,7 +601,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SinglePointWithCP56Time2a sp = SinglePointWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sp);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SinglePointWithCP56Time2a_destroy(sp);
                     break;
                 }
@@ -557,7 +619,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     DoublePointWithCP56Time2a dp = DoublePointWithCP56Time2a_create(NULL, ioa, (DoublePointValue)value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dp);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     DoublePointWithCP56Time2a_destroy(dp);
                     break;
                 }
@@ -576,7 +637,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     StepPositionWithCP56Time2a st = StepPositionWithCP56Time2a_create(NULL, ioa, value, false, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)st);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     StepPositionWithCP56Time2a_destroy(st);
                     break;
                 }
@@ -590,7 +650,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     Bitstring32WithCP56Time2a bo = Bitstring32WithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     Bitstring32WithCP56Time2a_destroy(bo);
                     break;
                 }
@@ -610,7 +669,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     MeasuredValueNormalizedWithCP56Time2a mn = MeasuredValueNormalizedWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)mn);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueNormalizedWithCP56Time2a_destroy(mn);
                     break;
                 }
@@ -629,7 +687,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     MeasuredValueScaledWithCP56Time2a ms = MeasuredValueScaledWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)ms);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueScaledWithCP56Time2a_destroy(ms);
                     break;
                 }
@@ -644,7 +701,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     MeasuredValueShortWithCP56Time2a mc = MeasuredValueShortWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)mc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     MeasuredValueShortWithCP56Time2a_destroy(mc);
                     break;
                 }
@@ -659,7 +715,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     BinaryCounterReading bcr = BinaryCounterReading_create(NULL, value, 0, false, false, false);
                     IntegratedTotalsWithCP56Time2a it = IntegratedTotalsWithCP56Time2a_create(NULL, ioa, bcr, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)it);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     IntegratedTotalsWithCP56Time2a_destroy(it);
                     BinaryCounterReading_destroy(bcr);
                     break;
@@ -673,7 +728,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
                     SingleCommand sc = SingleCommand_create(NULL, ioa, value, bselCmd, ql);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SingleCommand_destroy(sc);
                     break;
                 }
@@ -691,7 +745,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     DoubleCommand dc = DoubleCommand_create(NULL, ioa, value, bselCmd, ql);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     DoubleCommand_destroy(dc);
                     break;
                 }
@@ -710,7 +763,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     StepCommandWithCP56Time2a rc = StepCommandWithCP56Time2a_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     StepCommandWithCP56Time2a_destroy(rc);
                     break;
                 }
@@ -737,7 +789,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     SetpointCommandNormalizedWithCP56Time2a se = SetpointCommandNormalizedWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SetpointCommandNormalizedWithCP56Time2a_destroy(se);
                     break;
                 }
@@ -755,7 +806,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     SetpointCommandScaled se = SetpointCommandScaled_create(NULL, ioa, value, bselCmd, ql);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SetpointCommandScaled_destroy(se);
                     break;
                 }
@@ -776,7 +826,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     SetpointCommandShort se = SetpointCommandShort_create(NULL, ioa, value, bselCmd, ql);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SetpointCommandShort_destroy(se);
                     break;
                 }
@@ -789,7 +838,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
                     Bitstring32Command bo = Bitstring32Command_create(NULL, ioa, value);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     Bitstring32Command_destroy(bo);
                     break;
                 }
@@ -803,7 +851,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SingleCommandWithCP56Time2a sc = SingleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SingleCommandWithCP56Time2a_destroy(sc);
                     break;
                 }
@@ -822,7 +869,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     DoubleCommandWithCP56Time2a dc = DoubleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     DoubleCommandWithCP56Time2a_destroy(dc);
                     break;
                 }
@@ -841,7 +887,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     SetpointCommandScaledWithCP56Time2a se = SetpointCommandScaledWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SetpointCommandScaledWithCP56Time2a_destroy(se);
                     break;
                 }
@@ -863,7 +908,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SetpointCommandShortWithCP56Time2a se = SetpointCommandShortWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     SetpointCommandShortWithCP56Time2a_destroy(se);
                     break;
                 }
@@ -877,7 +921,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     Bitstring32CommandWithCP56Time2a bo = Bitstring32CommandWithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     Bitstring32CommandWithCP56Time2a_destroy(bo);
                     break;
                 }
@@ -895,7 +938,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     InterrogationCommand ic = InterrogationCommand_create(NULL, ioa, value);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)ic);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     InterrogationCommand_destroy(ic);
                     break;
                 }
@@ -913,14 +955,12 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     CounterInterrogationCommand ci = CounterInterrogationCommand_create(NULL, ioa, value);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)ci);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     CounterInterrogationCommand_destroy(ci);
                     break;
                 }
                 case C_RD_NA_1: {
                     ReadCommand rd = ReadCommand_create(NULL, ioa);
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)rd);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     ReadCommand_destroy(rd);
                     break;
                 }
@@ -933,7 +973,6 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     ClockSynchronizationCommand cs = ClockSynchronizationCommand_create(NULL, ioa, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
                     CS101_ASDU_addInformationObject(asdu, (InformationObject)cs);
-                    success = IMasterConnection_sendASDU(masterConnection, asdu);
                     ClockSynchronizationCommand_destroy(cs);
                     break;
                 }
@@ -945,6 +984,12 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                     continue;
             }
 
+            if (dataClass != 0) {
+                queued.emplace_back(asdu, CS101_ASDU_destroy);
+                continue;
+            }
+
+            bool success = IMasterConnection_sendASDU(masterConnection, asdu);
             CS101_ASDU_destroy(asdu);
             if (!success) {
                 allSuccess = false;
@@ -953,6 +998,21 @@ Napi::Value IEC101Slave::SendCommands(const Napi::CallbackInfo& info) {
                 printf("Sent command: typeId=%d, ioa=%d, clientID: %s, clientId: %i\n", typeId, ioa, clientID.c_str(), clientId);
             }
         }
+
+        if (dataClass != 0) {
+            std::vector<CS101_ASDU> asdus;
+            asdus.reserve(queued.size());
+            for (auto& asdu : queued) {
+                asdus.push_back(asdu.get());
+            }
+            int count = static_cast<int>(asdus.size());
+            int enqueued = (dataClass == 1) ? CS101_Slave_enqueueUserDataClass1Many(slave, asdus.data(), count)
+                                            : CS101_Slave_enqueueUserDataClass2Many(slave, asdus.data(), count);
+            if (enqueued < count) {
+                printf("Class %d queue full: %d of %d ASDUs enqueued, clientID: %s, clientId: %i\n", dataClass, enqueued, count, clientID.c_str(), clientId);
+            }
+            return Napi::Number::New(env, enqueued);
+        }
         return Napi::Boolean::New(env, allSuccess);
     } catch (const std::exception& e) {
         printf("Exception in SendCommands: %s, clientID: %s, clientId: %i\n", e.what(), clientID.c_str(), clientId);
@@ -968,9 +1028,36 @@ Napi::Value IEC101Slave::GetStatus(const Napi::CallbackInfo& info) {
     status.Set("connected", Napi::Boolean::New(env, connected));
     status.Set("clientId", Napi::Number::New(env, clientId));
     status.Set("clientID", Napi::String::New(env, clientID));
+    if (running && slave) {
+        status.Set("class1Queued", Napi::Number::New(env, CS101_Slave_getClass1QueueCount(slave)));
+        status.Set("class2Queued", Napi::Number::New(env, CS101_Slave_getClass2QueueCount(slave)));
+    }
+    status.Set("batching", batcher.GetStats(env));
     return status;
 }
 
+void IEC101Slave::EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands) {
+    Napi::Array jsArray = Napi::Array::New(env, commands.size());
+    for (size_t i = 0; i < commands.size(); i++) {
+        const CommandRecord& c = commands[i];
+        Napi::Object msg = Napi::Object::New(env);
+        msg.Set("clientID", Napi::String::New(env, clientID.c_str()));
+        msg.Set("typeId", Napi::Number::New(env, c.typeId));
+        msg.Set("ioa", Napi::Number::New(env, c.ioa));
+        msg.Set("val", Napi::Number::New(env, c.val));
+        msg.Set("quality", Napi::Number::New(env, c.quality));
+        msg.Set("bselCmd", Napi::Boolean::New(env, c.bselCmd));
+        msg.Set("ql", Napi::Number::New(env, c.ql));
+        if (c.timestamp > 0) {
+            msg.Set("timestamp", Napi::Number::New(env, static_cast<double>(c.timestamp)));
+        }
+        jsArray[i] = msg;
+    }
+    std::vector<napi_value> args = {Napi::String::New(env, "data"), jsArray};
+    jsCallback.Call(args);
+    cnt++;
+}
+
 void IEC101Slave::LinkLayerStateChanged(void* parameter, int address, LinkLayerState state) {
     IEC101Slave* client = static_cast<IEC101Slave*>(parameter);
     std::string eventStr;
@@ -1002,6 +1089,8 @@ void IEC101Slave::LinkLayerStateChanged(void* parameter, int address, LinkLayerS
         }
     }
 
+    client->linkCv.notify_all();
+
     printf("Link layer event: %s, reason: %s, clientID: %s, clientId: %i, slaveAddress: %d\n", eventStr.c_str(), reason.c_str(), client->clientID.c_str(), client->clientId, address);
 
     client->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
@@ -1326,6 +1415,15 @@ bool IEC101Slave::RawMessageHandler(void* parameter, IMasterConnection connectio
                    TypeID_toString(typeID), client->clientID.c_str(), client->clientId, ioa, val, quality, timestamp, bselCmd, ql, client->cnt);
         }
 
+        if (client->batcher.IsEnabled()) {
+            int receivedAsduAddress = CS101_ASDU_getCA(asdu);
+            client->batcher.Append(elements.size(), [&](size_t i) {
+                const auto& [ioa, val, quality, timestamp, bselCmd, ql] = elements[i];
+                return CommandRecord{std::string(), typeID, receivedAsduAddress, ioa, val, quality, timestamp, bselCmd, ql};
+            });
+            return true;
+        }
+
         client->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
             Napi::Array jsArray = Napi::Array::New(env, elements.size());
             for (size_t i = 0; i < elements.size(); i++) {
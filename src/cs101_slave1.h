@@ -6,7 +6,10 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <vector>
+#include <memory>
+#include "event_batcher.h"
 
 extern "C" {
 #include "hal_serial.h"
@@ -23,31 +26,37 @@ public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     IEC101Slave(const Napi::CallbackInfo& info);
     virtual ~IEC101Slave();
+    void Teardown();
 
 private:
 
-    static Napi::FunctionReference constructor;
    
-    CS101_Slave slave;
+    CS101_Slave slave = nullptr;
     SerialPort serialPort;
     std::thread _thread;
     std::atomic<bool> running;
     std::mutex connMutex;
+    std::condition_variable linkCv; // Будит поток соединения при потере связи или остановке
     bool connected = false;
     int clientId = 0;
     std::string clientID;
     int cnt = 0;
-    int asduAddress;
+    int asduAddress = 1;
     
     Napi::ThreadSafeFunction tsfn;
     IMasterConnection masterConnection = nullptr;
+    EventBatcher<CommandRecord> batcher; // Пакетная передача принятых команд в JS (batchSize/batchLatency)
 
     static bool RawMessageHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu);
     static void LinkLayerStateChanged(void* parameter, int address, LinkLayerState state);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands);
 
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value Disconnect(const Napi::CallbackInfo& info);
     Napi::Value SendCommands(const Napi::CallbackInfo& info);
+    Napi::Value EnqueueClass1(const Napi::CallbackInfo& info);
+    Napi::Value EnqueueClass2(const Napi::CallbackInfo& info);
+    Napi::Value SubmitCommands(const Napi::CallbackInfo& info, int dataClass);
     Napi::Value GetStatus(const Napi::CallbackInfo& info);
 };
 
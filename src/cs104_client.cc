@@ -22,19 +22,18 @@ time_t my_timegm(struct tm *tm)
 #include <fstream>
 #include <sstream>
 #include <inttypes.h> // Добавляем для PRIu64
+#include <math.h>
 #include "cs104_client.h"
+#include "addon_data.h"
 
 using namespace Napi;
 using namespace std;
 
-Napi::FunctionReference IEC104Client::constructor;
-
 Napi::Object IEC104Client::Init(Napi::Env env, Napi::Object exports)
 {
-    Napi::Function func = DefineClass(env, "IEC104Client", {InstanceMethod("connect", &IEC104Client::Connect), InstanceMethod("disconnect", &IEC104Client::Disconnect), InstanceMethod("sendStartDT", &IEC104Client::SendStartDT), InstanceMethod("sendStopDT", &IEC104Client::SendStopDT), InstanceMethod("sendCommands", &IEC104Client::SendCommands), InstanceMethod("getStatus", &IEC104Client::GetStatus), InstanceMethod("requestFileList", &IEC104Client::RequestFileList), InstanceMethod("selectFile", &IEC104Client::SelectFile), InstanceMethod("openFile", &IEC104Client::OpenFile), InstanceMethod("requestFileSegment", &IEC104Client::RequestFileSegment), InstanceMethod("confirmFileTransfer", &IEC104Client::ConfirmFileTransfer)});
+    Napi::Function func = DefineClass(env, "IEC104Client", {InstanceMethod("connect", &IEC104Client::Connect), InstanceMethod("disconnect", &IEC104Client::Disconnect), InstanceMethod("sendStartDT", &IEC104Client::SendStartDT), InstanceMethod("sendStopDT", &IEC104Client::SendStopDT), InstanceMethod("sendCommands", &IEC104Client::SendCommands), InstanceMethod("submitCommands", &IEC104Client::SubmitCommands), InstanceMethod("getStatus", &IEC104Client::GetStatus), InstanceMethod("getPoints", &IEC104Client::GetPoints), InstanceMethod("snapshot", &IEC104Client::Snapshot), InstanceMethod("requestFileList", &IEC104Client::RequestFileList), InstanceMethod("selectFile", &IEC104Client::SelectFile), InstanceMethod("openFile", &IEC104Client::OpenFile), InstanceMethod("requestFileSegment", &IEC104Client::RequestFileSegment), InstanceMethod("confirmFileTransfer", &IEC104Client::ConfirmFileTransfer)});
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    GetAddonData(env)->iec104Client = Napi::Persistent(func);
     exports.Set("IEC104Client", func);
     return exports;
 }
@@ -69,26 +68,32 @@ IEC104Client::IEC104Client(const Napi::CallbackInfo &info) : Napi::ObjectWrap<IE
     {
         // printf("Failed to create ThreadSafeFunction: %s\n", e.what());
         Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
     }
+    AddTeardownHook(info.Env(), this);
 }
 
 IEC104Client::~IEC104Client()
 {
-    std::lock_guard<std::mutex> lock(this->connMutex);
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает
+void IEC104Client::Teardown()
+{
     if (running)
     {
-        running = false;
-        if (connected)
         {
-            // printf("Destructor closing connection, clientID: %s\n", clientID.c_str());
-            CS104_Connection_destroy(connection);
-            connected = false;
-            activated = false;
+            std::lock_guard<std::mutex> lock(this->dialMutex);
+            running = false;
         }
+        dialCv.notify_all();
         if (_thread.joinable())
         {
             _thread.join();
         }
+        batcher.Stop();
         tsfn.Release();
     }
 }
@@ -157,212 +162,136 @@ Napi::Value IEC104Client::Connect(const Napi::CallbackInfo &info)
         t3 = params.Get("t3").As<Napi::Number>().Int32Value();
     if (params.Has("reconnectDelay"))
         reconnectDelay = params.Get("reconnectDelay").As<Napi::Number>().Int32Value();
+    int connectTimeout = t0 * 1000, startDTTimeout = -1;
+    if (params.Has("connectTimeout"))
+        connectTimeout = params.Get("connectTimeout").As<Napi::Number>().Int32Value();
+    if (params.Has("startDTTimeout"))
+        startDTTimeout = params.Get("startDTTimeout").As<Napi::Number>().Int32Value();
+    if (params.Has("primaryCheckInterval"))
+        primaryCheckIntervalMs = params.Get("primaryCheckInterval").As<Napi::Number>().Int32Value();
+    int standbyKeepAlive = -1;
+    if (params.Has("standbyT3"))
+        standbyKeepAlive = params.Get("standbyT3").As<Napi::Number>().Int32Value();
+
+    std::string redundancy = "parallel";
+    if (params.Has("redundancy") && params.Get("redundancy").IsString())
+        redundancy = params.Get("redundancy").As<Napi::String>().Utf8Value();
+    if (redundancy != "parallel" && redundancy != "hot-standby")
+    {
+        Napi::Error::New(env, "Invalid 'redundancy', expected 'parallel' or 'hot-standby'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (redundancy == "hot-standby" && ipReserve.empty())
+    {
+        Napi::Error::New(env, "redundancy 'hot-standby' requires 'ipReserve'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-    if (originatorAddress < 0 || originatorAddress > 255 || asduAddress < 0 || asduAddress > 65535 ||
-        k <= 0 || w <= 0 || t0 <= 0 || t1 <= 0 || t2 <= 0 || t3 <= 0 || reconnectDelay < 1)
+    std::string dataFormat = "objects";
+    if (params.Has("dataFormat") && params.Get("dataFormat").IsString())
+        dataFormat = params.Get("dataFormat").As<Napi::String>().Utf8Value();
+    if (dataFormat != "objects" && dataFormat != "columnar")
     {
-        Napi::Error::New(env, "Invalid connection parameters").ThrowAsJavaScriptException();
+        Napi::Error::New(env, "Invalid 'dataFormat', expected 'objects' or 'columnar'").ThrowAsJavaScriptException();
         return env.Undefined();
     }
+    columnar = (dataFormat == "columnar");
 
-    try
+    std::string deliverMode = "all";
+    if (params.Has("deliver") && params.Get("deliver").IsString())
+        deliverMode = params.Get("deliver").As<Napi::String>().Utf8Value();
+    if (deliverMode != "all" && deliverMode != "changesOnly" && deliverMode != "none")
+    {
+        Napi::Error::New(env, "Invalid 'deliver', expected 'all', 'changesOnly' or 'none'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    int cacheCapacity = 1024;
+    if (params.Has("cacheCapacity"))
+        cacheCapacity = params.Get("cacheCapacity").As<Napi::Number>().Int32Value();
+    if (cacheCapacity <= 0)
+    {
+        Napi::Error::New(env, "cacheCapacity must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    // 'changesOnly' и 'none' без таблицы последних значений не имеют смысла, поэтому включают её
+    useCache = (params.Has("lastValueCache") && params.Get("lastValueCache").ToBoolean().Value()) || deliverMode != "all";
+    deliver = deliverMode == "changesOnly" ? DELIVER_CHANGES : deliverMode == "none" ? DELIVER_NONE : DELIVER_ALL;
+    if (useCache)
+    {
+        auto cacheLock = lastValues.Lock();
+        lastValues.Reset(static_cast<size_t>(cacheCapacity));
+        suppressedPoints = 0;
+    }
+
+    std::string batchError = batcher.Configure(params);
+    if (!batchError.empty())
+    {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string deadbandError = deadband.Configure(params);
+    if (!deadbandError.empty())
+    {
+        Napi::Error::New(env, deadbandError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (params.Has("dataRing"))
     {
-        // printf("Creating connection to %s:%d, clientID: %s\n", ip.c_str(), port, clientID.c_str());
-        //fflush(stdout);
-        connection = CS104_Connection_create(ip.c_str(), port);
-        if (!connection)
+        std::string ringError = dataRing.Attach(params.Get("dataRing"));
+        if (!ringError.empty())
         {
-            throw runtime_error("Failed to create connection object");
+            Napi::TypeError::New(env, ringError).ThrowAsJavaScriptException();
+            return env.Undefined();
         }
+    }
+    else
+    {
+        dataRing.Detach();
+    }
 
-        CS101_AppLayerParameters alParams = CS104_Connection_getAppLayerParameters(connection);
-        alParams->originatorAddress = originatorAddress;
-        alParams->sizeOfCA = 2;
-
-        CS104_APCIParameters apciParams = CS104_Connection_getAPCIParameters(connection);
-        apciParams->k = k;
-        apciParams->w = w;
-        apciParams->t0 = t0;
-        apciParams->t1 = t1;
-        apciParams->t2 = t2;
-        apciParams->t3 = t3;
+    if (originatorAddress < 0 || originatorAddress > 255 || asduAddress < 0 || asduAddress > 65535 ||
+        k <= 0 || w <= 0 || t0 <= 0 || t1 <= 0 || t2 <= 0 || t3 <= 0 || reconnectDelay < 1)
+    {
+        Napi::Error::New(env, "Invalid connection parameters").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-        CS104_Connection_setConnectionHandler(connection, ConnectionHandler, this);
-        CS104_Connection_setASDUReceivedHandler(connection, RawMessageHandler, this);
+    if (startDTTimeout < 0)
+        startDTTimeout = t1 * 1000;
+    if (standbyKeepAlive < 0)
+        standbyKeepAlive = t3;
+    if (standbyKeepAlive == 0)
+    {
+        Napi::Error::New(env, "standbyT3 must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (connectTimeout <= 0 || startDTTimeout <= 0 || primaryCheckIntervalMs <= 0)
+    {
+        Napi::Error::New(env, "connectTimeout, startDTTimeout and primaryCheckInterval must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-        // printf("Connecting with params: originatorAddress=%d, asduAddress=%d, k=%d, w=%d, t0=%d, t1=%d, t2=%d, t3=%d, reconnectDelay=%d, clientID: %s\n",
-        //        originatorAddress, asduAddress, k, w, t0, t1, t2, t3, reconnectDelay, clientID.c_str());
-        //fflush(stdout);
+    try
+    {
+        apciParameters.k = k;
+        apciParameters.w = w;
+        apciParameters.t0 = t0;
+        apciParameters.t1 = t1;
+        apciParameters.t2 = t2;
+        apciParameters.t3 = t3;
+        connectTimeoutMs = connectTimeout;
+        startDTTimeoutMs = startDTTimeout;
+        hotStandby = (redundancy == "hot-standby");
+        commandALParams = {1, 1, 2, originatorAddress, 2, 3, 249}; // Как у соединения: sizeOfCA = 2
+        standbyT3 = standbyKeepAlive;
+        connection = nullptr;
 
         running = true;
         usingPrimaryIp = true;
-        _thread = std::thread([this, ip, ipReserve, port, k, w, t0, t1, t2, t3, reconnectDelay]()
-                              {
-    try {
-        int primaryRetryCount = 0;
-        int reserveRetryCount = 0;
-        const int maxRetries = 3; // Максимальное количество попыток для каждого IP
-        std::string currentIp = ip;
-        bool isPrimary = true;
-
-        while (running) {
-           // printf("Attempting to connect to %s:%d (attempt %d/%d), clientID: %s\n", 
-            //       currentIp.c_str(), port, (isPrimary ? primaryRetryCount : reserveRetryCount) + 1, maxRetries, clientID.c_str());
-            //fflush(stdout);
-
-            // Создаем новое соединение
-            connection = CS104_Connection_create(currentIp.c_str(), port);
-            if (!connection) {
-                throw runtime_error("Failed to create connection object");
-            }
-
-            CS101_AppLayerParameters alParams = CS104_Connection_getAppLayerParameters(connection);
-            alParams->originatorAddress = this->originatorAddress;
-            alParams->sizeOfCA = 2;
-
-            CS104_APCIParameters apciParams = CS104_Connection_getAPCIParameters(connection);
-            apciParams->k = k;
-            apciParams->w = w;
-            apciParams->t0 = t0;
-            apciParams->t1 = t1;
-            apciParams->t2 = t2;
-            apciParams->t3 = t3;
-
-            CS104_Connection_setConnectionHandler(connection, ConnectionHandler, this);
-            CS104_Connection_setASDUReceivedHandler(connection, RawMessageHandler, this);
-
-            bool connectSuccess = CS104_Connection_connect(connection);
-            {
-                std::lock_guard<std::mutex> lock(this->connMutex);
-                connected = connectSuccess;
-                activated = false;
-                usingPrimaryIp = isPrimary;
-            }
-
-            if (connectSuccess) {
-               // printf("Connected successfully to %s:%d, clientID: %s\n", currentIp.c_str(), port, clientID.c_str());
-                //fflush(stdout);
-                primaryRetryCount = 0;
-                reserveRetryCount = 0;
-
-                while (running) {
-                    {
-                        std::lock_guard<std::mutex> lock(this->connMutex);
-                        if (!connected) break;
-                    }
-                    Thread_sleep(100);
-
-                    // Проверка доступности основного IP, если используется резервный
-                    if (!isPrimary && !ipReserve.empty()) {
-                       // printf("Checking primary IP %s:%d availability, clientID: %s\n", ip.c_str(), port, clientID.c_str());
-                        //fflush(stdout);
-                        CS104_Connection testConn = CS104_Connection_create(ip.c_str(), port);
-                        if (testConn && CS104_Connection_connect(testConn)) {
-                           // printf("Primary IP %s restored, switching back, clientID: %s\n", ip.c_str(), clientID.c_str());
-                            //fflush(stdout);
-                            CS104_Connection_destroy(testConn);
-
-                            // Закрываем текущее соединение
-                           // printf("Closing current connection to %s:%d, clientID: %s\n", currentIp.c_str(), port, clientID.c_str());
-                            CS104_Connection_destroy(connection);
-                            connection = nullptr;
-
-                            {
-                                std::lock_guard<std::mutex> lock(this->connMutex);
-                                connected = false;
-                                activated = false;
-                            }
-
-                            currentIp = ip;
-                            isPrimary = true;
-                            primaryRetryCount = 0;
-                            break; // Выходим из внутреннего цикла для создания нового соединения
-                        } else {
-                          //  printf("Primary IP %s still unavailable, clientID: %s\n", ip.c_str(), clientID.c_str());
-                            CS104_Connection_destroy(testConn);
-                            Thread_sleep(5000);
-                        }
-                    }
-                }
-            } else {
-                //printf("Connection failed to %s:%d, clientID: %s\n", currentIp.c_str(), port, clientID.c_str());
-                //fflush(stdout);
-                tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
-                    Napi::Object eventObj = Napi::Object::New(env);
-                    eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
-                    eventObj.Set("type", Napi::String::New(env, "control"));
-                    eventObj.Set("event", Napi::String::New(env, "reconnecting"));
-                    eventObj.Set("reason", Napi::String::New(env, string("attempt ") + to_string((isPrimary ? primaryRetryCount : reserveRetryCount) + 1) + " to " + currentIp));
-                    eventObj.Set("isPrimaryIP", Napi::Boolean::New(env, isPrimary));
-                    std::vector<napi_value> args = {Napi::String::New(env, "conn"), eventObj};
-                    jsCallback.Call(args);
-                });
-            }
-
-            if (running && !connected) {
-                // Увеличиваем счетчик попыток для текущего IP
-                if (isPrimary) {
-                    primaryRetryCount++;
-                } else {
-                    reserveRetryCount++;
-                }
-
-                // Закрываем текущее соединение
-                CS104_Connection_destroy(connection);
-                connection = nullptr;
-
-                // Логика переключения IP
-                if (isPrimary && primaryRetryCount >= maxRetries && !ipReserve.empty()) {
-                    // Переключаемся на резервный IP после maxRetries попыток
-                   // printf("Primary IP %s unresponsive after %d attempts, switching to reserve IP %s, clientID: %s\n", 
-                     //      ip.c_str(), maxRetries, ipReserve.c_str(), clientID.c_str());
-                    currentIp = ipReserve;
-                    isPrimary = false;
-                    primaryRetryCount = 0; // Сбрасываем счетчик для основного IP
-                    reserveRetryCount = 0; // Сбрасываем счетчик для резервного IP
-                } else if (!isPrimary && reserveRetryCount >= maxRetries) {
-                    // Возвращаемся к основному IP после maxRetries попыток на резервном
-                  //  printf("Reserve IP %s unresponsive after %d attempts, switching back to primary IP %s, clientID: %s\n", 
-                    //       ipReserve.c_str(), maxRetries, ip.c_str(), clientID.c_str());
-                    currentIp = ip;
-                    isPrimary = true;
-                    reserveRetryCount = 0; // Сбрасываем счетчик для резервного IP
-                    primaryRetryCount = 0; // Сбрасываем счетчик для основного IP (для бесконечных попыток)
-                }
-
-               // printf("Reconnection attempt failed, retrying in %d seconds, clientID: %s\n", reconnectDelay, clientID.c_str());
-                Thread_sleep(reconnectDelay * 1000);
-            }
-
-            // Проверяем, завершена ли работа потока
-            if (!running && connected) {
-               // printf("Thread stopped by client, closing connection, clientID: %s\n", clientID.c_str());
-                CS104_Connection_destroy(connection);
-                connected = false;
-                activated = false;
-                return;
-            }
-        }
-    } catch (const std::exception& e) {
-       // printf("Exception in connection thread: %s, clientID: %s\n", e.what(), clientID.c_str());
-        //fflush(stdout);
-        std::lock_guard<std::mutex> lock(this->connMutex);
-        running = false;
-        if (connected) {
-            CS104_Connection_destroy(connection);
-            connected = false;
-            activated = false;
-        }
-        tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
-            Napi::Object eventObj = Napi::Object::New(env);
-            eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
-            eventObj.Set("type", Napi::String::New(env, "control"));
-            eventObj.Set("event", Napi::String::New(env, "error"));
-            eventObj.Set("reason", Napi::String::New(env, string("Thread exception: ") + e.what()));
-            std::vector<napi_value> args = {Napi::String::New(env, "conn"), eventObj};
-            jsCallback.Call(args);
-        });
-    } });
+        batcher.Start(tsfn, [this](Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord> &points)
+                      { EmitBatch(env, jsCallback, points); });
+        _thread = std::thread([this, ip, ipReserve, port, reconnectDelay]()
+                              { RunConnectionLoop(ip, ipReserve, port, reconnectDelay); });
 
         return env.Undefined();
     }
@@ -381,26 +310,21 @@ Napi::Value IEC104Client::Disconnect(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
     {
-        std::lock_guard<std::mutex> lock(this->connMutex);
-        if (running)
-        {
-            running = false;
-            if (connected)
-            {
-                //  printf("Disconnect called by client, clientID: %s\n", clientID.c_str());
-                CS104_Connection_destroy(connection);
-                connected = false;
-                activated = false;
-            }
-        }
+        // Соединения закрывает поток соединения при выходе из RunConnectionLoop
+        std::lock_guard<std::mutex> lock(this->dialMutex);
+        running = false;
     }
+    dialCv.notify_all();
 
     if (_thread.joinable())
     {
         _thread.join();
     }
 
+    batcher.Stop();
+
     std::lock_guard<std::mutex> lock(this->connMutex);
+    SettleUndeliveredCommands(env);
     tsfn.Release();
 
     return env.Undefined();
@@ -502,437 +426,771 @@ Napi::Value IEC104Client::SendCommands(const Napi::CallbackInfo &info)
 
             CS101_ASDU asdu = CS101_ASDU_create(CS104_Connection_getAppLayerParameters(connection), false, CS101_COT_ACTIVATION, originatorAddress, asduAddress, false, false);
 
-            bool success = false;
-            switch (typeId)
-            {
-            case C_SC_NA_1:
-            {
-                if (!cmdObj.Get("value").IsBoolean())
-                {
-                    Napi::TypeError::New(env, "C_SC_NA_1 requires 'value' as boolean").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                bool value = cmdObj.Get("value").As<Napi::Boolean>();
-                SingleCommand sc = SingleCommand_create(NULL, ioa, value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SingleCommand_destroy(sc);
-                break;
-            }
-
-            case C_DC_NA_1:
+            bool success = EncodeCommand(env, cmdObj, asdu, typeId, ioa, bselCmd, ql);
+            if (env.IsExceptionPending())
             {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_DC_NA_1 requires 'value' as number (0-3)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                if (value < 0 || value > 3)
-                {
-                    Napi::RangeError::New(env, "C_DC_NA_1 'value' must be 0-3").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                DoubleCommand dc = DoubleCommand_create(NULL, ioa, value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                DoubleCommand_destroy(dc);
-                break;
+                CS101_ASDU_destroy(asdu);
+                return env.Undefined();
             }
-
-            case C_RC_NA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_RC_NA_1 requires 'value' as number (0-3)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                if (value < 0 || value > 3)
-                {
-                    Napi::RangeError::New(env, "C_RC_NA_1 'value' must be 0-3").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                StepCommand rc = StepCommand_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
+            if (success)
                 success = CS104_Connection_sendASDU(connection, asdu);
-                StepCommand_destroy(rc);
-                break;
-            }
 
-            case C_SE_NA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_NA_1 requires 'value' as number (-1.0 to 1.0)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
-                if (value < -1.0f || value > 1.0f)
-                {
-                    Napi::RangeError::New(env, "C_SE_NA_1 'value' must be between -1.0 and 1.0").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                SetpointCommandNormalized scn = SetpointCommandNormalized_create(NULL, ioa, value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandNormalized_destroy(scn);
-                break;
-            }
+            CS101_ASDU_destroy(asdu);
 
-            case C_SE_NB_1:
+            if (!success)
             {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_NB_1 requires 'value' as number (-32768 to 32767)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                if (value < -32768 || value > 32767)
-                {
-                    Napi::RangeError::New(env, "C_SE_NB_1 'value' must be between -32768 and 32767").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                SetpointCommandScaled scs = SetpointCommandScaled_create(NULL, ioa, value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandScaled_destroy(scs);
-                break;
+                allSuccess = false;
+                //    printf("Failed to send command: typeId=%d, ioa=%d, clientID: %s, isPrimaryIP=%d\n", typeId, ioa, clientID.c_str(), usingPrimaryIp);
             }
-
-            case C_SE_NC_1:
+            else
             {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_NC_1 requires 'value' as number").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
-                SetpointCommandShort scsf = SetpointCommandShort_create(NULL, ioa, value, bselCmd, ql);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandShort_destroy(scsf);
-                break;
+                //   printf("Sent command: typeId=%d, ioa=%d, bselCmd=%d, ql=%d, clientID: %s, isPrimaryIP=%d\n", typeId, ioa, bselCmd, ql, clientID.c_str(), usingPrimaryIp);
             }
+        } // Закрытие for
+        return Napi::Boolean::New(env, allSuccess);
+    }
+    catch (const std::exception &e)
+    {
+        // printf("Exception in SendCommands: %s, clientID: %s, isPrimaryIP=%d\n", e.what(), clientID.c_str(), usingPrimaryIp);
+        Napi::Error::New(env, string("SendCommands failed: ") + e.what()).ThrowAsJavaScriptException();
 
-            case C_BO_NA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_BO_NA_1 requires 'value' as number (32-bit unsigned integer)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
-                Bitstring32Command bc = Bitstring32Command_create(NULL, ioa, value);
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                Bitstring32Command_destroy(bc);
-                break;
-            }
+        // Добавляем isPrimaryIP в объект события
+        tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback)
+                             {
+            Napi::Object eventObj = Napi::Object::New(env);
+            eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
+            eventObj.Set("type", Napi::String::New(env, "error"));
+            eventObj.Set("reason", Napi::String::New(env, string("SendCommands failed: ") + e.what()));
+            eventObj.Set("isPrimaryIP", Napi::Boolean::New(env, usingPrimaryIp)); // Добавляем isPrimaryIP
+            std::vector<napi_value> args = {Napi::String::New(env, "data"), eventObj};
+            jsCallback.Call(args); });
 
-            case C_SC_TA_1:
-            {
-                if (!cmdObj.Get("value").IsBoolean() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SC_TA_1 requires 'value' (boolean) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                bool value = cmdObj.Get("value").As<Napi::Boolean>();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                SingleCommandWithCP56Time2a sc = SingleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SingleCommandWithCP56Time2a_destroy(sc);
-                break;
-            }
+        return Napi::Boolean::New(env, false);
+    }
+}
 
-            case C_DC_TA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_DC_TA_1 requires 'value' (number 0-3) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                if (value < 0 || value > 3)
-                {
-                    Napi::RangeError::New(env, "C_DC_TA_1 'value' must be 0-3").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                DoubleCommandWithCP56Time2a dc = DoubleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                DoubleCommandWithCP56Time2a_destroy(dc);
-                break;
-            }
+// Команды в очереди клиента: каждая отправляется, когда в окне k есть место, и завершает свой
+// Promise по ACT_CON (ACT_TERM) или по таймауту. Очередь переживает переподключение и failover
+Napi::Value IEC104Client::SubmitCommands(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
 
-            case C_RC_TA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_RC_TA_1 requires 'value' (number 0-3) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                if (value < 0 || value > 3)
-                {
-                    Napi::RangeError::New(env, "C_RC_TA_1 'value' must be 0-3").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                StepCommandWithCP56Time2a rc = StepCommandWithCP56Time2a_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                StepCommandWithCP56Time2a_destroy(rc);
-                break;
-            }
+    if (info.Length() < 1 || !info[0].IsArray())
+    {
+        Napi::TypeError::New(env, "Expected commands (array of objects with 'typeId', 'ioa', 'asdu', and 'value') and optional options { timeout (ms), confirm ('actcon' | 'actterm') }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-            case C_SE_TA_1:
+    uint64_t timeoutMs = 10000;
+    bool waitTerm = false;
+    if (info.Length() > 1 && !info[1].IsUndefined())
+    {
+        if (!info[1].IsObject())
+        {
+            Napi::TypeError::New(env, "Options must be an object { timeout (ms), confirm ('actcon' | 'actterm') }").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("timeout"))
+        {
+            int timeout = options.Get("timeout").As<Napi::Number>().Int32Value();
+            if (timeout <= 0)
             {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_TA_1 requires 'value' (number -1.0 to 1.0) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                if (value < -1.0f || value > 1.0f)
-                {
-                    Napi::RangeError::New(env, "C_SE_TA_1 'value' must be between -1.0 and 1.0").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                SetpointCommandNormalizedWithCP56Time2a scn = SetpointCommandNormalizedWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandNormalizedWithCP56Time2a_destroy(scn);
-                break;
+                Napi::RangeError::New(env, "timeout must be positive").ThrowAsJavaScriptException();
+                return env.Undefined();
             }
-
-            case C_SE_TB_1:
+            timeoutMs = timeout;
+        }
+        if (options.Has("confirm"))
+        {
+            std::string confirm = options.Get("confirm").ToString().Utf8Value();
+            if (confirm != "actcon" && confirm != "actterm")
             {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_TB_1 requires 'value' (number -32768 to 32767) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                if (value < -32768 || value > 32767)
-                {
-                    Napi::RangeError::New(env, "C_SE_TB_1 'value' must be between -32768 and 32767").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                SetpointCommandScaledWithCP56Time2a scs = SetpointCommandScaledWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandScaledWithCP56Time2a_destroy(scs);
-                break;
+                Napi::Error::New(env, "confirm must be 'actcon' or 'actterm'").ThrowAsJavaScriptException();
+                return env.Undefined();
             }
+            waitTerm = (confirm == "actterm");
+        }
+    }
 
-            case C_SE_TC_1:
-            {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_SE_TC_1 requires 'value' (number) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                SetpointCommandShortWithCP56Time2a scsf = SetpointCommandShortWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                SetpointCommandShortWithCP56Time2a_destroy(scsf);
-                break;
-            }
+    Napi::Array commands = info[0].As<Napi::Array>();
 
-            case C_BO_TA_1:
-            {
-                if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_BO_TA_1 requires 'value' (32-bit number) and 'timestamp' (number)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
-                uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                Bitstring32CommandWithCP56Time2a bc = Bitstring32CommandWithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                Bitstring32CommandWithCP56Time2a_destroy(bc);
-                break;
-            }
+    std::lock_guard<std::mutex> lock(this->connMutex);
+    if (!running)
+    {
+        Napi::Error::New(env, "Client not running").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-            case C_IC_NA_1:
-            {
-                CS101_ASDU_setTypeID(asdu, C_IC_NA_1);
-                CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION);
-                InformationObject io = (InformationObject)InterrogationCommand_create(NULL, ioa, cmdObj.Get("value").As<Napi::Number>().Uint32Value());
-                CS101_ASDU_addInformationObject(asdu, io);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                InformationObject_destroy(io);
-                break;
-            }
+    // Сначала кодируются все команды: при ошибке в любой из них в очередь не попадает ни одна
+    uint64_t now = Hal_getTimeInMs();
+    std::vector<std::shared_ptr<PipelinedCommand>> pipelined;
+    Napi::Array promises = Napi::Array::New(env, commands.Length());
+    for (uint32_t i = 0; i < commands.Length(); i++)
+    {
+        Napi::Value item = commands[i];
+        if (!item.IsObject())
+        {
+            Napi::TypeError::New(env, "Each command must be an object").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
 
-            case C_CI_NA_1:
-            {
-                CS101_ASDU_setTypeID(asdu, C_CI_NA_1);
-                CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
-                InformationObject io = (InformationObject)CounterInterrogationCommand_create(NULL, ioa, cmdObj.Get("value").As<Napi::Number>().Uint32Value());
-                CS101_ASDU_addInformationObject(asdu, io);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                InformationObject_destroy(io);
-                break;
-            }
+        Napi::Object cmdObj = item.As<Napi::Object>();
+        if (!cmdObj.Has("typeId") || !cmdObj.Has("ioa") || !cmdObj.Has("asdu") || !cmdObj.Has("value"))
+        {
+            Napi::TypeError::New(env, "Each command must have 'typeId' (number), 'ioa' (number), 'asdu' (number), and 'value'").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        int typeId = cmdObj.Get("typeId").As<Napi::Number>().Int32Value();
+        int ioa = cmdObj.Get("ioa").As<Napi::Number>().Int32Value();
+        int ca = cmdObj.Get("asdu").As<Napi::Number>().Int32Value();
+
+        // Только команды с подтверждением активации: C_RD_NA_1 и файловые ASDU ACT_CON не получают
+        if (!((typeId >= C_SC_NA_1 && typeId <= C_BO_TA_1) || (typeId >= C_IC_NA_1 && typeId <= C_TS_TA_1)) || typeId == C_RD_NA_1)
+        {
+            Napi::TypeError::New(env, "submitCommands does not support typeId " + to_string(typeId)).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        bool bselCmd = cmdObj.Has("bselCmd") && cmdObj.Get("bselCmd").IsBoolean() ? cmdObj.Get("bselCmd").As<Napi::Boolean>() : false;
+        int ql = cmdObj.Has("ql") && cmdObj.Get("ql").IsNumber() ? cmdObj.Get("ql").As<Napi::Number>().Int32Value() : 0;
+        if (ql < 0 || ql > 31)
+        {
+            Napi::RangeError::New(env, "ql must be between 0 and 31").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        int cot = cmdObj.Has("cot") ? cmdObj.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_ACTIVATION;
+        if (cot != CS101_COT_ACTIVATION && cot != CS101_COT_DEACTIVATION)
+        {
+            Napi::RangeError::New(env, "cot must be 6 (activation) or 8 (deactivation)").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        std::shared_ptr<PipelinedCommand> command = std::make_shared<PipelinedCommand>(PipelinedCommand{Napi::Promise::Deferred::New(env)});
+        command->asdu.reset(CS101_ASDU_create(&commandALParams, false, CS101_COT_ACTIVATION, originatorAddress, ca, false, false));
+        if (!EncodeCommand(env, cmdObj, command->asdu.get(), typeId, ioa, bselCmd, ql))
+        {
+            if (!env.IsExceptionPending())
+                Napi::TypeError::New(env, "Unsupported command typeId " + to_string(typeId)).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        // EncodeCommand выставляет COT активации; ответ сопоставляется с тем COT, что ушёл в ASDU
+        CS101_ASDU_setCOT(command->asdu.get(), static_cast<CS101_CauseOfTransmission>(cot));
+
+        command->typeId = typeId;
+        command->ioa = ioa;
+        command->ca = ca;
+        command->cot = cot;
+        command->waitTerm = waitTerm && cot == CS101_COT_ACTIVATION; // Деактивация завершается DEACT_CON
+        command->queuedAt = now;
+        command->deadline = now + timeoutMs;
+        promises[i] = command->deferred.Promise();
+        pipelined.push_back(command);
+    }
+
+    // Без активного соединения команды не ждут таймаута в очереди
+    if (!connected || !activated)
+    {
+        for (auto &command : pipelined)
+        {
+            commandsFailed++;
+            command->deferred.Reject(Napi::Error::New(env, "Not connected").Value());
+        }
+        return promises;
+    }
+
+    for (auto &command : pipelined)
+        commandQueue.push_back(command);
 
-            case C_RD_NA_1:
+    // Отправляет поток соединения (ServeCommandQueue)
+    commandWakeup = true;
+    WakeConnectionLoop();
+
+    return promises;
+}
+
+// Кодирует команду в asdu (ASDU создан вызывающим и им же освобождается). false — команда не
+// закодирована: неподдерживаемый typeId или ошибка в параметрах (тогда брошено JS-исключение)
+bool IEC104Client::EncodeCommand(Napi::Env env, Napi::Object cmdObj, CS101_ASDU asdu, int typeId, int ioa, bool bselCmd, int ql)
+{
+    bool success = false;
+    switch (typeId)
+    {
+    case C_SC_NA_1:
+    {
+        if (!cmdObj.Get("value").IsBoolean())
+        {
+            Napi::TypeError::New(env, "C_SC_NA_1 requires 'value' as boolean").ThrowAsJavaScriptException();
+            return false;
+        }
+        bool value = cmdObj.Get("value").As<Napi::Boolean>();
+        SingleCommand sc = SingleCommand_create(NULL, ioa, value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
+        success = true;
+        SingleCommand_destroy(sc);
+        break;
+    }
+
+    case C_DC_NA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_DC_NA_1 requires 'value' as number (0-3)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        if (value < 0 || value > 3)
+        {
+            Napi::RangeError::New(env, "C_DC_NA_1 'value' must be 0-3").ThrowAsJavaScriptException();
+            return false;
+        }
+        DoubleCommand dc = DoubleCommand_create(NULL, ioa, value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
+        success = true;
+        DoubleCommand_destroy(dc);
+        break;
+    }
+
+    case C_RC_NA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_RC_NA_1 requires 'value' as number (0-3)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        if (value < 0 || value > 3)
+        {
+            Napi::RangeError::New(env, "C_RC_NA_1 'value' must be 0-3").ThrowAsJavaScriptException();
+            return false;
+        }
+        StepCommand rc = StepCommand_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
+        success = true;
+        StepCommand_destroy(rc);
+        break;
+    }
+
+    case C_SE_NA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_NA_1 requires 'value' as number (-1.0 to 1.0)").ThrowAsJavaScriptException();
+            return false;
+        }
+        float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
+        if (value < -1.0f || value > 1.0f)
+        {
+            Napi::RangeError::New(env, "C_SE_NA_1 'value' must be between -1.0 and 1.0").ThrowAsJavaScriptException();
+            return false;
+        }
+        SetpointCommandNormalized scn = SetpointCommandNormalized_create(NULL, ioa, value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
+        success = true;
+        SetpointCommandNormalized_destroy(scn);
+        break;
+    }
+
+    case C_SE_NB_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_NB_1 requires 'value' as number (-32768 to 32767)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        if (value < -32768 || value > 32767)
+        {
+            Napi::RangeError::New(env, "C_SE_NB_1 'value' must be between -32768 and 32767").ThrowAsJavaScriptException();
+            return false;
+        }
+        SetpointCommandScaled scs = SetpointCommandScaled_create(NULL, ioa, value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
+        success = true;
+        SetpointCommandScaled_destroy(scs);
+        break;
+    }
+
+    case C_SE_NC_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_NC_1 requires 'value' as number").ThrowAsJavaScriptException();
+            return false;
+        }
+        float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
+        SetpointCommandShort scsf = SetpointCommandShort_create(NULL, ioa, value, bselCmd, ql);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
+        success = true;
+        SetpointCommandShort_destroy(scsf);
+        break;
+    }
+
+    case C_BO_NA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_BO_NA_1 requires 'value' as number (32-bit unsigned integer)").ThrowAsJavaScriptException();
+            return false;
+        }
+        uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
+        Bitstring32Command bc = Bitstring32Command_create(NULL, ioa, value);
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
+        success = true;
+        Bitstring32Command_destroy(bc);
+        break;
+    }
+
+    case C_SC_TA_1:
+    {
+        if (!cmdObj.Get("value").IsBoolean() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SC_TA_1 requires 'value' (boolean) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        bool value = cmdObj.Get("value").As<Napi::Boolean>();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        SingleCommandWithCP56Time2a sc = SingleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
+        success = true;
+        SingleCommandWithCP56Time2a_destroy(sc);
+        break;
+    }
+
+    case C_DC_TA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_DC_TA_1 requires 'value' (number 0-3) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        if (value < 0 || value > 3)
+        {
+            Napi::RangeError::New(env, "C_DC_TA_1 'value' must be 0-3").ThrowAsJavaScriptException();
+            return false;
+        }
+        DoubleCommandWithCP56Time2a dc = DoubleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
+        success = true;
+        DoubleCommandWithCP56Time2a_destroy(dc);
+        break;
+    }
+
+    case C_RC_TA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_RC_TA_1 requires 'value' (number 0-3) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        if (value < 0 || value > 3)
+        {
+            Napi::RangeError::New(env, "C_RC_TA_1 'value' must be 0-3").ThrowAsJavaScriptException();
+            return false;
+        }
+        StepCommandWithCP56Time2a rc = StepCommandWithCP56Time2a_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
+        success = true;
+        StepCommandWithCP56Time2a_destroy(rc);
+        break;
+    }
+
+    case C_SE_TA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_TA_1 requires 'value' (number -1.0 to 1.0) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        if (value < -1.0f || value > 1.0f)
+        {
+            Napi::RangeError::New(env, "C_SE_TA_1 'value' must be between -1.0 and 1.0").ThrowAsJavaScriptException();
+            return false;
+        }
+        SetpointCommandNormalizedWithCP56Time2a scn = SetpointCommandNormalizedWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scn);
+        success = true;
+        SetpointCommandNormalizedWithCP56Time2a_destroy(scn);
+        break;
+    }
+
+    case C_SE_TB_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_TB_1 requires 'value' (number -32768 to 32767) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        if (value < -32768 || value > 32767)
+        {
+            Napi::RangeError::New(env, "C_SE_TB_1 'value' must be between -32768 and 32767").ThrowAsJavaScriptException();
+            return false;
+        }
+        SetpointCommandScaledWithCP56Time2a scs = SetpointCommandScaledWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scs);
+        success = true;
+        SetpointCommandScaledWithCP56Time2a_destroy(scs);
+        break;
+    }
+
+    case C_SE_TC_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_SE_TC_1 requires 'value' (number) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        float value = cmdObj.Get("value").As<Napi::Number>().FloatValue();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        SetpointCommandShortWithCP56Time2a scsf = SetpointCommandShortWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)scsf);
+        success = true;
+        SetpointCommandShortWithCP56Time2a_destroy(scsf);
+        break;
+    }
+
+    case C_BO_TA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber() || !cmdObj.Has("timestamp") || !cmdObj.Get("timestamp").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_BO_TA_1 requires 'value' (32-bit number) and 'timestamp' (number)").ThrowAsJavaScriptException();
+            return false;
+        }
+        uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
+        uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
+        Bitstring32CommandWithCP56Time2a bc = Bitstring32CommandWithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
+        CS101_ASDU_addInformationObject(asdu, (InformationObject)bc);
+        success = true;
+        Bitstring32CommandWithCP56Time2a_destroy(bc);
+        break;
+    }
+
+    case C_IC_NA_1:
+    {
+        CS101_ASDU_setTypeID(asdu, C_IC_NA_1);
+        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION);
+        InformationObject io = (InformationObject)InterrogationCommand_create(NULL, ioa, cmdObj.Get("value").As<Napi::Number>().Uint32Value());
+        CS101_ASDU_addInformationObject(asdu, io);
+        success = true;
+        InformationObject_destroy(io);
+        break;
+    }
+
+    case C_CI_NA_1:
+    {
+        CS101_ASDU_setTypeID(asdu, C_CI_NA_1);
+        CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
+        InformationObject io = (InformationObject)CounterInterrogationCommand_create(NULL, ioa, cmdObj.Get("value").As<Napi::Number>().Uint32Value());
+        CS101_ASDU_addInformationObject(asdu, io);
+        success = true;
+        InformationObject_destroy(io);
+        break;
+    }
+
+    case C_RD_NA_1:
+    {
+        CS101_ASDU_setTypeID(asdu, C_RD_NA_1);
+        CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
+        InformationObject io = (InformationObject)ReadCommand_create(NULL, ioa);
+        CS101_ASDU_addInformationObject(asdu, io);
+        success = true;
+        InformationObject_destroy(io);
+        break;
+    }
+
+    case C_CS_NA_1:
+    {
+        if (!cmdObj.Get("value").IsNumber())
+        {
+            Napi::TypeError::New(env, "C_CS_NA_1 requires 'value' as number (timestamp)").ThrowAsJavaScriptException();
+            return false;
+        }
+        uint64_t value = cmdObj.Get("value").As<Napi::Number>().Int64Value();
+        CS101_ASDU_setTypeID(asdu, C_CS_NA_1);
+        CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION);
+        InformationObject io = (InformationObject)ClockSynchronizationCommand_create(NULL, ioa, CP56Time2a_createFromMsTimestamp(NULL, value));
+        CS101_ASDU_addInformationObject(asdu, io);
+        success = true;
+        InformationObject_destroy(io);
+        break;
+    }
+
+    case 122:
+    { // F_SC_NA_1
+        CS101_CauseOfTransmission cot = cmdObj.Has("cot") ? (CS101_CauseOfTransmission)cmdObj.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_ACTIVATION;
+        int scq = cmdObj.Has("scq") ? cmdObj.Get("scq").As<Napi::Number>().Int32Value() : 0;
+        CS101_ASDU_setTypeID(asdu, F_SC_NA_1);
+
+        CS101_ASDU_setCOT(asdu, cot);
+
+        if (scq == 0)
+        {
+            uint16_t value = cmdObj.Has("value") ? cmdObj.Get("value").As<Napi::Number>().Uint32Value() : 4;
+            uint8_t payload[] = {
+                (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
+                (uint8_t)scq,                                                                       // SCQ
+                (uint8_t)(value & 0xff), (uint8_t)((value >> 8) & 0xff)                             // NOF
+            };
+            CS101_ASDU_setNumberOfElements(asdu, 1); // Устанавливаем NumIx=1
+            CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
+            //  printf("Sending F_SC_NA_1: IOA=%d, SCQ=%d, NOF=%u, COT=%d, clientID: %s\n",
+            //      ioa, scq, value, cot, clientID.c_str());
+            success = true;
+        }
+        else if (scq == 1 || scq == 2 || scq == 6)
+        {
+            std::string fileName = cmdObj.Get("value").As<Napi::String>().Utf8Value();
+            uint16_t nof;
+            if (sscanf(fileName.c_str(), "%hu", &nof) != 1)
             {
-                CS101_ASDU_setTypeID(asdu, C_RD_NA_1);
-                CS101_ASDU_setCOT(asdu, CS101_COT_REQUEST);
-                InformationObject io = (InformationObject)ReadCommand_create(NULL, ioa);
-                CS101_ASDU_addInformationObject(asdu, io);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                InformationObject_destroy(io);
-                break;
+                Napi::TypeError::New(env, "Invalid file name format, expected decimal (e.g., '1710')").ThrowAsJavaScriptException();
+                return false;
             }
-
-            case C_CS_NA_1:
+            uint8_t lof = (scq == 1 ? 0 : 1);
+            uint8_t foq = scq;
+            uint8_t payload[] = {
+                (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
+                (uint8_t)(nof & 0xff), (uint8_t)((nof >> 8) & 0xff),                                // NOF
+                lof,                                                                                // LOF
+                foq                                                                                 // FOQ
+            };
+            CS101_ASDU_setNumberOfElements(asdu, 1); // Устанавливаем NumIx=1
+            CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
+            //   printf("F_SC_NA_1 ASDU: TypeID=%d, COT=%d, OA=%d, ASDUAddr=%d, NumIx=%d, Payload: ",
+            //       CS101_ASDU_getTypeID(asdu), cot, 0, asduAddress, CS101_ASDU_getNumberOfElements(asdu));
+            for (unsigned long i = 0; i < sizeof(payload); i++)
             {
-                if (!cmdObj.Get("value").IsNumber())
-                {
-                    Napi::TypeError::New(env, "C_CS_NA_1 requires 'value' as number (timestamp)").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                uint64_t value = cmdObj.Get("value").As<Napi::Number>().Int64Value();
-                CS101_ASDU_setTypeID(asdu, C_CS_NA_1);
-                CS101_ASDU_setCOT(asdu, CS101_COT_ACTIVATION);
-                InformationObject io = (InformationObject)ClockSynchronizationCommand_create(NULL, ioa, CP56Time2a_createFromMsTimestamp(NULL, value));
-                CS101_ASDU_addInformationObject(asdu, io);
-                success = CS104_Connection_sendASDU(connection, asdu);
-                InformationObject_destroy(io);
-                break;
+                //     printf("%02x ", payload[i]);
             }
+            // printf("\n");
+            success = true;
+        }
+        else
+        {
+            Napi::TypeError::New(env, "Unsupported SCQ for F_SC_NA_1").ThrowAsJavaScriptException();
+            return false;
+        }
+        break;
+    }
+    case 124:
+    { // F_AF_NA_1
+        CS101_CauseOfTransmission cot = cmdObj.Has("cot") ? (CS101_CauseOfTransmission)cmdObj.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_ACTIVATION;
+        std::string valueStr = cmdObj.Get("value").As<Napi::String>().Utf8Value();
+        uint16_t nof;
+        if (sscanf(valueStr.c_str(), "%hu", &nof) != 1)
+        {
+            Napi::TypeError::New(env, "Invalid NOF format for F_AF_NA_1, expected decimal (e.g., '1710')").ThrowAsJavaScriptException();
+            return false;
+        }
+        CS101_ASDU_setTypeID(asdu, F_AF_NA_1);
+        CS101_ASDU_setCOT(asdu, cot);
+        uint8_t payload[] = {
+            (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
+            (uint8_t)(nof & 0xff), (uint8_t)((nof >> 8) & 0xff),                                // NOF
+            0x01,                                                                               // LOS = 1
+            0x01                                                                                // CHKS = 1
+        };
+        CS101_ASDU_setNumberOfElements(asdu, 1);
+        CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
+        //  printf("Sending F_AF_NA_1: IOA=%d, NOF=%u, LOS=1, CHKS=1, COT=%d, clientID: %s\n",
+        //      ioa, nof, cot, clientID.c_str());
+        success = true;
+        break;
+    }
+    }
 
-            case 122:
-            { // F_SC_NA_1
-                CS101_CauseOfTransmission cot = cmdObj.Has("cot") ? (CS101_CauseOfTransmission)cmdObj.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_ACTIVATION;
-                int scq = cmdObj.Has("scq") ? cmdObj.Get("scq").As<Napi::Number>().Int32Value() : 0;
-                CS101_ASDU_setTypeID(asdu, F_SC_NA_1);
+    return success;
+}
 
-                CS101_ASDU_setCOT(asdu, cot);
+// Вызывается только потоком соединения, без блокировок: разбирает принятые подтверждения, снимает
+// команды по таймауту и отправляет очередь, пока есть место в окне k
+void IEC104Client::ServeCommandQueue()
+{
+    commandWakeup = false;
+    std::vector<CommandConfirmation> received;
+    {
+        std::lock_guard<std::mutex> lock(this->confirmMutex);
+        received.swap(confirmations);
+    }
 
-                if (scq == 0)
-                {
-                    uint16_t value = cmdObj.Has("value") ? cmdObj.Get("value").As<Napi::Number>().Uint32Value() : 4;
-                    uint8_t payload[] = {
-                        (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
-                        (uint8_t)scq,                                                                       // SCQ
-                        (uint8_t)(value & 0xff), (uint8_t)((value >> 8) & 0xff)                             // NOF
-                    };
-                    CS101_ASDU_setNumberOfElements(asdu, 1); // Устанавливаем NumIx=1
-                    CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
-                    //  printf("Sending F_SC_NA_1: IOA=%d, SCQ=%d, NOF=%u, COT=%d, clientID: %s\n",
-                    //      ioa, scq, value, cot, clientID.c_str());
-                    success = CS104_Connection_sendASDU(connection, asdu);
-                }
-                else if (scq == 1 || scq == 2 || scq == 6)
+    CS104_Connection sendConnection;
+    {
+        std::lock_guard<std::mutex> lock(this->connMutex);
+        for (const CommandConfirmation &confirmation : received)
+            ConfirmCommand(confirmation);
+
+        uint64_t now = Hal_getTimeInMs();
+        for (auto *commands : {&commandsInFlight, &commandQueue})
+        {
+            for (auto it = commands->begin(); it != commands->end();)
+            {
+                if (now >= (*it)->deadline)
                 {
-                    std::string fileName = cmdObj.Get("value").As<Napi::String>().Utf8Value();
-                    uint16_t nof;
-                    if (sscanf(fileName.c_str(), "%hu", &nof) != 1)
-                    {
-                        CS101_ASDU_destroy(asdu);
-                        Napi::TypeError::New(env, "Invalid file name format, expected decimal (e.g., '1710')").ThrowAsJavaScriptException();
-                        return env.Undefined();
-                    }
-                    uint8_t lof = (scq == 1 ? 0 : 1);
-                    uint8_t foq = scq;
-                    uint8_t payload[] = {
-                        (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
-                        (uint8_t)(nof & 0xff), (uint8_t)((nof >> 8) & 0xff),                                // NOF
-                        lof,                                                                                // LOF
-                        foq                                                                                 // FOQ
-                    };
-                    CS101_ASDU_setNumberOfElements(asdu, 1); // Устанавливаем NumIx=1
-                    CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
-                    //   printf("F_SC_NA_1 ASDU: TypeID=%d, COT=%d, OA=%d, ASDUAddr=%d, NumIx=%d, Payload: ",
-                    //       CS101_ASDU_getTypeID(asdu), cot, 0, asduAddress, CS101_ASDU_getNumberOfElements(asdu));
-                    for (unsigned long i = 0; i < sizeof(payload); i++)
-                    {
-                        //     printf("%02x ", payload[i]);
-                    }
-                    // printf("\n");
-                    success = CS104_Connection_sendASDU(connection, asdu);
+                    CompleteCommand(*it, (*it)->sentAt ? "Command timeout" : "Command timeout (not sent, window or connection unavailable)", 0, now);
+                    it = commands->erase(it);
                 }
                 else
                 {
-                    CS101_ASDU_destroy(asdu);
-                    Napi::TypeError::New(env, "Unsupported SCQ for F_SC_NA_1").ThrowAsJavaScriptException();
-                    return env.Undefined();
+                    ++it;
                 }
-                break;
             }
-            case 124:
-            { // F_AF_NA_1
-                CS101_CauseOfTransmission cot = cmdObj.Has("cot") ? (CS101_CauseOfTransmission)cmdObj.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_ACTIVATION;
-                std::string valueStr = cmdObj.Get("value").As<Napi::String>().Utf8Value();
-                uint16_t nof;
-                if (sscanf(valueStr.c_str(), "%hu", &nof) != 1)
-                {
-                    CS101_ASDU_destroy(asdu);
-                    Napi::TypeError::New(env, "Invalid NOF format for F_AF_NA_1, expected decimal (e.g., '1710')").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-                CS101_ASDU_setTypeID(asdu, F_AF_NA_1);
-                CS101_ASDU_setCOT(asdu, cot);
-                uint8_t payload[] = {
-                    (uint8_t)(ioa & 0xff), (uint8_t)((ioa >> 8) & 0xff), (uint8_t)((ioa >> 16) & 0xff), // IOA
-                    (uint8_t)(nof & 0xff), (uint8_t)((nof >> 8) & 0xff),                                // NOF
-                    0x01,                                                                               // LOS = 1
-                    0x01                                                                                // CHKS = 1
-                };
-                CS101_ASDU_setNumberOfElements(asdu, 1);
-                CS101_ASDU_addPayload(asdu, payload, sizeof(payload));
-                //  printf("Sending F_AF_NA_1: IOA=%d, NOF=%u, LOS=1, CHKS=1, COT=%d, clientID: %s\n",
-                //      ioa, nof, cot, clientID.c_str());
-                success = CS104_Connection_sendASDU(connection, asdu);
+        }
+
+        if (!connected || !activated || !connection || commandQueue.empty())
+            return;
+        sendConnection = connection;
+    }
+
+    // Отправка идёт без connMutex: lib60870 вызывает обработчики событий под своей блокировкой
+    // состояния, и они берут connMutex. Соединение не может быть уничтожено во время отправки:
+    // соединения уничтожает только этот поток
+    while (true)
+    {
+        std::shared_ptr<PipelinedCommand> command;
+        {
+            std::lock_guard<std::mutex> lock(this->connMutex);
+            if (commandQueue.empty())
                 break;
-            }
-            }
+            command = commandQueue.front();
+            commandQueue.pop_front();
+        }
 
-            CS101_ASDU_destroy(asdu);
+        bool sent = !CS104_Connection_isTransmitBufferFull(sendConnection) && CS104_Connection_sendASDU(sendConnection, command->asdu.get());
 
-            if (!success)
-            {
-                allSuccess = false;
-                //    printf("Failed to send command: typeId=%d, ioa=%d, clientID: %s, isPrimaryIP=%d\n", typeId, ioa, clientID.c_str(), usingPrimaryIp);
-            }
-            else
-            {
-                //   printf("Sent command: typeId=%d, ioa=%d, bselCmd=%d, ql=%d, clientID: %s, isPrimaryIP=%d\n", typeId, ioa, bselCmd, ql, clientID.c_str(), usingPrimaryIp);
-            }
-        } // Закрытие for
-        return Napi::Boolean::New(env, allSuccess);
+        std::lock_guard<std::mutex> lock(this->connMutex);
+        if (!sent)
+        {
+            commandQueue.push_front(command);
+            break;
+        }
+        command->asdu.reset();
+        command->sentAt = Hal_getTimeInMs();
+        commandsInFlight.push_back(command);
     }
-    catch (const std::exception &e)
+}
+
+// Отвечает ли COT подтверждения на команду, отправленную с sentCot. COT 44..47 зеркалит любую команду
+static bool AnswersCommandCot(int sentCot, int cot)
+{
+    if (cot >= CS101_COT_UNKNOWN_TYPE_ID && cot <= CS101_COT_UNKNOWN_IOA)
+        return true;
+    if (sentCot == CS101_COT_DEACTIVATION)
+        return cot == CS101_COT_DEACTIVATION_CON;
+    return cot == CS101_COT_ACTIVATION_CON || cot == CS101_COT_ACTIVATION_TERMINATION;
+}
+
+// Под connMutex. Подтверждение относится к самой старой отправленной команде с теми же (ca, ioa, typeId, cot)
+void IEC104Client::ConfirmCommand(const CommandConfirmation &confirmation)
+{
+    for (auto it = commandsInFlight.begin(); it != commandsInFlight.end(); ++it)
     {
-        // printf("Exception in SendCommands: %s, clientID: %s, isPrimaryIP=%d\n", e.what(), clientID.c_str(), usingPrimaryIp);
-        Napi::Error::New(env, string("SendCommands failed: ") + e.what()).ThrowAsJavaScriptException();
+        std::shared_ptr<PipelinedCommand> command = *it;
+        if (command->typeId != confirmation.typeId || command->ca != confirmation.ca || command->ioa != confirmation.ioa ||
+            !AnswersCommandCot(command->cot, confirmation.cot))
+            continue;
 
-        // Добавляем isPrimaryIP в объект события
-        tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback)
-                             {
-            Napi::Object eventObj = Napi::Object::New(env);
-            eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
-            eventObj.Set("type", Napi::String::New(env, "error"));
-            eventObj.Set("reason", Napi::String::New(env, string("SendCommands failed: ") + e.what()));
-            eventObj.Set("isPrimaryIP", Napi::Boolean::New(env, usingPrimaryIp)); // Добавляем isPrimaryIP
-            std::vector<napi_value> args = {Napi::String::New(env, "data"), eventObj};
-            jsCallback.Call(args); });
+        if (confirmation.cot == CS101_COT_ACTIVATION_TERMINATION)
+        {
+            // ACT_TERM команды, уже завершённой по ACT_CON, не должен завершить следующую с тем же адресом
+            if (!command->actConReceived)
+                continue;
+            CompleteCommand(command, "", confirmation.cot, confirmation.receivedAt);
+        }
+        else if (command->actConReceived)
+        {
+            continue; // Уже подтверждена, ждёт ACT_TERM
+        }
+        else if (confirmation.negative || confirmation.cot >= CS101_COT_UNKNOWN_TYPE_ID)
+        {
+            CompleteCommand(command, "Negative confirmation (COT " + to_string(confirmation.cot) + ")", confirmation.cot, confirmation.receivedAt);
+        }
+        else if (command->waitTerm)
+        {
+            command->actConReceived = true;
+            command->actConAt = confirmation.receivedAt;
+            return;
+        }
+        else
+        {
+            CompleteCommand(command, "", confirmation.cot, confirmation.receivedAt);
+        }
+        commandsInFlight.erase(it);
+        return;
+    }
+}
 
-        return Napi::Boolean::New(env, false);
+void IEC104Client::CompleteCommand(const std::shared_ptr<PipelinedCommand> &command, const std::string &error, int cot, uint64_t completedAt)
+{
+    if (error.empty())
+        commandsConfirmed++;
+    else
+        commandsFailed++;
+
+    // Задержки считаются по времени приёма подтверждения потоком приёма, а не по времени его разбора
+    double latencyMs = command->sentAt ? static_cast<double>(completedAt - command->sentAt) : 0;
+    double queuedMs = static_cast<double>((command->sentAt ? command->sentAt : completedAt) - command->queuedAt);
+    double actConMs = command->actConAt ? static_cast<double>(command->actConAt - command->sentAt) : -1;
+
+    CommandResult result{command, error, cot, latencyMs, queuedMs, actConMs};
+    napi_status status = tsfn.NonBlockingCall([result](Napi::Env env, Napi::Function)
+                                              { SettleCommand(env, result); });
+    if (status != napi_ok)
+    {
+        // TSFN закрывается: промис разрешит Disconnect на потоке JS
+        undeliveredResults.push_back(std::move(result));
     }
 }
 
+void IEC104Client::SettleCommand(Napi::Env env, const CommandResult &result)
+{
+    const PipelinedCommand &completed = *result.command;
+    if (!result.error.empty())
+    {
+        Napi::Error err = Napi::Error::New(env, result.error);
+        if (result.cot)
+            err.Set("cot", Napi::Number::New(env, result.cot));
+        completed.deferred.Reject(err.Value());
+        return;
+    }
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("typeId", Napi::Number::New(env, completed.typeId));
+    obj.Set("ioa", Napi::Number::New(env, completed.ioa));
+    obj.Set("asdu", Napi::Number::New(env, completed.ca));
+    obj.Set("cot", Napi::Number::New(env, result.cot));
+    obj.Set("latencyMs", Napi::Number::New(env, result.latencyMs));
+    obj.Set("queuedMs", Napi::Number::New(env, result.queuedMs));
+    if (completed.waitTerm)
+        obj.Set("actConMs", Napi::Number::New(env, result.actConMs));
+    completed.deferred.Resolve(obj);
+}
+
+// Поток JS под connMutex, поток соединения уже остановлен: разрешает промисы, итог которых не прошёл
+// через tsfn. Вызывать до tsfn.Release().
+void IEC104Client::SettleUndeliveredCommands(Napi::Env env)
+{
+    for (const CommandResult &result : undeliveredResults)
+        SettleCommand(env, result);
+    undeliveredResults.clear();
+}
+
+void IEC104Client::FailCommands(std::deque<std::shared_ptr<PipelinedCommand>> &commands, const std::string &error)
+{
+    uint64_t now = Hal_getTimeInMs();
+    for (auto &command : commands)
+        CompleteCommand(command, error, 0, now);
+    commands.clear();
+}
+
 Napi::Value IEC104Client::RequestFileList(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
@@ -1115,63 +1373,560 @@ Napi::Value IEC104Client::RequestFileSegment(const Napi::CallbackInfo &info)
             return Napi::Boolean::New(env, false);
         }
 
-        //  printf("File segment requested (F_SC_NA_1, COT=13, SCQ=6), clientID: %s\n", clientID.c_str());
-        return Napi::Boolean::New(env, true);
+        //  printf("File segment requested (F_SC_NA_1, COT=13, SCQ=6), clientID: %s\n", clientID.c_str());
+        return Napi::Boolean::New(env, true);
+    }
+    catch (const std::exception &e)
+    {
+        //   printf("Exception in RequestFileSegment: %s, clientID: %s\n", e.what(), clientID.c_str());
+        Napi::Error::New(env, string("RequestFileSegment failed: ") + e.what()).ThrowAsJavaScriptException();
+        return Napi::Boolean::New(env, false);
+    }
+}
+
+Napi::Value IEC104Client::ConfirmFileTransfer(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber())
+    {
+        Napi::TypeError::New(env, "Expected IOA (number)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int ioa = info[0].As<Napi::Number>().Int32Value();
+    std::lock_guard<std::mutex> lock(this->connMutex);
+    if (!connected || !activated)
+    {
+        Napi::Error::New(env, "Not connected or not activated").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    try
+    {
+        // F_AF_NA_1 для подтверждения передачи
+        CS101_ASDU asdu = CS101_ASDU_create(CS104_Connection_getAppLayerParameters(connection), false, CS101_COT_ACTIVATION, asduAddress, originatorAddress, false, false);
+        CS101_ASDU_setTypeID(asdu, F_AF_NA_1);
+        InformationObject io = (InformationObject)FileACK_create(NULL, ioa, 1, 0, 0); // NOS=1, подтверждение
+        CS101_ASDU_addInformationObject(asdu, io);
+        InformationObject_destroy(io);
+
+        bool success = CS104_Connection_sendASDU(connection, asdu);
+        CS101_ASDU_destroy(asdu);
+
+        if (!success)
+        {
+            //   printf("Failed to confirm file transfer for IOA=%d, clientID: %s\n", ioa, clientID.c_str());
+            Napi::Error::New(env, "Failed to confirm file transfer").ThrowAsJavaScriptException();
+            return Napi::Boolean::New(env, false);
+        }
+
+        //   printf("File transfer confirmed (F_AF_NA_1, IOA=%d), clientID: %s\n", ioa, clientID.c_str());
+        return Napi::Boolean::New(env, true);
+    }
+    catch (const std::exception &e)
+    {
+        //  printf("Exception in ConfirmFileTransfer: %s, clientID: %s\n", e.what(), clientID.c_str());
+        Napi::Error::New(env, string("ConfirmFileTransfer failed: ") + e.what()).ThrowAsJavaScriptException();
+        return Napi::Boolean::New(env, false);
+    }
+}
+
+std::unique_ptr<IEC104Client::DialAttempt> IEC104Client::StartDial(const std::string &ip, int port, bool isPrimary, bool autoStartDT)
+{
+    std::unique_ptr<DialAttempt> attempt(new DialAttempt());
+    attempt->client = this;
+    attempt->ip = ip;
+    attempt->isPrimary = isPrimary;
+    attempt->autoStartDT = autoStartDT;
+    attempt->startedAt = Hal_getTimeInMs();
+    attempt->switchStartedAt = attempt->startedAt;
+    attempt->connection = CS104_Connection_create(ip.c_str(), port);
+    if (!attempt->connection)
+    {
+        throw runtime_error("Failed to create connection object");
+    }
+
+    CS101_AppLayerParameters alParams = CS104_Connection_getAppLayerParameters(attempt->connection);
+    alParams->originatorAddress = this->originatorAddress;
+    alParams->sizeOfCA = 2;
+
+    CS104_APCIParameters apciParams = CS104_Connection_getAPCIParameters(attempt->connection);
+    *apciParams = apciParameters;
+    if (!autoStartDT)
+        apciParams->t3 = standbyT3; // Резерв в STOPDT проверяется только TESTFR
+
+    CS104_Connection_setConnectTimeout(attempt->connection, connectTimeoutMs);
+    CS104_Connection_setConnectionHandler(attempt->connection, DialConnectionHandler, attempt.get());
+    CS104_Connection_setASDUReceivedHandler(attempt->connection, DialASDUHandler, attempt.get());
+
+    // Не блокирует: TCP-соединение устанавливает поток соединения lib60870
+    CS104_Connection_connectAsync(attempt->connection);
+    return attempt;
+}
+
+void IEC104Client::DestroyDial(std::unique_ptr<DialAttempt> &attempt)
+{
+    if (!attempt)
+        return;
+
+    bool isWinner = (dialWinner.load() == attempt.get());
+    if (isWinner)
+    {
+        std::lock_guard<std::mutex> lock(this->connMutex);
+        if (connection == attempt->connection)
+            connection = nullptr;
+    }
+    if (dialTakeover.load() == attempt.get())
+        dialTakeover = nullptr;
+
+    // Ждёт завершения потока соединения; событие CLOSED рабочего соединения уходит в JS как раньше
+    CS104_Connection_destroy(attempt->connection);
+
+    if (isWinner)
+        dialWinner = nullptr;
+    attempt.reset();
+}
+
+void IEC104Client::ActivateDial(DialAttempt *attempt, uint64_t dialStartedAt)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->connMutex);
+        connection = attempt->connection;
+        usingPrimaryIp = attempt->isPrimary;
+        lastSwitchoverMs = Hal_getTimeInMs() - dialStartedAt;
+        switchovers++;
+    }
+
+    ConnectionHandler(this, attempt->connection, CS104_CONNECTION_OPENED);
+    ConnectionHandler(this, attempt->connection, CS104_CONNECTION_STARTDT_CON_RECEIVED);
+}
+
+void IEC104Client::SendDialStartDT(DialAttempt *attempt)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->dialMutex);
+        attempt->state = DIAL_STARTING;
+        attempt->startDTSentAt = Hal_getTimeInMs();
+    }
+    // Вызывается без dialMutex: обработчик событий lib60870 сам берёт dialMutex
+    CS104_Connection_sendStartDT(attempt->connection);
+}
+
+void IEC104Client::WakeConnectionLoop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->dialMutex);
+        dialWakeup = true;
+    }
+    dialCv.notify_all();
+}
+
+void IEC104Client::SetStandby(DialAttempt *attempt)
+{
+    bool ready = false;
+    if (attempt)
+    {
+        std::lock_guard<std::mutex> lock(this->dialMutex);
+        ready = (attempt->state == DIAL_OPENED);
+    }
+    if (ready == standbyReady.load())
+        return;
+
+    std::string ip = attempt ? attempt->ip : "";
+    {
+        std::lock_guard<std::mutex> lock(this->connMutex);
+        standbyReady = ready;
+        standbyIp = ready ? ip : "";
+    }
+
+    bool isPrimaryIP = attempt ? attempt->isPrimary : false;
+    tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
+        Napi::Object eventObj = Napi::Object::New(env);
+        eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
+        eventObj.Set("type", Napi::String::New(env, "control"));
+        eventObj.Set("event", Napi::String::New(env, ready ? "standbyConnected" : "standbyLost"));
+        eventObj.Set("reason", Napi::String::New(env, ready ? "standby connection in STOPDT to " + ip : string("standby connection unavailable")));
+        eventObj.Set("isPrimaryIP", Napi::Boolean::New(env, isPrimaryIP));
+        std::vector<napi_value> args = {Napi::String::New(env, "conn"), eventObj};
+        jsCallback.Call(args);
+    });
+}
+
+void IEC104Client::DialConnectionHandler(void *parameter, CS104_Connection con, CS104_ConnectionEvent event)
+{
+    DialAttempt *attempt = static_cast<DialAttempt *>(parameter);
+    IEC104Client *client = attempt->client;
+
+    // События рабочего соединения обрабатываются как обычно
+    if (client->dialWinner.load() == attempt)
+    {
+        if (event == CS104_CONNECTION_CLOSED || event == CS104_CONNECTION_FAILED)
+        {
+            std::lock_guard<std::mutex> lock(client->dialMutex);
+            attempt->state = DIAL_FAILED;
+        }
+        ConnectionHandler(client, con, event);
+        client->WakeConnectionLoop();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(client->dialMutex);
+        switch (event)
+        {
+        case CS104_CONNECTION_OPENED:
+            attempt->openedAt = Hal_getTimeInMs();
+            if (attempt->autoStartDT)
+            {
+                attempt->state = DIAL_STARTING;
+                attempt->startDTSentAt = attempt->openedAt;
+            }
+            else
+            {
+                attempt->state = DIAL_OPENED;
+            }
+            break;
+        case CS104_CONNECTION_STARTDT_CON_RECEIVED:
+            attempt->state = DIAL_ACTIVATED;
+            break;
+        case CS104_CONNECTION_STOPDT_CON_RECEIVED:
+            attempt->state = DIAL_OPENED;
+            break;
+        case CS104_CONNECTION_FAILED:
+        case CS104_CONNECTION_CLOSED:
+            attempt->state = DIAL_FAILED;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (event == CS104_CONNECTION_OPENED && attempt->autoStartDT)
+    {
+        CS104_Connection_sendStartDT(con);
     }
-    catch (const std::exception &e)
+    else if (event == CS104_CONNECTION_STARTDT_CON_RECEIVED)
     {
-        //   printf("Exception in RequestFileSegment: %s, clientID: %s\n", e.what(), clientID.c_str());
-        Napi::Error::New(env, string("RequestFileSegment failed: ") + e.what()).ThrowAsJavaScriptException();
-        return Napi::Boolean::New(env, false);
+        // Первое соединение с подтверждённым STARTDT становится рабочим. Резерв, на который
+        // переключается поток соединения, становится рабочим сразу, без ожидания цикла
+        DialAttempt *noWinner = nullptr;
+        DialAttempt *self = attempt;
+        if (client->dialWinner.compare_exchange_strong(noWinner, attempt))
+        {
+            client->ActivateDial(attempt, attempt->switchStartedAt);
+        }
+        else if (client->dialTakeover.compare_exchange_strong(self, nullptr))
+        {
+            client->dialWinner = attempt;
+            client->ActivateDial(attempt, attempt->switchStartedAt);
+        }
     }
+
+    client->WakeConnectionLoop();
 }
 
-Napi::Value IEC104Client::ConfirmFileTransfer(const Napi::CallbackInfo &info)
+bool IEC104Client::DialASDUHandler(void *parameter, int address, CS101_ASDU asdu)
 {
-    Napi::Env env = info.Env();
+    DialAttempt *attempt = static_cast<DialAttempt *>(parameter);
 
-    if (info.Length() < 1 || !info[0].IsNumber())
-    {
-        Napi::TypeError::New(env, "Expected IOA (number)").ThrowAsJavaScriptException();
-        return env.Undefined();
-    }
+    // Данные проигравшей или ещё не выбранной попытки не передаются
+    if (attempt->client->dialWinner.load() != attempt)
+        return true;
 
-    int ioa = info[0].As<Napi::Number>().Int32Value();
-    std::lock_guard<std::mutex> lock(this->connMutex);
-    if (!connected || !activated)
-    {
-        Napi::Error::New(env, "Not connected or not activated").ThrowAsJavaScriptException();
-        return env.Undefined();
-    }
+    return RawMessageHandler(attempt->client, address, asdu);
+}
+
+void IEC104Client::RunConnectionLoop(std::string ip, std::string ipReserve, int port, int reconnectDelay)
+{
+    std::vector<std::unique_ptr<DialAttempt>> attempts;
+    std::unique_ptr<DialAttempt> active;
+    std::unique_ptr<DialAttempt> probe;   // parallel: пробное соединение с основным адресом
+    std::unique_ptr<DialAttempt> standby; // hot-standby: второй адрес в STOPDT
+    const uint64_t dialTimeout = static_cast<uint64_t>(connectTimeoutMs) + static_cast<uint64_t>(startDTTimeoutMs);
 
     try
     {
-        // F_AF_NA_1 для подтверждения передачи
-        CS101_ASDU asdu = CS101_ASDU_create(CS104_Connection_getAppLayerParameters(connection), false, CS101_COT_ACTIVATION, asduAddress, originatorAddress, false, false);
-        CS101_ASDU_setTypeID(asdu, F_AF_NA_1);
-        InformationObject io = (InformationObject)FileACK_create(NULL, ioa, 1, 0, 0); // NOS=1, подтверждение
-        CS101_ASDU_addInformationObject(asdu, io);
-        InformationObject_destroy(io);
+        int attempt = 0;
+        while (running)
+        {
+            // Основной и резервный адреса дозваниваются одновременно. В режиме hot-standby STARTDT
+            // получает первый подключившийся адрес, второй остаётся резервом в STOPDT
+            attempts.push_back(StartDial(ip, port, true, !hotStandby));
+            if (!ipReserve.empty())
+                attempts.push_back(StartDial(ipReserve, port, false, !hotStandby));
+
+            uint64_t deadline = Hal_getTimeInMs() + dialTimeout;
+            while (running && !dialWinner.load())
+            {
+                ServeCommandQueue();
 
-        bool success = CS104_Connection_sendASDU(connection, asdu);
-        CS101_ASDU_destroy(asdu);
+                DialAttempt *toStart = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock(this->dialMutex);
+                    uint64_t now = Hal_getTimeInMs();
+                    bool pending = false, starting = false;
+                    for (auto &a : attempts)
+                    {
+                        if (a->state == DIAL_STARTING && now - a->startDTSentAt > static_cast<uint64_t>(startDTTimeoutMs))
+                            a->state = DIAL_FAILED;
+                        if (a->state != DIAL_FAILED)
+                            pending = true;
+                        if (a->state == DIAL_STARTING || a->state == DIAL_ACTIVATED)
+                            starting = true;
+                    }
+                    if (!pending || now >= deadline)
+                        break;
 
-        if (!success)
-        {
-            //   printf("Failed to confirm file transfer for IOA=%d, clientID: %s\n", ioa, clientID.c_str());
-            Napi::Error::New(env, "Failed to confirm file transfer").ThrowAsJavaScriptException();
-            return Napi::Boolean::New(env, false);
-        }
+                    if (hotStandby && !starting)
+                    {
+                        for (auto &a : attempts)
+                        {
+                            if (a->state == DIAL_OPENED && (!toStart || a->isPrimary))
+                                toStart = a.get();
+                        }
+                    }
+                    if (!toStart)
+                    {
+                        dialCv.wait_for(lock, std::chrono::milliseconds(10), [this] { return dialWakeup || !running.load(); });
+                        dialWakeup = false;
+                    }
+                }
+                if (toStart)
+                    SendDialStartDT(toStart);
+            }
 
-        //   printf("File transfer confirmed (F_AF_NA_1, IOA=%d), clientID: %s\n", ioa, clientID.c_str());
-        return Napi::Boolean::New(env, true);
+            for (auto &a : attempts)
+            {
+                if (a.get() == dialWinner.load())
+                    active = std::move(a);
+            }
+            for (auto &a : attempts)
+            {
+                if (a && hotStandby && active && !standby)
+                    standby = std::move(a);
+                DestroyDial(a);
+            }
+            attempts.clear();
+
+            if (!active)
+            {
+                if (!running)
+                    break;
+
+                // Ни один адрес не ответил: команды из очереди не ждут паузы перед повтором и таймаута
+                {
+                    std::lock_guard<std::mutex> lock(this->connMutex);
+                    FailCommands(commandQueue, "Not connected");
+                }
+
+                attempt++;
+                std::string endpoints = ipReserve.empty() ? ip : ip + ", " + ipReserve;
+                tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
+                    Napi::Object eventObj = Napi::Object::New(env);
+                    eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
+                    eventObj.Set("type", Napi::String::New(env, "control"));
+                    eventObj.Set("event", Napi::String::New(env, "reconnecting"));
+                    eventObj.Set("reason", Napi::String::New(env, string("attempt ") + to_string(attempt) + " to " + endpoints));
+                    eventObj.Set("isPrimaryIP", Napi::Boolean::New(env, true));
+                    std::vector<napi_value> args = {Napi::String::New(env, "conn"), eventObj};
+                    jsCallback.Call(args);
+                });
+
+                // Пауза перед повтором; таймауты команд в очереди проверяются и во время паузы
+                uint64_t retryAt = Hal_getTimeInMs() + static_cast<uint64_t>(reconnectDelay) * 1000;
+                while (running && Hal_getTimeInMs() < retryAt)
+                {
+                    ServeCommandQueue();
+                    std::unique_lock<std::mutex> lock(this->dialMutex);
+                    dialCv.wait_for(lock, std::chrono::milliseconds(100), [this] { return !running.load(); });
+                }
+                continue;
+            }
+            attempt = 0;
+
+            // Работа через выбранное соединение. parallel: с резервного адреса периодически
+            // дозваниваемся до основного и переключаемся, как только он подтвердил STARTDT.
+            // hot-standby: второй адрес держится подключённым в STOPDT, переключение — один STARTDT
+            uint64_t nextProbe = Hal_getTimeInMs() + primaryCheckIntervalMs;
+            uint64_t nextStandby = 0;
+            DialAttempt *takeover = nullptr;
+            DialAttempt *expectedTakeover = nullptr;
+            while (running)
+            {
+                uint64_t now = Hal_getTimeInMs();
+                bool lost;
+                {
+                    std::lock_guard<std::mutex> lock(this->connMutex);
+                    lost = !connected;
+                }
+
+                if (hotStandby)
+                {
+                    int standbyState = DIAL_FAILED;
+                    if (standby)
+                    {
+                        std::lock_guard<std::mutex> lock(this->dialMutex);
+                        if (standby->state == DIAL_STARTING && now - standby->startDTSentAt > static_cast<uint64_t>(startDTTimeoutMs))
+                            standby->state = DIAL_FAILED;
+                        standbyState = standby->state;
+                    }
+
+                    if (takeover)
+                    {
+                        if (dialWinner.load() == takeover)
+                        {
+                            // Резерв подтвердил STARTDT и уже рабочий; прежнее соединение становится резервом
+                            takeover = nullptr;
+                            std::swap(active, standby);
+                            bool previousAlive;
+                            {
+                                std::lock_guard<std::mutex> lock(this->dialMutex);
+                                previousAlive = (standby->state != DIAL_FAILED);
+                                if (previousAlive)
+                                    standby->state = DIAL_OPENED;
+                            }
+                            if (previousAlive)
+                            {
+                                CS104_Connection_sendStopDT(standby->connection);
+                            }
+                            else
+                            {
+                                DestroyDial(standby);
+                                nextStandby = now;
+                            }
+                            nextProbe = now + primaryCheckIntervalMs;
+                        }
+                        else if (standbyState == DIAL_FAILED && dialTakeover.compare_exchange_strong(expectedTakeover, nullptr))
+                        {
+                            // Резерв не подтвердил STARTDT; если его всё же успел принять обработчик,
+                            // compare_exchange не пройдёт и переключение завершится на следующей итерации
+                            takeover = nullptr;
+                            DestroyDial(standby);
+                            nextStandby = now + primaryCheckIntervalMs;
+                            if (lost)
+                                break;
+                        }
+                    }
+                    else if (lost)
+                    {
+                        // Рабочее соединение потеряно: резерв в STOPDT активируется одним STARTDT
+                        if (standbyState != DIAL_OPENED)
+                            break;
+                        takeover = expectedTakeover = standby.get();
+                        takeover->switchStartedAt = now;
+                        dialTakeover = takeover;
+                        SendDialStartDT(takeover);
+                    }
+                    else if (standby && standbyState == DIAL_FAILED)
+                    {
+                        DestroyDial(standby);
+                        nextStandby = now + primaryCheckIntervalMs;
+                    }
+                    else if (!standby && now >= nextStandby)
+                    {
+                        bool standbyPrimary = !active->isPrimary;
+                        standby = StartDial(standbyPrimary ? ip : ipReserve, port, standbyPrimary, false);
+                    }
+                    else if (standby && standbyState == DIAL_OPENED && standby->isPrimary && now >= nextProbe)
+                    {
+                        // Возврат на основной адрес: STARTDT на основной, затем STOPDT на резервный
+                        takeover = expectedTakeover = standby.get();
+                        takeover->switchStartedAt = now;
+                        dialTakeover = takeover;
+                        SendDialStartDT(takeover);
+                    }
+
+                    SetStandby(standby && !takeover ? standby.get() : nullptr);
+                }
+                else
+                {
+                    if (lost)
+                        break;
+
+                    if (!active->isPrimary)
+                    {
+                        if (!probe && now >= nextProbe)
+                            probe = StartDial(ip, port, true);
+
+                        if (probe)
+                        {
+                            int state;
+                            {
+                                std::lock_guard<std::mutex> lock(this->dialMutex);
+                                if (probe->state == DIAL_STARTING && now - probe->startDTSentAt > static_cast<uint64_t>(startDTTimeoutMs))
+                                    probe->state = DIAL_FAILED;
+                                state = probe->state;
+                            }
+
+                            if (state == DIAL_ACTIVATED)
+                            {
+                                std::unique_ptr<DialAttempt> previous = std::move(active);
+                                active = std::move(probe);
+                                dialWinner = active.get();
+                                ActivateDial(active.get(), active->startedAt);
+                                DestroyDial(previous);
+                            }
+                            else if (state == DIAL_FAILED || now - probe->startedAt > dialTimeout)
+                            {
+                                DestroyDial(probe);
+                                nextProbe = now + primaryCheckIntervalMs;
+                            }
+                        }
+                    }
+                }
+
+                // Подтверждения команд разбираются здесь; пока команды ждут места в окне k,
+                // окно проверяется каждую миллисекунду (S-кадры с подтверждениями не будят поток)
+                ServeCommandQueue();
+                bool commandsWaiting;
+                {
+                    std::lock_guard<std::mutex> lock(this->connMutex);
+                    commandsWaiting = !commandQueue.empty();
+                }
+
+                // Потеря рабочего соединения, STARTDT_CON резерва и подтверждения команд выставляют
+                // dialWakeup под dialMutex, поэтому событие между проверкой и ожиданием не теряется
+                std::unique_lock<std::mutex> lock(this->dialMutex);
+                dialCv.wait_for(lock, std::chrono::milliseconds(takeover || commandsWaiting ? 1 : 100),
+                                [this] { return dialWakeup || commandWakeup.load() || !running.load(); });
+                dialWakeup = false;
+            }
+
+            SetStandby(nullptr);
+            DestroyDial(probe);
+            DestroyDial(standby);
+            DestroyDial(active);
+        }
     }
     catch (const std::exception &e)
     {
-        //  printf("Exception in ConfirmFileTransfer: %s, clientID: %s\n", e.what(), clientID.c_str());
-        Napi::Error::New(env, string("ConfirmFileTransfer failed: ") + e.what()).ThrowAsJavaScriptException();
-        return Napi::Boolean::New(env, false);
+        {
+            std::lock_guard<std::mutex> lock(this->connMutex);
+            running = false;
+        }
+        tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
+            Napi::Object eventObj = Napi::Object::New(env);
+            eventObj.Set("clientID", Napi::String::New(env, clientID.c_str()));
+            eventObj.Set("type", Napi::String::New(env, "control"));
+            eventObj.Set("event", Napi::String::New(env, "error"));
+            eventObj.Set("reason", Napi::String::New(env, string("Thread exception: ") + e.what()));
+            std::vector<napi_value> args = {Napi::String::New(env, "conn"), eventObj};
+            jsCallback.Call(args);
+        });
     }
+
+    for (auto &a : attempts)
+        DestroyDial(a);
+    DestroyDial(probe);
+    DestroyDial(standby);
+    DestroyDial(active);
+
+    std::lock_guard<std::mutex> lock(this->connMutex);
+    connected = false;
+    activated = false;
+    FailCommands(commandsInFlight, "Client stopped");
+    FailCommands(commandQueue, "Client stopped");
 }
 
 void IEC104Client::ConnectionHandler(void *parameter, CS104_Connection con, CS104_ConnectionEvent event)
@@ -1207,6 +1962,8 @@ void IEC104Client::ConnectionHandler(void *parameter, CS104_Connection con, CS10
             }
             client->connected = false;
             client->activated = false;
+            // Отправленные команды подтвердить уже некому; неотправленные ждут нового соединения
+            client->FailCommands(client->commandsInFlight, "Connection lost");
             break;
         case CS104_CONNECTION_STARTDT_CON_RECEIVED:
             eventStr = "activated";
@@ -1255,6 +2012,8 @@ void IEC104Client::ConnectionHandler(void *parameter, CS104_Connection con, CS10
 bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU asdu)
 {
     IEC104Client *client = static_cast<IEC104Client *>(parameter);
+    // Обработчик вызывается потоками обоих соединений при переключении; разбор ASDU последовательный
+    std::lock_guard<std::mutex> handlerLock(client->handlerMutex);
     IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
     CS101_CauseOfTransmission cot = CS101_ASDU_getCOT(asdu);
     int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
@@ -1264,10 +2023,30 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
     // printf("Received ASDU: TypeID=%d, COT=%d, ASDUAddr=%d, Elements=%d, clientID: %s\n",
     //    typeID, cot, receivedAsduAddress, numberOfElements, client->clientID.c_str());
 
+    // Подтверждения команд (ACT_CON, DEACT_CON, ACT_TERM и отрицательные ответы 44..47) для submitCommands.
+    // Обработчик вызывается под блокировкой lib60870 и не может отправлять, поэтому только кладёт
+    // подтверждение в очередь и будит поток соединения
+    if (((typeID >= C_SC_NA_1 && typeID <= C_BO_TA_1) || (typeID >= C_IC_NA_1 && typeID <= C_TS_TA_1)) &&
+        (cot == CS101_COT_ACTIVATION_CON || cot == CS101_COT_DEACTIVATION_CON || cot == CS101_COT_ACTIVATION_TERMINATION ||
+         (cot >= CS101_COT_UNKNOWN_TYPE_ID && cot <= CS101_COT_UNKNOWN_IOA)))
+    {
+        InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, 0);
+        CommandConfirmation confirmation{typeID, cot, receivedAsduAddress, io ? InformationObject_getObjectAddress(io) : 0,
+                                         CS101_ASDU_isNegative(asdu), Hal_getTimeInMs()};
+        {
+            std::lock_guard<std::mutex> lock(client->confirmMutex);
+            client->confirmations.push_back(confirmation);
+        }
+        client->commandWakeup = true;
+        client->WakeConnectionLoop();
+    }
+
     try
     {
-        // Логика для данных мониторинга (M_ types)
-        std::vector<std::tuple<int, double, uint8_t, uint64_t>> elements;
+        // Логика для данных мониторинга (M_ types): точки декодируются в буфер соединения без выделения памяти
+        DecodedPoints &elements = client->decodedPoints;
+        elements.clear();
+        elements.reserve(numberOfElements);
 
         switch (typeID)
         {
@@ -1275,7 +2054,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_SP_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElement(asdu, i);
+                SinglePointInformation io = (SinglePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1283,7 +2062,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = SinglePointInformation_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    SinglePointInformation_destroy(io);
                 }
             }
             break;
@@ -1291,7 +2069,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_DP_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElement(asdu, i);
+                DoublePointInformation io = (DoublePointInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1299,7 +2077,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = DoublePointInformation_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    DoublePointInformation_destroy(io);
                 }
             }
             break;
@@ -1307,7 +2084,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ST_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElement(asdu, i);
+                StepPositionInformation io = (StepPositionInformation)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1315,7 +2092,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = StepPositionInformation_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    StepPositionInformation_destroy(io);
                 }
             }
             break;
@@ -1323,7 +2099,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_BO_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                BitString32 io = (BitString32)CS101_ASDU_getElement(asdu, i);
+                BitString32 io = (BitString32)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1331,7 +2107,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = BitString32_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    BitString32_destroy(io);
                 }
             }
             break;
@@ -1339,7 +2114,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueNormalized io = (MeasuredValueNormalized)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1347,7 +2122,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = MeasuredValueNormalized_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueNormalized_destroy(io);
                 }
             }
             break;
@@ -1355,7 +2129,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_NB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueScaled io = (MeasuredValueScaled)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1363,7 +2137,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = MeasuredValueScaled_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueScaled_destroy(io);
                 }
             }
             break;
@@ -1371,7 +2144,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_NC_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueShort io = (MeasuredValueShort)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1379,7 +2152,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = MeasuredValueShort_getQuality(io);
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueShort_destroy(io);
                 }
             }
             break;
@@ -1387,7 +2159,7 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_IT_NA_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElement(asdu, i);
+                IntegratedTotals io = (IntegratedTotals)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
@@ -1395,7 +2167,6 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                     uint8_t quality = IEC60870_QUALITY_GOOD;
                     uint64_t timestamp = 0;
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    IntegratedTotals_destroy(io);
                 }
             }
             break;
@@ -1403,15 +2174,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_SP_TB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                SinglePointWithCP56Time2a io = (SinglePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0;
                     uint8_t quality = SinglePointInformation_getQuality((SinglePointInformation)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(SinglePointWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(SinglePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    SinglePointWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1419,15 +2189,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_DP_TB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                DoublePointWithCP56Time2a io = (DoublePointWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = static_cast<double>(DoublePointInformation_getValue((DoublePointInformation)io));
                     uint8_t quality = DoublePointInformation_getQuality((DoublePointInformation)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(DoublePointWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(DoublePointWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    DoublePointWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1435,15 +2204,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ST_TB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                StepPositionWithCP56Time2a io = (StepPositionWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = static_cast<double>(StepPositionInformation_getValue((StepPositionInformation)io));
                     uint8_t quality = StepPositionInformation_getQuality((StepPositionInformation)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(StepPositionWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(StepPositionWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    StepPositionWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1451,15 +2219,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_BO_TB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                Bitstring32WithCP56Time2a io = (Bitstring32WithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = static_cast<double>(BitString32_getValue((BitString32)io));
                     uint8_t quality = BitString32_getQuality((BitString32)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(Bitstring32WithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(Bitstring32WithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    Bitstring32WithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1467,15 +2234,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_TD_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueNormalizedWithCP56Time2a io = (MeasuredValueNormalizedWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = MeasuredValueNormalized_getValue((MeasuredValueNormalized)io);
                     uint8_t quality = MeasuredValueNormalized_getQuality((MeasuredValueNormalized)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueNormalizedWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueNormalizedWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1483,15 +2249,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_TE_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueScaledWithCP56Time2a io = (MeasuredValueScaledWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = MeasuredValueScaled_getValue((MeasuredValueScaled)io);
                     uint8_t quality = MeasuredValueScaled_getQuality((MeasuredValueScaled)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueScaledWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueScaledWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueScaledWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1499,15 +2264,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_ME_TF_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                MeasuredValueShortWithCP56Time2a io = (MeasuredValueShortWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = MeasuredValueShort_getValue((MeasuredValueShort)io);
                     uint8_t quality = MeasuredValueShort_getQuality((MeasuredValueShort)io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(MeasuredValueShortWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueShortWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    MeasuredValueShortWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1515,15 +2279,14 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         case M_IT_TB_1:
             for (int i = 0; i < numberOfElements; i++)
             {
-                IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                IntegratedTotalsWithCP56Time2a io = (IntegratedTotalsWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     float val = BinaryCounterReading_getValue(IntegratedTotals_getBCR((IntegratedTotals)io));
                     uint8_t quality = IEC60870_QUALITY_GOOD;
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(IntegratedTotalsWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(IntegratedTotalsWithCP56Time2a_getTimestamp(io), &client->dayCache);
                     elements.emplace_back(ioa, val, quality, timestamp);
-                    IntegratedTotalsWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1533,22 +2296,21 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
             for (int i = 0; i < numberOfElements; i++)
             {
                 EventOfProtectionEquipmentWithCP56Time2a io =
-                    (EventOfProtectionEquipmentWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    (EventOfProtectionEquipmentWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     SingleEvent valSE = EventOfProtectionEquipmentWithCP56Time2a_getEvent(io);
                     EventState val = SingleEvent_getEventState(valSE);
                     QualityDescriptorP quality = SingleEvent_getQDP(valSE);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(
-                        EventOfProtectionEquipmentWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(
+                        EventOfProtectionEquipmentWithCP56Time2a_getTimestamp(io), &client->dayCache);
 
                     elements.emplace_back(ioa, static_cast<double>(val), static_cast<uint8_t>(quality), timestamp);
 
                     //  printf("M_EP_TD_1: IOA=%d, State=%u, Quality=%u, Timestamp=%" PRIu64 ", clientID: %s\n",
                     //      ioa, val, quality, timestamp, client->clientID.c_str());
 
-                    EventOfProtectionEquipmentWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1558,20 +2320,19 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         {
             for (int i = 0; i < numberOfElements; i++)
             {
-                PackedStartEventsOfProtectionEquipmentWithCP56Time2a io = (PackedStartEventsOfProtectionEquipmentWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                PackedStartEventsOfProtectionEquipmentWithCP56Time2a io = (PackedStartEventsOfProtectionEquipmentWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     StartEvent val = PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getEvent(io);
                     uint8_t quality = PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getQuality(io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(PackedStartEventsOfProtectionEquipmentWithCP56Time2a_getTimestamp(io), &client->dayCache);
 
                     elements.emplace_back(ioa, static_cast<double>(val), quality, timestamp);
 
                     //  printf("M_EP_TE_1: IOA=%d, State=%u, Quality=%u, Timestamp=%" PRIu64 ", clientID: %s\n",
                     //     ioa, val, quality, timestamp, client->clientID.c_str());
 
-                    PackedStartEventsOfProtectionEquipmentWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1582,20 +2343,19 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
             for (int i = 0; i < numberOfElements; i++)
             {
                 PackedOutputCircuitInfoWithCP56Time2a io =
-                    (PackedOutputCircuitInfoWithCP56Time2a)CS101_ASDU_getElement(asdu, i);
+                    (PackedOutputCircuitInfoWithCP56Time2a)CS101_ASDU_getElementEx(asdu, (InformationObject)&client->decodeBuffer, i);
                 if (io)
                 {
                     int ioa = InformationObject_getObjectAddress((InformationObject)io);
                     OutputCircuitInfo val = PackedOutputCircuitInfoWithCP56Time2a_getOCI(io);
                     uint8_t quality = PackedOutputCircuitInfoWithCP56Time2a_getQuality(io);
-                    uint64_t timestamp = CP56Time2a_toMsTimestamp(PackedOutputCircuitInfoWithCP56Time2a_getTimestamp(io));
+                    uint64_t timestamp = CP56Time2a_toMsTimestampCached(PackedOutputCircuitInfoWithCP56Time2a_getTimestamp(io), &client->dayCache);
 
                     elements.emplace_back(ioa, static_cast<double>(val), quality, timestamp);
 
                     // printf("M_EP_TF_1: IOA=%d, State=%u, Quality=%u, Timestamp=%" PRIu64 ", clientID: %s\n",
                     //     ioa, val, quality, timestamp, client->clientID.c_str());
 
-                    PackedOutputCircuitInfoWithCP56Time2a_destroy(io);
                 }
             }
             break;
@@ -1919,6 +2679,26 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
         }
 
         // Обработка данных мониторинга (M_ types), если есть элементы
+        if (!elements.empty() && client->useCache)
+        {
+            // Таблица последних значений обновляется до передачи в JS. При deliver: 'changesOnly' дальше
+            // идут только новые точки и точки с изменившимся значением или качеством, при 'none' — ничего
+            auto cacheLock = client->lastValues.Lock();
+            size_t kept = 0;
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                const auto &[ioa, val, quality, timestamp] = elements[i];
+                bool changed = client->lastValues.Update(typeID, receivedAsduAddress, ioa, val, quality, timestamp);
+                if (client->deliver == DELIVER_ALL || (client->deliver == DELIVER_CHANGES && changed))
+                    elements[kept++] = elements[i];
+            }
+            client->suppressedPoints += elements.size() - kept;
+            elements.resize(kept);
+        }
+        // Значения внутри зоны нечувствительности в JS не передаются (таблица последних значений их уже учла)
+        if (!elements.empty())
+            client->deadband.Apply(typeID, cot, receivedAsduAddress, elements);
+
         if (!elements.empty())
         {
             for (const auto &[ioa, val, quality, timestamp] : elements)
@@ -1927,11 +2707,72 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                 //     TypeID_toString(typeID), client->clientID.c_str(), receivedAsduAddress, ioa, val, quality, timestamp, client->cnt);
             }
 
-            client->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback)
+            if (client->dataRing.IsAttached())
+            {
+                // Точки пишутся в SharedArrayBuffer, их читает worker_threads; главный поток не участвует
+                client->dataRing.Push(elements.size(), [&](size_t i)
+                                      {
+                    const auto& [ioa, val, quality, timestamp] = elements[i];
+                    return PointRecord{typeID, receivedAsduAddress, cot, ioa, val, quality, timestamp, 0}; }, client->tsfn);
+                return true;
+            }
+
+            if (client->batcher.IsEnabled())
+            {
+                // Точки копятся в накопителе и уходят в JS пакетом по размеру или по таймеру
+                client->batcher.Append(elements.size(), [&](size_t i)
+                                       {
+                    const auto& [ioa, val, quality, timestamp] = elements[i];
+                    return PointRecord{typeID, receivedAsduAddress, cot, ioa, val, quality, timestamp, 0}; });
+                return true;
+            }
+
+            if (client->columnar)
+            {
+                // Колоночный формат: один объект на ASDU с typed arrays вместо объекта на каждую точку
+                DecodedPoints *points = client->pointsPool.Acquire(elements);
+                if (client->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback)
+                                             {
+                    size_t count = points->size();
+                    Napi::Int32Array ioaArr = Napi::Int32Array::New(env, count);
+                    Napi::Float64Array valArr = Napi::Float64Array::New(env, count);
+                    Napi::Uint8Array qualityArr = Napi::Uint8Array::New(env, count);
+                    Napi::Float64Array tsArr = Napi::Float64Array::New(env, count);
+                    int32_t *ioaData = ioaArr.Data();
+                    double *valData = valArr.Data();
+                    uint8_t *qualityData = qualityArr.Data();
+                    double *tsData = tsArr.Data();
+                    for (size_t i = 0; i < count; i++) {
+                        const auto& [ioa, val, quality, timestamp] = (*points)[i];
+                        ioaData[i] = ioa;
+                        valData[i] = val;
+                        qualityData[i] = quality;
+                        tsData[i] = static_cast<double>(timestamp);
+                    }
+                    client->pointsPool.Release(points);
+                    Napi::Object batch = Napi::Object::New(env);
+                    batch.Set("clientID", Napi::String::New(env, client->clientID.c_str()));
+                    batch.Set("typeId", Napi::Number::New(env, typeID));
+                    batch.Set("asdu", Napi::Number::New(env, receivedAsduAddress));
+                    batch.Set("cot", Napi::Number::New(env, cot));
+                    batch.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+                    batch.Set("ioa", ioaArr);
+                    batch.Set("val", valArr);
+                    batch.Set("quality", qualityArr);
+                    batch.Set("timestamp", tsArr);
+                    std::vector<napi_value> args = {Napi::String::New(env, "data"), batch};
+                    jsCallback.Call(args);
+                    client->cnt++; }) != napi_ok)
+                    client->pointsPool.Release(points);
+                return true;
+            }
+
+            DecodedPoints *points = client->pointsPool.Acquire(elements);
+            if (client->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback)
                                          {
-                    Napi::Array jsArray = Napi::Array::New(env, elements.size());
-                    for (size_t i = 0; i < elements.size(); i++) {
-                        const auto& [ioa, val, quality, timestamp] = elements[i];
+                    Napi::Array jsArray = Napi::Array::New(env, points->size());
+                    for (size_t i = 0; i < points->size(); i++) {
+                        const auto& [ioa, val, quality, timestamp] = (*points)[i];
                         Napi::Object msg = Napi::Object::New(env);
                         msg.Set("clientID", Napi::String::New(env, client->clientID.c_str()));
                         msg.Set("typeId", Napi::Number::New(env, typeID));
@@ -1944,9 +2785,11 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
                         }
                         jsArray[i] = msg;
                     }
+                    client->pointsPool.Release(points);
                     std::vector<napi_value> args = {Napi::String::New(env, "data"), jsArray};
                     jsCallback.Call(args);
-                    client->cnt++; });
+                    client->cnt++; }) != napi_ok)
+                client->pointsPool.Release(points);
         }
 
         return true;
@@ -1967,6 +2810,210 @@ bool IEC104Client::RawMessageHandler(void *parameter, int address, CS101_ASDU as
     }
 }
 
+void IEC104Client::EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord> &points)
+{
+    size_t count = points.size();
+    if (columnar)
+    {
+        // В пакете могут быть точки из разных ASDU, поэтому typeId/asdu/cot тоже передаются колонками
+        Napi::Uint8Array typeIdArr = Napi::Uint8Array::New(env, count);
+        Napi::Uint16Array asduArr = Napi::Uint16Array::New(env, count);
+        Napi::Uint8Array cotArr = Napi::Uint8Array::New(env, count);
+        Napi::Int32Array ioaArr = Napi::Int32Array::New(env, count);
+        Napi::Float64Array valArr = Napi::Float64Array::New(env, count);
+        Napi::Uint8Array qualityArr = Napi::Uint8Array::New(env, count);
+        Napi::Float64Array tsArr = Napi::Float64Array::New(env, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const PointRecord &p = points[i];
+            typeIdArr[i] = static_cast<uint8_t>(p.typeId);
+            asduArr[i] = static_cast<uint16_t>(p.ca);
+            cotArr[i] = static_cast<uint8_t>(p.cot);
+            ioaArr[i] = p.ioa;
+            valArr[i] = p.val;
+            qualityArr[i] = p.quality;
+            tsArr[i] = static_cast<double>(p.timestamp);
+        }
+        Napi::Object batch = Napi::Object::New(env);
+        batch.Set("clientID", Napi::String::New(env, clientID.c_str()));
+        batch.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+        batch.Set("typeId", typeIdArr);
+        batch.Set("asdu", asduArr);
+        batch.Set("cot", cotArr);
+        batch.Set("ioa", ioaArr);
+        batch.Set("val", valArr);
+        batch.Set("quality", qualityArr);
+        batch.Set("timestamp", tsArr);
+        jsCallback.Call({Napi::String::New(env, "data"), batch});
+    }
+    else
+    {
+        Napi::Array jsArray = Napi::Array::New(env, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const PointRecord &p = points[i];
+            Napi::Object msg = Napi::Object::New(env);
+            msg.Set("clientID", Napi::String::New(env, clientID.c_str()));
+            msg.Set("typeId", Napi::Number::New(env, p.typeId));
+            msg.Set("asdu", Napi::Number::New(env, p.ca));
+            msg.Set("ioa", Napi::Number::New(env, p.ioa));
+            msg.Set("val", Napi::Number::New(env, p.val));
+            msg.Set("quality", Napi::Number::New(env, p.quality));
+            if (p.timestamp > 0)
+            {
+                msg.Set("timestamp", Napi::Number::New(env, static_cast<double>(p.timestamp)));
+            }
+            jsArray[i] = msg;
+        }
+        jsCallback.Call({Napi::String::New(env, "data"), jsArray});
+    }
+    cnt++;
+}
+
+// Читает столбец ключей getPoints: массив чисел или typed array
+static bool ReadKeyColumn(Napi::Value value, std::vector<int32_t> &out)
+{
+    if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_int32_array)
+    {
+        Napi::Int32Array column = value.As<Napi::Int32Array>();
+        out.assign(column.Data(), column.Data() + column.ElementLength());
+        return true;
+    }
+    if (!value.IsObject())
+        return false;
+
+    Napi::Object column = value.As<Napi::Object>();
+    uint32_t length = column.Get("length").ToNumber().Uint32Value();
+    out.resize(length);
+    for (uint32_t i = 0; i < length; i++)
+        out[i] = column.Get(i).ToNumber().Int32Value();
+    return true;
+}
+
+// Последние значения точек по ключам { asdu, ioa }; результат выровнен по ключам, found[i] = 0 — точки нет
+Napi::Value IEC104Client::GetPoints(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!useCache)
+    {
+        Napi::Error::New(env, "Last value cache is disabled, connect with 'lastValueCache: true'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected keys { asdu (number or array), ioa (array or Int32Array) }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object keys = info[0].As<Napi::Object>();
+    std::vector<int32_t> ioas;
+    std::vector<int32_t> cas;
+    if (!keys.Has("ioa") || !ReadKeyColumn(keys.Get("ioa"), ioas))
+    {
+        Napi::TypeError::New(env, "keys.ioa must be an array or Int32Array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!keys.Has("asdu"))
+    {
+        Napi::TypeError::New(env, "keys.asdu must be a number or an array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (keys.Get("asdu").IsNumber())
+    {
+        cas.assign(ioas.size(), keys.Get("asdu").As<Napi::Number>().Int32Value());
+    }
+    else if (!ReadKeyColumn(keys.Get("asdu"), cas) || cas.size() != ioas.size())
+    {
+        Napi::TypeError::New(env, "keys.asdu must be a number or an array of the same length as keys.ioa").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    size_t count = ioas.size();
+    Napi::Uint8Array foundArr = Napi::Uint8Array::New(env, count);
+    Napi::Uint8Array typeIdArr = Napi::Uint8Array::New(env, count);
+    Napi::Float64Array valArr = Napi::Float64Array::New(env, count);
+    Napi::Uint8Array qualityArr = Napi::Uint8Array::New(env, count);
+    Napi::Float64Array tsArr = Napi::Float64Array::New(env, count);
+    uint8_t *foundData = foundArr.Data();
+    uint8_t *typeIdData = typeIdArr.Data();
+    double *valData = valArr.Data();
+    uint8_t *qualityData = qualityArr.Data();
+    double *tsData = tsArr.Data();
+    {
+        auto cacheLock = lastValues.Lock();
+        for (size_t i = 0; i < count; i++)
+        {
+            const LastValueCache::Entry *entry = lastValues.Find(cas[i], ioas[i]);
+            foundData[i] = entry ? 1 : 0;
+            typeIdData[i] = entry ? static_cast<uint8_t>(entry->typeId) : 0;
+            valData[i] = entry ? entry->val : NAN;
+            qualityData[i] = entry ? entry->quality : 0;
+            tsData[i] = entry ? static_cast<double>(entry->timestamp) : 0;
+        }
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("found", foundArr);
+    result.Set("typeId", typeIdArr);
+    result.Set("val", valArr);
+    result.Set("quality", qualityArr);
+    result.Set("timestamp", tsArr);
+    return result;
+}
+
+// Все последние значения колонками, в том же виде, что и пакеты dataFormat: 'columnar'
+Napi::Value IEC104Client::Snapshot(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!useCache)
+    {
+        Napi::Error::New(env, "Last value cache is disabled, connect with 'lastValueCache: true'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Копия под блокировкой, typed arrays создаются уже без неё, чтобы не задерживать поток приёма
+    std::vector<PointRecord> points;
+    {
+        auto cacheLock = lastValues.Lock();
+        points.reserve(lastValues.Size());
+        lastValues.ForEach([&points](int ca, int32_t ioa, const LastValueCache::Entry &entry) {
+            points.push_back(PointRecord{entry.typeId, ca, 0, ioa, entry.val, entry.quality, entry.timestamp, 0});
+        });
+    }
+
+    size_t count = points.size();
+    Napi::Uint8Array typeIdArr = Napi::Uint8Array::New(env, count);
+    Napi::Uint16Array asduArr = Napi::Uint16Array::New(env, count);
+    Napi::Int32Array ioaArr = Napi::Int32Array::New(env, count);
+    Napi::Float64Array valArr = Napi::Float64Array::New(env, count);
+    Napi::Uint8Array qualityArr = Napi::Uint8Array::New(env, count);
+    Napi::Float64Array tsArr = Napi::Float64Array::New(env, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const PointRecord &p = points[i];
+        typeIdArr[i] = static_cast<uint8_t>(p.typeId);
+        asduArr[i] = static_cast<uint16_t>(p.ca);
+        ioaArr[i] = p.ioa;
+        valArr[i] = p.val;
+        qualityArr[i] = p.quality;
+        tsArr[i] = static_cast<double>(p.timestamp);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("clientID", Napi::String::New(env, clientID.c_str()));
+    result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("typeId", typeIdArr);
+    result.Set("asdu", asduArr);
+    result.Set("ioa", ioaArr);
+    result.Set("val", valArr);
+    result.Set("quality", qualityArr);
+    result.Set("timestamp", tsArr);
+    return result;
+}
+
 std::string IEC104Client::getFileNameByNOF(uint16_t nof)
 {
     auto it = fileList.find(nof);
@@ -1993,5 +3040,28 @@ Napi::Value IEC104Client::GetStatus(const Napi::CallbackInfo &info)
     status.Set("activated", Napi::Boolean::New(env, activated));
     status.Set("clientID", Napi::String::New(env, clientID.c_str()));
     status.Set("usingPrimaryIp", Napi::Boolean::New(env, usingPrimaryIp));
+    status.Set("switchovers", Napi::Number::New(env, static_cast<double>(switchovers)));
+    status.Set("lastSwitchoverMs", Napi::Number::New(env, static_cast<double>(lastSwitchoverMs)));
+    status.Set("redundancy", Napi::String::New(env, hotStandby ? "hot-standby" : "parallel"));
+    status.Set("standbyConnected", Napi::Boolean::New(env, standbyReady.load()));
+    status.Set("standbyIp", Napi::String::New(env, standbyIp.c_str()));
+    status.Set("commandsQueued", Napi::Number::New(env, static_cast<double>(commandQueue.size())));
+    status.Set("commandsInFlight", Napi::Number::New(env, static_cast<double>(commandsInFlight.size())));
+    status.Set("commandsConfirmed", Napi::Number::New(env, static_cast<double>(commandsConfirmed)));
+    status.Set("commandsFailed", Napi::Number::New(env, static_cast<double>(commandsFailed)));
+    if (useCache)
+    {
+        auto cacheLock = lastValues.Lock();
+        Napi::Object cache = Napi::Object::New(env);
+        cache.Set("points", Napi::Number::New(env, static_cast<double>(lastValues.Size())));
+        cache.Set("capacity", Napi::Number::New(env, static_cast<double>(lastValues.Capacity())));
+        cache.Set("suppressed", Napi::Number::New(env, static_cast<double>(suppressedPoints)));
+        status.Set("lastValueCache", cache);
+    }
+    status.Set("batching", batcher.GetStats(env));
+    if (deadband.IsEnabled())
+        status.Set("deadband", deadband.GetStats(env));
+    if (dataRing.IsAttached())
+        status.Set("dataRing", dataRing.GetStats(env));
     return status;
 }
\ No newline at end of file
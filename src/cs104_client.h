@@ -7,6 +7,14 @@
 #include <atomic>
 #include <vector>
 #include <map> // Добавляем для std::map
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+#include "last_value_cache.h"
+#include "deadband_filter.h"
+#include "shared_ring.h"
 
 extern "C" {
 #include "cs104_connection.h"
@@ -25,15 +33,46 @@ public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     IEC104Client(const Napi::CallbackInfo& info);
     virtual ~IEC104Client();
+    void Teardown();
 
 private:
     //std::vector<FileInfo> fileList; // Изменено с std::vector<std::pair<int, std::string>>
     std::map<uint16_t, FileInfo> fileList; // Ключ — NOF
-    static Napi::FunctionReference constructor;
     uint16_t currentNOF; // Добавляем для хранения текущего NOF
     
+    // Соединение с одним из адресов (основной/резервный). Оба адреса дозваниваются одновременно,
+    // рабочим становится то соединение, которое первым получило STARTDT_CON.
+    struct DialAttempt {
+        IEC104Client* client = nullptr;
+        CS104_Connection connection = nullptr;
+        std::string ip;
+        bool isPrimary = true;
+        bool autoStartDT = true; // false — соединение остаётся в STOPDT (горячий резерв)
+        int state = 0;          // DialState, под dialMutex
+        uint64_t startedAt = 0;
+        uint64_t openedAt = 0;
+        uint64_t startDTSentAt = 0;
+        uint64_t switchStartedAt = 0; // Начало переключения на это соединение (для lastSwitchoverMs)
+    };
+    enum DialState { DIAL_PENDING, DIAL_OPENED, DIAL_STARTING, DIAL_ACTIVATED, DIAL_FAILED };
+
     int originatorAddress;
-    CS104_Connection connection;
+    CS104_Connection connection; // Соединение рабочей попытки (dialWinner)
+    std::mutex dialMutex;
+    std::condition_variable dialCv;
+    bool dialWakeup = false; // Событие соединения или команды для потока соединения, под dialMutex
+    std::atomic<DialAttempt*> dialWinner{nullptr};
+    std::atomic<DialAttempt*> dialTakeover{nullptr}; // Резерв, которому отправлен STARTDT: по STARTDT_CON сразу становится рабочим
+    bool hotStandby = false;      // redundancy: 'hot-standby' — второй адрес держится подключённым в STOPDT
+    int standbyT3 = 0;            // t3 резервного соединения (TESTFR), с
+    std::atomic<bool> standbyReady{false};
+    std::string standbyIp;        // Под connMutex
+    struct sCS104_APCIParameters apciParameters;
+    int connectTimeoutMs = 0;
+    int startDTTimeoutMs = 0;
+    int primaryCheckIntervalMs = 5000;
+    uint64_t lastSwitchoverMs = 0; // Время от начала дозвона до STARTDT_CON последнего переключения
+    uint64_t switchovers = 0;
     std::thread _thread;
     std::atomic<bool> running;
     std::mutex connMutex;
@@ -43,21 +82,104 @@ private:
     int cnt = 0;
     int asduAddress; 
     bool usingPrimaryIp;
+    bool columnar = false; // dataFormat: 'columnar' — данные мониторинга передаются колонками typed arrays
+
+    // Таблица последних значений (params.lastValueCache) и какие точки из неё уходят в JS (params.deliver)
+    enum DeliverMode { DELIVER_ALL, DELIVER_CHANGES, DELIVER_NONE };
+    bool useCache = false;
+    DeliverMode deliver = DELIVER_ALL;
+    LastValueCache lastValues;
+    uint64_t suppressedPoints = 0; // Не переданные в JS точки (под lastValues.Lock())
+
+    // Команда submitCommands: ждёт свободного места в окне k, затем ACT_CON (или ACT_TERM) либо
+    // DEACT_CON, который сопоставляется по (ca, ioa, typeId, cot)
+    struct PipelinedCommand {
+        Napi::Promise::Deferred deferred; // Разрешается только в JS-потоке через tsfn
+        std::unique_ptr<sCS101_ASDU, void (*)(CS101_ASDU)> asdu{nullptr, CS101_ASDU_destroy};
+        int typeId = 0;
+        int ioa = 0;
+        int ca = 0;
+        int cot = CS101_COT_ACTIVATION; // COT отправленной команды: ACTIVATION или DEACTIVATION
+        bool waitTerm = false;        // confirm: 'actterm' — завершать по ACT_TERM
+        bool actConReceived = false;
+        uint64_t queuedAt = 0;
+        uint64_t sentAt = 0;
+        uint64_t actConAt = 0;
+        uint64_t deadline = 0;
+    };
+    // Подтверждение команды, принятое потоком приёма. Поток приёма вызывает обработчик ASDU под
+    // блокировкой lib60870, поэтому не берёт connMutex: подтверждения разбирает ServeCommandQueue
+    struct CommandConfirmation {
+        int typeId;
+        int cot;
+        int ca;
+        int ioa;
+        bool negative;
+        uint64_t receivedAt;
+    };
+    // Итог команды для промиса submitCommands
+    struct CommandResult {
+        std::shared_ptr<PipelinedCommand> command;
+        std::string error;
+        int cot;
+        double latencyMs;
+        double queuedMs;
+        double actConMs;
+    };
+    std::deque<std::shared_ptr<PipelinedCommand>> commandQueue;     // Ещё не отправлены (под connMutex)
+    std::deque<std::shared_ptr<PipelinedCommand>> commandsInFlight; // Отправлены, ждут подтверждения (под connMutex)
+    std::mutex confirmMutex;
+    std::vector<CommandConfirmation> confirmations; // Под confirmMutex
+    std::atomic<bool> commandWakeup{false};         // Есть новые команды или подтверждения для потока соединения
+    struct sCS101_AppLayerParameters commandALParams; // Параметры ASDU в очереди: рабочее соединение может смениться до отправки
+    uint64_t commandsConfirmed = 0;
+    uint64_t commandsFailed = 0;
+    std::vector<CommandResult> undeliveredResults; // Не переданы в поток JS: TSFN закрывается (под connMutex)
 
     //std::vector<std::pair<int, std::string>> fileList; // IOA и имя файла
     std::map<int, std::vector<uint8_t>> fileData; // Хранение фрагментов файла по IOA
 
     Napi::ThreadSafeFunction tsfn;
+    // При make-before-break ASDU приходят из потоков двух соединений сразу (старое ещё не закрыто,
+    // новое уже выбрано), поэтому состояние приёма ниже используется только под handlerMutex
+    std::mutex handlerMutex;
+    IODecodeBuffer decodeBuffer; // Буфер для CS101_ASDU_getElementEx (под handlerMutex)
+    DecodedPoints decodedPoints; // Точки текущего ASDU и векторы для передачи в JS (под handlerMutex)
+    DecodedPointsPool pointsPool;
+    CP56Time2aDayCache dayCache = {0, 0}; // Последние сутки для CP56Time2a_toMsTimestampCached (под handlerMutex)
+    EventBatcher<PointRecord> batcher; // Пакетная передача точек в JS (batchSize/batchLatency)
+    DeadbandFilter deadband; // Зона нечувствительности аналоговых точек (params.deadband)
+    SharedRing dataRing;     // Точки в SharedArrayBuffer для worker_threads (params.dataRing)
 
     static bool RawMessageHandler(void* parameter, int address, CS101_ASDU asdu);
     static void ConnectionHandler(void* parameter, CS104_Connection con, CS104_ConnectionEvent event);
+    static void DialConnectionHandler(void* parameter, CS104_Connection con, CS104_ConnectionEvent event);
+    static bool DialASDUHandler(void* parameter, int address, CS101_ASDU asdu);
+    std::unique_ptr<DialAttempt> StartDial(const std::string& ip, int port, bool isPrimary, bool autoStartDT = true);
+    void DestroyDial(std::unique_ptr<DialAttempt>& attempt);
+    void ActivateDial(DialAttempt* attempt, uint64_t dialStartedAt);
+    void SendDialStartDT(DialAttempt* attempt);
+    void SetStandby(DialAttempt* attempt);
+    void WakeConnectionLoop();
+    void RunConnectionLoop(std::string ip, std::string ipReserve, int port, int reconnectDelay);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord>& points);
+    bool EncodeCommand(Napi::Env env, Napi::Object cmdObj, CS101_ASDU asdu, int typeId, int ioa, bool bselCmd, int ql);
+    void ServeCommandQueue();
+    void ConfirmCommand(const CommandConfirmation& confirmation);
+    void CompleteCommand(const std::shared_ptr<PipelinedCommand>& command, const std::string& error, int cot, uint64_t completedAt);
+    void FailCommands(std::deque<std::shared_ptr<PipelinedCommand>>& commands, const std::string& error);
+    void SettleUndeliveredCommands(Napi::Env env);
+    static void SettleCommand(Napi::Env env, const CommandResult& result);
 
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value Disconnect(const Napi::CallbackInfo& info);
     Napi::Value SendStartDT(const Napi::CallbackInfo& info);
     Napi::Value SendStopDT(const Napi::CallbackInfo& info);
     Napi::Value SendCommands(const Napi::CallbackInfo& info);
+    Napi::Value SubmitCommands(const Napi::CallbackInfo& info);
     Napi::Value GetStatus(const Napi::CallbackInfo& info);
+    Napi::Value GetPoints(const Napi::CallbackInfo& info);
+    Napi::Value Snapshot(const Napi::CallbackInfo& info);
     Napi::Value RequestFileList(const Napi::CallbackInfo& info);
     Napi::Value SelectFile(const Napi::CallbackInfo& info); // Новый метод для выбора файла
     Napi::Value OpenFile(const Napi::CallbackInfo& info);     // Новый метод для открытия файла
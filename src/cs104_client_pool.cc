@@ -0,0 +1,851 @@
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include <inttypes.h>
+#include <cs104_client_pool.h>
+#include "addon_data.h"
+#include <napi.h>
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+}
+
+using namespace Napi;
+using namespace std;
+
+// data.u64 события epoll для eventfd пробуждения; у соединений — их номер
+static const uint64_t WAKEUP_EVENT = UINT64_MAX;
+static const int MAX_EPOLL_EVENTS = 64;
+
+Object IEC104ClientPool::Init(Napi::Env env, Object exports) {
+    Function func = DefineClass(env, "IEC104ClientPool", {
+        InstanceMethod("start", &IEC104ClientPool::Start),
+        InstanceMethod("stop", &IEC104ClientPool::Stop),
+        InstanceMethod("addConnection", &IEC104ClientPool::AddConnection),
+        InstanceMethod("removeConnection", &IEC104ClientPool::RemoveConnection),
+        InstanceMethod("sendCommands", &IEC104ClientPool::SendCommands),
+        InstanceMethod("sendStartDT", &IEC104ClientPool::SendStartDT),
+        InstanceMethod("sendStopDT", &IEC104ClientPool::SendStopDT),
+        InstanceMethod("getStatus", &IEC104ClientPool::GetStatus)
+    });
+
+    GetAddonData(env)->iec104ClientPool = Persistent(func);
+    exports.Set("IEC104ClientPool", func);
+    return exports;
+}
+
+IEC104ClientPool::IEC104ClientPool(const CallbackInfo &info) : ObjectWrap<IEC104ClientPool>(info) {
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(info.Env(), "Expected a callback function").ThrowAsJavaScriptException();
+        return;
+    }
+
+#ifndef __linux__
+    // Без epoll рабочим потокам нечем ждать сокеты: пул обходил бы соединения по таймеру
+    Napi::Error::New(info.Env(), "IEC104ClientPool is not supported on this platform (requires epoll)").ThrowAsJavaScriptException();
+    return;
+#endif
+
+    Napi::Function emit = info[0].As<Napi::Function>();
+    running = false;
+
+    try {
+        tsfn = ThreadSafeFunction::New(
+            info.Env(),
+            emit,
+            "IEC104ClientPoolTSFN",
+            0,
+            1,
+            [](Napi::Env) {}
+        );
+    } catch (const std::exception& e) {
+        printf("Failed to create ThreadSafeFunction: %s\n", e.what());
+        Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
+    }
+    AddTeardownHook(info.Env(), this);
+}
+
+IEC104ClientPool::~IEC104ClientPool() {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает
+void IEC104ClientPool::Teardown() {
+    if (running) {
+        Shutdown();
+        tsfn.Release();
+    }
+}
+
+Napi::Value IEC104ClientPool::Start(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected an object with { poolID (string), [threads (number)], [params (object)] }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (running) {
+        Napi::Error::New(env, "Pool already running").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    if (!config.Has("poolID") || !config.Get("poolID").IsString()) {
+        Napi::TypeError::New(env, "Object must contain 'poolID' (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    poolID = config.Get("poolID").As<String>().Utf8Value();
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 1) threads = 1;
+    if (config.Has("threads")) threads = config.Get("threads").As<Number>().Int32Value();
+
+    if (threads < 1 || threads > 64) {
+        Napi::RangeError::New(env, "threads must be 1-64").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Пакетная передача данных в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = config.Has("params") && config.Get("params").IsObject() ? config.Get("params").As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    workers.clear();
+    for (int i = 0; i < threads; i++) {
+        auto worker = std::make_unique<PoolWorker>();
+#ifdef __linux__
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = WAKEUP_EVENT;
+        if (worker->epollFd < 0 || worker->wakeupFd < 0 ||
+            epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeupFd, &ev) != 0) {
+            if (worker->epollFd >= 0) close(worker->epollFd);
+            if (worker->wakeupFd >= 0) close(worker->wakeupFd);
+            for (auto &w : workers) {
+                close(w->epollFd);
+                close(w->wakeupFd);
+            }
+            workers.clear();
+            Napi::Error::New(env, "Failed to create epoll instance").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+#endif
+        workers.push_back(std::move(worker));
+    }
+
+    printf("Starting IEC 104 client pool %s with %d threads\n", poolID.c_str(), threads);
+
+    running = true;
+    batcher.Start(tsfn, [this](Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+        EmitBatch(env, jsCallback, points);
+    });
+    for (auto &worker : workers) {
+        PoolWorker *w = worker.get();
+        w->thread = std::thread([this, w]() { WorkerLoop(*w); });
+    }
+
+    return env.Undefined();
+}
+
+void IEC104ClientPool::Shutdown() {
+    running = false;
+
+    for (auto &worker : workers) {
+        Wakeup(*worker);
+    }
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (auto &entry : worker->connections) {
+            PooledConnection &con = *entry.second;
+            con.removed = true;
+            if (con.connection) {
+                CS104_Connection_destroy(con.connection);
+                con.connection = nullptr;
+            }
+        }
+        worker->connections.clear();
+        worker->timers = {};
+#ifdef __linux__
+        close(worker->epollFd);
+        close(worker->wakeupFd);
+#endif
+    }
+    workers.clear();
+    connections.clear();
+
+    batcher.Stop();
+}
+
+Napi::Value IEC104ClientPool::Stop(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (running) {
+        printf("Stopping IEC 104 client pool %s\n", poolID.c_str());
+        Shutdown();
+        tsfn.Release();
+    }
+    return env.Undefined();
+}
+
+Napi::Value IEC104ClientPool::AddConnection(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected an object with { clientID (string), ip (string), port (number), [params (object)] }").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!running) {
+        Napi::Error::New(env, "Pool not started").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    if (!config.Has("clientID") || !config.Get("clientID").IsString() ||
+        !config.Has("ip") || !config.Get("ip").IsString() ||
+        !config.Has("port") || !config.Get("port").IsNumber()) {
+        Napi::TypeError::New(env, "Object must contain 'clientID' (string), 'ip' (string), and 'port' (number)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto con = std::make_shared<PooledConnection>();
+    con->pool = this;
+    con->clientID = config.Get("clientID").As<String>().Utf8Value();
+    con->ip = config.Get("ip").As<String>().Utf8Value();
+    con->port = config.Get("port").As<Number>().Int32Value();
+
+    if (con->clientID.empty() || con->ip.empty() || con->port <= 0 || con->port > 65535) {
+        Napi::Error::New(env, "Invalid 'clientID', 'ip', or 'port'").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (connections.count(con->clientID)) {
+        Napi::Error::New(env, "Connection '" + con->clientID + "' already exists").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (config.Has("params") && config.Get("params").IsObject()) {
+        Napi::Object params = config.Get("params").As<Napi::Object>();
+        if (params.Has("originatorAddress")) con->originatorAddress = params.Get("originatorAddress").As<Number>().Int32Value();
+        if (params.Has("k")) con->apci.k = params.Get("k").As<Number>().Int32Value();
+        if (params.Has("w")) con->apci.w = params.Get("w").As<Number>().Int32Value();
+        if (params.Has("t0")) con->apci.t0 = params.Get("t0").As<Number>().Int32Value();
+        if (params.Has("t1")) con->apci.t1 = params.Get("t1").As<Number>().Int32Value();
+        if (params.Has("t2")) con->apci.t2 = params.Get("t2").As<Number>().Int32Value();
+        if (params.Has("t3")) con->apci.t3 = params.Get("t3").As<Number>().Int32Value();
+        if (params.Has("connectTimeout")) con->connectTimeout = params.Get("connectTimeout").As<Number>().Int32Value();
+        if (params.Has("reconnectDelay")) con->reconnectDelay = params.Get("reconnectDelay").As<Number>().Int32Value();
+        if (params.Has("autoStartDT")) con->autoStartDT = params.Get("autoStartDT").ToBoolean().Value();
+    }
+
+    if (con->originatorAddress < 0 || con->originatorAddress > 255) {
+        Napi::Error::New(env, "originatorAddress must be 0-255").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (con->apci.k <= 0 || con->apci.w <= 0 || con->apci.t0 <= 0 || con->apci.t1 <= 0 || con->apci.t2 <= 0 || con->apci.t3 <= 0) {
+        Napi::Error::New(env, "k, w, t0, t1, t2, t3 must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (con->connectTimeout < 0) {
+        Napi::Error::New(env, "connectTimeout must not be negative").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (con->reconnectDelay < 1) {
+        Napi::Error::New(env, "reconnectDelay must be at least 1 second").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Соединение достаётся потоку с наименьшим числом соединений
+    size_t best = 0;
+    size_t bestCount = SIZE_MAX;
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::lock_guard<std::mutex> lock(workers[i]->mutex);
+        if (workers[i]->connections.size() < bestCount) {
+            best = i;
+            bestCount = workers[i]->connections.size();
+        }
+    }
+
+    con->worker = best;
+    con->index = static_cast<int>(connectionNames.size());
+    connectionNames.push_back(con->clientID);
+    connections[con->clientID] = con;
+
+    {
+        PoolWorker &worker = *workers[best];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.connections[con->index] = con;
+        Schedule(worker, con, 0);
+    }
+    Wakeup(*workers[best]);
+
+    return env.Undefined();
+}
+
+Napi::Value IEC104ClientPool::RemoveConnection(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected clientID (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string clientID = info[0].As<String>().Utf8Value();
+    auto it = connections.find(clientID);
+    if (it == connections.end()) {
+        return Boolean::New(env, false);
+    }
+
+    std::shared_ptr<PooledConnection> con = it->second;
+    PoolWorker &worker = *workers[con->worker];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        con->removed = true;
+        if (con->connection) {
+            // В режиме без потока закрывает сокет сразу; epoll забывает закрытый дескриптор сам
+            CS104_Connection_destroy(con->connection);
+            con->connection = nullptr;
+        }
+        worker.connections.erase(con->index);
+    }
+    connections.erase(it);
+
+    return Boolean::New(env, true);
+}
+
+Napi::Value IEC104ClientPool::SendCommands(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+        Napi::TypeError::New(env, "Expected clientID (string) and commands (array of objects)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto it = connections.find(info[0].As<String>().Utf8Value());
+    if (it == connections.end()) {
+        Napi::Error::New(env, "Unknown connection").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::shared_ptr<PooledConnection> con = it->second;
+    Napi::Array commands = info[1].As<Napi::Array>();
+
+    PoolWorker &worker = *workers[con->worker];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!con->connected || !con->activated) {
+        Napi::Error::New(env, "Connection not active").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    CS101_AppLayerParameters alParams = CS104_Connection_getAppLayerParameters(con->connection);
+    std::vector<CS101_ASDU> asdus;
+
+    for (uint32_t i = 0; i < commands.Length(); i++) {
+        Napi::Value cmdVal = commands[i];
+        if (!cmdVal.IsObject()) {
+            Napi::TypeError::New(env, "Command must be an object").ThrowAsJavaScriptException();
+            break;
+        }
+
+        Napi::Object cmdObj = cmdVal.As<Napi::Object>();
+        if (!cmdObj.Has("typeId") || !cmdObj.Has("ioa") || !cmdObj.Has("asdu")) {
+            Napi::TypeError::New(env, "Each command must have 'typeId', 'ioa' and 'asdu'").ThrowAsJavaScriptException();
+            break;
+        }
+
+        int typeId = cmdObj.Get("typeId").As<Number>().Int32Value();
+        int ioa = cmdObj.Get("ioa").As<Number>().Int32Value();
+        int ca = cmdObj.Get("asdu").As<Number>().Int32Value();
+        Napi::Value value = cmdObj.Has("value") ? cmdObj.Get("value") : Napi::Value(Number::New(env, 0));
+        bool select = cmdObj.Has("bselCmd") && cmdObj.Get("bselCmd").ToBoolean().Value();
+        int ql = cmdObj.Has("ql") ? cmdObj.Get("ql").As<Number>().Int32Value() : 0;
+
+        CS101_CauseOfTransmission cot = (typeId == C_RD_NA_1) ? CS101_COT_REQUEST : CS101_COT_ACTIVATION;
+        InformationObject io = nullptr;
+        struct sCP56Time2a time;
+
+        switch (typeId) {
+            case C_SC_NA_1:
+                io = (InformationObject)SingleCommand_create(NULL, ioa, value.ToBoolean().Value(), select, ql);
+                break;
+            case C_DC_NA_1:
+                io = (InformationObject)DoubleCommand_create(NULL, ioa, value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_RC_NA_1:
+                io = (InformationObject)StepCommand_create(NULL, ioa, (StepCommandValue)value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_SE_NA_1:
+                io = (InformationObject)SetpointCommandNormalized_create(NULL, ioa, value.ToNumber().FloatValue(), select, ql);
+                break;
+            case C_SE_NB_1:
+                io = (InformationObject)SetpointCommandScaled_create(NULL, ioa, value.ToNumber().Int32Value(), select, ql);
+                break;
+            case C_SE_NC_1:
+                io = (InformationObject)SetpointCommandShort_create(NULL, ioa, value.ToNumber().FloatValue(), select, ql);
+                break;
+            case C_BO_NA_1:
+                io = (InformationObject)Bitstring32Command_create(NULL, ioa, value.ToNumber().Uint32Value());
+                break;
+            case C_IC_NA_1:
+                io = (InformationObject)InterrogationCommand_create(NULL, ioa, cmdObj.Has("value") ? value.ToNumber().Uint32Value() : IEC60870_QOI_STATION);
+                break;
+            case C_CI_NA_1:
+                io = (InformationObject)CounterInterrogationCommand_create(NULL, ioa, value.ToNumber().Uint32Value());
+                break;
+            case C_RD_NA_1:
+                io = (InformationObject)ReadCommand_create(NULL, ioa);
+                break;
+            case C_CS_NA_1:
+                CP56Time2a_createFromMsTimestamp(&time, cmdObj.Has("value") ? value.ToNumber().Int64Value() : Hal_getTimeInMs());
+                io = (InformationObject)ClockSynchronizationCommand_create(NULL, ioa, &time);
+                break;
+            default:
+                break;
+        }
+
+        if (!io) {
+            Napi::TypeError::New(env, "Unsupported command typeId " + to_string(typeId)).ThrowAsJavaScriptException();
+            break;
+        }
+
+        CS101_ASDU asdu = CS101_ASDU_create(alParams, false, cot, con->originatorAddress, ca, false, false);
+        CS101_ASDU_addInformationObject(asdu, io);
+        InformationObject_destroy(io);
+        asdus.push_back(asdu);
+    }
+
+    if (asdus.size() != commands.Length()) {
+        for (CS101_ASDU asdu : asdus) {
+            CS101_ASDU_destroy(asdu);
+        }
+        return env.Undefined();
+    }
+
+    // Отправка останавливается на заполненном окне k: возвращается число отправленных команд
+    uint32_t sent = 0;
+    bool full = false;
+    for (CS101_ASDU asdu : asdus) {
+        if (!full && CS104_Connection_sendASDU(con->connection, asdu))
+            sent++;
+        else
+            full = true;
+        CS101_ASDU_destroy(asdu);
+    }
+
+    // t1 отправленных команд должен попасть в очередь таймеров
+    if (sent > 0 && con->active) {
+        Schedule(worker, con, Hal_getTimeInMs() + 1);
+        Wakeup(worker);
+    }
+
+    return Number::New(env, sent);
+}
+
+Napi::Value IEC104ClientPool::SendStartDT(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected clientID (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto it = connections.find(info[0].As<String>().Utf8Value());
+    if (it == connections.end()) {
+        Napi::Error::New(env, "Unknown connection").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::shared_ptr<PooledConnection> con = it->second;
+
+    PoolWorker &worker = *workers[con->worker];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!con->connected) {
+        return Boolean::New(env, false);
+    }
+    CS104_Connection_sendStartDT(con->connection);
+    // Таймаут ответа на U-кадр должен попасть в очередь таймеров
+    Schedule(worker, con, Hal_getTimeInMs() + 1);
+    Wakeup(worker);
+    return Boolean::New(env, true);
+}
+
+Napi::Value IEC104ClientPool::SendStopDT(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected clientID (string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto it = connections.find(info[0].As<String>().Utf8Value());
+    if (it == connections.end()) {
+        Napi::Error::New(env, "Unknown connection").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::shared_ptr<PooledConnection> con = it->second;
+
+    PoolWorker &worker = *workers[con->worker];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!con->connected) {
+        return Boolean::New(env, false);
+    }
+    CS104_Connection_sendStopDT(con->connection);
+    // Таймаут ответа на U-кадр должен попасть в очередь таймеров
+    Schedule(worker, con, Hal_getTimeInMs() + 1);
+    Wakeup(worker);
+    return Boolean::New(env, true);
+}
+
+Napi::Value IEC104ClientPool::GetStatus(const CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Object status = Object::New(env);
+    status.Set("poolID", String::New(env, poolID.c_str()));
+    status.Set("running", Boolean::New(env, running.load()));
+    status.Set("threads", Number::New(env, static_cast<double>(workers.size())));
+    status.Set("ioModel", String::New(env, "epoll"));
+
+    Napi::Array workerArray = Napi::Array::New(env, workers.size());
+    Napi::Array connectionArray = Napi::Array::New(env);
+    uint32_t connectionIndex = 0;
+    uint32_t connectedCount = 0;
+    uint32_t activatedCount = 0;
+    for (size_t i = 0; i < workers.size(); i++) {
+        PoolWorker &worker = *workers[i];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        Object w = Object::New(env);
+        w.Set("connections", Number::New(env, static_cast<double>(worker.connections.size())));
+        w.Set("wakeups", Number::New(env, static_cast<double>(worker.wakeups.load())));
+        w.Set("runs", Number::New(env, static_cast<double>(worker.runs.load())));
+        w.Set("timers", Number::New(env, static_cast<double>(worker.timers.size())));
+        workerArray[i] = w;
+
+        for (auto &entry : worker.connections) {
+            const PooledConnection &con = *entry.second;
+            Object c = Object::New(env);
+            c.Set("clientID", String::New(env, con.clientID.c_str()));
+            c.Set("ip", String::New(env, con.ip.c_str()));
+            c.Set("port", Number::New(env, con.port));
+            c.Set("worker", Number::New(env, static_cast<double>(i)));
+            c.Set("connected", Boolean::New(env, con.connected));
+            c.Set("activated", Boolean::New(env, con.activated));
+            c.Set("connectAttempts", Number::New(env, static_cast<double>(con.connectAttempts)));
+            c.Set("runs", Number::New(env, static_cast<double>(con.runs)));
+            c.Set("asdusReceived", Number::New(env, static_cast<double>(con.asdusReceived)));
+            connectionArray[connectionIndex++] = c;
+            if (con.connected) connectedCount++;
+            if (con.activated) activatedCount++;
+        }
+    }
+    status.Set("connected", Number::New(env, connectedCount));
+    status.Set("activated", Number::New(env, activatedCount));
+    status.Set("workers", workerArray);
+    status.Set("connections", connectionArray);
+    status.Set("batching", batcher.GetStats(env));
+    return status;
+}
+
+void IEC104ClientPool::Wakeup(PoolWorker &worker) {
+#ifdef __linux__
+    uint64_t one = 1;
+    if (write(worker.wakeupFd, &one, sizeof(one)) < 0) {
+        // Счётчик eventfd переполнен — поток и так проснётся
+    }
+#endif
+}
+
+void IEC104ClientPool::Schedule(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t due) {
+    con->nextTimer = due;
+    worker.timers.push({due, con});
+}
+
+void IEC104ClientPool::WorkerLoop(PoolWorker &worker) {
+#ifdef __linux__
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+#endif
+
+    while (running) {
+        // Ждём до ближайшего таймера потока; без таймеров — до события сокета или Wakeup
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (!worker.timers.empty()) {
+                uint64_t now = Hal_getTimeInMs();
+                uint64_t due = worker.timers.top().due;
+                timeout = due <= now ? 0 : static_cast<int>(std::min<uint64_t>(due - now, INT32_MAX));
+            }
+        }
+
+#ifdef __linux__
+        int count = epoll_wait(worker.epollFd, events, MAX_EPOLL_EVENTS, timeout);
+#else
+        // Недостижимо: вне Linux конструктор бросает исключение
+        Thread_sleep(timeout);
+#endif
+        worker.wakeups++;
+
+        if (!running)
+            break;
+
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        uint64_t now = Hal_getTimeInMs();
+
+#ifdef __linux__
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.u64 == WAKEUP_EVENT) {
+                uint64_t value;
+                if (read(worker.wakeupFd, &value, sizeof(value)) < 0) {
+                    // Уже прочитано
+                }
+                continue;
+            }
+            auto it = worker.connections.find(static_cast<int>(events[i].data.u64));
+            if (it == worker.connections.end() || !it->second->active)
+                continue;
+            std::shared_ptr<PooledConnection> con = it->second;
+            RunConnection(worker, con, now);
+        }
+#endif
+
+        // Таймеры t1/t2/t3, connect timeout и повторные подключения. Запись устарела, если
+        // соединение с тех пор перепланировано или удалено
+        while (!worker.timers.empty() && worker.timers.top().due <= now) {
+            TimerEntry entry = worker.timers.top();
+            worker.timers.pop();
+            std::shared_ptr<PooledConnection> con = entry.connection;
+            if (con->removed || entry.due != con->nextTimer)
+                continue;
+            if (con->active) {
+                RunConnection(worker, con, now);
+            } else if (now >= con->nextConnectAttempt) {
+                OpenConnection(worker, con, now);
+            } else {
+                Schedule(worker, con, con->nextConnectAttempt);
+            }
+        }
+    }
+}
+
+void IEC104ClientPool::OpenConnection(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t now) {
+    con->connectAttempts++;
+
+    if (!con->connection) {
+        con->connection = CS104_Connection_create(con->ip.c_str(), con->port);
+        if (!con->connection) {
+            con->nextConnectAttempt = now + static_cast<uint64_t>(con->reconnectDelay) * 1000;
+            Schedule(worker, con, con->nextConnectAttempt);
+            EmitControl(*con, "error", "Failed to create connection object");
+            return;
+        }
+
+        CS104_Connection_setAPCIParameters(con->connection, &con->apci);
+        if (con->connectTimeout > 0)
+            CS104_Connection_setConnectTimeout(con->connection, con->connectTimeout);
+
+        CS101_AppLayerParameters alParams = CS104_Connection_getAppLayerParameters(con->connection);
+        alParams->originatorAddress = con->originatorAddress;
+        alParams->sizeOfCA = 2;
+
+        CS104_Connection_setConnectionHandler(con->connection, ConnectionHandler, con.get());
+        CS104_Connection_setASDUReceivedHandler(con->connection, RawMessageHandler, con.get());
+    }
+
+    // Поток lib60870 не создаётся: соединение ведёт рабочий поток пула (CS104_Connection_run)
+    if (!CS104_Connection_connectThreadless(con->connection)) {
+        con->nextConnectAttempt = now + static_cast<uint64_t>(con->reconnectDelay) * 1000;
+        Schedule(worker, con, con->nextConnectAttempt);
+        EmitControl(*con, "reconnecting", string("attempt ") + to_string(con->connectAttempts) + " failed to start");
+        return;
+    }
+
+    con->active = true;
+    UpdateRegistration(worker, *con);
+    Schedule(worker, con, CS104_Connection_getNextTimeout(con->connection));
+}
+
+void IEC104ClientPool::RunConnection(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t now) {
+    con->runs++;
+    worker.runs++;
+
+    if (!CS104_Connection_run(con->connection)) {
+        // Сокет уже закрыт (и удалён из epoll вместе с дескриптором), обработчик соединения вызван
+        con->active = false;
+        con->registeredFd = -1;
+        con->watchWrite = false;
+        con->nextConnectAttempt = now + static_cast<uint64_t>(con->reconnectDelay) * 1000;
+        if (!con->removed)
+            Schedule(worker, con, con->nextConnectAttempt);
+        return;
+    }
+
+    UpdateRegistration(worker, *con);
+
+    // Следующий проход — по готовности сокета или по ближайшему из t1/t2/t3 и connect timeout.
+    // Команды из JS перепланируют соединение сами (SendCommands)
+    Schedule(worker, con, std::max(CS104_Connection_getNextTimeout(con->connection), now + 1));
+}
+
+void IEC104ClientPool::UpdateRegistration(PoolWorker &worker, PooledConnection &con) {
+#ifdef __linux__
+    int fd = CS104_Connection_getSocketFd(con.connection);
+    bool watchWrite = CS104_Connection_isConnecting(con.connection);
+    if (fd < 0)
+        return;
+
+    struct epoll_event ev;
+    ev.events = watchWrite ? EPOLLOUT : EPOLLIN;
+    ev.data.u64 = static_cast<uint64_t>(con.index);
+
+    if (fd != con.registeredFd) {
+        if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+            con.registeredFd = fd;
+            con.watchWrite = watchWrite;
+        }
+    } else if (watchWrite != con.watchWrite) {
+        epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, fd, &ev);
+        con.watchWrite = watchWrite;
+    }
+#endif
+}
+
+void IEC104ClientPool::EmitControl(const PooledConnection &con, const std::string &event, const std::string &reason) {
+    std::string clientID = con.clientID;
+    tsfn.NonBlockingCall([clientID, event, reason](Napi::Env env, Function jsCallback) {
+        Object eventObj = Object::New(env);
+        eventObj.Set("clientID", String::New(env, clientID.c_str()));
+        eventObj.Set("type", String::New(env, "control"));
+        eventObj.Set("event", String::New(env, event));
+        eventObj.Set("reason", String::New(env, reason));
+        std::vector<napi_value> args = {String::New(env, "conn"), eventObj};
+        jsCallback.Call(args);
+    });
+}
+
+Napi::Object IEC104ClientPool::PointObject(Napi::Env env, const PointRecord &p) {
+    Napi::Object msg = Napi::Object::New(env);
+    if (p.line >= 0 && static_cast<size_t>(p.line) < connectionNames.size()) {
+        msg.Set("clientID", String::New(env, connectionNames[p.line].c_str()));
+    }
+    msg.Set("typeId", Number::New(env, p.typeId));
+    msg.Set("asdu", Number::New(env, p.ca));
+    msg.Set("cot", Number::New(env, p.cot));
+    msg.Set("ioa", Number::New(env, p.ioa));
+    msg.Set("val", Number::New(env, p.val));
+    msg.Set("quality", Number::New(env, p.quality));
+    if (p.timestamp > 0) {
+        msg.Set("timestamp", Number::New(env, static_cast<double>(p.timestamp)));
+    }
+    return msg;
+}
+
+void IEC104ClientPool::EmitBatch(Napi::Env env, Function jsCallback, const vector<PointRecord> &points) {
+    Napi::Array jsArray = Napi::Array::New(env, points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        jsArray[i] = PointObject(env, points[i]);
+    }
+    std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+    jsCallback.Call(args);
+    cnt++;
+}
+
+void IEC104ClientPool::ConnectionHandler(void *parameter, CS104_Connection connection, CS104_ConnectionEvent event) {
+    PooledConnection *con = static_cast<PooledConnection *>(parameter);
+    std::string eventStr;
+    std::string reason;
+
+    // Вызывается рабочим потоком (CS104_Connection_run) или при удалении соединения, всегда под mutex потока
+    switch (event) {
+        case CS104_CONNECTION_OPENED:
+            eventStr = "opened";
+            reason = "connection established";
+            con->connected = true;
+            break;
+        case CS104_CONNECTION_FAILED:
+            eventStr = "failed";
+            reason = "connection attempt failed";
+            con->connected = false;
+            con->activated = false;
+            break;
+        case CS104_CONNECTION_CLOSED:
+            eventStr = "closed";
+            reason = con->removed ? "client closed connection" : "server closed connection or timeout";
+            con->connected = false;
+            con->activated = false;
+            break;
+        case CS104_CONNECTION_STARTDT_CON_RECEIVED:
+            eventStr = "activated";
+            reason = "STARTDT confirmed";
+            con->activated = true;
+            break;
+        case CS104_CONNECTION_STOPDT_CON_RECEIVED:
+            eventStr = "deactivated";
+            reason = "STOPDT confirmed";
+            con->activated = false;
+            break;
+    }
+
+    con->pool->EmitControl(*con, eventStr, reason);
+
+    if (event == CS104_CONNECTION_OPENED && con->autoStartDT) {
+        CS104_Connection_sendStartDT(connection);
+    }
+}
+
+bool IEC104ClientPool::RawMessageHandler(void *parameter, int address, CS101_ASDU asdu) {
+    PooledConnection *con = static_cast<PooledConnection *>(parameter);
+    IEC104ClientPool *pool = con->pool;
+    PoolWorker &worker = *pool->workers[con->worker];
+
+    IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
+    int ca = CS101_ASDU_getCA(asdu);
+    int cot = CS101_ASDU_getCOT(asdu);
+    int index = con->index;
+
+    con->asdusReceived++;
+
+    // Точки декодируются в буфер рабочего потока без выделения памяти
+    DecodedPoints &elements = worker.decodedPoints;
+    DecodeMonitoringASDU(asdu, worker.decodeBuffer, worker.dayCache, elements);
+    if (elements.empty())
+        return true;
+
+    if (pool->batcher.IsEnabled()) {
+        pool->batcher.Append(elements.size(), [&](size_t i) {
+            const auto& [ioa, val, quality, timestamp] = elements[i];
+            PointRecord record{typeID, ca, cot, ioa, val, quality, timestamp, 0};
+            record.line = index;
+            return record;
+        });
+        return true;
+    }
+
+    DecodedPoints *points = pool->pointsPool.Acquire(elements);
+    if (pool->tsfn.NonBlockingCall([=](Napi::Env env, Function jsCallback) {
+        Napi::Array jsArray = Napi::Array::New(env, points->size());
+        for (size_t i = 0; i < points->size(); i++) {
+            const auto& [ioa, val, quality, timestamp] = (*points)[i];
+            PointRecord record{typeID, ca, cot, ioa, val, quality, timestamp, 0};
+            record.line = index;
+            jsArray[i] = pool->PointObject(env, record);
+        }
+        pool->pointsPool.Release(points);
+        std::vector<napi_value> args = {String::New(env, "data"), jsArray};
+        jsCallback.Call(args);
+        pool->cnt++;
+    }) != napi_ok)
+        pool->pointsPool.Release(points);
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef CS104_CLIENT_POOL_H
+#define CS104_CLIENT_POOL_H
+
+#include <napi.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include "iec60870_decode.h"
+#include "event_batcher.h"
+
+extern "C" {
+#include "cs104_connection.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+}
+
+// Много соединений IEC 104 (клиент) на нескольких потоках. Соединения lib60870 работают
+// без собственных потоков (CS104_Connection_connectThreadless): каждый рабочий поток ждёт
+// сокеты всех своих соединений одним epoll и вызывает CS104_Connection_run по готовности
+// сокета или по ближайшему таймауту t1/t2/t3 из общей очереди таймеров потока.
+class IEC104ClientPool : public Napi::ObjectWrap<IEC104ClientPool> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    IEC104ClientPool(const Napi::CallbackInfo& info);
+    virtual ~IEC104ClientPool();
+    void Teardown();
+
+private:
+
+    // Соединение пула. Состояние меняется только под mutex своего рабочего потока.
+    struct PooledConnection {
+        IEC104ClientPool *pool = nullptr;
+        size_t worker = 0;          // Индекс рабочего потока, который ведёт соединение
+        int index = 0;              // Номер соединения (PointRecord.line)
+        std::string clientID;
+        std::string ip;
+        int port = 2404;
+        int originatorAddress = 1;
+        struct sCS104_APCIParameters apci = {12, 8, 30, 15, 10, 20};
+        int connectTimeout = 0;     // мс, 0 — t0
+        int reconnectDelay = 5;
+        bool autoStartDT = true;
+
+        CS104_Connection connection = nullptr;
+        bool active = false;        // Соединение устанавливается или установлено
+        bool connected = false;
+        bool activated = false;
+        bool removed = false;
+        int registeredFd = -1;      // Сокет, зарегистрированный в epoll
+        bool watchWrite = false;    // В epoll ждём запись (идёт TCP connect)
+        uint64_t nextConnectAttempt = 0;
+        uint64_t nextTimer = 0;     // Актуальная запись в очереди таймеров потока
+        uint64_t connectAttempts = 0;
+        uint64_t runs = 0;
+        uint64_t asdusReceived = 0;
+    };
+
+    struct TimerEntry {
+        uint64_t due;
+        std::shared_ptr<PooledConnection> connection;
+        bool operator>(const TimerEntry &other) const { return due > other.due; }
+    };
+
+    struct PoolWorker {
+        std::thread thread;
+        std::mutex mutex;           // Соединения потока и их состояние
+        std::map<int, std::shared_ptr<PooledConnection>> connections; // index -> соединение
+        std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers;
+        int epollFd = -1;
+        int wakeupFd = -1;          // eventfd
+        IODecodeBuffer decodeBuffer; // Буфер для CS101_ASDU_getElementEx (только этот поток)
+        CP56Time2aDayCache dayCache = {0, 0}; // Последние сутки для CP56Time2a_toMsTimestampCached (только этот поток)
+        DecodedPoints decodedPoints; // Точки текущего ASDU (только этот поток)
+        std::atomic<uint64_t> wakeups{0};
+        std::atomic<uint64_t> runs{0};
+    };
+
+    std::vector<std::unique_ptr<PoolWorker>> workers;
+    std::map<std::string, std::shared_ptr<PooledConnection>> connections; // Только из JS-потока
+    std::vector<std::string> connectionNames;                             // Номер соединения -> clientID (только из JS-потока)
+    std::atomic<bool> running{false};
+    std::string poolID;
+    int cnt = 0;
+    Napi::ThreadSafeFunction tsfn;
+    EventBatcher<PointRecord> batcher; // Пакетная передача точек в JS (batchSize/batchLatency)
+    DecodedPointsPool pointsPool;      // Векторы точек для передачи ASDU в JS без batcher
+
+    void WorkerLoop(PoolWorker &worker);
+    void Wakeup(PoolWorker &worker);
+    void Schedule(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t due);
+    void OpenConnection(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t now);
+    void RunConnection(PoolWorker &worker, const std::shared_ptr<PooledConnection> &con, uint64_t now);
+    void UpdateRegistration(PoolWorker &worker, PooledConnection &con);
+    void EmitControl(const PooledConnection &con, const std::string &event, const std::string &reason);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<PointRecord>& points);
+    Napi::Object PointObject(Napi::Env env, const PointRecord &p);
+    void Shutdown();
+
+    static bool RawMessageHandler(void *parameter, int address, CS101_ASDU asdu);
+    static void ConnectionHandler(void *parameter, CS104_Connection con, CS104_ConnectionEvent event);
+
+    Napi::Value Start(const Napi::CallbackInfo& info);
+    Napi::Value Stop(const Napi::CallbackInfo& info);
+    Napi::Value AddConnection(const Napi::CallbackInfo& info);
+    Napi::Value RemoveConnection(const Napi::CallbackInfo& info);
+    Napi::Value SendCommands(const Napi::CallbackInfo& info);
+    Napi::Value SendStartDT(const Napi::CallbackInfo& info);
+    Napi::Value SendStopDT(const Napi::CallbackInfo& info);
+    Napi::Value GetStatus(const Napi::CallbackInfo& info);
+};
+
+#endif // CS104_CLIENT_POOL_H
@@ -10,6 +10,8 @@
 #include <thread>
 #include <vector>
 #include <tuple>
+#include <chrono>
+#include <algorithm>
 #include <napi.h>
 #include <stdexcept>
 #include <stdio.h>
@@ -17,22 +19,22 @@
 #include <string.h>
 #include <inttypes.h> // Для PRIu64
 #include "cs104_server.h"
+#include "addon_data.h"
 
 using namespace Napi;
 using namespace std;
 
-Napi::FunctionReference IEC104Server::constructor;
-
 Napi::Object IEC104Server::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "IEC104Server", {
         InstanceMethod("start", &IEC104Server::Start),
         InstanceMethod("stop", &IEC104Server::Stop),
         InstanceMethod("sendCommands", &IEC104Server::SendCommands),
+        InstanceMethod("updatePoints", &IEC104Server::UpdatePoints),
+        InstanceMethod("publish", &IEC104Server::Publish),
         InstanceMethod("getStatus", &IEC104Server::GetStatus)
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    GetAddonData(env)->iec104Server = Napi::Persistent(func);
     exports.Set("IEC104Server", func);
     return exports;
 }
@@ -49,6 +51,9 @@ IEC104Server::IEC104Server(const Napi::CallbackInfo& info) : Napi::ObjectWrap<IE
     server = nullptr; // Explicitly initialize
     cnt = 0;
     restrictIPs = false;
+    autoInterrogation = false;
+    ioModel = "thread";
+    ioWorkers = 0;
     serverMode = CS104_MODE_CONNECTION_IS_REDUNDANCY_GROUP;
 
     try {
@@ -67,15 +72,28 @@ IEC104Server::IEC104Server(const Napi::CallbackInfo& info) : Napi::ObjectWrap<IE
         //printf("Failed to create ThreadSafeFunction: %s\n", e.what());
         fflush(stdout);
         Napi::Error::New(info.Env(), string("TSFN creation failed: ") + e.what()).ThrowAsJavaScriptException();
+        return;
     }
+    AddTeardownHook(info.Env(), this);
 }
 
 IEC104Server::~IEC104Server() {
+    RemoveTeardownHook(Env(), this);
+    Teardown();
+}
+
+// Вызывается из деструктора или при завершении окружения (cleanup hook), повторный вызов ничего не делает
+void IEC104Server::Teardown() {
     // Ensure server is stopped and thread is joined
     {
         std::lock_guard<std::mutex> lock(connMutex);
         if (running) {
             running = false;
+            {
+                std::lock_guard<std::mutex> giLock(giMutex);
+                interrogations.clear();
+            }
+            WakeInterrogations();
             if (started && server) {
                // printf("Destructor stopping server, serverID: %s\n", serverID.c_str());
                 fflush(stdout);
@@ -91,6 +109,8 @@ IEC104Server::~IEC104Server() {
         _thread.join();
     }
 
+    batcher.Stop();
+
     // Clean up redundancy groups
     for (auto& [name, group] : redundancyGroups) {
         if (group) {
@@ -101,7 +121,10 @@ IEC104Server::~IEC104Server() {
     redundancyGroups.clear();
 
     // Release thread-safe function
-    tsfn.Release();
+    if (!tsfnReleased) {
+        tsfnReleased = true;
+        tsfn.Release();
+    }
 }
 
 Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
@@ -153,6 +176,7 @@ Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
     int t2 = 10;
     int t3 = 20;
     int maxClients = 10;
+    int eventQueueSize = 0; // Размер очереди спонтанных ASDU (publish), по умолчанию maxClients
 
     if (config.Has("params") && config.Get("params").IsObject()) {
         Napi::Object params = config.Get("params").As<Napi::Object>();
@@ -164,18 +188,54 @@ Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
         if (params.Has("t2")) t2 = params.Get("t2").As<Napi::Number>().Int32Value();
         if (params.Has("t3")) t3 = params.Get("t3").As<Napi::Number>().Int32Value();
         if (params.Has("maxClients")) maxClients = params.Get("maxClients").As<Napi::Number>().Int32Value();
+        if (params.Has("eventQueueSize")) eventQueueSize = params.Get("eventQueueSize").As<Napi::Number>().Int32Value();
+        if (params.Has("autoInterrogation")) autoInterrogation = params.Get("autoInterrogation").ToBoolean();
 
         if (originatorAddress < 0 || originatorAddress > 255 ||
-            k <= 0 || w <= 0 || t0 <= 0 || t1 <= 0 || t2 <= 0 || t3 <= 0 || maxClients <= 0) {
+            k <= 0 || w <= 0 || t0 <= 0 || t1 <= 0 || t2 <= 0 || t3 <= 0 || maxClients <= 0 || eventQueueSize < 0) {
             Napi::Error::New(env, "Invalid parameters").ThrowAsJavaScriptException();
             return env.Undefined();
         }
     }
 
+    // Модель ввода-вывода: 'thread' (по умолчанию) или 'epoll' с фиксированным пулом рабочих потоков
+    std::string newIoModel = "thread";
+    int workers = 0;
+    if (config.Has("ioModel")) {
+        if (!config.Get("ioModel").IsString()) {
+            Napi::TypeError::New(env, "'ioModel' must be a string").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        newIoModel = config.Get("ioModel").As<Napi::String>().Utf8Value();
+        if (newIoModel != "thread" && newIoModel != "epoll") {
+            Napi::Error::New(env, "ioModel must be 'thread' or 'epoll'").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+    if (newIoModel == "epoll") {
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+        if (workers <= 0) workers = 1;
+        if (config.Has("workers")) {
+            if (!config.Get("workers").IsNumber() || config.Get("workers").As<Napi::Number>().Int32Value() <= 0) {
+                Napi::RangeError::New(env, "'workers' must be a positive number").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            workers = config.Get("workers").As<Napi::Number>().Int32Value();
+        }
+    }
+
+    // Пакетная передача принятых команд в JS (params.batchSize, params.batchLatency, params.maxQueuedEvents, params.queuePolicy)
+    Napi::Object batchParams = config.Has("params") && config.Get("params").IsObject() ? config.Get("params").As<Napi::Object>() : Napi::Object::New(env);
+    std::string batchError = batcher.Configure(batchParams);
+    if (!batchError.empty()) {
+        Napi::Error::New(env, batchError).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
     try {
        // printf("Creating server on port %d, serverID: %s, mode: %s\n", port, serverID.c_str(), mode.c_str());
         fflush(stdout);
-        server = CS104_Slave_create(maxClients, maxClients);
+        server = CS104_Slave_create(eventQueueSize > 0 ? eventQueueSize : maxClients, maxClients);
         if (!server) {
             throw runtime_error("Failed to create server object");
         }
@@ -184,6 +244,9 @@ Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
         CS104_Slave_setConnectionRequestHandler(server, ConnectionRequestHandler, this);
         CS104_Slave_setConnectionEventHandler(server, ConnectionEventHandler, this);
         CS104_Slave_setASDUHandler(server, RawMessageHandler, this);
+        if (autoInterrogation) {
+            CS104_Slave_setRawMessageHandler(server, FrameHandler, this);
+        }
 
         CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(server);
         alParams->originatorAddress = originatorAddress;
@@ -202,6 +265,12 @@ Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
 
         CS104_Slave_setServerMode(server, serverMode);
 
+        if (workers > 0 && !CS104_Slave_setEpollWorkers(server, workers)) {
+            throw runtime_error("ioModel 'epoll' is not supported on this platform or with TLS");
+        }
+        ioModel = newIoModel;
+        ioWorkers = workers;
+
         // Настройка групп резервирования для режима redundant
         if (serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS) { // Исправлено
             if (config.Has("clients") && config.Get("clients").IsArray()) {
@@ -239,17 +308,39 @@ Napi::Value IEC104Server::Start(const Napi::CallbackInfo& info) {
         fflush(stdout);
 
         running = true;
+        batcher.Start(tsfn, [this](Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands) {
+            EmitBatch(env, jsCallback, commands);
+        });
         _thread = std::thread([this] {
             CS104_Slave_start(server);
             {
                 std::lock_guard<std::mutex> lock(connMutex);
                 started = true;
+                // Если пул epoll не запустился, lib60870 обслуживает каждое соединение своим потоком
+                ioWorkers = CS104_Slave_getEpollWorkers(server);
+                ioModel = ioWorkers > 0 ? "epoll" : "thread";
             }
            // printf("Server started, serverID: %s\n", serverID.c_str());
             fflush(stdout);
 
-         while (running) {
-                Thread_sleep(100);
+            // Поток сервера досылает ответы на опрос, которые не поместились в очередь соединения.
+            // Просыпается, когда добавлен опрос или отправлен/принят кадр (место в окне k и очереди)
+            while (running) {
+                {
+                    std::lock_guard<std::mutex> giLock(giMutex);
+                    giPending = !interrogations.empty();
+                    for (auto it = interrogations.begin(); it != interrogations.end();) {
+                        if (DrainInterrogation(it->first, it->second)) {
+                            it = interrogations.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+                    giPending = !interrogations.empty();
+                }
+                std::unique_lock<std::mutex> wakeLock(giWakeMutex);
+                giCv.wait(wakeLock, [this] { return giWakeup; });
+                giWakeup = false;
             }
 
             // Thread cleanup: only stop server, do not destroy
@@ -337,6 +428,10 @@ void IEC104Server::ConnectionEventHandler(void* parameter, IMasterConnection con
             case CS104_CON_EVENT_CONNECTION_CLOSED: {
                 eventStr = "disconnected";
                 reason = "client disconnected";
+                {
+                    std::lock_guard<std::mutex> giLock(server->giMutex);
+                    server->interrogations.erase(connection);
+                }
                 if (server->clientConnections.find(connection) != server->clientConnections.end()) {
                     clientIdStr = server->clientConnections[connection];
                     server->clientConnections.erase(connection);
@@ -358,6 +453,10 @@ void IEC104Server::ConnectionEventHandler(void* parameter, IMasterConnection con
             case CS104_CON_EVENT_DEACTIVATED: {
                 eventStr = "deactivated";
                 reason = "STOPDT confirmed";
+                {
+                    std::lock_guard<std::mutex> giLock(server->giMutex);
+                    server->interrogations.erase(connection);
+                }
                 if (server->clientConnections.find(connection) != server->clientConnections.end()) {
                     clientIdStr = server->clientConnections[connection];
                     // Send STOPDT ASDU in redundant mode
@@ -394,6 +493,11 @@ Napi::Value IEC104Server::Stop(const Napi::CallbackInfo& info) {
         std::lock_guard<std::mutex> lock(connMutex);
         if (running) {
             running = false;
+            {
+                std::lock_guard<std::mutex> giLock(giMutex);
+                interrogations.clear();
+            }
+            WakeInterrogations();
             if (started && server) {
                // printf("Stop called, stopping server, serverID: %s\n", serverID.c_str());
                 fflush(stdout);
@@ -409,6 +513,8 @@ Napi::Value IEC104Server::Stop(const Napi::CallbackInfo& info) {
         _thread.join();
     }
 
+    batcher.Stop();
+
     // Clear redundancy groups
     for (auto& [name, group] : redundancyGroups) {
         if (group) {
@@ -463,8 +569,8 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
     try {
         bool allSuccess = true;
 
-        // Группировка команд по typeId и asduAddress
-        std::map<std::pair<int, int>, std::vector<Napi::Object>> groupedCommands;
+        // Группировка команд по typeId, asduAddress и cot
+        std::map<std::tuple<int, int, int>, std::vector<Napi::Object>> groupedCommands;
         for (uint32_t i = 0; i < commands.Length(); i++) {
             Napi::Value item = commands[i];
             if (!item.IsObject()) {
@@ -480,48 +586,61 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
 
             int typeId = cmdObj.Get("typeId").As<Napi::Number>().Int32Value();
             int asduAddress = cmdObj.Get("asduAddress").As<Napi::Number>().Int32Value();
-            groupedCommands[{typeId, asduAddress}].push_back(cmdObj);
+            int cot = CS101_COT_SPONTANEOUS;
+            if (cmdObj.Has("cot") && cmdObj.Get("cot").IsNumber()) {
+                cot = cmdObj.Get("cot").As<Napi::Number>().Int32Value();
+                if (cot < 0 || cot > 63) {
+                    Napi::RangeError::New(env, "cot must be between 0 and 63").ThrowAsJavaScriptException();
+                    return env.Undefined();
+                }
+            }
+            groupedCommands[{typeId, asduAddress, cot}].push_back(cmdObj);
         }
 
         // Обработка каждой группы
         for (const auto& [key, cmdList] : groupedCommands) {
-            int typeId = key.first;
-            int asduAddress = key.second;
+            const auto& [typeId, asduAddress, cot] = key;
 
-            // Получение параметров для ASDU (cot, quality и т.д. берем из первой команды в группе)
-            Napi::Object firstCmd = cmdList[0];
+            // Создание ASDU для группы
+            CS101_ASDU asdu = CS101_ASDU_create(alParams, false, (CS101_CauseOfTransmission)cot, 0, asduAddress, false, false);
+            bool success = true;
+            std::vector<PackPoint> points; // Точки мониторинга пакуются отдельно, см. ниже
+            points.reserve(cmdList.size());
+
+            // Добавляет объект команды; если ASDU заполнен, отправляет его и начинает новый
+            auto addObject = [&](InformationObject io) {
+                if (CS101_ASDU_addInformationObject(asdu, io)) {
+                    return;
+                }
+                if (CS101_ASDU_getNumberOfElements(asdu) == 0 || !IMasterConnection_sendASDU(targetConnection, asdu)) {
+                    allSuccess = false;
+                }
+                CS101_ASDU_removeAllElements(asdu);
+                if (!CS101_ASDU_addInformationObject(asdu, io)) {
+                    allSuccess = false;
+                }
+            };
+
+        // Обработка всех команд в группе
+        for (const auto& cmdObj : cmdList) {
+            // bselCmd, ql и quality берутся из каждой команды
             bool bselCmd = false;
             int ql = 0;
-            int cot = CS101_COT_SPONTANEOUS;
             uint8_t quality = IEC60870_QUALITY_GOOD;
-
-            if (firstCmd.Has("bselCmd") && firstCmd.Get("bselCmd").IsBoolean()) {
-                bselCmd = firstCmd.Get("bselCmd").As<Napi::Boolean>();
+            if (cmdObj.Has("bselCmd") && cmdObj.Get("bselCmd").IsBoolean()) {
+                bselCmd = cmdObj.Get("bselCmd").As<Napi::Boolean>();
             }
-            if (firstCmd.Has("ql") && firstCmd.Get("ql").IsNumber()) {
-                ql = firstCmd.Get("ql").As<Napi::Number>().Int32Value();
+            if (cmdObj.Has("ql") && cmdObj.Get("ql").IsNumber()) {
+                ql = cmdObj.Get("ql").As<Napi::Number>().Int32Value();
                 if (ql < 0 || ql > 31) {
                     Napi::RangeError::New(env, "ql must be between 0 and 31").ThrowAsJavaScriptException();
+                    CS101_ASDU_destroy(asdu);
                     return env.Undefined();
                 }
             }
-            if (firstCmd.Has("cot") && firstCmd.Get("cot").IsNumber()) {
-                cot = firstCmd.Get("cot").As<Napi::Number>().Int32Value();
-                if (cot < 0 || cot > 63) {
-                    Napi::RangeError::New(env, "cot must be between 0 and 63").ThrowAsJavaScriptException();
-                    return env.Undefined();
-                }
-            }
-            if (firstCmd.Has("quality") && firstCmd.Get("quality").IsNumber()) {
-                quality = firstCmd.Get("quality").As<Napi::Number>().Uint32Value();
+            if (cmdObj.Has("quality") && cmdObj.Get("quality").IsNumber()) {
+                quality = cmdObj.Get("quality").As<Napi::Number>().Uint32Value();
             }
-
-            // Создание ASDU для группы
-            CS101_ASDU asdu = CS101_ASDU_create(alParams, false, (CS101_CauseOfTransmission)cot, 0, asduAddress, false, false);
-            bool success = true;
-
-        // Обработка всех команд в группе
-        for (const auto& cmdObj : cmdList) {
             int ioa = cmdObj.Get("ioa").As<Napi::Number>().Int32Value();
             switch (typeId) {
                 case M_SP_NA_1: {
@@ -531,10 +650,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
-                    SinglePointInformation sp = SinglePointInformation_create(NULL, ioa, value, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)sp);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    SinglePointInformation_destroy(sp);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_DP_NA_1: {
@@ -549,10 +665,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    DoublePointInformation dp = DoublePointInformation_create(NULL, ioa, (DoublePointValue)value, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)dp);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    DoublePointInformation_destroy(dp);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_ST_NA_1: {
@@ -567,10 +680,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    StepPositionInformation st = StepPositionInformation_create(NULL, ioa, value, false, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)st);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    StepPositionInformation_destroy(st);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_BO_NA_1: {
@@ -580,10 +690,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
-                    BitString32 bo = BitString32_create(NULL, ioa, value);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    BitString32_destroy(bo);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_ME_NA_1: {
@@ -598,10 +705,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    MeasuredValueNormalized mn = MeasuredValueNormalized_create(NULL, ioa, value, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)mn);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueNormalized_destroy(mn);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_ME_NB_1: {
@@ -617,10 +721,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    MeasuredValueScaled ms = MeasuredValueScaled_create(NULL, ioa, value, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)ms);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueScaled_destroy(ms);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_ME_NC_1: {
@@ -631,10 +732,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     double doubleValue = cmdObj.Get("value").As<Napi::Number>().DoubleValue();                  
                     float value = static_cast<float>(doubleValue);
-                    MeasuredValueShort mc = MeasuredValueShort_create(NULL, ioa, value, quality);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)mc);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueShort_destroy(mc);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_IT_NA_1: {
@@ -644,12 +742,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
-                    BinaryCounterReading bcr = BinaryCounterReading_create(NULL, value, 0, false, false, false);
-                    IntegratedTotals it = IntegratedTotals_create(NULL, ioa, bcr);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)it);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    IntegratedTotals_destroy(it);
-                    BinaryCounterReading_destroy(bcr);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, 0});
                     break;
                 }
                 case M_SP_TB_1: {
@@ -660,10 +753,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                    SinglePointWithCP56Time2a sp = SinglePointWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)sp);
-                    success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    SinglePointWithCP56Time2a_destroy(sp);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_DP_TB_1: {
@@ -679,10 +769,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    DoublePointWithCP56Time2a dp = DoublePointWithCP56Time2a_create(NULL, ioa, (DoublePointValue)value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)dp);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    DoublePointWithCP56Time2a_destroy(dp);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_ST_TB_1: {
@@ -698,10 +785,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    StepPositionWithCP56Time2a st = StepPositionWithCP56Time2a_create(NULL, ioa, value, false, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)st);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    StepPositionWithCP56Time2a_destroy(st);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_BO_TB_1: {
@@ -712,10 +796,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                    Bitstring32WithCP56Time2a bo = Bitstring32WithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
-                    success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    Bitstring32WithCP56Time2a_destroy(bo);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_ME_TD_1: {
@@ -732,10 +813,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    MeasuredValueNormalizedWithCP56Time2a mn = MeasuredValueNormalizedWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)mn);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueNormalizedWithCP56Time2a_destroy(mn);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_ME_TE_1: {
@@ -751,10 +829,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         CS101_ASDU_destroy(asdu);
                         return env.Undefined();
                     }
-                    MeasuredValueScaledWithCP56Time2a ms = MeasuredValueScaledWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)ms);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueScaledWithCP56Time2a_destroy(ms);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_ME_TF_1: {
@@ -766,10 +841,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     double doubleValue = cmdObj.Get("value").As<Napi::Number>().DoubleValue();                  
                     float value = static_cast<float>(doubleValue);
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                    MeasuredValueShortWithCP56Time2a mc = MeasuredValueShortWithCP56Time2a_create(NULL, ioa, value, quality, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)mc);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    MeasuredValueShortWithCP56Time2a_destroy(mc);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case M_IT_TB_1: {
@@ -780,12 +852,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     int value = cmdObj.Get("value").As<Napi::Number>().Int32Value();
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
-                    BinaryCounterReading bcr = BinaryCounterReading_create(NULL, value, 0, false, false, false);
-                    IntegratedTotalsWithCP56Time2a it = IntegratedTotalsWithCP56Time2a_create(NULL, ioa, bcr, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)it);
-                    //success = IMasterConnection_sendASDU(targetConnection, asdu);
-                    IntegratedTotalsWithCP56Time2a_destroy(it);
-                    BinaryCounterReading_destroy(bcr);
+                    points.push_back(PackPoint{ioa, static_cast<double>(value), quality, timestamp});
                     break;
                 }
                 case C_SC_NA_1: {
@@ -796,7 +863,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
                     SingleCommand sc = SingleCommand_create(NULL, ioa, value, bselCmd, ql);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
+                    addObject((InformationObject)sc);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SingleCommand_destroy(sc);
                     break;
@@ -814,7 +881,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     DoubleCommand dc = DoubleCommand_create(NULL, ioa, value, bselCmd, ql);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
+                    addObject((InformationObject)dc);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     DoubleCommand_destroy(dc);
                     break;
@@ -833,7 +900,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     StepCommandWithCP56Time2a rc = StepCommandWithCP56Time2a_create(NULL, ioa, (StepCommandValue)value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)rc);
+                    addObject((InformationObject)rc);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     StepCommandWithCP56Time2a_destroy(rc);
                     break;
@@ -860,7 +927,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     SetpointCommandNormalizedWithCP56Time2a se = SetpointCommandNormalizedWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
+                    addObject((InformationObject)se);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SetpointCommandNormalizedWithCP56Time2a_destroy(se);
                     break;
@@ -878,7 +945,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     SetpointCommandScaled se = SetpointCommandScaled_create(NULL, ioa, value, bselCmd, ql);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
+                    addObject((InformationObject)se);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SetpointCommandScaled_destroy(se);
                     break;
@@ -899,7 +966,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     SetpointCommandShort se = SetpointCommandShort_create(NULL, ioa, value, bselCmd, ql);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
+                    addObject((InformationObject)se);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SetpointCommandShort_destroy(se);
                     break;
@@ -912,7 +979,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
                     Bitstring32Command bo = Bitstring32Command_create(NULL, ioa, value);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
+                    addObject((InformationObject)bo);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     Bitstring32Command_destroy(bo);
                     break;
@@ -926,7 +993,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     bool value = cmdObj.Get("value").As<Napi::Boolean>();
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SingleCommandWithCP56Time2a sc = SingleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)sc);
+                    addObject((InformationObject)sc);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SingleCommandWithCP56Time2a_destroy(sc);
                     break;
@@ -945,7 +1012,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     DoubleCommandWithCP56Time2a dc = DoubleCommandWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)dc);
+                    addObject((InformationObject)dc);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     DoubleCommandWithCP56Time2a_destroy(dc);
                     break;
@@ -964,7 +1031,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     SetpointCommandScaledWithCP56Time2a se = SetpointCommandScaledWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
+                    addObject((InformationObject)se);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SetpointCommandScaledWithCP56Time2a_destroy(se);
                     break;
@@ -986,7 +1053,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     SetpointCommandShortWithCP56Time2a se = SetpointCommandShortWithCP56Time2a_create(NULL, ioa, value, bselCmd, ql, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)se);
+                    addObject((InformationObject)se);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     SetpointCommandShortWithCP56Time2a_destroy(se);
                     break;
@@ -1000,7 +1067,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     uint32_t value = cmdObj.Get("value").As<Napi::Number>().Uint32Value();
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     Bitstring32CommandWithCP56Time2a bo = Bitstring32CommandWithCP56Time2a_create(NULL, ioa, value, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)bo);
+                    addObject((InformationObject)bo);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     Bitstring32CommandWithCP56Time2a_destroy(bo);
                     break;
@@ -1018,7 +1085,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     InterrogationCommand ic = InterrogationCommand_create(NULL, ioa, value);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)ic);
+                    addObject((InformationObject)ic);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     InterrogationCommand_destroy(ic);
                     break;
@@ -1036,15 +1103,14 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                         return env.Undefined();
                     }
                     CounterInterrogationCommand ci = CounterInterrogationCommand_create(NULL, ioa, value);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)ci);
+                    addObject((InformationObject)ci);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     CounterInterrogationCommand_destroy(ci);
                     break;
                 }
                 case C_RD_NA_1: {
                     ReadCommand rd = ReadCommand_create(NULL, ioa);
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)rd);
-                    success = IMasterConnection_sendASDU(targetConnection, asdu);
+                    addObject((InformationObject)rd);
                     ReadCommand_destroy(rd);
                     break;
                 }
@@ -1056,7 +1122,7 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                     }
                     uint64_t timestamp = cmdObj.Get("timestamp").As<Napi::Number>().Int64Value();
                     ClockSynchronizationCommand cs = ClockSynchronizationCommand_create(NULL, ioa, CP56Time2a_createFromMsTimestamp(NULL, timestamp));
-                    CS101_ASDU_addInformationObject(asdu, (InformationObject)cs);
+                    addObject((InformationObject)cs);
                     //success = IMasterConnection_sendASDU(targetConnection, asdu);
                     ClockSynchronizationCommand_destroy(cs);
                     break;
@@ -1069,8 +1135,23 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
                 }
             }
 
+            // Точки мониторинга: сортировка по ioa и упаковка в ASDU максимального размера (SQ=1 для подряд идущих IOA)
+            if (success && !points.empty()) {
+                std::stable_sort(points.begin(), points.end(), [](const PackPoint& a, const PackPoint& b) { return a.ioa < b.ioa; });
+                sCS101_StaticASDU storage;
+                for (size_t pos = 0; pos < points.size();) {
+                    CS101_ASDU packedAsdu;
+                    size_t packed = PackASDU(&storage, &packedAsdu, alParams, (CS101_CauseOfTransmission)cot, asduAddress, typeId, &points[pos], points.size() - pos);
+                    if (packed == 0 || !IMasterConnection_sendASDU(targetConnection, packedAsdu)) {
+                        allSuccess = false;
+                        break;
+                    }
+                    pos += packed;
+                }
+            }
+
             // Отправка ASDU после добавления всех объектов
-            if (success) {
+            if (success && CS101_ASDU_getNumberOfElements(asdu) > 0) {
                 success = IMasterConnection_sendASDU(targetConnection, asdu);
                 if (!success) {
                     allSuccess = false;
@@ -1096,7 +1177,330 @@ Napi::Value IEC104Server::SendCommands(const Napi::CallbackInfo& info) {
     }
 }
 
-            
+// Разбирает точки для updatePoints/publish: массив { typeId, asduAddress, ioa, value, [quality, timestamp, group, cot] }
+// или колоночный объект { typeId, asduAddress, ioa: Int32Array, value: Float64Array, [quality: Uint8Array, timestamp: Float64Array, group, cot] }.
+// typeId остаётся исходным. Типам с меткой времени без timestamp (или с 0) ставится текущее время.
+// При ошибке бросает исключение JS и возвращает false.
+static bool ParsePoints(Napi::Env env, Napi::Value arg, std::vector<ImagePoint>& updates, std::vector<int>& cots) {
+    if (!arg.IsObject()) {
+        Napi::TypeError::New(env, "Expected points (array of objects or object with typed arrays)").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    if (arg.IsArray()) {
+        Napi::Array points = arg.As<Napi::Array>();
+        updates.reserve(points.Length());
+        cots.reserve(points.Length());
+        for (uint32_t i = 0; i < points.Length(); i++) {
+            Napi::Value item = points[i];
+            if (!item.IsObject()) {
+                Napi::TypeError::New(env, "Each point must be an object").ThrowAsJavaScriptException();
+                return false;
+            }
+            Napi::Object point = item.As<Napi::Object>();
+            if (!point.Has("typeId") || !point.Get("typeId").IsNumber() ||
+                !point.Has("asduAddress") || !point.Get("asduAddress").IsNumber() ||
+                !point.Has("ioa") || !point.Get("ioa").IsNumber() || !point.Has("value")) {
+                Napi::TypeError::New(env, "Each point must have 'typeId' (number), 'asduAddress' (number), 'ioa' (number) and 'value'").ThrowAsJavaScriptException();
+                return false;
+            }
+            ImagePoint p;
+            p.typeId = point.Get("typeId").As<Napi::Number>().Int32Value();
+            p.ca = point.Get("asduAddress").As<Napi::Number>().Int32Value();
+            p.ioa = point.Get("ioa").As<Napi::Number>().Int32Value();
+            Napi::Value value = point.Get("value");
+            p.value = value.IsBoolean() ? (value.As<Napi::Boolean>().Value() ? 1.0 : 0.0) : value.ToNumber().DoubleValue();
+            p.quality = point.Has("quality") && point.Get("quality").IsNumber() ? point.Get("quality").As<Napi::Number>().Uint32Value() : IEC60870_QUALITY_GOOD;
+            p.timestamp = point.Has("timestamp") && point.Get("timestamp").IsNumber() ? point.Get("timestamp").As<Napi::Number>().Int64Value() : 0;
+            p.group = point.Has("group") && point.Get("group").IsNumber() ? point.Get("group").As<Napi::Number>().Int32Value() : 0;
+            updates.push_back(p);
+            cots.push_back(point.Has("cot") && point.Get("cot").IsNumber() ? point.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_SPONTANEOUS);
+        }
+    } else {
+        Napi::Object columns = arg.As<Napi::Object>();
+        if (!columns.Has("typeId") || !columns.Get("typeId").IsNumber() ||
+            !columns.Has("asduAddress") || !columns.Get("asduAddress").IsNumber() ||
+            !columns.Get("ioa").IsTypedArray() || !columns.Get("value").IsTypedArray()) {
+            Napi::TypeError::New(env, "Columnar points must have 'typeId' (number), 'asduAddress' (number), 'ioa' (Int32Array) and 'value' (Float64Array)").ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::TypedArray ioaArray = columns.Get("ioa").As<Napi::TypedArray>();
+        Napi::TypedArray valueArray = columns.Get("value").As<Napi::TypedArray>();
+        if (ioaArray.TypedArrayType() != napi_int32_array || valueArray.TypedArrayType() != napi_float64_array ||
+            ioaArray.ElementLength() != valueArray.ElementLength()) {
+            Napi::TypeError::New(env, "'ioa' must be an Int32Array and 'value' a Float64Array of the same length").ThrowAsJavaScriptException();
+            return false;
+        }
+        size_t count = ioaArray.ElementLength();
+        const uint8_t* quality = nullptr;
+        const double* timestamp = nullptr;
+        if (columns.Get("quality").IsTypedArray()) {
+            Napi::TypedArray q = columns.Get("quality").As<Napi::TypedArray>();
+            if (q.TypedArrayType() != napi_uint8_array || q.ElementLength() != count) {
+                Napi::TypeError::New(env, "'quality' must be a Uint8Array of the same length as 'ioa'").ThrowAsJavaScriptException();
+                return false;
+            }
+            quality = q.As<Napi::Uint8Array>().Data();
+        }
+        if (columns.Get("timestamp").IsTypedArray()) {
+            Napi::TypedArray t = columns.Get("timestamp").As<Napi::TypedArray>();
+            if (t.TypedArrayType() != napi_float64_array || t.ElementLength() != count) {
+                Napi::TypeError::New(env, "'timestamp' must be a Float64Array of the same length as 'ioa'").ThrowAsJavaScriptException();
+                return false;
+            }
+            timestamp = t.As<Napi::Float64Array>().Data();
+        }
+        int typeId = columns.Get("typeId").As<Napi::Number>().Int32Value();
+        int ca = columns.Get("asduAddress").As<Napi::Number>().Int32Value();
+        int group = columns.Has("group") && columns.Get("group").IsNumber() ? columns.Get("group").As<Napi::Number>().Int32Value() : 0;
+        int cot = columns.Has("cot") && columns.Get("cot").IsNumber() ? columns.Get("cot").As<Napi::Number>().Int32Value() : CS101_COT_SPONTANEOUS;
+        const int32_t* ioa = ioaArray.As<Napi::Int32Array>().Data();
+        const double* value = valueArray.As<Napi::Float64Array>().Data();
+
+        updates.resize(count);
+        cots.assign(count, cot);
+        for (size_t i = 0; i < count; i++) {
+            updates[i] = ImagePoint{ca, typeId, ioa[i], group, value[i],
+                                    quality ? quality[i] : (uint8_t)IEC60870_QUALITY_GOOD,
+                                    timestamp ? static_cast<uint64_t>(timestamp[i]) : 0};
+        }
+    }
+
+    uint64_t now = 0;
+    for (size_t i = 0; i < updates.size(); i++) {
+        ImagePoint& p = updates[i];
+        if (p.ca < 0 || p.ca > 65535) {
+            Napi::TypeError::New(env, "asduAddress must be between 0 and 65535").ThrowAsJavaScriptException();
+            return false;
+        }
+        if (p.ioa < 0 || p.ioa > 16777215) {
+            Napi::TypeError::New(env, "ioa must be between 0 and 16777215").ThrowAsJavaScriptException();
+            return false;
+        }
+        if (!IsPackableMonitorType(p.typeId)) {
+            Napi::TypeError::New(env, "Unsupported typeId " + std::to_string(p.typeId) + " for process image").ThrowAsJavaScriptException();
+            return false;
+        }
+        if (p.group < 0 || p.group > 16) {
+            Napi::RangeError::New(env, "group must be between 0 and 16").ThrowAsJavaScriptException();
+            return false;
+        }
+        if (cots[i] < 0 || cots[i] > 63) {
+            Napi::RangeError::New(env, "cot must be between 0 and 63").ThrowAsJavaScriptException();
+            return false;
+        }
+        // Без метки времени тип с CP56Time2a ушёл бы с датой 1970 года: ставим текущее время
+        if (p.timestamp == 0 && HasCP56Time2a(p.typeId)) {
+            if (now == 0) {
+                now = Hal_getTimeInMs();
+            }
+            p.timestamp = now;
+        }
+    }
+    return true;
+}
+
+// Загружает значения в образ процесса
+Napi::Value IEC104Server::UpdatePoints(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ImagePoint> updates;
+    std::vector<int> cots;
+
+    if (!ParsePoints(env, info[0], updates, cots)) {
+        return env.Undefined();
+    }
+
+    for (ImagePoint& p : updates) {
+        p.typeId = InterrogationTypeId(p.typeId);
+    }
+    processImage.Update(updates);
+    return env.Undefined();
+}
+
+// Рассылает изменения всем подключённым клиентам: каждая группа (ca, typeId, cot) кодируется
+// один раз в плотно упакованные ASDU и ставится в общую очередь событий через CS104_Slave_enqueueASDU.
+// Возвращает число поставленных в очередь ASDU. Образ процесса обновляется теми же значениями.
+Napi::Value IEC104Server::Publish(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ImagePoint> updates;
+    std::vector<int> cots;
+
+    if (!ParsePoints(env, info[0], updates, cots)) {
+        return env.Undefined();
+    }
+
+    std::lock_guard<std::mutex> lock(connMutex);
+    if (!started || !server) {
+        Napi::Error::New(env, "Server not started").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    // Порядок (ca, typeId, cot, ioa); stable_sort сохраняет очерёдность повторных изменений одной точки
+    std::vector<size_t> order(updates.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const ImagePoint& pa = updates[a];
+        const ImagePoint& pb = updates[b];
+        return std::tie(pa.ca, pa.typeId, cots[a], pa.ioa) < std::tie(pb.ca, pb.typeId, cots[b], pb.ioa);
+    });
+
+    CS101_AppLayerParameters alParams = CS104_Slave_getAppLayerParameters(server);
+    sCS101_StaticASDU storage;
+    std::vector<PackPoint> group;
+    group.reserve(updates.size());
+    int asduCount = 0;
+
+    for (size_t i = 0; i < order.size();) {
+        const ImagePoint& first = updates[order[i]];
+        int cot = cots[order[i]];
+        group.clear();
+        for (; i < order.size(); i++) {
+            const ImagePoint& p = updates[order[i]];
+            if (p.ca != first.ca || p.typeId != first.typeId || cots[order[i]] != cot) {
+                break;
+            }
+            group.push_back(PackPoint{p.ioa, p.value, p.quality, p.timestamp});
+        }
+
+        for (size_t pos = 0; pos < group.size();) {
+            CS101_ASDU asdu;
+            size_t packed = PackASDU(&storage, &asdu, alParams, (CS101_CauseOfTransmission)cot, first.ca, first.typeId, &group[pos], group.size() - pos);
+            if (packed == 0) {
+                break;
+            }
+            CS104_Slave_enqueueASDU(server, asdu);
+            asduCount++;
+            pos += packed;
+        }
+    }
+
+    for (ImagePoint& p : updates) {
+        p.typeId = InterrogationTypeId(p.typeId);
+    }
+    processImage.Update(updates);
+
+    return Napi::Number::New(env, asduCount);
+}
+
+
+// Отвечает на общий опрос и опрос счётчиков из образа процесса в потоке протокола
+bool IEC104Server::HandleInterrogation(IMasterConnection connection, CS101_ASDU asdu) {
+    CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
+    IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
+    int ca = CS101_ASDU_getCA(asdu);
+    bool counters = (typeID == C_CI_NA_1);
+
+    IODecodeBuffer decodeBuffer;
+    InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&decodeBuffer, 0);
+    if (!io) {
+        return false;
+    }
+
+    InterrogationJob job;
+    job.ca = ca;
+    job.typeId = typeID;
+    int group;
+    if (counters) {
+        job.qualifier = CounterInterrogationCommand_getQCC((CounterInterrogationCommand)io);
+        int rqt = job.qualifier & 0x3f;
+        if (rqt < 1 || rqt > 5) {
+            IMasterConnection_sendACT_CON(connection, asdu, true);
+            return true;
+        }
+        group = (rqt == 5) ? 0 : rqt;
+        job.cot = (rqt == 5) ? CS101_COT_REQUESTED_BY_GENERAL_COUNTER : (CS101_CauseOfTransmission)(CS101_COT_REQUESTED_BY_GENERAL_COUNTER + rqt);
+    } else {
+        job.qualifier = InterrogationCommand_getQOI((InterrogationCommand)io);
+        if (job.qualifier < CS101_COT_INTERROGATED_BY_STATION || job.qualifier > CS101_COT_INTERROGATED_BY_STATION + 16) {
+            IMasterConnection_sendACT_CON(connection, asdu, true);
+            return true;
+        }
+        // QOI 20..36 совпадает с COT ответа (опрос станции, группы 1..16)
+        group = job.qualifier - CS101_COT_INTERROGATED_BY_STATION;
+        job.cot = (CS101_CauseOfTransmission)job.qualifier;
+    }
+
+    int broadcastCA = (alParams->sizeOfCA == 1) ? 0xff : 0xffff;
+    if (ca != broadcastCA && !processImage.HasCA(ca)) {
+        CS101_ASDU_setCOT(asdu, CS101_COT_UNKNOWN_CA);
+        CS101_ASDU_setNegative(asdu, true);
+        IMasterConnection_sendASDU(connection, asdu);
+        return true;
+    }
+
+    IMasterConnection_sendACT_CON(connection, asdu, false);
+    processImage.Select(ca == broadcastCA ? -1 : ca, counters, group, job.segments, job.points);
+    interrogationsServed++;
+
+    std::lock_guard<std::mutex> giLock(giMutex);
+    if (!running) {
+        return true;
+    }
+    // Новый опрос от того же клиента заменяет незавершённый
+    InterrogationJob& active = interrogations[connection] = std::move(job);
+    if (DrainInterrogation(connection, active)) {
+        interrogations.erase(connection);
+    } else {
+        WakeInterrogations();
+    }
+    return true;
+}
+
+// Будит поток, досылающий ответы на опрос. giMutex не берётся: обработчики кадров lib60870
+// вызываются под блокировками очереди соединения, а поток досылки держит giMutex в IMasterConnection_sendASDU.
+void IEC104Server::WakeInterrogations() {
+    {
+        std::lock_guard<std::mutex> lock(giWakeMutex);
+        giWakeup = true;
+    }
+    giCv.notify_one();
+}
+
+// Каждый отправленный I-кадр освобождает место в очереди соединения, каждый принятый может сдвинуть окно k
+void IEC104Server::FrameHandler(void* parameter, IMasterConnection connection, uint8_t* msg, int msgSize, bool sent) {
+    IEC104Server* server = static_cast<IEC104Server*>(parameter);
+    if (server->giPending.load(std::memory_order_relaxed)) {
+        server->WakeInterrogations();
+    }
+}
+
+// Отправляет упакованные ASDU, пока соединение их принимает. Возвращает true, когда отправлен ACT_TERM.
+// Вызывается под giMutex.
+bool IEC104Server::DrainInterrogation(IMasterConnection connection, InterrogationJob& job) {
+    CS101_AppLayerParameters alParams = IMasterConnection_getApplicationLayerParameters(connection);
+    sCS101_StaticASDU storage;
+
+    while (job.segment < job.segments.size()) {
+        const ImageSegment& seg = job.segments[job.segment];
+        if (job.pos < seg.begin) {
+            job.pos = seg.begin;
+        }
+        if (job.pos >= seg.end) {
+            job.segment++;
+            continue;
+        }
+        CS101_ASDU out;
+        size_t packed = PackASDU(&storage, &out, alParams, job.cot, seg.ca, seg.typeId, &job.points[job.pos], seg.end - job.pos);
+        if (packed == 0) {
+            job.pos = seg.end;
+            continue;
+        }
+        if (!IMasterConnection_sendASDU(connection, out)) {
+            return false; // Очередь соединения заполнена, продолжим позже
+        }
+        job.pos += packed;
+    }
+
+    IODecodeBuffer ioBuffer;
+    CS101_ASDU term = CS101_ASDU_initializeStatic(&storage, alParams, false, CS101_COT_ACTIVATION_TERMINATION, 0, job.ca, false, false);
+    InformationObject io = (job.typeId == C_CI_NA_1)
+        ? (InformationObject)CounterInterrogationCommand_create((CounterInterrogationCommand)&ioBuffer, 0, (QualifierOfCIC)job.qualifier)
+        : (InformationObject)InterrogationCommand_create((InterrogationCommand)&ioBuffer, 0, (uint8_t)job.qualifier);
+    CS101_ASDU_addInformationObject(term, io);
+    return IMasterConnection_sendASDU(connection, term);
+}
 
 Napi::Value IEC104Server::GetStatus(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -1106,6 +1510,8 @@ Napi::Value IEC104Server::GetStatus(const Napi::CallbackInfo& info) {
     status.Set("serverID", Napi::String::New(env, serverID));
     status.Set("mode", Napi::String::New(env, serverMode == CS104_MODE_MULTIPLE_REDUNDANCY_GROUPS ? "redundant" : "multi"));
     status.Set("restrictIPs", Napi::Boolean::New(env, restrictIPs));
+    status.Set("ioModel", Napi::String::New(env, ioModel));
+    status.Set("workers", Napi::Number::New(env, ioWorkers));
 
     Napi::Array clients = Napi::Array::New(env, clientConnections.size());
     int index = 0;
@@ -1113,10 +1519,44 @@ Napi::Value IEC104Server::GetStatus(const Napi::CallbackInfo& info) {
         clients[index++] = Napi::String::New(env, id);
     }
     status.Set("connectedClients", clients);
+    status.Set("batching", batcher.GetStats(env));
+
+    Napi::Object image = Napi::Object::New(env);
+    image.Set("points", Napi::Number::New(env, static_cast<double>(processImage.Size())));
+    image.Set("autoInterrogation", Napi::Boolean::New(env, autoInterrogation));
+    image.Set("interrogationsServed", Napi::Number::New(env, static_cast<double>(interrogationsServed.load())));
+    {
+        std::lock_guard<std::mutex> giLock(giMutex);
+        image.Set("pendingInterrogations", Napi::Number::New(env, static_cast<double>(interrogations.size())));
+    }
+    status.Set("processImage", image);
 
     return status;
 }
 
+void IEC104Server::EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands) {
+    Napi::Array jsArray = Napi::Array::New(env, commands.size());
+    for (size_t i = 0; i < commands.size(); i++) {
+        const CommandRecord& c = commands[i];
+        Napi::Object msg = Napi::Object::New(env);
+        msg.Set("serverID", Napi::String::New(env, serverID));
+        msg.Set("clientId", Napi::String::New(env, c.clientId));
+        msg.Set("typeId", Napi::Number::New(env, c.typeId));
+        msg.Set("asduAddress", Napi::Number::New(env, c.ca));
+        msg.Set("ioa", Napi::Number::New(env, c.ioa));
+        msg.Set("val", Napi::Number::New(env, c.val));
+        msg.Set("quality", Napi::Number::New(env, c.quality));
+        msg.Set("bselCmd", Napi::Boolean::New(env, c.bselCmd));
+        msg.Set("ql", Napi::Number::New(env, c.ql));
+        if (c.timestamp > 0) {
+            msg.Set("timestamp", Napi::Number::New(env, static_cast<double>(c.timestamp)));
+        }
+        jsArray[i] = msg;
+    }
+    jsCallback.Call({Napi::String::New(env, "data"), jsArray});
+    cnt++;
+}
+
 bool IEC104Server::RawMessageHandler(void* parameter, IMasterConnection connection, CS101_ASDU asdu) {
     IEC104Server* server = static_cast<IEC104Server*>(parameter);
     IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
@@ -1135,6 +1575,10 @@ bool IEC104Server::RawMessageHandler(void* parameter, IMasterConnection connecti
         }
     }
 
+    if (server->autoInterrogation && (typeID == C_IC_NA_1 || typeID == C_CI_NA_1)) {
+        return server->HandleInterrogation(connection, asdu);
+    }
+
     try {
         vector<tuple<int, double, uint8_t, uint64_t, bool, int>> elements;
 
@@ -1440,6 +1884,14 @@ bool IEC104Server::RawMessageHandler(void* parameter, IMasterConnection connecti
             fflush(stdout);
         }
 
+        if (server->batcher.IsEnabled()) {
+            server->batcher.Append(elements.size(), [&](size_t i) {
+                const auto& [ioa, val, quality, timestamp, bselCmd, ql] = elements[i];
+                return CommandRecord{clientIdStr, typeID, receivedAsduAddress, ioa, val, quality, timestamp, bselCmd, ql};
+            });
+            return true;
+        }
+
         server->tsfn.NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
             Napi::Array jsArray = Napi::Array::New(env, elements.size());
             for (size_t i = 0; i < elements.size(); i++) {
@@ -7,6 +7,9 @@
 #include <mutex>
 #include <vector>
 #include <map>
+#include <condition_variable>
+#include "event_batcher.h"
+#include "process_image.h"
 
 extern "C" {
 #include "cs104_slave.h"
@@ -16,14 +19,26 @@ extern "C" {
 
 
 
+// Ответ на опрос из образа процесса, который досылается по мере освобождения очереди соединения
+struct InterrogationJob {
+    int ca;             // Общий адрес из команды (для ACT_TERM)
+    int typeId;         // C_IC_NA_1 или C_CI_NA_1
+    int qualifier;      // QOI или QCC
+    CS101_CauseOfTransmission cot;
+    std::vector<ImageSegment> segments;
+    std::vector<PackPoint> points;
+    size_t segment = 0;
+    size_t pos = 0;
+};
+
 class IEC104Server : public Napi::ObjectWrap<IEC104Server> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     IEC104Server(const Napi::CallbackInfo& info);
     virtual ~IEC104Server();
+    void Teardown();
 
 private:
-    static Napi::FunctionReference constructor;
 
     
     CS104_Slave server;
@@ -36,6 +51,7 @@ private:
     std::map<int, CS101_ASDU> asduGroups; // Пока не используется, но добавлено для будущей группировки
     int cnt = 0;   
     Napi::ThreadSafeFunction tsfn;
+    bool tsfnReleased = false;
     bool running;
     bool started;
     //static thread_local std::string lastIpAddress;
@@ -45,14 +61,35 @@ private:
 
     bool restrictIPs; // Флаг для ограничения IP-адресов
     CS104_ServerMode serverMode; // Режим сервера
+    EventBatcher<CommandRecord> batcher; // Пакетная передача принятых команд в JS (batchSize/batchLatency)
+
+    ProcessImage processImage;           // Последние значения точек для ответа на опрос
+    bool autoInterrogation;              // Отвечать на C_IC_NA_1/C_CI_NA_1 из processImage без участия JS
+    std::mutex giMutex;
+    std::mutex giWakeMutex;              // Только для giWakeup: его берут обработчики lib60870 под её блокировками
+    std::condition_variable giCv;        // Ждёт giWakeup под giWakeMutex
+    bool giWakeup = false;               // Добавлен опрос, освободилось место в окне или очереди, остановка
+    std::atomic<bool> giPending{false};  // Есть недосланные ответы на опрос
+    std::map<IMasterConnection, InterrogationJob> interrogations; // Незавершённые ответы на опрос
+    std::atomic<uint64_t> interrogationsServed{0};
+
+    std::string ioModel;                 // 'thread' — поток на соединение, 'epoll' — пул рабочих потоков
+    int ioWorkers;                       // Число рабочих потоков epoll
 
     static bool ConnectionRequestHandler(void *parameter, const char *ipAddress);
     static void ConnectionEventHandler(void *parameter, IMasterConnection connection, CS104_PeerConnectionEvent event);
+    static void FrameHandler(void *parameter, IMasterConnection connection, uint8_t *msg, int msgSize, bool sent);
+    void WakeInterrogations();
     static bool RawMessageHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu);
+    void EmitBatch(Napi::Env env, Napi::Function jsCallback, const std::vector<CommandRecord>& commands);
+    bool HandleInterrogation(IMasterConnection connection, CS101_ASDU asdu);
+    bool DrainInterrogation(IMasterConnection connection, InterrogationJob& job);
 
     Napi::Value Start(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
     Napi::Value SendCommands(const Napi::CallbackInfo& info);
+    Napi::Value UpdatePoints(const Napi::CallbackInfo& info);
+    Napi::Value Publish(const Napi::CallbackInfo& info);
     Napi::Value GetStatus(const Napi::CallbackInfo& info);
 };
 
@@ -0,0 +1,105 @@
+#ifndef DEADBAND_FILTER_H
+#define DEADBAND_FILTER_H
+
+#include <napi.h>
+#include <string>
+#include "deadband_rules.h"
+
+// DeadbandRules с настройкой из params.deadband и статистикой для getStatus()
+class DeadbandFilter : public DeadbandRules {
+public:
+    // Читает params.deadband: число (абсолютная зона для всех аналоговых точек) или объект
+    // { absolute, percent, range | min/max, points: [{ asdu, ioa, ioaTo, absolute, percent, range | min/max }] }.
+    // percent считается от диапазона измерения; правило без своего диапазона берёт диапазон по умолчанию.
+    // Возвращает текст ошибки или пустую строку.
+    std::string Configure(const Napi::Object &params)
+    {
+        Reset();
+        if (!params.Has("deadband"))
+            return "";
+
+        Napi::Value value = params.Get("deadband");
+        Band defaultBand;
+        if (value.IsNumber()) {
+            defaultBand.absolute = value.As<Napi::Number>().DoubleValue();
+            if (!(defaultBand.absolute >= 0))
+                return "deadband must be non-negative";
+        } else if (value.IsObject()) {
+            Napi::Object config = value.As<Napi::Object>();
+            std::string error = ReadBand(config, defaultBand);
+            if (!error.empty())
+                return error;
+            if (config.Has("points")) {
+                if (!config.Get("points").IsArray())
+                    return "deadband.points must be an array";
+                Napi::Array list = config.Get("points").As<Napi::Array>();
+                for (uint32_t i = 0; i < list.Length(); i++) {
+                    Napi::Value item = list.Get(i);
+                    if (!item.IsObject() || !item.As<Napi::Object>().Has("ioa"))
+                        return "deadband.points[" + std::to_string(i) + "] must be an object with ioa";
+                    Napi::Object ruleObj = item.As<Napi::Object>();
+                    int ca = ruleObj.Has("asdu") ? ruleObj.Get("asdu").ToNumber().Int32Value() : -1;
+                    int ioaFrom = ruleObj.Get("ioa").ToNumber().Int32Value();
+                    int ioaTo = ruleObj.Has("ioaTo") ? ruleObj.Get("ioaTo").ToNumber().Int32Value() : ioaFrom;
+                    if (ioaTo < ioaFrom)
+                        return "deadband.points[" + std::to_string(i) + "].ioaTo must not be less than ioa";
+                    Band band;
+                    band.range = defaultBand.range;
+                    error = ReadBand(ruleObj, band);
+                    if (!error.empty())
+                        return "deadband.points[" + std::to_string(i) + "]: " + error;
+                    AddRule(ca, ioaFrom, ioaTo, band);
+                }
+            }
+        } else {
+            return "deadband must be a number or an object";
+        }
+        SetDefaultBand(defaultBand);
+        Enable();
+        return "";
+    }
+
+    Napi::Object GetStats(Napi::Env env)
+    {
+        Counters counters = GetCounters();
+        Napi::Object stats = Napi::Object::New(env);
+        stats.Set("rules", Napi::Number::New(env, static_cast<double>(counters.rules)));
+        stats.Set("points", Napi::Number::New(env, static_cast<double>(counters.points)));
+        stats.Set("filtered", Napi::Number::New(env, static_cast<double>(counters.filtered)));
+        return stats;
+    }
+
+private:
+    static std::string ReadBand(const Napi::Object &obj, Band &band)
+    {
+        if (obj.Has("absolute"))
+            band.absolute = obj.Get("absolute").ToNumber().DoubleValue();
+        if (obj.Has("percent"))
+            band.percent = obj.Get("percent").ToNumber().DoubleValue();
+        if (!(band.absolute >= 0) || !(band.percent >= 0))
+            return "deadband absolute and percent must be non-negative";
+
+        if (obj.Has("min") != obj.Has("max"))
+            return "deadband min and max must be set together";
+        if (obj.Has("range") && obj.Has("min"))
+            return "deadband takes either range or min/max";
+        if (obj.Has("range")) {
+            band.range = obj.Get("range").ToNumber().DoubleValue();
+            if (!(band.range > 0))
+                return "deadband range must be positive";
+        } else if (obj.Has("min")) {
+            double min = obj.Get("min").ToNumber().DoubleValue();
+            double max = obj.Get("max").ToNumber().DoubleValue();
+            if (!(max > min))
+                return "deadband max must be greater than min";
+            band.range = max - min;
+        }
+
+        // Процент от последнего значения сжимал бы зону до нуля около нуля — нужен диапазон
+        if (band.percent > 0 && !(band.range > 0))
+            return "deadband percent needs range or min/max";
+        return "";
+    }
+};
+
+#endif // DEADBAND_FILTER_H
@@ -0,0 +1,134 @@
+#ifndef DEADBAND_RULES_H
+#define DEADBAND_RULES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Зона нечувствительности (deadband) для аналоговых измерений. Точка уходит в JS, только если
+// значение отошло от последнего переданного больше чем на зону или изменилось качество.
+// Остальные типы, ответы на опрос (COT 20–36) и ответы на запрос (COT 5) проходят всегда.
+// Зона точки определяется по правилам один раз, при первом её появлении. Разбор params.deadband
+// (N-API) — в DeadbandFilter; здесь только правила и фильтр, их проверяют нативные тесты.
+class DeadbandRules {
+public:
+    struct Band {
+        double absolute = 0; // Абсолютная зона в единицах значения
+        double percent = 0;  // Зона в процентах от диапазона измерения
+        double range = 0;    // Диапазон измерения (max - min), без него percent не задаётся
+
+        double Width() const { return std::max(absolute, range * percent / 100.0); }
+    };
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        rules.clear();
+        points.clear();
+        defaultBand = Band();
+        filtered = 0;
+        enabled = false;
+    }
+
+    // Зона по умолчанию и правила задаются до Enable, пока поток приёма не запущен
+    void SetDefaultBand(const Band &band) { defaultBand = band; }
+    const Band &DefaultBand() const { return defaultBand; }
+
+    void AddRule(int ca, int ioaFrom, int ioaTo, const Band &band)
+    {
+        rules.push_back(Rule{ca, ioaFrom, ioaTo, band});
+    }
+
+    void Enable() { enabled = true; }
+    bool IsEnabled() const { return enabled; }
+
+    // Убирает из elements (ioa, val, quality, timestamp) точки внутри зоны. Вызывается из потока приёма.
+    template <typename Elements>
+    void Apply(int typeId, int cot, int ca, Elements &elements)
+    {
+        if (!enabled || !IsAnalog(typeId))
+            return;
+        bool always = cot == 5 || (cot >= 20 && cot <= 36);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t kept = 0;
+        for (size_t i = 0; i < elements.size(); i++) {
+            int ioa = std::get<0>(elements[i]);
+            double val = std::get<1>(elements[i]);
+            uint8_t quality = std::get<2>(elements[i]);
+
+            uint64_t key = (static_cast<uint64_t>(ca & 0xffff) << 32) | static_cast<uint32_t>(ioa);
+            auto it = points.find(key);
+            if (it == points.end()) {
+                points.emplace(key, PointState{BandFor(ca, ioa).Width(), val, quality});
+            } else {
+                PointState &state = it->second;
+                if (!always && state.band > 0 && quality == state.lastQuality && !(std::fabs(val - state.lastVal) > state.band)) {
+                    filtered++;
+                    continue;
+                }
+                state.lastVal = val;
+                state.lastQuality = quality;
+            }
+            if (kept != i)
+                elements[kept] = elements[i];
+            kept++;
+        }
+        elements.resize(kept);
+    }
+
+    struct Counters {
+        size_t rules;
+        size_t points;
+        uint64_t filtered;
+    };
+
+    Counters GetCounters()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Counters{rules.size(), points.size(), filtered};
+    }
+
+private:
+    struct Rule {
+        int ca = -1; // -1 — любой адрес ASDU
+        int ioaFrom = 0;
+        int ioaTo = 0;
+        Band band;
+    };
+
+    struct PointState {
+        double band;         // Ширина зоны точки в единицах значения
+        double lastVal;      // Последнее переданное в JS значение
+        uint8_t lastQuality;
+    };
+
+    // Измеренные значения: M_ME_NA/TA/NB/TB/NC/TC/ND_1 и M_ME_TD/TE/TF_1
+    static bool IsAnalog(int typeId)
+    {
+        return (typeId >= 9 && typeId <= 14) || typeId == 21 || (typeId >= 34 && typeId <= 36);
+    }
+
+    // Первое подходящее правило, иначе зона по умолчанию
+    const Band &BandFor(int ca, int ioa) const
+    {
+        for (const Rule &rule : rules) {
+            if ((rule.ca < 0 || rule.ca == ca) && ioa >= rule.ioaFrom && ioa <= rule.ioaTo)
+                return rule.band;
+        }
+        return defaultBand;
+    }
+
+    std::mutex mutex;
+    bool enabled = false;
+    Band defaultBand;
+    std::vector<Rule> rules;
+    std::unordered_map<uint64_t, PointState> points;
+    uint64_t filtered = 0;
+};
+
+#endif // DEADBAND_RULES_H
@@ -0,0 +1,386 @@
+#ifndef EVENT_BATCHER_H
+#define EVENT_BATCHER_H
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Точка мониторинга, накопленная для пакетной передачи в JS
+struct PointRecord {
+    int typeId;
+    int ca;
+    int cot;
+    int ioa;
+    double val;
+    uint8_t quality;
+    uint64_t timestamp;
+    int source; // Адрес канального уровня слейва (CS101 unbalanced), иначе 0
+    int line = 0; // Номер линии IEC101LineManager или соединения IEC104ClientPool, иначе 0
+};
+
+// Принятая команда (сервер/слейв), накопленная для пакетной передачи в JS
+struct CommandRecord {
+    std::string clientId;
+    int typeId;
+    int ca;
+    int ioa;
+    double val;
+    uint8_t quality;
+    uint64_t timestamp;
+    bool bselCmd;
+    int ql;
+};
+
+// Ключ (ca, ioa) для политики coalesce
+inline uint64_t CoalesceKey(const PointRecord &r)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(r.line) & 0xffff) << 48) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(r.ca) & 0xffff) << 32) | static_cast<uint32_t>(r.ioa);
+}
+
+inline uint64_t CoalesceKey(const CommandRecord &r)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(r.ca)) << 32) | static_cast<uint32_t>(r.ioa);
+}
+
+// Что делать, когда в очереди к JS уже maxQueuedEvents записей
+// Ожидания места нет: Append вызывается из обработчиков lib60870 под её блокировкой соединения,
+// и поток протокола, ждущий JS, взаимно блокировался бы с sendCommands из колбэка JS.
+enum class QueuePolicy {
+    DropOldest, // отбрасываются самые старые записи
+    Coalesce    // запись с тем же (ca, ioa) заменяется новой, иначе отбрасывается самая старая
+};
+
+// Состояние EventBatcher. Пакеты в очереди TSFN держат его через shared_ptr:
+// они могут дойти до потока JS уже после того, как владелец накопителя удалён.
+template <typename Record>
+class EventBatcherCore : public std::enable_shared_from_this<EventBatcherCore<Record>> {
+public:
+    using FlushFn = std::function<void(Napi::Env, Napi::Function, const std::vector<Record> &)>;
+
+    ~EventBatcherCore() { Stop(); }
+
+    std::string Configure(const Napi::Object &params)
+    {
+        int size = 1000;
+        int latency = 0;
+        int queued = 0;
+        std::string policyName = "dropOldest";
+        if (params.Has("batchSize") && params.Get("batchSize").IsNumber())
+            size = params.Get("batchSize").As<Napi::Number>().Int32Value();
+        if (params.Has("batchLatency") && params.Get("batchLatency").IsNumber())
+            latency = params.Get("batchLatency").As<Napi::Number>().Int32Value();
+        if (params.Has("maxQueuedEvents") && params.Get("maxQueuedEvents").IsNumber())
+            queued = params.Get("maxQueuedEvents").As<Napi::Number>().Int32Value();
+        if (params.Has("queuePolicy") && params.Get("queuePolicy").IsString())
+            policyName = params.Get("queuePolicy").As<Napi::String>().Utf8Value();
+
+        if (size <= 0 || latency < 0)
+            return "batchSize must be positive and batchLatency non-negative";
+        if (queued < 0)
+            return "maxQueuedEvents must be non-negative";
+        if (policyName == "dropOldest")
+            policy = QueuePolicy::DropOldest;
+        else if (policyName == "coalesce")
+            policy = QueuePolicy::Coalesce;
+        else
+            return "queuePolicy must be 'dropOldest' or 'coalesce'";
+
+        maxBatchSize = static_cast<size_t>(size);
+        maxLatencyMs = latency;
+        maxQueued = static_cast<size_t>(queued);
+        return "";
+    }
+
+    bool IsEnabled() const { return maxLatencyMs > 0 || maxQueued > 0; }
+
+    void Start(Napi::ThreadSafeFunction tsfn, FlushFn flushFn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!IsEnabled() || active)
+            return;
+        this->tsfn = tsfn;
+        this->flushFn = std::move(flushFn);
+        pending.clear();
+        pending.reserve(maxQueued ? maxQueued : maxBatchSize);
+        head = 0;
+        index.clear();
+        inFlight = false;
+        active = true;
+        if (maxLatencyMs > 0)
+            worker = std::thread([this]() { TimerLoop(); });
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!active)
+                return;
+            active = false;
+        }
+        cv.notify_one();
+        if (worker.joinable())
+            worker.join();
+        std::unique_lock<std::mutex> lock(mutex);
+        FlushLocked(lock);
+    }
+
+    template <typename MakeRecord>
+    void Append(size_t count, MakeRecord makeRecord)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!active)
+            return;
+        bool wasEmpty = Queued() == 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            Record rec = makeRecord(i);
+            if (maxQueued > 0)
+            {
+                if (policy == QueuePolicy::Coalesce)
+                {
+                    auto it = index.find(CoalesceKey(rec));
+                    if (it != index.end())
+                    {
+                        pending[it->second] = std::move(rec);
+                        coalesced++;
+                        continue;
+                    }
+                }
+                while (Queued() >= maxQueued)
+                    DropOldestLocked();
+                if (policy == QueuePolicy::Coalesce)
+                    index[CoalesceKey(rec)] = pending.size();
+            }
+            if (Queued() == 0)
+                batchStart = std::chrono::steady_clock::now();
+            pending.push_back(std::move(rec));
+            if (ReadyLocked(true))
+                FlushLocked(lock);
+        }
+        // Без batchLatency таймера нет: остаток ASDU уходит одним пакетом в конце Append
+        if (maxLatencyMs == 0 && Queued() > 0 && ReadyLocked())
+            FlushLocked(lock);
+        if (wasEmpty && Queued() > 0)
+            cv.notify_one();
+    }
+
+    // Владелец удаляется (поток JS): пакеты, оставшиеся в очереди TSFN, больше не передаются в flushFn,
+    // который ссылается на владельца
+    void Detach()
+    {
+        Stop();
+        flushFn = nullptr;
+    }
+
+    Napi::Object GetStats(Napi::Env env)
+    {
+        uint64_t nFlushes = flushes.load();
+        uint64_t nDelivered = deliveredFlushes.load();
+        size_t queuedNow;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queuedNow = Queued();
+        }
+        Napi::Object stats = Napi::Object::New(env);
+        stats.Set("enabled", Napi::Boolean::New(env, IsEnabled()));
+        stats.Set("maxBatchSize", Napi::Number::New(env, static_cast<double>(maxBatchSize)));
+        stats.Set("maxLatencyMs", Napi::Number::New(env, maxLatencyMs));
+        stats.Set("flushes", Napi::Number::New(env, static_cast<double>(nFlushes)));
+        stats.Set("records", Napi::Number::New(env, static_cast<double>(records.load())));
+        stats.Set("avgFlushSize", Napi::Number::New(env, nFlushes ? static_cast<double>(records.load()) / nFlushes : 0.0));
+        stats.Set("maxFlushSize", Napi::Number::New(env, static_cast<double>(maxFlushSize.load())));
+        stats.Set("avgLatencyMs", Napi::Number::New(env, nDelivered ? totalLatencyUs.load() / 1000.0 / nDelivered : 0.0));
+        stats.Set("maxLatencyMsObserved", Napi::Number::New(env, maxObservedLatencyUs.load() / 1000.0));
+        stats.Set("maxQueuedEvents", Napi::Number::New(env, static_cast<double>(maxQueued)));
+        stats.Set("queuePolicy", Napi::String::New(env, policy == QueuePolicy::Coalesce ? "coalesce" : "dropOldest"));
+        stats.Set("queued", Napi::Number::New(env, static_cast<double>(queuedNow)));
+        stats.Set("dropped", Napi::Number::New(env, static_cast<double>(dropped.load())));
+        stats.Set("coalesced", Napi::Number::New(env, static_cast<double>(coalesced.load())));
+        return stats;
+    }
+
+private:
+    size_t Queued() const { return pending.size() - head; }
+
+    // Можно ли отправить буфер прямо сейчас (под mutex). midAppend — Append ещё добавляет записи ASDU:
+    // без batchLatency буфер тогда уходит только по достижении maxBatchSize, а не с первой записью.
+    bool ReadyLocked(bool midAppend = false) const
+    {
+        if (maxQueued > 0 && inFlight)
+            return false;
+        if (Queued() >= maxBatchSize)
+            return true;
+        if (maxLatencyMs == 0)
+            return !midAppend;
+        return std::chrono::steady_clock::now() >= batchStart + std::chrono::milliseconds(maxLatencyMs);
+    }
+
+    void DropOldestLocked()
+    {
+        if (policy == QueuePolicy::Coalesce)
+            index.erase(CoalesceKey(pending[head]));
+        head++;
+        dropped++;
+        if (head == pending.size())
+        {
+            pending.clear();
+            head = 0;
+        }
+    }
+
+    void TimerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (active)
+        {
+            // Пока пакет в TSFN, следующий отправит колбэк доставки
+            if (Queued() == 0 || (maxQueued > 0 && inFlight))
+            {
+                cv.wait(lock);
+                continue;
+            }
+            auto deadline = batchStart + std::chrono::milliseconds(maxLatencyMs);
+            if (cv.wait_until(lock, deadline) == std::cv_status::timeout && Queued() > 0 && ReadyLocked())
+                FlushLocked(lock);
+        }
+    }
+
+    void FlushLocked(std::unique_lock<std::mutex> &lock)
+    {
+        if (Queued() == 0)
+            return;
+        auto batch = std::make_shared<std::vector<Record>>();
+        if (head == 0)
+        {
+            batch->reserve(pending.capacity());
+            batch->swap(pending);
+        }
+        else
+        {
+            batch->assign(std::make_move_iterator(pending.begin() + head), std::make_move_iterator(pending.end()));
+            pending.clear();
+            head = 0;
+        }
+        index.clear();
+        auto start = batchStart;
+        size_t size = batch->size();
+        flushes++;
+        records += size;
+        if (size > maxFlushSize.load())
+            maxFlushSize = size;
+        if (maxQueued > 0)
+            inFlight = true;
+
+        auto self = this->shared_from_this();
+        napi_status status = tsfn.NonBlockingCall([self, batch, start](Napi::Env env, Napi::Function jsCallback) {
+            self->Deliver(env, jsCallback, *batch, start);
+        });
+        if (status != napi_ok)
+        {
+            dropped += size;
+            inFlight = false;
+        }
+    }
+
+    // Поток JS: передаёт пакет владельцу и, если очередь ограничена, отправляет накопленное за это время
+    void Deliver(Napi::Env env, Napi::Function jsCallback, const std::vector<Record> &batch,
+                 std::chrono::steady_clock::time_point start)
+    {
+        // flushFn сбрасывает Detach на том же потоке JS, поэтому проверка без mutex
+        if (!flushFn)
+            return;
+        flushFn(env, jsCallback, batch);
+        uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - start).count();
+        totalLatencyUs += latencyUs;
+        deliveredFlushes++;
+        if (latencyUs > maxObservedLatencyUs.load())
+            maxObservedLatencyUs = latencyUs;
+
+        if (maxQueued > 0)
+        {
+            // Пакет доставлен: накопленное за это время уходит следующим вызовом
+            std::unique_lock<std::mutex> lock(mutex);
+            inFlight = false;
+            if (Queued() > 0 && ReadyLocked())
+                FlushLocked(lock);
+            else
+                cv.notify_one();
+        }
+    }
+
+    size_t maxBatchSize = 1000;
+    int maxLatencyMs = 0;
+    size_t maxQueued = 0;
+    QueuePolicy policy = QueuePolicy::DropOldest;
+
+    Napi::ThreadSafeFunction tsfn;
+    FlushFn flushFn;
+    std::vector<Record> pending;
+    size_t head = 0;                            // Первая неотброшенная запись в pending
+    std::unordered_map<uint64_t, size_t> index; // (ca, ioa) -> позиция в pending для coalesce
+    std::chrono::steady_clock::time_point batchStart;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    bool active = false;
+    bool inFlight = false;
+
+    std::atomic<uint64_t> flushes{0};
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> maxFlushSize{0};
+    std::atomic<uint64_t> deliveredFlushes{0};
+    std::atomic<uint64_t> totalLatencyUs{0};
+    std::atomic<uint64_t> maxObservedLatencyUs{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> coalesced{0};
+};
+
+// Накопитель событий между потоками протокола и потоком JS.
+// Вместо одного NonBlockingCall на каждый ASDU записи складываются в буфер и
+// передаются одним вызовом, когда набралось maxBatchSize записей или с момента
+// первой записи прошло maxLatencyMs.
+// При maxQueuedEvents > 0 очередь ограничена: в TSFN одновременно находится не
+// больше одного пакета, а то, что не помещается в буфер, обрабатывается по QueuePolicy.
+// Без batchLatency пакет — записи одного ASDU, разбитые по maxBatchSize.
+// Если не заданы ни batchLatency, ни maxQueuedEvents, накопитель выключен.
+template <typename Record>
+class EventBatcher {
+public:
+    using FlushFn = typename EventBatcherCore<Record>::FlushFn;
+
+    ~EventBatcher() { core->Detach(); }
+
+    // Читает batchSize/batchLatency/maxQueuedEvents/queuePolicy из объекта параметров.
+    // Возвращает текст ошибки или пустую строку.
+    std::string Configure(const Napi::Object &params) { return core->Configure(params); }
+
+    bool IsEnabled() const { return core->IsEnabled(); }
+
+    void Start(Napi::ThreadSafeFunction tsfn, FlushFn flushFn) { core->Start(tsfn, std::move(flushFn)); }
+
+    // Отправляет остаток буфера и останавливает таймер. Вызывать до tsfn.Release().
+    void Stop() { core->Stop(); }
+
+    // Добавляет count записей, makeRecord(i) возвращает i-ю запись
+    template <typename MakeRecord>
+    void Append(size_t count, MakeRecord makeRecord) { core->Append(count, makeRecord); }
+
+    Napi::Object GetStats(Napi::Env env) { return core->GetStats(env); }
+
+private:
+    std::shared_ptr<EventBatcherCore<Record>> core = std::make_shared<EventBatcherCore<Record>>();
+};
+
+#endif // EVENT_BATCHER_H
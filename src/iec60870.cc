@@ -4,13 +4,21 @@
 #include "cs101_master_balanced.h"  // Assuming this defines IEC101MasterBalanced
 #include "cs101_slave1.h"           // Assuming this defines IEC101Slave
 #include "cs104_client.h"          // Assuming this defines IEC104Client
+#include "cs101_line_manager.h"      // IEC101LineManager
+#include "cs104_client_pool.h"       // IEC104ClientPool
+#include "addon_data.h"              // Per-environment class constructors
 
+// Called once per environment: the main thread and every worker_threads Worker that
+// loads the addon get their own AddonData and their own class constructors.
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    GetAddonData(env);                         // Create instance data for this environment
     IEC104Server::Init(env, exports);          // Export IEC104Server class
     IEC101MasterUnbalanced::Init(env, exports); // Export IEC101MasterUnbalanced class
     IEC101MasterBalanced::Init(env, exports);   // Export IEC101MasterBalanced class
     IEC101Slave::Init(env, exports);           // Export IEC101Slave class
     IEC104Client::Init(env, exports);          // Export IEC104Client class
+    IEC101LineManager::Init(env, exports);     // Export IEC101LineManager class
+    IEC104ClientPool::Init(env, exports);      // Export IEC104ClientPool class
     return exports;
 }
 
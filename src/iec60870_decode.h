@@ -0,0 +1,151 @@
+#ifndef IEC60870_DECODE_H
+#define IEC60870_DECODE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+extern "C" {
+#include "information_objects_internal.h"
+}
+
+// Память под один информационный объект для CS101_ASDU_getElementEx.
+// uInformationObject из lib60870 не содержит упакованные события защиты (M_EP_TE_1/M_EP_TF_1),
+// поэтому добавляем их отдельно. Каждый экземпляр соединения держит свой буфер и декодирует
+// элементы ASDU в него без выделения памяти в куче.
+union IODecodeBuffer {
+    union uInformationObject io;
+    struct sPackedStartEventsOfProtectionEquipmentWithCP56Time2a epte;
+    struct sPackedOutputCircuitInfoWithCP56Time2a eptf;
+};
+
+// Декодированная точка мониторинга: (ioa, значение, качество, метка времени в мс)
+typedef std::tuple<int, double, uint8_t, uint64_t> DecodedPoint;
+typedef std::vector<DecodedPoint> DecodedPoints;
+
+// Декодирует элементы ASDU мониторинга в points (points очищается). Метки CP56Time2a переводятся
+// в мс через кэш суток потока приёма. Элементы прочих типов (подтверждения команд и т.п.) дают
+// точку со значением 0 и качеством GOOD: IEC101LineManager и IEC104ClientPool передают их в JS без значений.
+inline void DecodeMonitoringASDU(CS101_ASDU asdu, IODecodeBuffer &buffer, CP56Time2aDayCache &dayCache, DecodedPoints &points)
+{
+    IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
+    int numberOfElements = CS101_ASDU_getNumberOfElements(asdu);
+
+    points.clear();
+    points.reserve(numberOfElements);
+
+    for (int i = 0; i < numberOfElements; i++) {
+        InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&buffer, i);
+        if (!io)
+            continue;
+
+        double val = 0;
+        uint8_t quality = IEC60870_QUALITY_GOOD;
+        uint64_t timestamp = 0;
+
+        switch (typeID) {
+            case M_SP_NA_1:
+            case M_SP_TB_1:
+                val = SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0;
+                quality = SinglePointInformation_getQuality((SinglePointInformation)io);
+                if (typeID == M_SP_TB_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(SinglePointWithCP56Time2a_getTimestamp((SinglePointWithCP56Time2a)io), &dayCache);
+                break;
+            case M_DP_NA_1:
+            case M_DP_TB_1:
+                val = static_cast<double>(DoublePointInformation_getValue((DoublePointInformation)io));
+                quality = DoublePointInformation_getQuality((DoublePointInformation)io);
+                if (typeID == M_DP_TB_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(DoublePointWithCP56Time2a_getTimestamp((DoublePointWithCP56Time2a)io), &dayCache);
+                break;
+            case M_ST_NA_1:
+            case M_ST_TB_1:
+                val = static_cast<double>(StepPositionInformation_getValue((StepPositionInformation)io));
+                quality = StepPositionInformation_getQuality((StepPositionInformation)io);
+                if (typeID == M_ST_TB_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(StepPositionWithCP56Time2a_getTimestamp((StepPositionWithCP56Time2a)io), &dayCache);
+                break;
+            case M_BO_NA_1:
+            case M_BO_TB_1:
+                val = static_cast<double>(BitString32_getValue((BitString32)io));
+                quality = BitString32_getQuality((BitString32)io);
+                if (typeID == M_BO_TB_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(Bitstring32WithCP56Time2a_getTimestamp((Bitstring32WithCP56Time2a)io), &dayCache);
+                break;
+            case M_ME_NA_1:
+            case M_ME_TD_1:
+                val = MeasuredValueNormalized_getValue((MeasuredValueNormalized)io);
+                quality = MeasuredValueNormalized_getQuality((MeasuredValueNormalized)io);
+                if (typeID == M_ME_TD_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueNormalizedWithCP56Time2a_getTimestamp((MeasuredValueNormalizedWithCP56Time2a)io), &dayCache);
+                break;
+            case M_ME_NB_1:
+            case M_ME_TE_1:
+                val = static_cast<double>(MeasuredValueScaled_getValue((MeasuredValueScaled)io));
+                quality = MeasuredValueScaled_getQuality((MeasuredValueScaled)io);
+                if (typeID == M_ME_TE_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueScaledWithCP56Time2a_getTimestamp((MeasuredValueScaledWithCP56Time2a)io), &dayCache);
+                break;
+            case M_ME_NC_1:
+            case M_ME_TF_1:
+                val = MeasuredValueShort_getValue((MeasuredValueShort)io);
+                quality = MeasuredValueShort_getQuality((MeasuredValueShort)io);
+                if (typeID == M_ME_TF_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(MeasuredValueShortWithCP56Time2a_getTimestamp((MeasuredValueShortWithCP56Time2a)io), &dayCache);
+                break;
+            case M_IT_NA_1:
+            case M_IT_TB_1:
+                val = BinaryCounterReading_getValue(IntegratedTotals_getBCR((IntegratedTotals)io));
+                if (typeID == M_IT_TB_1)
+                    timestamp = CP56Time2a_toMsTimestampCached(IntegratedTotalsWithCP56Time2a_getTimestamp((IntegratedTotalsWithCP56Time2a)io), &dayCache);
+                break;
+            default:
+                break;
+        }
+
+        points.emplace_back(InformationObject_getObjectAddress(io), val, quality, timestamp);
+    }
+}
+
+// Векторы точек для передачи ASDU в поток JS. Поток приёма декодирует в свой DecodedPoints,
+// копирует точки в вектор из пула и отдаёт его лямбде TSFN, которая возвращает вектор после
+// разбора. Ёмкость векторов сохраняется, так что в установившемся режиме память не выделяется.
+class DecodedPointsPool {
+public:
+    DecodedPointsPool() { free.reserve(MAX_FREE); }
+
+    DecodedPoints *Acquire(const DecodedPoints &points)
+    {
+        std::unique_ptr<DecodedPoints> buffer;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!free.empty()) {
+                buffer = std::move(free.back());
+                free.pop_back();
+            }
+        }
+        if (!buffer)
+            buffer.reset(new DecodedPoints());
+        buffer->assign(points.begin(), points.end());
+        return buffer.release();
+    }
+
+    // Вызывается из потока JS после разбора или из потока приёма, если вызов TSFN не поставлен в очередь
+    void Release(DecodedPoints *points)
+    {
+        std::unique_ptr<DecodedPoints> buffer(points);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (free.size() < MAX_FREE)
+            free.push_back(std::move(buffer));
+    }
+
+private:
+    static const size_t MAX_FREE = 64; // Больше свободных векторов не держим: это только пики очереди к JS
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<DecodedPoints>> free;
+};
+
+#endif // IEC60870_DECODE_H
@@ -0,0 +1,143 @@
+#ifndef LAST_VALUE_CACHE_H
+#define LAST_VALUE_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Таблица последних значений клиента по (ca, ioa). Открытая адресация с линейным пробированием
+// в одном векторе: обновление из потока приёма — одно умножение и, как правило, одно сравнение
+// ключа, без выделения памяти после заполнения. Таблица растёт вдвое при заполнении на 70%.
+// Все методы, кроме Lock(), вызываются под блокировкой, которую возвращает Lock(): поток приёма
+// обновляет весь ASDU под одной блокировкой, JS-поток читает выборку целиком.
+class LastValueCache {
+public:
+    struct Entry
+    {
+        uint64_t key;
+        int typeId;
+        double val;
+        uint8_t quality;
+        uint64_t timestamp;
+    };
+
+    explicit LastValueCache(size_t capacity = 1024)
+    {
+        Reset(capacity);
+    }
+
+    std::unique_lock<std::mutex> Lock()
+    {
+        return std::unique_lock<std::mutex>(mutex);
+    }
+
+    void Reset(size_t capacity)
+    {
+        size_t size = 16;
+        while (size < capacity)
+            size <<= 1;
+        slots.assign(size, Entry{EMPTY, 0, 0, 0, 0});
+        count = 0;
+    }
+
+    // Возвращает true, если точка новая или изменились значение или качество
+    bool Update(int typeId, int ca, int ioa, double val, uint8_t quality, uint64_t timestamp)
+    {
+        if ((count + 1) * 10 > slots.size() * 7)
+            Grow();
+
+        uint64_t key = Key(ca, ioa);
+        size_t mask = slots.size() - 1;
+        for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+        {
+            Entry &slot = slots[i];
+            if (slot.key == EMPTY)
+            {
+                slot = Entry{key, typeId, val, quality, timestamp};
+                count++;
+                return true;
+            }
+            if (slot.key == key)
+            {
+                bool changed = slot.val != val || slot.quality != quality;
+                slot.typeId = typeId;
+                slot.val = val;
+                slot.quality = quality;
+                if (timestamp > 0)
+                    slot.timestamp = timestamp;
+                return changed;
+            }
+        }
+    }
+
+    const Entry *Find(int ca, int ioa) const
+    {
+        uint64_t key = Key(ca, ioa);
+        size_t mask = slots.size() - 1;
+        for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+        {
+            const Entry &slot = slots[i];
+            if (slot.key == key)
+                return &slot;
+            if (slot.key == EMPTY)
+                return nullptr;
+        }
+    }
+
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (const Entry &slot : slots)
+        {
+            if (slot.key != EMPTY)
+                f(static_cast<int>(slot.key >> 32), static_cast<int32_t>(slot.key & 0xffffffff), slot);
+        }
+    }
+
+    size_t Size() const
+    {
+        return count;
+    }
+
+    size_t Capacity() const
+    {
+        return slots.size();
+    }
+
+private:
+    static const uint64_t EMPTY = UINT64_MAX; // ca не длиннее 16 бит, поэтому такого ключа не бывает
+
+    static uint64_t Key(int ca, int ioa)
+    {
+        return (static_cast<uint64_t>(ca & 0xffff) << 32) | static_cast<uint32_t>(ioa);
+    }
+
+    // Хеширование Фибоначчи: соседние ioa одного ca расходятся по таблице
+    static size_t Hash(uint64_t key)
+    {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 20);
+    }
+
+    void Grow()
+    {
+        std::vector<Entry> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, Entry{EMPTY, 0, 0, 0, 0});
+        size_t mask = slots.size() - 1;
+        for (const Entry &entry : old)
+        {
+            if (entry.key == EMPTY)
+                continue;
+            size_t i = Hash(entry.key) & mask;
+            while (slots[i].key != EMPTY)
+                i = (i + 1) & mask;
+            slots[i] = entry;
+        }
+    }
+
+    std::vector<Entry> slots;
+    size_t count = 0;
+    std::mutex mutex;
+};
+
+#endif // LAST_VALUE_CACHE_H
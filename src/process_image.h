@@ -0,0 +1,118 @@
+#ifndef PROCESS_IMAGE_H
+#define PROCESS_IMAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "asdu_packer.h"
+
+// Точка образа процесса
+struct ImagePoint {
+    int ca;
+    int typeId;  // Тип для ответа на опрос (без метки времени, см. InterrogationTypeId)
+    int ioa;
+    int group;   // 0 — только общий опрос, 1..16 — группа опроса (для счётчиков 1..4)
+    double value;
+    uint8_t quality;
+    uint64_t timestamp;
+};
+
+// Непрерывный участок выборки с одинаковыми (ca, typeId)
+struct ImageSegment {
+    int ca;
+    int typeId;
+    size_t begin;
+    size_t end;
+};
+
+// Образ процесса сервера: последние значения по (ca, typeId, ioa).
+// Точки хранятся в одном векторе, отсортированном по ключу, поэтому выборка для
+// общего опроса идёт подряд по памяти и сразу даёт цепочки ioa для упаковки с SQ=1.
+// Новые точки дописываются в конец, сортировка откладывается до следующего чтения.
+class ProcessImage {
+public:
+    void Update(const std::vector<ImagePoint> &updates)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const ImagePoint &p : updates)
+        {
+            uint64_t key = Key(p.ca, p.typeId, p.ioa);
+            auto it = index.find(key);
+            if (it != index.end())
+            {
+                points[it->second] = p;
+            }
+            else
+            {
+                index.emplace(key, points.size());
+                points.push_back(p);
+                sorted = false;
+            }
+        }
+    }
+
+    size_t Size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return points.size();
+    }
+
+    bool HasCA(int ca)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        SortLocked();
+        auto it = std::lower_bound(points.begin(), points.end(), Key(ca, 0, 0),
+                                   [](const ImagePoint &p, uint64_t key) { return Key(p.ca, p.typeId, p.ioa) < key; });
+        return it != points.end() && it->ca == ca;
+    }
+
+    // Копирует точки для ответа на опрос. counters — опрос счётчиков (только M_IT_NA_1),
+    // иначе общий опрос (всё, кроме счётчиков). group 0 — все точки, иначе только группа.
+    // ca < 0 — все общие адреса.
+    void Select(int ca, bool counters, int group, std::vector<ImageSegment> &segments, std::vector<PackPoint> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        SortLocked();
+        for (const ImagePoint &p : points)
+        {
+            if (ca >= 0 && p.ca != ca)
+                continue;
+            if ((p.typeId == M_IT_NA_1) != counters)
+                continue;
+            if (group != 0 && p.group != group)
+                continue;
+            if (segments.empty() || segments.back().ca != p.ca || segments.back().typeId != p.typeId)
+                segments.push_back(ImageSegment{p.ca, p.typeId, out.size(), out.size()});
+            out.push_back(PackPoint{p.ioa, p.value, p.quality, p.timestamp});
+            segments.back().end = out.size();
+        }
+    }
+
+private:
+    static uint64_t Key(int ca, int typeId, int ioa)
+    {
+        return (static_cast<uint64_t>(ca & 0xffff) << 40) | (static_cast<uint64_t>(typeId & 0xff) << 32) |
+               static_cast<uint32_t>(ioa);
+    }
+
+    void SortLocked()
+    {
+        if (sorted)
+            return;
+        std::sort(points.begin(), points.end(), [](const ImagePoint &a, const ImagePoint &b) {
+            return Key(a.ca, a.typeId, a.ioa) < Key(b.ca, b.typeId, b.ioa);
+        });
+        for (size_t i = 0; i < points.size(); i++)
+            index[Key(points[i].ca, points[i].typeId, points[i].ioa)] = i;
+        sorted = true;
+    }
+
+    std::vector<ImagePoint> points;
+    std::unordered_map<uint64_t, size_t> index;
+    bool sorted = true;
+    std::mutex mutex;
+};
+
+#endif // PROCESS_IMAGE_H
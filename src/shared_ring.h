@@ -0,0 +1,147 @@
+#ifndef SHARED_RING_H
+#define SHARED_RING_H
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include "event_batcher.h"
+
+// Кольцевой буфер точек в SharedArrayBuffer: потоки протокола пишут записи, worker_threads читает
+// их напрямую, без копирования и без участия главного потока. Один читатель, писатели сериализуются
+// мьютексом на стороне C++, так что между C++ и JS буфер остаётся SPSC без блокировок.
+//
+// Раскладка (Int32Array поверх SharedArrayBuffer, индексы в int32):
+//   [0] версия (1), [1] ёмкость в записях (степень двойки), [2] размер записи (32), [3] отброшено
+//   [16] head — записано (пишет C++), [17] waiting — читатель спит в Atomics.wait на [16]
+//   [32] tail — прочитано (пишет JS); записи начинаются с байта 192
+// Запись: f64 val, f64 timestamp, i32 ioa, u16 asdu, u8 typeId, u8 quality, u16 cot, u16 source, u32 0.
+// Счётчики — uint32 с переполнением. Если читатель выставил waiting, после публикации главный
+// поток вызывает Atomics.notify(ring, 16): это происходит только при переходе читателя в сон.
+class SharedRing {
+public:
+    static const size_t HEADER_BYTES = 192;
+    static const size_t RECORD_BYTES = 32;
+    enum { VERSION = 0, CAPACITY = 1, RECORD_SIZE = 2, DROPPED = 3, HEAD = 16, WAITING = 17, TAIL = 32 };
+
+    // Подключает Int32Array поверх SharedArrayBuffer и заполняет заголовок. Вызывается из потока JS,
+    // пока потоки протокола не запущены. Возвращает текст ошибки или пустую строку.
+    std::string Attach(const Napi::Value &value)
+    {
+        if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array)
+            return "dataRing must be an Int32Array over a SharedArrayBuffer";
+        Napi::Int32Array view = value.As<Napi::Int32Array>();
+        size_t bytes = view.ByteLength();
+        size_t capacity = 16;
+        if (bytes < HEADER_BYTES + capacity * RECORD_BYTES)
+            return "dataRing is too small, need at least " + std::to_string(HEADER_BYTES + capacity * RECORD_BYTES) + " bytes";
+        while (HEADER_BYTES + capacity * 2 * RECORD_BYTES <= bytes)
+            capacity *= 2;
+
+        Detach();
+        std::lock_guard<std::mutex> lock(mutex);
+        viewRef = Napi::Persistent(static_cast<Napi::Object>(view));
+        base = reinterpret_cast<uint8_t *>(view.Data());
+        mask = static_cast<uint32_t>(capacity - 1);
+        written = 0;
+        dropped = 0;
+        notifies = 0;
+        memset(base, 0, HEADER_BYTES);
+        Slot(VERSION).store(1);
+        Slot(CAPACITY).store(static_cast<int32_t>(capacity));
+        Slot(RECORD_SIZE).store(static_cast<int32_t>(RECORD_BYTES));
+        return "";
+    }
+
+    // Вызывается из потока JS, когда потоки протокола остановлены
+    void Detach()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        base = nullptr;
+        if (!viewRef.IsEmpty())
+            viewRef.Reset();
+    }
+
+    bool IsAttached() const { return base != nullptr; }
+
+    // Пишет count точек (record(i) возвращает PointRecord) и будит спящего читателя через tsfn.
+    // Если места нет, лишние точки отбрасываются и учитываются в заголовке [3].
+    template <typename RecordFn>
+    void Push(size_t count, RecordFn record, const Napi::ThreadSafeFunction &tsfn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!base)
+            return;
+        uint32_t head = static_cast<uint32_t>(Slot(HEAD).load(std::memory_order_relaxed));
+        uint32_t tail = static_cast<uint32_t>(Slot(TAIL).load(std::memory_order_acquire));
+        size_t stored = 0;
+        for (; stored < count && head - tail <= mask; stored++, head++) {
+            const PointRecord p = record(stored);
+            uint8_t *r = base + HEADER_BYTES + static_cast<size_t>(head & mask) * RECORD_BYTES;
+            double timestamp = static_cast<double>(p.timestamp);
+            uint16_t asdu = static_cast<uint16_t>(p.ca);
+            uint16_t cot = static_cast<uint16_t>(p.cot);
+            uint16_t source = static_cast<uint16_t>(p.source ? p.source : p.line);
+            uint32_t reserved = 0;
+            memcpy(r, &p.val, 8);
+            memcpy(r + 8, &timestamp, 8);
+            memcpy(r + 16, &p.ioa, 4);
+            memcpy(r + 20, &asdu, 2);
+            r[22] = static_cast<uint8_t>(p.typeId);
+            r[23] = p.quality;
+            memcpy(r + 24, &cot, 2);
+            memcpy(r + 26, &source, 2);
+            memcpy(r + 28, &reserved, 4);
+        }
+        if (stored < count) {
+            Slot(DROPPED).fetch_add(static_cast<int32_t>(count - stored));
+            dropped += count - stored;
+        }
+        if (stored == 0)
+            return;
+        written += stored;
+        // seq_cst в паре с JS: читатель пишет waiting и перечитывает head, мы пишем head и читаем waiting
+        Slot(HEAD).store(static_cast<int32_t>(head));
+        if (Slot(WAITING).exchange(0) != 0) {
+            notifies++;
+            tsfn.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (viewRef.IsEmpty())
+                    return;
+                Napi::Object atomics = env.Global().Get("Atomics").As<Napi::Object>();
+                atomics.Get("notify").As<Napi::Function>().Call(atomics, {viewRef.Value(), Napi::Number::New(env, HEAD)});
+            });
+        }
+    }
+
+    Napi::Object GetStats(Napi::Env env)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Napi::Object stats = Napi::Object::New(env);
+        stats.Set("capacity", Napi::Number::New(env, base ? static_cast<double>(mask) + 1 : 0));
+        stats.Set("pending", Napi::Number::New(env, base ? static_cast<double>(static_cast<uint32_t>(Slot(HEAD).load() - Slot(TAIL).load())) : 0));
+        stats.Set("written", Napi::Number::New(env, static_cast<double>(written)));
+        stats.Set("dropped", Napi::Number::New(env, static_cast<double>(dropped)));
+        stats.Set("notifies", Napi::Number::New(env, static_cast<double>(notifies)));
+        return stats;
+    }
+
+private:
+    // Ячейки заголовка общие с JS Atomics; std::atomic<int32_t> без блокировок совпадает с int32 по раскладке
+    std::atomic<int32_t> &Slot(int index) const
+    {
+        return *reinterpret_cast<std::atomic<int32_t> *>(base + index * sizeof(int32_t));
+    }
+
+    std::mutex mutex;
+    Napi::ObjectReference viewRef;
+    uint8_t *base = nullptr;
+    uint32_t mask = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    uint64_t notifies = 0;
+};
+
+#endif // SHARED_RING_H
@@ -0,0 +1,136 @@
+// Загрузка аддона в нескольких worker_threads и их завершение. Каждый воркер загружает аддон сам,
+// создаёт все классы, поднимает IEC104Server и IEC104Client к нему и ждёт данных. Затем воркер
+// завершается одним из трёх способов: после stop/disconnect, через process.exit() с работающими
+// потоками или через worker.terminate() снаружи. Нативные потоки должны останавливаться до того,
+// как окружение воркера освободит свои ThreadSafeFunction, иначе процесс падает.
+//
+//   npm test   (node --test --test-force-exit test/)
+//
+// Нужен собранный build/Release/addon_iec60870.node (npm run configure && npm run build); без него тест
+// падает. IEC60870_ADDON задаёт путь к другой сборке аддона.
+// --test-force-exit: TSFN остановленного IEC104Server держит цикл событий, пока объект не собран GC.
+
+const test = require('node:test');
+const assert = require('node:assert');
+const fs = require('fs');
+const path = require('path');
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+
+const addonPath = process.env.IEC60870_ADDON
+    ? path.resolve(process.env.IEC60870_ADDON)
+    : path.join(__dirname, '..', 'build', 'Release', 'addon_iec60870.node');
+const WORKERS = 4;
+const ROUNDS = 3;
+const BASE_PORT = 24140;
+const MODES = ['stop', 'exit', 'terminate'];
+
+// Поднимает сервер и клиента на порту и ждёт, пока клиент примет точки
+function runPair(addon, port, id, onData) {
+    const server = new addon.IEC104Server(() => {});
+    server.start({ port, serverID: `s${id}`, mode: 'multi' });
+
+    let received = 0;
+    const client = new addon.IEC104Client((event, data) => {
+        if (event === 'data' && Array.isArray(data)) {
+            received += data.length;
+            onData(received);
+        }
+    });
+    client.connect({ ip: '127.0.0.1', port, clientID: `c${id}`, reconnectDelay: 1 });
+
+    const batch = Array.from({ length: 10 }, (_, i) => ({ typeId: 13, asduAddress: 1, ioa: 100 + i, value: 0 }));
+    let tick = 0;
+    const timer = setInterval(() => {
+        tick++;
+        for (const p of batch) p.value = tick;
+        server.publish(batch);
+    }, 50);
+
+    let stopped = false;
+    return {
+        stop() {
+            if (stopped) return;
+            stopped = true;
+            clearInterval(timer);
+            client.disconnect();
+            server.stop();
+        }
+    };
+}
+
+if (!isMainThread) {
+    const addon = require(addonPath);
+    const { id, port } = workerData;
+
+    // Объекты без запущенных потоков тоже проходят через завершение окружения
+    const idle = [
+        new addon.IEC101MasterBalanced(() => {}),
+        new addon.IEC101MasterUnbalanced(() => {}),
+        new addon.IEC101Slave(() => {}),
+        new addon.IEC101LineManager(() => {})
+    ];
+    if (process.platform === 'linux') idle.push(new addon.IEC104ClientPool(() => {}));
+
+    let ready = false;
+    const pair = runPair(addon, port, id, received => {
+        if (ready) return;
+        ready = true;
+        parentPort.postMessage({ id, received, idle: idle.length });
+    });
+
+    parentPort.on('message', command => {
+        if (command === 'stop') pair.stop();
+        if (command === 'stop' || command === 'exit') process.exit(0);
+    });
+} else {
+    function startWorker(id, port, mode) {
+        const worker = new Worker(__filename, { workerData: { id, port, mode } });
+        const ready = new Promise((resolve, reject) => {
+            worker.once('message', resolve);
+            worker.once('error', reject);
+            worker.once('exit', code => reject(new Error(`worker ${id} exited with ${code} before data`)));
+        });
+        const exited = new Promise(resolve => worker.on('exit', resolve));
+        return { worker, mode, ready, exited };
+    }
+
+    test('addon loads and tears down in worker_threads', { timeout: 120000 }, async () => {
+        assert.ok(fs.existsSync(addonPath), `addon is not built: ${addonPath}`);
+        // Аддон загружен и в главном потоке: завершение воркеров не должно его задевать
+        const addon = require(addonPath);
+
+        for (let round = 0; round < ROUNDS; round++) {
+            const started = [];
+            for (let i = 0; i < WORKERS; i++) {
+                const id = round * WORKERS + i;
+                started.push(startWorker(id, BASE_PORT + id, MODES[(round + i) % MODES.length]));
+            }
+
+            for (const w of started) {
+                const result = await w.ready;
+                assert.ok(result.received > 0, `worker ${result.id} received no points`);
+            }
+
+            for (const w of started) {
+                if (w.mode === 'terminate') w.worker.terminate();
+                else w.worker.postMessage(w.mode);
+            }
+            const codes = await Promise.all(started.map(w => w.exited));
+            started.forEach((w, i) => {
+                // terminate() завершает воркер с кодом 1
+                assert.strictEqual(codes[i], w.mode === 'terminate' ? 1 : 0, `worker mode ${w.mode}`);
+            });
+        }
+
+        // После всех завершений главный поток по-прежнему работает с аддоном
+        const received = await new Promise((resolve, reject) => {
+            const timeout = setTimeout(() => reject(new Error('main thread received no points')), 20000);
+            const pair = runPair(addon, BASE_PORT + ROUNDS * WORKERS, 'main', count => {
+                clearTimeout(timeout);
+                pair.stop();
+                resolve(count);
+            });
+        });
+        assert.ok(received > 0);
+    });
+}
@@ -0,0 +1,82 @@
+// Проверки PackASDU (src/asdu_packer.h) без Node.js: SQ=1 только для типов без метки времени,
+// все точки укладываются, значения и метки времени читаются обратно через lib60870.
+//
+//   test_asdu_packer
+
+#include <cstdio>
+#include <vector>
+#include "asdu_packer.h"
+
+static struct sCS101_AppLayerParameters appLayerParameters = {
+    /* .sizeOfTypeId = */ 1,
+    /* .sizeOfVSQ = */ 1,
+    /* .sizeOfCOT = */ 2,
+    /* .originatorAddress = */ 0,
+    /* .sizeOfCA = */ 2,
+    /* .sizeOfIOA = */ 3,
+    /* .maxSizeOfASDU = */ 249
+};
+
+static int failures = 0;
+
+#define EXPECT(cond)                                                         \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+// Упаковывает все точки подряд идущих IOA и проверяет SQ каждого ASDU и обратное чтение
+static void CheckPacking(int typeId, bool expectSequence)
+{
+    const uint64_t timestamp = 1700000000123ULL;
+    std::vector<PackPoint> points;
+    for (int i = 0; i < 40; i++)
+        points.push_back(PackPoint{100 + i, static_cast<double>(i), IEC60870_QUALITY_GOOD, timestamp + i});
+
+    sCS101_StaticASDU storage;
+    size_t pos = 0;
+    int asdus = 0;
+    while (pos < points.size()) {
+        CS101_ASDU asdu = NULL;
+        size_t packed = PackASDU(&storage, &asdu, &appLayerParameters, CS101_COT_SPONTANEOUS, 1, typeId, &points[pos], points.size() - pos);
+        EXPECT(packed > 0);
+        if (packed == 0)
+            return;
+        EXPECT(CS101_ASDU_getTypeID(asdu) == typeId);
+        EXPECT(CS101_ASDU_isSequence(asdu) == expectSequence);
+        EXPECT(CS101_ASDU_getNumberOfElements(asdu) == static_cast<int>(packed));
+        for (size_t i = 0; i < packed; i++) {
+            InformationObject io = CS101_ASDU_getElement(asdu, static_cast<int>(i));
+            EXPECT(io != NULL);
+            if (!io)
+                continue;
+            EXPECT(InformationObject_getObjectAddress(io) == points[pos + i].ioa);
+            if (typeId == M_ME_TF_1) {
+                MeasuredValueShortWithCP56Time2a mv = (MeasuredValueShortWithCP56Time2a)io;
+                EXPECT(MeasuredValueShort_getValue((MeasuredValueShort)mv) == static_cast<float>(points[pos + i].value));
+                EXPECT(CP56Time2a_toMsTimestamp(MeasuredValueShortWithCP56Time2a_getTimestamp(mv)) == points[pos + i].timestamp);
+            }
+            InformationObject_destroy(io);
+        }
+        pos += packed;
+        asdus++;
+    }
+    EXPECT(asdus > 0);
+}
+
+int main()
+{
+    CheckPacking(M_ME_NC_1, true);
+    CheckPacking(M_ME_TF_1, false);
+    CheckPacking(M_SP_TB_1, false);
+    CheckPacking(M_IT_TB_1, false);
+
+    EXPECT(HasCP56Time2a(M_ME_TF_1));
+    EXPECT(!HasCP56Time2a(M_ME_NC_1));
+
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+// CS101_Master_setChannelReadyHandler (несбалансированный режим): после подтверждения кадра слейвом
+// канальный уровень вызывает обработчик, и CS101_Master_isChannelReady снова возвращает true.
+// Мастер и слейв lib60870 соединены двумя псевдотерминалами, байты между ними перекладывает поток.
+//
+//   test_cs101_channel_ready
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "cs101_master.h"
+#include "cs101_slave.h"
+#include "hal_serial.h"
+#include "hal_thread.h"
+}
+
+static const int SLAVE_ADDRESS = 3;
+
+static std::atomic<bool> relayRunning{true};
+static std::atomic<int> channelReady{0};
+static std::atomic<int> channelReadyAddress{-1};
+static std::atomic<bool> linkAvailable{false};
+static std::atomic<int> commands{0};
+
+// Перекладывает байты между ведущими сторонами двух псевдотерминалов (нуль-модем)
+static void Relay(int a, int b)
+{
+    uint8_t buffer[256];
+    while (relayRunning) {
+        struct pollfd fds[2] = {{a, POLLIN, 0}, {b, POLLIN, 0}};
+        if (poll(fds, 2, 10) <= 0)
+            continue;
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].revents & POLLIN) {
+                ssize_t n = read(fds[i].fd, buffer, sizeof(buffer));
+                if (n > 0 && write(i == 0 ? b : a, buffer, n) != n)
+                    return;
+            }
+        }
+    }
+}
+
+static void ChannelReady(void *parameter, int address)
+{
+    channelReadyAddress = address;
+    channelReady++;
+}
+
+static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state)
+{
+    if (address == SLAVE_ADDRESS && state == LL_STATE_AVAILABLE)
+        linkAvailable = true;
+}
+
+static bool SlaveASDUHandler(void *parameter, IMasterConnection connection, CS101_ASDU asdu)
+{
+    if (CS101_ASDU_getTypeID(asdu) == C_SC_NA_1)
+        commands++;
+    return true;
+}
+
+template <typename Predicate>
+static bool WaitFor(Predicate predicate, int timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        Thread_sleep(1);
+    }
+    return true;
+}
+
+static int OpenRawPty(int &master, char *name)
+{
+    int slave;
+    if (openpty(&master, &slave, name, NULL, NULL) != 0)
+        return -1;
+    struct termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+    return slave;
+}
+
+int main()
+{
+    int masterPty, slavePty;
+    char masterName[64], slaveName[64];
+    int masterSide = OpenRawPty(masterPty, masterName);
+    int slaveSide = OpenRawPty(slavePty, slaveName);
+    if (masterSide < 0 || slaveSide < 0) {
+        fprintf(stderr, "openpty failed\n");
+        return 1;
+    }
+    std::thread relay(Relay, masterPty, slavePty);
+
+    SerialPort slavePort = SerialPort_create(slaveName, 9600, 8, 'E', 1);
+    SerialPort masterPort = SerialPort_create(masterName, 9600, 8, 'E', 1);
+    SerialPort_open(slavePort);
+    SerialPort_open(masterPort);
+
+    CS101_Slave slave = CS101_Slave_create(slavePort, NULL, NULL, IEC60870_LINK_LAYER_UNBALANCED);
+    CS101_Slave_setLinkLayerAddress(slave, SLAVE_ADDRESS);
+    CS101_Slave_setASDUHandler(slave, SlaveASDUHandler, NULL);
+
+    CS101_Master master = CS101_Master_create(masterPort, NULL, NULL, IEC60870_LINK_LAYER_UNBALANCED);
+    CS101_Master_setLinkLayerStateChanged(master, LinkLayerStateChanged, NULL);
+    CS101_Master_setChannelReadyHandler(master, ChannelReady, NULL);
+    CS101_Master_addSlave(master, SLAVE_ADDRESS);
+
+    CS101_Slave_start(slave);
+    CS101_Master_start(master);
+
+    int failures = 0;
+    if (!WaitFor([] { return linkAvailable.load(); }, 5000)) {
+        fprintf(stderr, "link layer of slave %d not available\n", SLAVE_ADDRESS);
+        failures++;
+    } else {
+        WaitFor([&] { return CS101_Master_isChannelReady(master, SLAVE_ADDRESS); }, 2000);
+        int before = channelReady;
+
+        CS101_Master_useSlaveAddress(master, SLAVE_ADDRESS);
+        CS101_ASDU asdu = CS101_ASDU_create(CS101_Master_getAppLayerParameters(master), false, CS101_COT_ACTIVATION, 0, 1, false, false);
+        InformationObject io = (InformationObject)SingleCommand_create(NULL, 100, true, false, 0);
+        CS101_ASDU_addInformationObject(asdu, io);
+        CS101_Master_sendASDU(master, asdu);
+        InformationObject_destroy(io);
+        CS101_ASDU_destroy(asdu);
+
+        if (!WaitFor([&] { return channelReady > before; }, 5000)) {
+            fprintf(stderr, "channel ready handler not called after the command was confirmed\n");
+            failures++;
+        } else {
+            if (channelReadyAddress != SLAVE_ADDRESS) {
+                fprintf(stderr, "channel ready handler called for address %d\n", channelReadyAddress.load());
+                failures++;
+            }
+            if (!CS101_Master_isChannelReady(master, SLAVE_ADDRESS)) {
+                fprintf(stderr, "channel not ready in the channel ready handler\n");
+                failures++;
+            }
+            if (commands != 1) {
+                fprintf(stderr, "slave received %d commands\n", commands.load());
+                failures++;
+            }
+        }
+    }
+
+    CS101_Master_stop(master);
+    CS101_Slave_stop(slave);
+    relayRunning = false;
+    relay.join();
+    CS101_Master_destroy(master);
+    CS101_Slave_destroy(slave);
+    SerialPort_destroy(masterPort);
+    SerialPort_destroy(slavePort);
+    close(masterSide);
+    close(slaveSide);
+    close(masterPty);
+    close(slavePty);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,279 @@
+// Зона нечувствительности на приёме мастеров CS101 (IEC101MasterUnbalanced и IEC101MasterBalanced):
+// слейв lib60870 отправляет аналоговые значения, обработчик ASDU мастера декодирует их так же, как
+// RawMessageHandler аддона (CS101_ASDU_getElementEx в IODecodeBuffer, DecodedPoints), и пропускает
+// через DeadbandRules. Проверяется, какие значения дошли бы до JS: процент от диапазона (в том
+// числе около нуля), смена качества, ответы на опрос, правило для диапазона IOA и неаналоговый тип.
+// Мастер и слейв соединены двумя псевдотерминалами, байты между ними перекладывает поток.
+//
+//   test_cs101_master_deadband
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include "deadband_rules.h"
+#include "iec60870_decode.h"
+
+extern "C" {
+#include "cs101_master.h"
+#include "cs101_slave.h"
+#include "hal_serial.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+}
+
+static const int LINK_ADDRESS = 3;
+static const int CA = 1;
+
+// Значение, отправляемое слейвом, и должно ли оно дойти до JS
+struct Sample {
+    int typeId;
+    int cot;
+    int ioa;
+    double value;
+    uint8_t quality;
+    bool delivered;
+};
+
+// Зона по умолчанию: 1 % от диапазона 200 (min -100, max 100) = 2.0. IOA 200–209 — абсолютная зона 10
+static const Sample SAMPLES[] = {
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 0.0, IEC60870_QUALITY_GOOD, true},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 0.3, IEC60870_QUALITY_GOOD, false}, // Около нуля зона та же
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 1.9, IEC60870_QUALITY_GOOD, false},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 2.5, IEC60870_QUALITY_GOOD, true},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 2.6, IEC60870_QUALITY_INVALID, true}, // Смена качества
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 100, 2.7, IEC60870_QUALITY_INVALID, false},
+    {M_ME_NC_1, CS101_COT_INTERROGATED_BY_STATION, 100, 2.7, IEC60870_QUALITY_INVALID, true},
+    {M_ME_TF_1, CS101_COT_SPONTANEOUS, 101, 50.0, IEC60870_QUALITY_GOOD, true},
+    {M_ME_TF_1, CS101_COT_SPONTANEOUS, 101, 51.5, IEC60870_QUALITY_GOOD, false},
+    {M_ME_TF_1, CS101_COT_SPONTANEOUS, 101, 47.9, IEC60870_QUALITY_GOOD, true},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 205, 0.0, IEC60870_QUALITY_GOOD, true},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 205, 9.0, IEC60870_QUALITY_GOOD, false},
+    {M_ME_NC_1, CS101_COT_SPONTANEOUS, 205, 10.5, IEC60870_QUALITY_GOOD, true},
+    {M_SP_NA_1, CS101_COT_SPONTANEOUS, 300, 1.0, IEC60870_QUALITY_GOOD, true},
+    {M_SP_NA_1, CS101_COT_SPONTANEOUS, 300, 1.0, IEC60870_QUALITY_GOOD, true}, // Не аналоговый тип
+};
+static const int SAMPLE_COUNT = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+
+struct Receiver {
+    DeadbandRules deadband;
+    IODecodeBuffer decodeBuffer;
+    DecodedPoints decodedPoints;
+    std::mutex mutex;
+    std::vector<std::pair<int, double>> delivered; // (ioa, значение), прошедшие фильтр
+    std::atomic<int> received{0};
+};
+
+static std::atomic<bool> relayRunning{true};
+static std::atomic<bool> linkAvailable{false};
+
+// Перекладывает байты между ведущими сторонами двух псевдотерминалов (нуль-модем)
+static void Relay(int a, int b)
+{
+    uint8_t buffer[256];
+    while (relayRunning) {
+        struct pollfd fds[2] = {{a, POLLIN, 0}, {b, POLLIN, 0}};
+        if (poll(fds, 2, 10) <= 0)
+            continue;
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].revents & POLLIN) {
+                ssize_t n = read(fds[i].fd, buffer, sizeof(buffer));
+                if (n > 0 && write(i == 0 ? b : a, buffer, n) != n)
+                    return;
+            }
+        }
+    }
+}
+
+static void LinkLayerStateChanged(void *parameter, int address, LinkLayerState state)
+{
+    if (state == LL_STATE_AVAILABLE)
+        linkAvailable = true;
+}
+
+// Декодирование, как в RawMessageHandler мастеров CS101, затем DeadbandRules::Apply
+static bool MasterASDUHandler(void *parameter, int address, CS101_ASDU asdu)
+{
+    Receiver *receiver = static_cast<Receiver *>(parameter);
+    IEC60870_5_TypeID typeID = CS101_ASDU_getTypeID(asdu);
+    DecodedPoints &elements = receiver->decodedPoints;
+    elements.clear();
+    for (int i = 0; i < CS101_ASDU_getNumberOfElements(asdu); i++) {
+        InformationObject io = CS101_ASDU_getElementEx(asdu, (InformationObject)&receiver->decodeBuffer, i);
+        if (!io)
+            continue;
+        int ioa = InformationObject_getObjectAddress(io);
+        if (typeID == M_ME_NC_1 || typeID == M_ME_TF_1)
+            elements.emplace_back(ioa, MeasuredValueShort_getValue((MeasuredValueShort)io), MeasuredValueShort_getQuality((MeasuredValueShort)io), 0);
+        else if (typeID == M_SP_NA_1)
+            elements.emplace_back(ioa, SinglePointInformation_getValue((SinglePointInformation)io) ? 1.0 : 0.0, SinglePointInformation_getQuality((SinglePointInformation)io), 0);
+    }
+    receiver->deadband.Apply(typeID, CS101_ASDU_getCOT(asdu), CS101_ASDU_getCA(asdu), elements);
+    {
+        std::lock_guard<std::mutex> lock(receiver->mutex);
+        for (const auto &point : elements)
+            receiver->delivered.emplace_back(std::get<0>(point), std::get<1>(point));
+    }
+    receiver->received++;
+    return true;
+}
+
+static CS101_ASDU CreateSample(CS101_AppLayerParameters alParams, const Sample &sample)
+{
+    CS101_ASDU asdu = CS101_ASDU_create(alParams, false, static_cast<CS101_CauseOfTransmission>(sample.cot), 0, CA, false, false);
+    InformationObject io = nullptr;
+    if (sample.typeId == M_ME_NC_1) {
+        io = (InformationObject)MeasuredValueShort_create(NULL, sample.ioa, static_cast<float>(sample.value), sample.quality);
+    } else if (sample.typeId == M_ME_TF_1) {
+        struct sCP56Time2a time;
+        CP56Time2a_createFromMsTimestamp(&time, Hal_getTimeInMs());
+        io = (InformationObject)MeasuredValueShortWithCP56Time2a_create(NULL, sample.ioa, static_cast<float>(sample.value), sample.quality, &time);
+    } else {
+        io = (InformationObject)SinglePointInformation_create(NULL, sample.ioa, sample.value != 0, sample.quality);
+    }
+    CS101_ASDU_addInformationObject(asdu, io);
+    InformationObject_destroy(io);
+    return asdu;
+}
+
+template <typename Predicate>
+static bool WaitFor(Predicate predicate, int timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        Thread_sleep(1);
+    }
+    return true;
+}
+
+static int OpenRawPty(int &master, char *name)
+{
+    int slave;
+    if (openpty(&master, &slave, name, NULL, NULL) != 0)
+        return -1;
+    struct termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+    return slave;
+}
+
+static int Run(IEC60870_LinkLayerMode mode)
+{
+    const char *name = mode == IEC60870_LINK_LAYER_BALANCED ? "balanced" : "unbalanced";
+    int masterPty, slavePty;
+    char masterName[64], slaveName[64];
+    int masterSide = OpenRawPty(masterPty, masterName);
+    int slaveSide = OpenRawPty(slavePty, slaveName);
+    if (masterSide < 0 || slaveSide < 0) {
+        fprintf(stderr, "openpty failed\n");
+        return 1;
+    }
+    relayRunning = true;
+    linkAvailable = false;
+    std::thread relay(Relay, masterPty, slavePty);
+
+    Receiver receiver;
+    DeadbandRules::Band band;
+    band.percent = 1;
+    band.range = 200;
+    receiver.deadband.SetDefaultBand(band);
+    DeadbandRules::Band rangeBand;
+    rangeBand.absolute = 10;
+    receiver.deadband.AddRule(CA, 200, 209, rangeBand);
+    receiver.deadband.Enable();
+
+    SerialPort slavePort = SerialPort_create(slaveName, 9600, 8, 'E', 1);
+    SerialPort masterPort = SerialPort_create(masterName, 9600, 8, 'E', 1);
+    SerialPort_open(slavePort);
+    SerialPort_open(masterPort);
+
+    CS101_Slave slave = CS101_Slave_create(slavePort, NULL, NULL, mode);
+    CS101_Slave_setLinkLayerAddress(slave, LINK_ADDRESS);
+    CS101_Slave_setLinkLayerAddressOtherStation(slave, LINK_ADDRESS);
+
+    CS101_Master master = CS101_Master_create(masterPort, NULL, NULL, mode);
+    CS101_Master_setASDUReceivedHandler(master, MasterASDUHandler, &receiver);
+    CS101_Master_setLinkLayerStateChanged(master, LinkLayerStateChanged, NULL);
+    if (mode == IEC60870_LINK_LAYER_BALANCED) {
+        CS101_Master_setDIR(master, true);
+        CS101_Master_setOwnAddress(master, LINK_ADDRESS);
+        CS101_Master_useSlaveAddress(master, LINK_ADDRESS);
+    } else {
+        // Данные класса 2 мастер запрашивает сам, как IEC101MasterUnbalanced с автоопросом
+        CS101_Master_addSlave(master, LINK_ADDRESS);
+        CS101_Master_setAutoPolling(master, true, 0, 0);
+    }
+
+    CS101_Slave_start(slave);
+    CS101_Master_start(master);
+
+    int failures = 0;
+    if (!WaitFor([] { return linkAvailable.load(); }, 5000)) {
+        fprintf(stderr, "%s: link layer not available\n", name);
+        failures++;
+    } else {
+        CS101_AppLayerParameters alParams = CS101_Slave_getAppLayerParameters(slave);
+        for (const Sample &sample : SAMPLES) {
+            CS101_ASDU asdu = CreateSample(alParams, sample);
+            CS101_Slave_enqueueUserDataClass2(slave, asdu);
+            CS101_ASDU_destroy(asdu);
+        }
+
+        if (!WaitFor([&] { return receiver.received >= SAMPLE_COUNT; }, 10000)) {
+            fprintf(stderr, "%s: master received %d of %d ASDUs\n", name, receiver.received.load(), SAMPLE_COUNT);
+            failures++;
+        } else {
+            std::vector<std::pair<int, double>> expected;
+            for (const Sample &sample : SAMPLES) {
+                if (sample.delivered)
+                    expected.emplace_back(sample.ioa, static_cast<float>(sample.value));
+            }
+            std::lock_guard<std::mutex> lock(receiver.mutex);
+            if (receiver.delivered != expected) {
+                fprintf(stderr, "%s: delivered", name);
+                for (const auto &point : receiver.delivered)
+                    fprintf(stderr, " %d:%g", point.first, point.second);
+                fprintf(stderr, ", expected");
+                for (const auto &point : expected)
+                    fprintf(stderr, " %d:%g", point.first, point.second);
+                fprintf(stderr, "\n");
+                failures++;
+            }
+            uint64_t filtered = receiver.deadband.GetCounters().filtered;
+            if (filtered != static_cast<uint64_t>(SAMPLE_COUNT) - expected.size()) {
+                fprintf(stderr, "%s: filtered %llu samples\n", name, static_cast<unsigned long long>(filtered));
+                failures++;
+            }
+        }
+    }
+
+    CS101_Master_stop(master);
+    CS101_Slave_stop(slave);
+    relayRunning = false;
+    relay.join();
+    CS101_Master_destroy(master);
+    CS101_Slave_destroy(slave);
+    SerialPort_destroy(masterPort);
+    SerialPort_destroy(slavePort);
+    close(masterSide);
+    close(slaveSide);
+    close(masterPty);
+    close(slavePty);
+    return failures;
+}
+
+int main()
+{
+    int failures = Run(IEC60870_LINK_LAYER_UNBALANCED) + Run(IEC60870_LINK_LAYER_BALANCED);
+    return failures ? 1 : 0;
+}
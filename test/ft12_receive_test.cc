@@ -0,0 +1,116 @@
+// SerialTransceiverFT12_readAvailableMessages (неблокирующий приём FT 1.2): кадр, байты которого
+// приходят с паузами короче таймаута символа, принимается, даже если весь кадр дольше таймаута;
+// кадр 0x68 с испорченным заголовком (L != L или нет второго 0x68) сразу сбрасывает синхронизацию.
+//
+//   test_ft12_receive
+
+#include <cstdio>
+#include <vector>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "hal_serial.h"
+#include "hal_thread.h"
+#include "link_layer_parameters.h"
+#include "serial_transceiver_ft_1_2.h"
+}
+
+static const int CHARACTER_TIMEOUT = 100;
+
+static std::vector<std::vector<uint8_t>> messages;
+
+static void MessageHandler(void *parameter, uint8_t *msg, int msgSize)
+{
+    messages.emplace_back(msg, msg + msgSize);
+}
+
+static int failures = 0;
+
+#define EXPECT(cond)                                                         \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+// Кадр с переменной длиной: 68 L L 68 C A <данные> CS 16
+static std::vector<uint8_t> VariableFrame(std::vector<uint8_t> userData)
+{
+    std::vector<uint8_t> body = {0x08, 0x01};
+    body.insert(body.end(), userData.begin(), userData.end());
+    uint8_t checksum = 0;
+    for (uint8_t b : body)
+        checksum += b;
+    std::vector<uint8_t> frame = {0x68, (uint8_t)body.size(), (uint8_t)body.size(), 0x68};
+    frame.insert(frame.end(), body.begin(), body.end());
+    frame.push_back(checksum);
+    frame.push_back(0x16);
+    return frame;
+}
+
+int main()
+{
+    int ptyMaster, ptySlave;
+    char name[64];
+    if (openpty(&ptyMaster, &ptySlave, name, NULL, NULL) != 0) {
+        fprintf(stderr, "openpty failed\n");
+        return 1;
+    }
+    struct termios tio;
+    tcgetattr(ptyMaster, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(ptyMaster, TCSANOW, &tio);
+
+    SerialPort port = SerialPort_create(name, 9600, 8, 'E', 1);
+    SerialPort_open(port);
+    struct sLinkLayerParameters llParameters = {1, 200, 1000, true, 1000};
+    SerialTransceiverFT12 transceiver = SerialTransceiverFT12_create(port, &llParameters);
+    SerialTransceiverFT12_setTimeouts(transceiver, 10, CHARACTER_TIMEOUT);
+    uint8_t buffer[256];
+
+    // Кадр по байту каждые 30 мс: пауза меньше таймаута символа, весь кадр — около 450 мс
+    std::vector<uint8_t> slow = VariableFrame({0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09});
+    for (uint8_t b : slow) {
+        EXPECT(write(ptyMaster, &b, 1) == 1);
+        Thread_sleep(30);
+        SerialTransceiverFT12_readAvailableMessages(transceiver, buffer, MessageHandler, NULL);
+    }
+    EXPECT(messages.size() == 1);
+    EXPECT(!messages.empty() && messages[0] == slow);
+
+    // Испорченная длина (05 06): без проверки заголовка приёмник ждал бы 11 байт и проглотил бы следующий кадр
+    messages.clear();
+    std::vector<uint8_t> corrupt = {0x68, 0x05, 0x06, 0x68};
+    EXPECT(write(ptyMaster, corrupt.data(), corrupt.size()) == (ssize_t)corrupt.size());
+    Thread_sleep(20);
+    SerialTransceiverFT12_readAvailableMessages(transceiver, buffer, MessageHandler, NULL);
+    std::vector<uint8_t> valid = VariableFrame({0x11, 0x22});
+    EXPECT(write(ptyMaster, valid.data(), valid.size()) == (ssize_t)valid.size());
+    Thread_sleep(20);
+    SerialTransceiverFT12_readAvailableMessages(transceiver, buffer, MessageHandler, NULL);
+    EXPECT(messages.size() == 1);
+    EXPECT(!messages.empty() && messages[0] == valid);
+
+    // Нет второго 0x68
+    messages.clear();
+    std::vector<uint8_t> noStart = {0x68, 0x02, 0x02, 0x10};
+    EXPECT(write(ptyMaster, noStart.data(), noStart.size()) == (ssize_t)noStart.size());
+    Thread_sleep(20);
+    SerialTransceiverFT12_readAvailableMessages(transceiver, buffer, MessageHandler, NULL);
+    EXPECT(write(ptyMaster, valid.data(), valid.size()) == (ssize_t)valid.size());
+    Thread_sleep(20);
+    SerialTransceiverFT12_readAvailableMessages(transceiver, buffer, MessageHandler, NULL);
+    EXPECT(messages.size() == 1);
+    EXPECT(!messages.empty() && messages[0] == valid);
+
+    SerialTransceiverFT12_destroy(transceiver);
+    SerialPort_destroy(port);
+    close(ptySlave);
+    close(ptyMaster);
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}